@@ -0,0 +1,115 @@
+// Memória por host: pendura 'hosts' hosts em rodízio nos roteadores de uma
+// topologia gerada, monta tudo com o perfil de host pedido (full: o
+// InternetStackHelper completo; light: IPv4, ICMP e UDP, ver
+// util/topology-loader.h) e mede quanto a memória residente cresceu na
+// montagem.
+//
+//   ./waf --run "host_memory --generate=grid:16x16 --hosts=50000 --profile=light --results=hosts.csv"
+//   ./waf --run "host_memory --generate=grid:16x16 --hosts=0 --results=hosts.csv"
+//
+// A memória de um host sai da diferença entre uma execução com hosts e outra
+// sem nenhum; bench/host_memory.sh faz as duas para cada perfil e tamanho e
+// imprime os KiB por host. Com simulationTime > 0 a simulação também roda,
+// para incluir o estado criado pelo roteamento (tabelas do RIP, por exemplo).
+
+#include "../util/resource-usage.h"
+#include "../util/run-results.h"
+#include "../util/topology-generator.h"
+#include "../util/topology-loader.h"
+
+#include "ns3/core-module.h"
+
+#include <iostream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("HostMemory");
+
+int main (int argc, char **argv)
+{
+  std::string generate ("grid:16x16");
+  uint32_t hosts = 10000;
+  std::string profile ("light");
+  std::string linkType ("p2p");
+  std::string routing ("none");
+  double simulationTime = 0.0; //seconds
+  std::string resultsFile;
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("generate", "Router topology (ring:N, grid:RxC, mesh:N[:degree[:seed]], regular:N:degree, fattree:K)", generate);
+  cmd.AddValue ("hosts", "Hosts spread round-robin over the routers", hosts);
+  cmd.AddValue ("profile", "Host profile: full (InternetStackHelper) or light (IPv4, ICMP and UDP only)", profile);
+  cmd.AddValue ("linkType", "Link type: p2p or csma (csma hosts keep ARP)", linkType);
+  cmd.AddValue ("routing", "Routing: none, rip or global", routing);
+  cmd.AddValue ("simulationTime", "Simulation time in seconds, 0 to only build the topology", simulationTime);
+  cmd.AddValue ("results", "Append a CSV row with the node counts and memory to this file", resultsFile);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF (profile != "full" && profile != "light", "Unknown host profile " << profile << " (full or light)");
+  NS_ABORT_MSG_IF (linkType != "p2p" && linkType != "csma", "Unknown link type " << linkType << " (p2p or csma)");
+  NS_ABORT_MSG_IF (routing != "none" && routing != "rip" && routing != "global",
+                   "Unknown routing " << routing << " (none, rip or global)");
+
+  TopologySpec spec;
+  std::string error;
+  if (!GenerateTopology (spec, generate, &error))
+  {
+    NS_FATAL_ERROR (error);
+  }
+  uint32_t routers = spec.nodes.size ();
+  SpreadHosts (spec, hosts);
+
+  uint64_t startKiB = GetCurrentRssKiB ();
+  WallClock buildClock;
+  TopologyLoader topology;
+  topology.SetLinkType (linkType == "p2p" ? TopologyLoader::POINT_TO_POINT : TopologyLoader::CSMA);
+  topology.SetRouting (routing == "rip"      ? TopologyLoader::ROUTING_RIP
+                       : routing == "global" ? TopologyLoader::ROUTING_GLOBAL
+                                             : TopologyLoader::ROUTING_NONE);
+  topology.SetHostProfile (profile == "light" ? TopologyLoader::HOST_LIGHT : TopologyLoader::HOST_FULL);
+  topology.SetRegisterNames (false);
+  topology.SetSpec (spec);
+  topology.Build ();
+  double buildSeconds = buildClock.GetSeconds ();
+  uint64_t rssKiB = GetCurrentRssKiB ();
+  uint64_t buildKiB = rssKiB - std::min (rssKiB, startKiB);
+
+  double wallSeconds = 0;
+  if (simulationTime > 0)
+  {
+    Simulator::Stop (Seconds (simulationTime));
+    WallClock runClock;
+    Simulator::Run ();
+    wallSeconds = runClock.GetSeconds ();
+  }
+  rssKiB = GetCurrentRssKiB ();
+  uint64_t totalKiB = rssKiB - std::min (rssKiB, startKiB);
+
+  topology.PrintReport (std::cout);
+  std::cout << generate << " + " << hosts << " " << profile << " hosts (" << linkType << ", " << routing
+            << "): build " << buildKiB / 1024.0 << " MiB in " << buildSeconds << " s, "
+            << (routers + hosts ? buildKiB / double (routers + hosts) : 0.0) << " KiB per node, after run "
+            << totalKiB / 1024.0 << " MiB" << std::endl;
+  if (!resultsFile.empty ())
+  {
+    RunResults results;
+    results.Set ("topology", generate);
+    results.Set ("routers", routers);
+    results.Set ("hosts", hosts);
+    results.Set ("profile", profile);
+    results.Set ("linkType", linkType);
+    results.Set ("routing", routing);
+    results.Set ("simulationTime", simulationTime);
+    results.Set ("buildSeconds", buildSeconds);
+    results.Set ("buildKiB", buildKiB);
+    results.Set ("totalKiB", totalKiB);
+    results.Set ("wallSeconds", wallSeconds);
+    results.Set ("peakRssMiB", GetPeakRssKiB () / 1024.0);
+    if (!results.Write (resultsFile, &error))
+    {
+      NS_FATAL_ERROR (error);
+    }
+  }
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,32 @@
+#!/bin/sh
+# Memória por host: roda o host_memory sem hosts e com cada quantidade de
+# SIZES, nos dois perfis, e imprime os KiB por host (crescimento da memória
+# na montagem em relação à execução sem hosts, dividido pelos hosts).
+#
+#   ./bench/host_memory.sh
+#   SIZES="10000 60000" ROUTING=rip SIMULATION_TIME=30 ./bench/host_memory.sh
+#   LINK_TYPE=csma OUT=csma.csv ./bench/host_memory.sh
+#
+# Rodar a partir do diretório do ns-3, com o programa copiado para scratch/.
+
+set -e
+
+GENERATE=${GENERATE:-grid:16x16}
+SIZES=${SIZES:-"1000 10000 50000"}
+PROFILES=${PROFILES:-"full light"}
+LINK_TYPE=${LINK_TYPE:-p2p}
+ROUTING=${ROUTING:-none}
+SIMULATION_TIME=${SIMULATION_TIME:-0}
+OUT=${OUT:-host-memory.csv}
+
+rm -f "$OUT"
+./waf build
+for profile in $PROFILES; do
+  for hosts in 0 $SIZES; do
+    ./waf --run-no-build "host_memory --generate=$GENERATE --hosts=$hosts --profile=$profile --linkType=$LINK_TYPE --routing=$ROUTING --simulationTime=$SIMULATION_TIME --results=$OUT"
+  done
+done
+
+# colunas: topology routers hosts profile linkType routing simulationTime buildSeconds buildKiB totalKiB wallSeconds peakRssMiB
+awk -F, 'NR > 1 && $3 == 0 { base[$4] = $9; baseTotal[$4] = $10 }
+         NR > 1 && $3 > 0 { printf "%-5s %7d hosts  build %8.2f s  %7.2f KiB/host  %7.2f KiB/host after run\n", $4, $3, $8, ($9 - base[$4]) / $3, ($10 - baseTotal[$4]) / $3 }' "$OUT"
@@ -0,0 +1,187 @@
+// Busca do maior prefixo: varredura linear da tabela (como a BatchedRip e a
+// OspfRouting faziam) contra a PrefixTrie (util/prefix-trie.h), em ns por
+// busca para tabelas de tamanhos crescentes, mais o custo das atualizações
+// incrementais da trie (remove e reinsere prefixos da tabela, como a
+// coleta e o reaprendizado de rotas RIP). Os prefixos seguem uma mistura parecida com a de uma tabela
+// real (a maioria /24, o resto entre /8 e /32) e cada busca é conferida
+// contra a varredura.
+//
+//   g++ -O2 -std=c++17 -o lpm_bench bench/lpm_bench.cc
+//   ./lpm_bench
+//   ./lpm_bench --sizes=100,10000,500000 --lookups=2000000
+//
+// Não depende do ns-3.
+
+#include "../util/prefix-trie.h"
+#include "../util/resource-usage.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+using namespace ns3;
+
+namespace {
+
+typedef std::pair<uint32_t, uint32_t> Prefix; // (rede, máscara)
+
+volatile long g_sink; // para as buscas não saírem do laço medido
+
+uint32_t
+MaskOf (uint32_t length)
+{
+  return length == 0 ? 0 : 0xffffffffu << (32 - length);
+}
+
+Prefix
+RandomPrefix (std::mt19937 &rng)
+{
+  std::uniform_int_distribution<uint32_t> percent (0, 99);
+  uint32_t p = percent (rng);
+  uint32_t length = p < 55 ? 24 : p < 70 ? std::uniform_int_distribution<uint32_t> (16, 23) (rng)
+                            : p < 95 ? std::uniform_int_distribution<uint32_t> (25, 30) (rng)
+                                     : p < 98 ? 32 : std::uniform_int_distribution<uint32_t> (8, 15) (rng);
+  uint32_t mask = MaskOf (length);
+  return Prefix (rng () & mask, mask);
+}
+
+// a busca antiga: a tabela inteira, guardando o maior prefixo que casa
+const int *
+LinearLookup (const std::map<Prefix, int> &table, uint32_t address)
+{
+  const int *best = nullptr;
+  uint32_t bestMask = 0;
+  for (const std::pair<const Prefix, int> &entry : table)
+  {
+    if ((address & entry.first.second) == entry.first.first && (best == nullptr || entry.first.second > bestMask))
+    {
+      best = &entry.second;
+      bestMask = entry.first.second;
+    }
+  }
+  return best;
+}
+
+} // namespace
+
+int main (int argc, char **argv)
+{
+  std::vector<uint32_t> sizes = {16, 128, 1024, 8192, 65536};
+  unsigned long lookups = 1000000;
+  unsigned long updates = 200000;
+  for (int i = 1; i < argc; ++i)
+  {
+    if (std::strncmp (argv[i], "--sizes=", 8) == 0)
+    {
+      sizes.clear ();
+      std::istringstream list (argv[i] + 8);
+      std::string size;
+      while (std::getline (list, size, ','))
+      {
+        sizes.push_back (std::strtoul (size.c_str (), nullptr, 10));
+      }
+    }
+    else if (std::strncmp (argv[i], "--lookups=", 10) == 0)
+    {
+      lookups = std::strtoul (argv[i] + 10, nullptr, 10);
+    }
+    else if (std::strncmp (argv[i], "--updates=", 10) == 0)
+    {
+      updates = std::strtoul (argv[i] + 10, nullptr, 10);
+    }
+    else
+    {
+      std::cerr << "uso: " << argv[0] << " [--sizes=N,N,...] [--lookups=N] [--updates=N]" << std::endl;
+      return 2;
+    }
+  }
+
+  std::printf ("%10s %14s %12s %10s %14s\n", "prefixos", "linear ns/op", "trie ns/op", "ganho", "update ns/op");
+  for (uint32_t size : sizes)
+  {
+    std::mt19937 rng (size);
+    std::map<Prefix, int> table;
+    PrefixTrie<int> trie;
+    table[Prefix (0, 0)] = 0; // rota padrão, como nos hosts
+    trie.Insert (0, 0, 0);
+    while (table.size () < size)
+    {
+      Prefix prefix = RandomPrefix (rng);
+      int value = table.size ();
+      if (table.insert (std::make_pair (prefix, value)).second)
+      {
+        trie.Insert (prefix.first, PrefixTrie<int>::GetPrefixLength (prefix.second), value);
+      }
+    }
+    // metade dos destinos dentro de um prefixo da tabela, metade ao acaso
+    std::vector<const Prefix *> keys;
+    for (const std::pair<const Prefix, int> &entry : table)
+    {
+      keys.push_back (&entry.first);
+    }
+    std::vector<uint32_t> addresses (4096);
+    for (uint32_t &address : addresses)
+    {
+      const Prefix &prefix = *keys[rng () % keys.size ()];
+      address = rng () % 2 ? prefix.first | (rng () & ~prefix.second) : rng ();
+    }
+
+    // a varredura fica com no máximo ~5e7 prefixos visitados
+    unsigned long linearLookups = std::max<unsigned long> (20, std::min<unsigned long> (lookups, 5e7 / size));
+    long checksum = 0;
+    WallClock clock;
+    for (unsigned long i = 0; i < linearLookups; ++i)
+    {
+      const int *value = LinearLookup (table, addresses[i % addresses.size ()]);
+      checksum += value ? *value : -1;
+    }
+    double linearNs = clock.GetSeconds () * 1e9 / linearLookups;
+
+    clock.Restart ();
+    for (unsigned long i = 0; i < lookups; ++i)
+    {
+      const int *value = trie.Lookup (addresses[i % addresses.size ()]);
+      checksum -= value ? *value : -1;
+    }
+    double trieNs = clock.GetSeconds () * 1e9 / lookups;
+
+    for (uint32_t i = 0; i < std::min<unsigned long> (addresses.size (), linearLookups); ++i)
+    {
+      uint32_t address = addresses[i];
+      const int *want = LinearLookup (table, address);
+      const int *got = trie.Lookup (address);
+      if ((want == nullptr) != (got == nullptr) || (want && *want != *got))
+      {
+        std::cerr << "busca de " << address << " nao confere com a varredura" << std::endl;
+        return 1;
+      }
+    }
+
+    // churn: cada update retira um prefixo e o anuncia de novo
+    clock.Restart ();
+    for (unsigned long i = 0; i < updates; ++i)
+    {
+      const Prefix &old = *keys[i % keys.size ()];
+      trie.Remove (old.first, PrefixTrie<int>::GetPrefixLength (old.second));
+      trie.Insert (old.first, PrefixTrie<int>::GetPrefixLength (old.second), i);
+    }
+    double updateNs = clock.GetSeconds () * 1e9 / (2 * updates);
+    if (trie.GetSize () != table.size ())
+    {
+      std::cerr << "trie com " << trie.GetSize () << " prefixos depois dos updates, esperava " << table.size ()
+                << std::endl;
+      return 1;
+    }
+
+    g_sink = checksum;
+    std::printf ("%10zu %14.1f %12.1f %9.0fx %14.1f\n", table.size (), linearNs, trieNs, linearNs / trieNs, updateNs);
+  }
+  return 0;
+}
@@ -0,0 +1,35 @@
+#!/bin/sh
+# Relatório de escala do RIP na simulação distribuída: roda o
+# rip_mpi_scaling com 1, 2, 4, ... processos na mesma topologia e imprime
+# eventos por segundo e aceleração em relação a um processo; a tabela fica
+# também em $REPORT, para ir junto com as mudanças no particionamento.
+#
+#   ./bench/mpi_scaling.sh                                  # mesh:5000:4, 1 2 4 8 processos
+#   RANKS="1 2 4" GENERATE=mesh:10000:4 ./bench/mpi_scaling.sh
+#   PARTITION=block ./bench/mpi_scaling.sh                  # corte ingênuo, para comparar
+#
+# Rodar a partir do diretório do ns-3, com o programa copiado para scratch/ e
+# o ns-3 configurado com --enable-mpi.
+
+set -e
+
+RANKS=${RANKS:-"1 2 4 8"}
+GENERATE=${GENERATE:-mesh:5000:4}
+SIMULATION_TIME=${SIMULATION_TIME:-60}
+PARTITION=${PARTITION:-graph}
+OUT=${OUT:-mpi-scaling.csv}
+REPORT=${REPORT:-mpi-scaling.txt}
+MPIEXEC=${MPIEXEC:-mpiexec}
+
+rm -f "$OUT"
+for n in $RANKS; do
+  ./waf --run "rip_mpi_scaling --generate=$GENERATE --simulationTime=$SIMULATION_TIME --partition=$PARTITION --results=$OUT" \
+    --command-template="$MPIEXEC -np $n %s"
+done
+
+# colunas: ranks partition nodes links cutLinks lookaheadMs simulationTime events wallSeconds eventsPerSecond ...
+echo "$GENERATE, ${SIMULATION_TIME} s, partition $PARTITION" > "$REPORT"
+awk -F, 'NR == 1 { next }
+         NR == 2 { base = $10 }
+         { printf "%6s ranks  %8s cut links  %12.0f events/s  speedup %.2f\n", $1, $5, $10, $10 / base }' "$OUT" >> "$REPORT"
+cat "$REPORT"
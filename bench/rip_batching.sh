@@ -0,0 +1,99 @@
+#!/bin/sh
+# Custo e convergência do RIP com e sem os mecanismos da BatchedRip
+# (util/batched-rip.h): roda o rip_tp2 sob um roteiro de falhas com
+# oscilações, RUNS vezes (--RngRun) em cada configuração, e imprime a média
+# dos bytes de controle, dos updates disparados, das rotas suprimidas, da
+# soma dos tempos de convergência e dos ecos perdidos. A configuração
+# recomendada é a de menos bytes de controle entre as que não convergem mais
+# devagar nem perdem mais ecos que a linha de base além de TOLERANCE (10%);
+# a tabela e a recomendação ficam também em $REPORT.
+#
+#   ./bench/rip_batching.sh
+#   RUNS=10 SPLIT_HORIZON=SplitHorizon ./bench/rip_batching.sh
+#   FAILURES=meu-roteiro.txt TOPOLOGY=malha.topo ./bench/rip_batching.sh
+#
+# Rodar a partir do diretório do ns-3, com o programa copiado para scratch/.
+
+set -e
+
+RUNS=${RUNS:-5}
+SPLIT_HORIZON=${SPLIT_HORIZON:-PoisonReverse}
+SIMULATION_TIME=${SIMULATION_TIME:-150}
+FAILURES=${FAILURES:-}
+TOPOLOGY=${TOPOLOGY:-}
+OUT=${OUT:-rip-batching.csv}
+CONVERGENCE=${CONVERGENCE:-rip-batching-convergence.csv}
+REPORT=${REPORT:-rip-batching.txt}
+TOLERANCE=${TOLERANCE:-0.1}
+
+# roteiro padrão: net2 oscila três vezes em 20 s, net5 cai uma vez
+if [ -z "$FAILURES" ]; then
+  FAILURES=rip-batching-failures.txt
+  cat > "$FAILURES" <<EOF
+down 30 link net2
+up 34 link net2
+down 38 link net2
+up 42 link net2
+down 46 link net2
+up 50 link net2
+down 80 link net5
+up 110 link net5
+EOF
+fi
+EXTRA=""
+if [ -n "$TOPOLOGY" ]; then
+  EXTRA="--topology=$TOPOLOGY"
+fi
+
+rm -f "$OUT" "$CONVERGENCE"
+./waf build
+
+# nome e opções de cada configuração; baseline é a BatchedRip com os
+# atributos padrão, igual ao ns3::Rip
+run ()
+{
+  name=$1
+  shift
+  for run in $(seq 1 "$RUNS"); do
+    ./waf --run-no-build "rip_tp2 --batchedRip $* --splitHorizonStrategy=$SPLIT_HORIZON --failures=$FAILURES $EXTRA --simulationTime=$SIMULATION_TIME --RngRun=$run --anim=none --pcap=none --traceFormat=none --convergence=rip-batching-run.csv --results=$OUT"
+    awk -F, -v name="$name" -v options="$*" \
+      'NR == 1 { for (c = 1; c <= NF; c++) column[$c] = c
+                 if (!("lastRouteChange" in column) || !("lost" in column)) { print "rip-batching-run.csv sem lastRouteChange/lost" > "/dev/stderr"; bad = 1; exit 1 }
+                 next }
+       { convergence += $column["lastRouteChange"]; lost += $column["lost"] }
+       END { if (bad) exit 1; printf "%s,%.3f,%d,%s\n", name, convergence, lost, options }' rip-batching-run.csv >> "$CONVERGENCE"
+  done
+}
+
+run baseline
+run coalesce5 --coalesceWindow=5
+run coalesce15 --coalesceWindow=15
+run packing25 --ripMaxEntries=25
+run damping --ripDamping
+run all --coalesceWindow=5 --ripMaxEntries=25 --ripDamping
+
+# colunas do $CONVERGENCE: name convergenceSeconds lost options (uma linha por execução, na ordem do $OUT);
+# as do $OUT saem do cabeçalho pelo nome
+awk -F, -v tolerance="$TOLERANCE" \
+    'NR == FNR { name[FNR] = $1; convergence[FNR] = $2; lost[FNR] = $3; options[$1] = $4; next }
+     FNR == 1 { for (c = 1; c <= NF; c++) column[$c] = c
+                split ("ripControlBytes triggeredUpdates routeSuppressions", wanted, " ")
+                for (w in wanted) if (!(wanted[w] in column)) { print FILENAME " sem a coluna " wanted[w] > "/dev/stderr"; bad = 1; exit 1 }
+                next }
+     { i = FNR - 1; n = name[i]; if (!(n in runs)) order[++names] = n
+       runs[n]++; bytes[n] += $column["ripControlBytes"]; triggered[n] += $column["triggeredUpdates"]
+       suppressed[n] += $column["routeSuppressions"]; conv[n] += convergence[i]; loss[n] += lost[i] }
+     END { if (bad) exit 1
+           for (k = 1; k <= names; k++) { n = order[k]
+             printf "%-10s %9.0f control bytes  %6.1f triggered  %5.1f suppressed  converged %7.2f s  %6.1f echoes lost\n",
+                    n, bytes[n] / runs[n], triggered[n] / runs[n], suppressed[n] / runs[n], conv[n] / runs[n], loss[n] / runs[n] }
+           best = "baseline"
+           for (k = 1; k <= names; k++) { n = order[k]
+             if (conv[n] / runs[n] <= (1 + tolerance) * conv["baseline"] / runs["baseline"] \
+                 && loss[n] / runs[n] <= (1 + tolerance) * loss["baseline"] / runs["baseline"] \
+                 && bytes[n] / runs[n] < bytes[best] / runs[best])
+               best = n }
+           printf "recommended: %s (%s), %.0f%% of the baseline control bytes\n",
+                  best, options[best] == "" ? "default attributes" : options[best], 100 * bytes[best] / bytes["baseline"] }' \
+    "$CONVERGENCE" "$OUT" > "$REPORT"
+cat "$REPORT"
@@ -0,0 +1,154 @@
+// Convergência do RIP numa topologia grande dividida entre processos MPI
+// (simulador distribuído do ns-3). Todos os processos montam a mesma
+// topologia; o PartitionGraph (util/graph-partition.h) decide o processo de
+// cada nó minimizando os enlaces cortados, que viram ponto a ponto remotos com
+// o atraso dos enlaces (2 ms por padrão) como lookahead.
+//
+//   ./waf configure --enable-mpi
+//   ./waf --run "rip_mpi_scaling --generate=mesh:5000:4 --results=escala.csv" --command-template="mpiexec -np 4 %s"
+//
+// O processo 0 acrescenta a 'results' uma linha com o número de processos, o
+// corte, os eventos de todos os processos e o tempo de parede do mais lento.
+// bench/mpi_scaling.sh roda a sequência de 1, 2, 4, ... processos.
+
+#include "../util/graph-partition.h"
+#include "../util/run-results.h"
+#include "../util/topology-generator.h"
+#include "../util/topology-loader.h"
+
+#include "ns3/core-module.h"
+#include "ns3/mpi-module.h"
+
+#include <mpi.h>
+
+#include <iostream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("RipMpiScaling");
+
+int main (int argc, char **argv)
+{
+  std::string topologyFile;
+  std::string generate ("mesh:5000:4");
+  uint32_t hosts = 0;
+  std::string partitionMethod ("graph");
+  bool nullMessage = false;
+  double simulationTime = 60.0; //seconds
+  std::string dataRate ("5Mbps");
+  std::string delay ("2ms");
+  std::string resultsFile;
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("topology", "Edge list or GraphML file to load", topologyFile);
+  cmd.AddValue ("generate", "Generate the topology instead (ring:N, grid:RxC, mesh:N[:degree[:seed]])", generate);
+  cmd.AddValue ("hosts", "Hosts attached to the first routers of a generated topology", hosts);
+  cmd.AddValue ("partition", "Node to rank assignment: graph (minimum cut) or block (by node id)", partitionMethod);
+  cmd.AddValue ("nullMessage", "Use the null message instead of the granted time window synchronisation", nullMessage);
+  cmd.AddValue ("simulationTime", "Simulation time in seconds", simulationTime);
+  cmd.AddValue ("dataRate", "Default link data rate (e.g. 5Mbps)", dataRate);
+  cmd.AddValue ("delay", "Default link delay, the lookahead across ranks (e.g. 2ms)", delay);
+  cmd.AddValue ("results", "Append a CSV row with ranks, cut and events/s to this file (rank 0)", resultsFile);
+  cmd.Parse (argc, argv);
+
+  GlobalValue::Bind ("SimulatorImplementationType",
+                     StringValue (nullMessage ? "ns3::NullMessageSimulatorImpl" : "ns3::DistributedSimulatorImpl"));
+  MpiInterface::Enable (&argc, &argv);
+  uint32_t rank = MpiInterface::GetSystemId ();
+  uint32_t ranks = MpiInterface::GetSize ();
+
+  WallClock buildClock;
+  TopologySpec spec;
+  std::string error;
+  if (!topologyFile.empty ())
+  {
+    if (!spec.ReadFile (topologyFile, &error))
+    {
+      NS_FATAL_ERROR (error);
+    }
+  }
+  else if (!GenerateTopology (spec, generate, &error))
+  {
+    NS_FATAL_ERROR (error);
+  }
+  AttachHosts (spec, hosts);
+
+  std::vector<uint32_t> systemIds (spec.nodes.size ());
+  if (partitionMethod == "block")
+  {
+    for (uint32_t i = 0; i < systemIds.size (); ++i)
+    {
+      systemIds[i] = uint64_t (i) * ranks / systemIds.size ();
+    }
+  }
+  else
+  {
+    systemIds = PartitionGraph (spec, ranks);
+  }
+  uint32_t cutLinks = 0;
+  Time lookahead;
+  for (const TopologyLinkSpec &link : spec.links)
+  {
+    if (systemIds[link.a] != systemIds[link.b])
+    {
+      Time linkDelay = link.delayNs >= 0 ? NanoSeconds (link.delayNs) : Time (delay);
+      lookahead = cutLinks == 0 ? linkDelay : std::min (lookahead, linkDelay);
+      ++cutLinks;
+    }
+  }
+  NS_ABORT_MSG_IF (cutLinks && !lookahead.IsStrictlyPositive (), "Links between ranks need a positive delay");
+
+  TopologyLoader topology;
+  topology.SetLinkType (TopologyLoader::POINT_TO_POINT);
+  topology.SetRouting (TopologyLoader::ROUTING_RIP);
+  topology.SetDefaultDataRate (DataRate (dataRate));
+  topology.SetDefaultDelay (Time (delay));
+  topology.SetRegisterNames (false);
+  topology.SetPartition (systemIds);
+  topology.SetSpec (spec);
+  topology.Build ();
+  double buildSeconds = buildClock.GetSeconds ();
+
+  Simulator::Stop (Seconds (simulationTime));
+  WallClock runClock;
+  Simulator::Run ();
+  double wallSeconds = runClock.GetSeconds ();
+  uint64_t localEvents = Simulator::GetEventCount ();
+
+  uint64_t events = 0;
+  double slowest = 0;
+  MPI_Reduce (&localEvents, &events, 1, MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce (&wallSeconds, &slowest, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+  if (rank == 0)
+  {
+    topology.PrintReport (std::cout);
+    std::cout << ranks << " ranks, " << cutLinks << " links between ranks, lookahead " << lookahead.GetMilliSeconds ()
+              << " ms: " << events << " events in " << slowest << " s (" << events / slowest << " events/s)"
+              << std::endl;
+    if (!resultsFile.empty ())
+    {
+      RunResults results;
+      results.Set ("ranks", ranks);
+      results.Set ("partition", partitionMethod);
+      results.Set ("nodes", spec.nodes.size ());
+      results.Set ("links", spec.links.size ());
+      results.Set ("cutLinks", cutLinks);
+      results.Set ("lookaheadMs", lookahead.GetMilliSeconds ());
+      results.Set ("simulationTime", simulationTime);
+      results.Set ("events", events);
+      results.Set ("wallSeconds", slowest);
+      results.Set ("eventsPerSecond", events / slowest);
+      results.Set ("buildSeconds", buildSeconds);
+      results.Set ("peakRssMiB", GetPeakRssKiB () / 1024.0);
+      if (!results.Write (resultsFile, &error))
+      {
+        NS_FATAL_ERROR (error);
+      }
+    }
+  }
+
+  Simulator::Destroy ();
+  MpiInterface::Disable ();
+  return 0;
+}
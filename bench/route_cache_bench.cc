@@ -0,0 +1,199 @@
+// Custo do repasse com e sem o RouteCache (util/route-cache.h): monta uma
+// topologia gerada com o cache na frente do roteamento dos roteadores, deixa
+// o roteamento convergir e, com a simulação parada, chama o RouteInput de um
+// roteador para pacotes de --flows pares (origem, destino) sorteados entre os
+// endereços dos enlaces. Cada pacote passa uma vez pelo cache e outra direto
+// pela Ipv4ListRouting de baixo, que é o caminho sem o cache; a saída é o
+// tempo de relógio por pacote repassado nos dois casos e a taxa de acertos.
+//
+//   ./waf --run "route_cache_bench --generate=grid:16x16 --routing=rip"
+//   ./waf --run "route_cache_bench --generate=mesh:1000:4 --routing=ospf --flows=4096 --results=cache.csv"
+//
+// Com mais pares que entradas (--routeCacheSize) as colisões aparecem na taxa
+// de acertos e no tempo com o cache.
+
+#include "../util/resource-usage.h"
+#include "../util/route-cache.h"
+#include "../util/run-results.h"
+#include "../util/topology-generator.h"
+#include "../util/topology-loader.h"
+
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("RouteCacheBench");
+
+namespace {
+
+uint64_t g_forwarded = 0;
+uint64_t g_errors = 0;
+
+void
+Forwarded (Ptr<Ipv4Route> /* route */, Ptr<const Packet> /* packet */, const Ipv4Header & /* header */)
+{
+  ++g_forwarded;
+}
+
+void
+MulticastForwarded (Ptr<Ipv4MulticastRoute> /* route */, Ptr<const Packet> /* packet */,
+                    const Ipv4Header & /* header */)
+{
+}
+
+void
+Delivered (Ptr<const Packet> /* packet */, const Ipv4Header & /* header */, uint32_t /* interface */)
+{
+}
+
+void
+Failed (Ptr<const Packet> /* packet */, const Ipv4Header & /* header */, Socket::SocketErrno /* error */)
+{
+  ++g_errors;
+}
+
+// ns por pacote de 'packets' chamadas ao RouteInput, em rodízio pelos
+// cabeçalhos
+double
+Measure (Ptr<Ipv4RoutingProtocol> routing, Ptr<const NetDevice> device, Ptr<const Packet> packet,
+         const std::vector<Ipv4Header> &headers, uint64_t packets)
+{
+  Ipv4RoutingProtocol::UnicastForwardCallback ucb = MakeCallback (&Forwarded);
+  Ipv4RoutingProtocol::MulticastForwardCallback mcb = MakeCallback (&MulticastForwarded);
+  Ipv4RoutingProtocol::LocalDeliverCallback lcb = MakeCallback (&Delivered);
+  Ipv4RoutingProtocol::ErrorCallback ecb = MakeCallback (&Failed);
+  // uma passada antes, para as duas medidas começarem com o cache cheio
+  for (const Ipv4Header &header : headers)
+  {
+    routing->RouteInput (packet, header, device, ucb, mcb, lcb, ecb);
+  }
+  g_forwarded = 0;
+  g_errors = 0;
+  WallClock clock;
+  for (uint64_t i = 0; i < packets; ++i)
+  {
+    routing->RouteInput (packet, headers[i % headers.size ()], device, ucb, mcb, lcb, ecb);
+  }
+  return clock.GetSeconds () * 1e9 / packets;
+}
+
+} // namespace
+
+int main (int argc, char **argv)
+{
+  std::string generate ("grid:16x16");
+  std::string routing ("rip");
+  double convergenceTime = 120.0; //seconds
+  uint32_t router = UINT32_MAX;
+  uint32_t flows = 256;
+  uint64_t packets = 2000000;
+  uint32_t routeCacheSize = 1024;
+  uint32_t seed = 1;
+  std::string resultsFile;
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("generate", "Topology description (e.g. grid:16x16, mesh:1000:4)", generate);
+  cmd.AddValue ("routing", "Routing: rip, batchedRip or ospf", routing);
+  cmd.AddValue ("convergenceTime", "Simulated time (s) before the measurement", convergenceTime);
+  cmd.AddValue ("router", "Index of the measured router among the routers (default: the middle one)", router);
+  cmd.AddValue ("flows", "Distinct (source, destination) pairs", flows);
+  cmd.AddValue ("packets", "RouteInput calls in each measurement", packets);
+  cmd.AddValue ("routeCacheSize", "Entries of each RouteCache table, rounded up to a power of 2", routeCacheSize);
+  cmd.AddValue ("seed", "Seed of the pairs", seed);
+  cmd.AddValue ("results", "Append a CSV row with the cost per packet with and without the cache to this file", resultsFile);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF (routing != "rip" && routing != "batchedRip" && routing != "ospf",
+                   "Unknown routing " << routing << " (rip, batchedRip or ospf)");
+  NS_ABORT_MSG_IF (flows == 0 || packets == 0, "Need at least one flow and one packet");
+  Config::SetDefault ("ns3::RouteCache::Size", UintegerValue (routeCacheSize));
+
+  TopologySpec spec;
+  std::string error;
+  if (!GenerateTopology (spec, generate, &error))
+  {
+    NS_FATAL_ERROR (error);
+  }
+  TopologyLoader topology;
+  topology.SetLinkType (TopologyLoader::POINT_TO_POINT);
+  topology.SetRouting (routing == "rip"          ? TopologyLoader::ROUTING_RIP
+                       : routing == "batchedRip" ? TopologyLoader::ROUTING_BATCHED_RIP
+                                                 : TopologyLoader::ROUTING_OSPF);
+  topology.SetRouteCache (true);
+  topology.SetRegisterNames (false);
+  topology.SetSpec (spec);
+  topology.Build ();
+
+  Simulator::Stop (Seconds (convergenceTime));
+  Simulator::Run ();
+
+  NodeContainer routers = topology.GetRouters ();
+  Ptr<Node> node = routers.Get (router < routers.GetN () ? router : routers.GetN () / 2);
+  Ptr<RouteCache> cache = RouteCache::Find (node);
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ABORT_MSG_IF (!cache || ipv4->GetNInterfaces () < 2, "Router " << node->GetId () << " has no route cache");
+  Ptr<const NetDevice> device = ipv4->GetNetDevice (1);
+
+  // endereços dos enlaces que não são do roteador medido: todos repassados
+  std::vector<Ipv4Address> addresses;
+  for (uint32_t l = 0; l < spec.links.size (); ++l)
+  {
+    for (uint32_t side = 0; side < 2; ++side)
+    {
+      if (topology.GetNode (side == 0 ? spec.links[l].a : spec.links[l].b) != node)
+      {
+        addresses.push_back (topology.GetAddress (l, side));
+      }
+    }
+  }
+  std::mt19937 random (seed);
+  std::uniform_int_distribution<std::size_t> pick (0, addresses.size () - 1);
+  std::vector<Ipv4Header> headers (flows);
+  for (Ipv4Header &header : headers)
+  {
+    header.SetSource (addresses[pick (random)]);
+    header.SetDestination (addresses[pick (random)]);
+    header.SetProtocol (UdpL4Protocol::PROT_NUMBER);
+    header.SetTtl (64);
+    header.SetPayloadSize (100);
+  }
+  Ptr<Packet> packet = Create<Packet> (100);
+
+  double uncachedNs = Measure (cache->GetRouting (), device, packet, headers, packets);
+  RouteCache::Stats before = cache->GetStats ();
+  double cachedNs = Measure (cache, device, packet, headers, packets);
+  RouteCache::Stats after = cache->GetStats ();
+  NS_ABORT_MSG_IF (g_forwarded == 0, "No packet was forwarded; raise convergenceTime");
+  uint64_t lookups = after.inputLookups - before.inputLookups;
+  double hitRate = lookups ? double (after.inputHits - before.inputHits) / lookups : 0;
+
+  std::cout << generate << " " << routing << ", router " << node->GetId () << ", " << flows << " flows: "
+            << uncachedNs << " ns/packet without the cache, " << cachedNs << " ns/packet with it ("
+            << uncachedNs / cachedNs << "x), " << 100 * hitRate << "% hits, " << g_errors << " of " << packets
+            << " without a route" << std::endl;
+  if (!resultsFile.empty ())
+  {
+    RunResults results;
+    results.Set ("generate", generate);
+    results.Set ("routing", routing);
+    results.Set ("router", node->GetId ());
+    results.Set ("flows", flows);
+    results.Set ("packets", packets);
+    results.Set ("routeCacheSize", routeCacheSize);
+    results.Set ("uncachedNsPerPacket", uncachedNs);
+    results.Set ("cachedNsPerPacket", cachedNs);
+    results.Set ("hitRate", hitRate);
+    results.Set ("noRoute", g_errors);
+    if (!results.Write (resultsFile, &error))
+    {
+      NS_FATAL_ERROR (error);
+    }
+  }
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,170 @@
+// Escala do roteamento: monta um anel, grade, grafo aleatório regular ou
+// fat-tree com o número de roteadores pedido, roda o RIP (RipHelper), o OSPF
+// (util/ospf-routing.h) ou o roteamento global (Ipv4GlobalRoutingHelper) e mede o tempo de montagem, o
+// tempo de parede da simulação, os eventos, o pico de memória e o tempo de
+// convergência (última mudança de tabela vista numa amostra de roteadores).
+//
+//   ./waf --run "routing_scaling --kind=grid --routers=1024 --routing=rip --results=escala.csv"
+//   ./waf --run "routing_scaling --kind=fattree --routers=1280 --routing=global"
+//   ./waf --run "routing_scaling --kind=grid --routers=1024 --routing=ospf"
+//
+// Cada execução acrescenta uma linha a 'results'; bench/routing_scaling.sh
+// varre os tipos, os tamanhos de 16 a 8192 e os três roteamentos. Com OSPF a
+// linha traz também os bytes de controle e as execuções do SPF.
+
+#include "../util/convergence-monitor.h"
+#include "../util/ospf-routing.h"
+#include "../util/resource-usage.h"
+#include "../util/run-results.h"
+#include "../util/topology-generator.h"
+#include "../util/topology-loader.h"
+
+#include "ns3/core-module.h"
+
+#include <cmath>
+#include <iostream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("RoutingScaling");
+
+namespace {
+
+// descrição do GenerateTopology com cerca de 'routers' roteadores
+std::string
+Describe (const std::string &kind, uint32_t routers, uint32_t degree, uint32_t seed)
+{
+  if (kind == "grid")
+  {
+    uint32_t rows = std::max (1u, uint32_t (std::sqrt (double (routers))));
+    return "grid:" + std::to_string (rows) + "x" + std::to_string ((routers + rows - 1) / rows);
+  }
+  if (kind == "regular" || kind == "mesh")
+  {
+    // o grafo regular precisa de routers * degree par
+    uint32_t n = kind == "regular" && (uint64_t (routers) * degree) % 2 ? routers + 1 : routers;
+    return kind + ":" + std::to_string (n) + ":" + std::to_string (degree) + ":" + std::to_string (seed);
+  }
+  if (kind == "fattree")
+  {
+    // menor k par com 5k^2/4 >= routers
+    uint32_t k = 2;
+    while (5 * k * k / 4 < routers)
+    {
+      k += 2;
+    }
+    return "fattree:" + std::to_string (k);
+  }
+  return kind + ":" + std::to_string (routers);
+}
+
+} // namespace
+
+int main (int argc, char **argv)
+{
+  std::string kind ("ring");
+  uint32_t routers = 64;
+  uint32_t degree = 4;
+  uint32_t seed = 1;
+  std::string generate;
+  std::string routing ("rip");
+  double simulationTime = 120.0; //seconds
+  double convergenceInterval = 1.0;
+  uint32_t convergenceNodes = 64;
+  std::string dataRate ("5Mbps");
+  std::string delay ("2ms");
+  std::string resultsFile;
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("kind", "Topology: ring, grid, regular (random regular), mesh or fattree", kind);
+  cmd.AddValue ("routers", "Approximate number of routers", routers);
+  cmd.AddValue ("degree", "Degree of the regular and mesh topologies", degree);
+  cmd.AddValue ("seed", "Seed of the regular and mesh topologies", seed);
+  cmd.AddValue ("generate", "Explicit topology description instead of kind/routers (e.g. grid:32x32)", generate);
+  cmd.AddValue ("routing", "Routing: rip, ospf or global", routing);
+  cmd.AddValue ("simulationTime", "Simulation time in seconds", simulationTime);
+  cmd.AddValue ("convergenceInterval", "Routing table sampling interval (s) for the convergence time, 0 to skip", convergenceInterval);
+  cmd.AddValue ("convergenceNodes", "Routers sampled for the convergence time (evenly spaced)", convergenceNodes);
+  cmd.AddValue ("dataRate", "Link data rate (e.g. 5Mbps)", dataRate);
+  cmd.AddValue ("delay", "Link delay (e.g. 2ms)", delay);
+  cmd.AddValue ("results", "Append a CSV row with the sizes, times, events and memory to this file", resultsFile);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF (routing != "rip" && routing != "ospf" && routing != "global",
+                   "Unknown routing " << routing << " (rip, ospf or global)");
+  if (generate.empty ())
+  {
+    generate = Describe (kind, routers, degree, seed);
+  }
+
+  WallClock buildClock;
+  TopologySpec spec;
+  std::string error;
+  if (!GenerateTopology (spec, generate, &error))
+  {
+    NS_FATAL_ERROR (error);
+  }
+  TopologyLoader topology;
+  topology.SetLinkType (TopologyLoader::POINT_TO_POINT);
+  topology.SetRouting (routing == "rip"    ? TopologyLoader::ROUTING_RIP
+                       : routing == "ospf" ? TopologyLoader::ROUTING_OSPF
+                                           : TopologyLoader::ROUTING_GLOBAL);
+  topology.SetDefaultDataRate (DataRate (dataRate));
+  topology.SetDefaultDelay (Time (delay));
+  topology.SetRegisterNames (false);
+  topology.SetSpec (spec);
+  topology.Build ();
+  double buildSeconds = buildClock.GetSeconds ();
+
+  ConvergenceMonitor convergence;
+  if (convergenceInterval > 0)
+  {
+    NodeContainer all = topology.GetRouters ();
+    NodeContainer sample;
+    uint32_t step = std::max (1u, all.GetN () / std::max (1u, convergenceNodes));
+    for (uint32_t i = 0; i < all.GetN (); i += step)
+    {
+      sample.Add (all.Get (i));
+    }
+    convergence.SetPollInterval (Seconds (convergenceInterval));
+    convergence.Install (sample, Seconds (simulationTime));
+  }
+
+  Simulator::Stop (Seconds (simulationTime));
+  WallClock runClock;
+  Simulator::Run ();
+  double wallSeconds = runClock.GetSeconds ();
+  uint64_t events = Simulator::GetEventCount ();
+
+  topology.PrintReport (std::cout);
+  std::cout << generate << " " << routing << ": " << events << " events in " << wallSeconds << " s ("
+            << events / wallSeconds << " events/s), converged at " << convergence.GetLastChange () << " s, peak rss "
+            << GetPeakRssKiB () / 1024.0 << " MiB" << std::endl;
+  OspfRouting::Report (std::cout, topology.GetRouters ());
+  OspfRouting::Stats ospfStats = OspfRouting::GetTotalStats (topology.GetRouters ());
+  if (!resultsFile.empty ())
+  {
+    RunResults results;
+    results.Set ("topology", generate);
+    results.Set ("kind", kind);
+    results.Set ("routers", spec.nodes.size () - spec.CountHosts ());
+    results.Set ("links", spec.links.size ());
+    results.Set ("routing", routing);
+    results.Set ("simulationTime", simulationTime);
+    results.Set ("buildSeconds", buildSeconds);
+    results.Set ("wallSeconds", wallSeconds);
+    results.Set ("events", events);
+    results.Set ("eventsPerSecond", events / wallSeconds);
+    results.Set ("convergenceSeconds", convergence.GetLastChange ());
+    results.Set ("peakRssMiB", GetPeakRssKiB () / 1024.0);
+    results.Set ("ospfControlBytes", ospfStats.bytesSent);
+    results.Set ("spfRuns", ospfStats.spfRuns);
+    results.Set ("spfMs", ospfStats.spfMs);
+    if (!results.Write (resultsFile, &error))
+    {
+      NS_FATAL_ERROR (error);
+    }
+  }
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,31 @@
+#!/bin/sh
+# Benchmark de escala do roteamento: roda o routing_scaling para cada tipo de
+# topologia, tamanho e roteamento e junta tudo num CSV (uma linha por
+# execução), para acompanhar regressões entre versões.
+#
+#   ./bench/routing_scaling.sh                               # tudo, 16 a 8192 roteadores
+#   KINDS="grid fattree" SIZES="64 256 1024" ./bench/routing_scaling.sh
+#   ROUTINGS=global OUT=global.csv ./bench/routing_scaling.sh
+#
+# Rodar a partir do diretório do ns-3, com o programa copiado para scratch/.
+
+set -e
+
+KINDS=${KINDS:-"ring grid regular fattree"}
+SIZES=${SIZES:-"16 32 64 128 256 512 1024 2048 4096 8192"}
+ROUTINGS=${ROUTINGS:-"rip ospf global"}
+SIMULATION_TIME=${SIMULATION_TIME:-120}
+OUT=${OUT:-routing-scaling.csv}
+
+rm -f "$OUT"
+./waf build
+for kind in $KINDS; do
+  for size in $SIZES; do
+    for routing in $ROUTINGS; do
+      ./waf --run-no-build "routing_scaling --kind=$kind --routers=$size --routing=$routing --simulationTime=$SIMULATION_TIME --results=$OUT"
+    done
+  done
+done
+
+# colunas: topology kind routers links routing simulationTime buildSeconds wallSeconds events eventsPerSecond convergenceSeconds peakRssMiB ospfControlBytes spfRuns spfMs
+awk -F, 'NR > 1 { printf "%-8s %6s routers %-6s build %8.2f s  run %8.2f s  %10.0f events/s  converged %6.1f s  %8.1f MiB\n", $2, $3, $5, $7, $8, $10, $11, $12 }' "$OUT"
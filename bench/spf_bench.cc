@@ -0,0 +1,171 @@
+// Compara o SPF incremental (util/dynamic-spf.h) com o recálculo completo
+// que o roteamento global faz a cada evento de interface, derrubando e
+// religando enlaces sorteados de uma topologia gerada ou lida de arquivo.
+//
+//   g++ -O2 -std=c++17 -o spf_bench bench/spf_bench.cc
+//   ./spf_bench --generate=mesh:2000:4 --events=50
+//   ./spf_bench --topology=grade.topo --events=20 --verify
+//
+// Não depende do ns-3.
+
+#include "../util/dynamic-spf.h"
+#include "../util/resource-usage.h"
+#include "../util/topology-generator.h"
+
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+using namespace ns3;
+
+namespace {
+
+bool
+SameDistances (const DynamicSpf &a, const DynamicSpf &b)
+{
+  for (uint32_t s = 0; s < a.GetNNodes (); ++s)
+  {
+    for (uint32_t d = 0; d < a.GetNNodes (); ++d)
+    {
+      if (a.GetDistance (s, d) != b.GetDistance (s, d))
+      {
+        std::cerr << "distancia divergente " << s << " -> " << d << ": incremental " << a.GetDistance (s, d)
+                  << ", completo " << b.GetDistance (s, d) << std::endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+int main (int argc, char **argv)
+{
+  std::string generate ("mesh:1000:4");
+  std::string topologyFile;
+  unsigned long events = 20;
+  unsigned long seed = 1;
+  bool verify = false;
+  bool full = true;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg (argv[i]);
+    std::string value = arg.substr (arg.find ('=') + 1);
+    if (arg.compare (0, 11, "--generate=") == 0)
+    {
+      generate = value;
+    }
+    else if (arg.compare (0, 11, "--topology=") == 0)
+    {
+      topologyFile = value;
+    }
+    else if (arg.compare (0, 9, "--events=") == 0)
+    {
+      events = std::strtoul (value.c_str (), nullptr, 10);
+    }
+    else if (arg.compare (0, 7, "--seed=") == 0)
+    {
+      seed = std::strtoul (value.c_str (), nullptr, 10);
+    }
+    else if (arg == "--verify")
+    {
+      verify = true;
+    }
+    else if (arg == "--no-full")
+    {
+      full = false;
+    }
+    else
+    {
+      std::cerr << "uso: " << argv[0] << " [--generate=ring:N|grid:RxC|mesh:N[:grau[:semente]]] [--topology=ARQ]"
+                << " [--events=N] [--seed=S] [--verify] [--no-full]" << std::endl;
+      return 2;
+    }
+  }
+
+  TopologySpec spec;
+  std::string error;
+  bool ok = topologyFile.empty () ? GenerateTopology (spec, generate, &error) : spec.ReadFile (topologyFile, &error);
+  if (!ok)
+  {
+    std::cerr << error << std::endl;
+    return 1;
+  }
+  std::cout << (topologyFile.empty () ? generate : topologyFile) << ": " << spec.nodes.size () << " nos, "
+            << spec.links.size () << " enlaces" << std::endl;
+  if (!DynamicSpf::CheckSize (spec, &error))
+  {
+    std::cerr << error << std::endl;
+    return 1;
+  }
+
+  WallClock clock;
+  DynamicSpf incremental (spec);
+  incremental.ComputeAll ();
+  double initialMs = clock.GetMilliSeconds ();
+  DynamicSpf reference (spec);
+  if (full || verify)
+  {
+    reference.ComputeAll ();
+  }
+  std::cout << "SPF inicial de todas as origens: " << initialMs << " ms, rss " << GetCurrentRssKiB () / 1024.0
+            << " MiB" << std::endl;
+
+  // cada evento derruba um enlace sorteado e depois o religa
+  std::mt19937 rng (seed);
+  std::uniform_int_distribution<uint32_t> pick (0, spec.links.size () - 1);
+  double incrementalMs = 0;
+  double fullMs = 0;
+  uint64_t sources = 0;
+  uint64_t changed = 0;
+  uint64_t settled = 0;
+  uint64_t updates = 0;
+  for (unsigned long e = 0; e < events; ++e)
+  {
+    uint32_t link = pick (rng);
+    for (bool up : {false, true})
+    {
+      clock.Restart ();
+      incremental.SetLinkUp (link, up);
+      incrementalMs += clock.GetMilliSeconds ();
+      sources += incremental.GetLastSources ();
+      changed += incremental.GetChangedSources ().size ();
+      settled += incremental.GetLastSettled ();
+      ++updates;
+
+      if (full || verify)
+      {
+        clock.Restart ();
+        reference.SetLinkState (link, up);
+        reference.ComputeAll ();
+        fullMs += clock.GetMilliSeconds ();
+      }
+      if (verify && !SameDistances (incremental, reference))
+      {
+        std::cerr << "falha de verificacao no evento " << e << " (enlace " << link << (up ? " up" : " down") << ")"
+                  << std::endl;
+        return 1;
+      }
+    }
+  }
+
+  std::cout << std::fixed << std::setprecision (3);
+  std::cout << updates << " atualizacoes (" << events << " enlaces derrubados e religados)" << std::endl;
+  std::cout << "  incremental: " << incrementalMs / updates << " ms/atualizacao, " << double (sources) / updates
+            << " origens refeitas, " << double (changed) / updates << " tabelas alteradas, "
+            << double (settled) / updates << " nos processados" << std::endl;
+  if (full)
+  {
+    std::cout << "  completo:    " << fullMs / updates << " ms/atualizacao, " << spec.nodes.size ()
+              << " origens refeitas" << std::endl;
+    std::cout << "  ganho:       " << (incrementalMs > 0 ? fullMs / incrementalMs : 0.0) << "x" << std::endl;
+  }
+  if (verify)
+  {
+    std::cout << "  distancias conferidas com o recalculo completo apos cada atualizacao" << std::endl;
+  }
+  std::cout << "  pico de memoria: " << GetPeakRssKiB () / 1024.0 << " MiB" << std::endl;
+  return 0;
+}
@@ -0,0 +1,77 @@
+// Carrega uma topologia grande (arquivo ou gerada) pelo TopologyLoader e
+// relata o tempo e a memória de cada passada.
+//
+//   ./waf --run "topology_load --generate=mesh:10000:4 --hosts=100 --routing=global"
+//   ./waf --run "topology_load --topology=grade.topo --simulationTime=60"
+
+#include "../util/topology-generator.h"
+#include "../util/topology-loader.h"
+
+#include "ns3/core-module.h"
+
+#include <iostream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TopologyLoad");
+
+int main (int argc, char **argv)
+{
+  std::string topologyFile;
+  std::string generate;
+  uint32_t hosts = 0;
+  std::string routing ("rip");
+  std::string linkType ("p2p");
+  bool registerNames = false;
+  double simulationTime = 0.0; //seconds
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("topology", "Edge list or GraphML file to load", topologyFile);
+  cmd.AddValue ("generate", "Generate the topology instead (ring:N, grid:RxC, mesh:N[:degree[:seed]])", generate);
+  cmd.AddValue ("hosts", "Hosts attached to the first routers of a generated topology", hosts);
+  cmd.AddValue ("routing", "Routing to install: rip, global, none", routing);
+  cmd.AddValue ("linkType", "Link type: csma, p2p", linkType);
+  cmd.AddValue ("registerNames", "Register every node in ns3::Names", registerNames);
+  cmd.AddValue ("simulationTime", "Seconds to simulate after building (0 = build only)", simulationTime);
+  cmd.Parse (argc, argv);
+
+  TopologyLoader topology;
+  topology.SetLinkType (linkType == "csma" ? TopologyLoader::CSMA : TopologyLoader::POINT_TO_POINT);
+  topology.SetRouting (routing == "global" ? TopologyLoader::ROUTING_GLOBAL
+                       : routing == "none" ? TopologyLoader::ROUTING_NONE
+                       : TopologyLoader::ROUTING_RIP);
+  topology.SetRegisterNames (registerNames);
+
+  if (!generate.empty ())
+  {
+    TopologySpec spec;
+    std::string error;
+    if (!GenerateTopology (spec, generate, &error))
+    {
+      NS_FATAL_ERROR (error);
+    }
+    AttachHosts (spec, hosts);
+    topology.SetSpec (spec);
+  }
+  else if (!topologyFile.empty ())
+  {
+    topology.Load (topologyFile);
+  }
+  else
+  {
+    NS_FATAL_ERROR ("Use --topology=<file> or --generate=<description>");
+  }
+
+  topology.Build ();
+
+  if (simulationTime > 0)
+  {
+    WallClock clock;
+    Simulator::Stop (Seconds (simulationTime));
+    Simulator::Run ();
+    std::cout << "Simulated " << simulationTime << " s in " << clock.GetSeconds () << " s wall" << std::endl;
+  }
+  topology.PrintReport (std::cout);
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,180 @@
+// Compara o tamanho e o tempo de escrita do trace ASCII (uma linha de texto
+// no formato do EnableAsciiAll por evento) com o trace binário
+// (util/binary-trace.h), para a mesma sequência sintética de eventos de
+// fila/recepção de pacotes UDP de 1024 bytes, e confere a leitura de volta.
+//
+//   g++ -O2 -std=c++17 -o trace_bench bench/trace_bench.cc
+//   ./trace_bench --records=2000000
+//
+// Não depende do ns-3.
+
+#include "../util/binary-trace.h"
+#include "../util/resource-usage.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+using namespace ns3;
+
+namespace {
+
+// sequência de eventos parecida com a dos cenários: cada pacote é
+// enfileirado, sai da fila e é recebido em cada salto
+class EventSource
+{
+public:
+  explicit EventSource (uint32_t seed)
+    : m_rng (seed),
+      m_time (1000000000),
+      m_uid (0),
+      m_step (0)
+  {
+  }
+
+  TraceRecord Next ()
+  {
+    static const char types[3] = {'+', '-', 'r'};
+    if (m_step % 3 == 0)
+    {
+      m_time += std::uniform_int_distribution<uint64_t> (1000, 2000000) (m_rng);
+      if (m_step % 12 == 0)
+      {
+        ++m_uid;
+      }
+    }
+    uint32_t hop = (m_step / 3) % 4;
+    TraceRecord record {types[m_step % 3], m_time + (m_step % 3) * 1638400, hop + (m_step % 3 == 2), 1 + hop % 2,
+                        m_uid, m_uid % 10 ? 1082u : 66u};
+    ++m_step;
+    return record;
+  }
+
+private:
+  std::mt19937 m_rng;
+  uint64_t m_time;
+  uint64_t m_uid;
+  uint64_t m_step;
+};
+
+// linha equivalente à do AsciiTraceHelper para um pacote UDP em CSMA
+int
+FormatAscii (char *line, std::size_t size, const TraceRecord &record)
+{
+  const char *source = record.type == 'r' ? "MacRx" : record.type == '+' ? "TxQueue/Enqueue" : "TxQueue/Dequeue";
+  return std::snprintf (line, size,
+                        "%c %.9f /NodeList/%u/DeviceList/%u/$ns3::CsmaNetDevice/%s ns3::EthernetHeader ( "
+                        "length/type=0x800, source=00:00:00:00:00:%02x, destination=00:00:00:00:00:%02x) "
+                        "ns3::Ipv4Header (tos 0x0 DSCP Default ECN Not-ECT ttl 63 id %llu protocol 17 offset "
+                        "(bytes) 0 flags [none] length: %u 10.0.0.1 > 10.0.2.2) ns3::UdpHeader (length: %u "
+                        "49153 > 9) Payload (size=%u) ns3::EthernetTrailer (fcs=0)\n",
+                        record.type, record.timeNs / 1e9, record.node, record.device, source, record.node * 2 + 1,
+                        record.node * 2 + 2, (unsigned long long) record.uid, record.size - 38, record.size - 58,
+                        record.size - 66);
+}
+
+uint64_t
+FileSize (const std::string &path)
+{
+  std::ifstream in (path, std::ios::binary | std::ios::ate);
+  return in ? uint64_t (in.tellg ()) : 0;
+}
+
+} // namespace
+
+int main (int argc, char **argv)
+{
+  unsigned long records = 1000000;
+  std::string prefix ("trace_bench");
+  for (int i = 1; i < argc; ++i)
+  {
+    if (std::strncmp (argv[i], "--records=", 10) == 0)
+    {
+      records = std::strtoul (argv[i] + 10, nullptr, 10);
+    }
+    else if (std::strncmp (argv[i], "--prefix=", 9) == 0)
+    {
+      prefix = argv[i] + 9;
+    }
+    else
+    {
+      std::cerr << "uso: " << argv[0] << " [--records=N] [--prefix=ARQ]" << std::endl;
+      return 2;
+    }
+  }
+  std::string asciiPath = prefix + ".tr";
+  std::string binaryPath = prefix + ".btr";
+
+  WallClock clock;
+  {
+    std::ofstream ascii (asciiPath);
+    EventSource source (1);
+    char line[512];
+    for (unsigned long i = 0; i < records; ++i)
+    {
+      int length = FormatAscii (line, sizeof (line), source.Next ());
+      ascii.write (line, length);
+    }
+  }
+  double asciiSeconds = clock.GetSeconds ();
+
+  clock.Restart ();
+  {
+    BinaryTraceWriter writer;
+    std::string error;
+    if (!writer.Open (binaryPath, &error))
+    {
+      std::cerr << error << std::endl;
+      return 1;
+    }
+    EventSource source (1);
+    for (unsigned long i = 0; i < records; ++i)
+    {
+      writer.Write (source.Next ());
+    }
+  }
+  double binarySeconds = clock.GetSeconds ();
+
+  clock.Restart ();
+  BinaryTraceReader reader;
+  std::string error;
+  if (!reader.Open (binaryPath, &error))
+  {
+    std::cerr << error << std::endl;
+    return 1;
+  }
+  EventSource expected (1);
+  TraceRecord record;
+  unsigned long read = 0;
+  while (reader.Next (record, &error))
+  {
+    TraceRecord want = expected.Next ();
+    if (record.type != want.type || record.timeNs != want.timeNs || record.node != want.node
+        || record.device != want.device || record.uid != want.uid || record.size != want.size)
+    {
+      std::cerr << "registro " << read << " nao confere" << std::endl;
+      return 1;
+    }
+    ++read;
+  }
+  if (!error.empty () || read != records)
+  {
+    std::cerr << "leitura falhou apos " << read << " registros: " << error << std::endl;
+    return 1;
+  }
+  double readSeconds = clock.GetSeconds ();
+
+  uint64_t asciiBytes = FileSize (asciiPath);
+  uint64_t binaryBytes = FileSize (binaryPath);
+  std::cout << records << " registros\n"
+            << "  ascii:   " << asciiBytes / 1048576.0 << " MiB em " << asciiSeconds << " s\n"
+            << "  binario: " << binaryBytes / 1048576.0 << " MiB em " << binarySeconds << " s ("
+            << double (binaryBytes) / records << " bytes/registro, leitura em " << readSeconds << " s)\n"
+            << "  reducao: " << double (asciiBytes) / binaryBytes << "x no tamanho, " << asciiSeconds / binarySeconds
+            << "x no tempo de escrita" << std::endl;
+  std::remove (asciiPath.c_str ());
+  std::remove (binaryPath.c_str ());
+  return 0;
+}
@@ -0,0 +1,158 @@
+// Carga UDP de muitos pares de hosts numa topologia grande, para ver quantos
+// pacotes por segundo de relógio o simulador processa e onde ele satura.
+// Cada roteador gerado (até 'hosts') ganha um host; os fluxos ligam pares de
+// hosts sorteados, com roteamento global.
+//
+//   ./waf --run "traffic_load --generate=grid:20x20 --hosts=400 --flows=1000 --mode=poisson --rate=2Mbps"
+//   ./waf --run "traffic_load --generate=mesh:2000:4 --hosts=500 --mode=onoff --results=carga.csv"
+//
+// Com 'results', acrescenta uma linha com os pacotes enviados e recebidos, as
+// transmissões em todos os enlaces e as transmissões por segundo de relógio.
+
+#include "../util/resource-usage.h"
+#include "../util/run-results.h"
+#include "../util/topology-generator.h"
+#include "../util/topology-loader.h"
+#include "../util/traffic-source.h"
+
+#include "ns3/core-module.h"
+
+#include <iostream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TrafficLoad");
+
+int main (int argc, char **argv)
+{
+  std::string topologyFile;
+  std::string generate ("grid:10x10");
+  uint32_t hosts = 100;
+  uint32_t flows = 200;
+  std::string mode ("cbr");
+  std::string rate ("1Mbps");
+  uint32_t packetSize = 512;
+  std::string traceFile;
+  double shape = 1.5;
+  double simulationTime = 10.0; //seconds
+  std::string dataRate ("100Mbps");
+  std::string delay ("1ms");
+  uint32_t seed = 1;
+  std::string resultsFile;
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("topology", "Edge list or GraphML file to load (its host nodes carry the flows)", topologyFile);
+  cmd.AddValue ("generate", "Generate the topology instead (ring:N, grid:RxC, mesh:N[:degree[:seed]])", generate);
+  cmd.AddValue ("hosts", "Hosts attached to the first routers of a generated topology", hosts);
+  cmd.AddValue ("flows", "Load flows between random pairs of hosts", flows);
+  cmd.AddValue ("mode", "Packet arrivals: cbr, poisson, onoff or trace", mode);
+  cmd.AddValue ("rate", "Rate of each flow (while on, in onoff mode)", rate);
+  cmd.AddValue ("packetSize", "Payload bytes per packet", packetSize);
+  cmd.AddValue ("trace", "File with '<gap seconds> <bytes>' lines for the trace mode", traceFile);
+  cmd.AddValue ("paretoShape", "Shape of the Pareto on/off periods", shape);
+  cmd.AddValue ("simulationTime", "Simulation time in seconds", simulationTime);
+  cmd.AddValue ("dataRate", "Default link data rate (e.g. 100Mbps)", dataRate);
+  cmd.AddValue ("delay", "Default link delay (e.g. 1ms)", delay);
+  cmd.AddValue ("seed", "Seed for the choice of pairs", seed);
+  cmd.AddValue ("results", "Append a CSV row with the load and packets per wall second to this file", resultsFile);
+  cmd.Parse (argc, argv);
+
+  TopologySpec spec;
+  std::string error;
+  if (!topologyFile.empty ())
+  {
+    if (!spec.ReadFile (topologyFile, &error))
+    {
+      NS_FATAL_ERROR (error);
+    }
+  }
+  else if (!GenerateTopology (spec, generate, &error))
+  {
+    NS_FATAL_ERROR (error);
+  }
+  else
+  {
+    AttachHosts (spec, hosts);
+  }
+
+  TopologyLoader topology;
+  topology.SetLinkType (TopologyLoader::POINT_TO_POINT);
+  topology.SetRouting (TopologyLoader::ROUTING_GLOBAL);
+  topology.SetDefaultDataRate (DataRate (dataRate));
+  topology.SetDefaultDelay (Time (delay));
+  topology.SetRegisterNames (false);
+  topology.SetSpec (spec);
+  topology.Build ();
+
+  // endereço de cada host: o do seu primeiro enlace
+  std::vector<uint32_t> hostIds;
+  std::vector<Ipv4Address> hostAddresses;
+  for (uint32_t i = 0; i < spec.nodes.size (); ++i)
+  {
+    if (!spec.nodes[i].host)
+    {
+      continue;
+    }
+    for (uint32_t l = 0; l < spec.links.size (); ++l)
+    {
+      if (spec.links[l].a == i || spec.links[l].b == i)
+      {
+        hostIds.push_back (i);
+        hostAddresses.push_back (topology.GetAddress (l, spec.links[l].a == i ? 0 : 1));
+        break;
+      }
+    }
+  }
+  NS_ABORT_MSG_IF (hostIds.size () < 2, "Need at least two connected hosts");
+
+  uint16_t port = 5000;
+  TrafficHelper load (mode);
+  load.SetAttribute ("DataRate", DataRateValue (DataRate (rate)));
+  load.SetAttribute ("PacketSize", UintegerValue (packetSize));
+  load.SetAttribute ("TraceFile", StringValue (traceFile));
+  load.SetAttribute ("ParetoShape", DoubleValue (shape));
+  ApplicationContainer apps = load.InstallSink (topology.GetHosts (), port);
+  apps.Start (Seconds (0.0));
+  apps = ApplicationContainer ();
+  for (const std::pair<uint32_t, uint32_t> &pair : TrafficHelper::RandomPairs (hostIds.size (), flows, seed))
+  {
+    apps.Add (load.Install (topology.GetNode (hostIds[pair.first]), hostAddresses[pair.second], port));
+  }
+  apps.Start (Seconds (0.1));
+
+  TrafficMeter meter;
+  meter.Install ();
+
+  Simulator::Stop (Seconds (simulationTime));
+  WallClock clock;
+  Simulator::Run ();
+  double wallSeconds = clock.GetSeconds ();
+
+  topology.PrintReport (std::cout);
+  meter.Report (std::cout, wallSeconds);
+  if (!resultsFile.empty ())
+  {
+    RunResults results;
+    results.Set ("mode", mode);
+    results.Set ("nodes", spec.nodes.size ());
+    results.Set ("hosts", hostIds.size ());
+    results.Set ("flows", flows);
+    results.Set ("rate", rate);
+    results.Set ("packetSize", packetSize);
+    results.Set ("simulationTime", simulationTime);
+    results.Set ("sent", meter.GetSent ());
+    results.Set ("received", meter.GetReceived ());
+    results.Set ("linkTransmissions", meter.GetTransmissions ());
+    results.Set ("events", Simulator::GetEventCount ());
+    results.Set ("wallSeconds", wallSeconds);
+    results.Set ("packetsPerWallSecond", meter.GetTransmissions () / wallSeconds);
+    results.Set ("eventsPerSecond", Simulator::GetEventCount () / wallSeconds);
+    results.Set ("peakRssMiB", GetPeakRssKiB () / 1024.0);
+    if (!results.Write (resultsFile, &error))
+    {
+      NS_FATAL_ERROR (error);
+    }
+  }
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,91 @@
+// Descomprime os arquivos de animação do modo sampled
+// (util/animation-output.h) de volta para o XML do NetAnim.
+//
+//   g++ -O2 -std=c++17 -o anim_unpack tools/anim_unpack.cc
+//   ./anim_unpack tp2-ospf.anim-0.xml.lz tp2-ospf.anim-1.xml.lz
+//
+// Cada <arquivo>.xml.lz vira <arquivo>.xml.
+//
+// Não depende do ns-3.
+
+#include "../util/block-codec.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+namespace {
+
+const char ANIM_CHUNK_MAGIC[8] = {'N', 'S', '3', 'A', 'N', 'Z', '1', '\n'};
+
+bool
+Unpack (const std::string &path, const std::string &target, std::string *error)
+{
+  std::ifstream in (path, std::ios::binary);
+  std::vector<uint8_t> data ((std::istreambuf_iterator<char> (in)), std::istreambuf_iterator<char> ());
+  if (!in || data.size () < sizeof (ANIM_CHUNK_MAGIC)
+      || std::memcmp (data.data (), ANIM_CHUNK_MAGIC, sizeof (ANIM_CHUNK_MAGIC)) != 0)
+  {
+    *error = path + " nao e uma animacao comprimida";
+    return false;
+  }
+  std::ofstream out (target, std::ios::binary | std::ios::trunc);
+  if (!out)
+  {
+    *error = "nao foi possivel gravar " + target;
+    return false;
+  }
+  const uint8_t *pos = data.data () + sizeof (ANIM_CHUNK_MAGIC);
+  const uint8_t *end = data.data () + data.size ();
+  std::vector<uint8_t> raw;
+  while (pos < end)
+  {
+    uint64_t rawSize;
+    uint64_t compressedSize;
+    if (!GetVarint (pos, end, rawSize) || !GetVarint (pos, end, compressedSize)
+        || compressedSize > uint64_t (end - pos))
+    {
+      *error = path + ": bloco truncado";
+      return false;
+    }
+    raw.clear ();
+    if (!BlockDecompress (pos, compressedSize, rawSize, raw, error))
+    {
+      *error = path + ": " + *error;
+      return false;
+    }
+    out.write (reinterpret_cast<const char *> (raw.data ()), raw.size ());
+    pos += compressedSize;
+  }
+  return true;
+}
+
+} // namespace
+
+int main (int argc, char **argv)
+{
+  if (argc < 2)
+  {
+    std::cerr << "uso: " << argv[0] << " <animacao.xml.lz>..." << std::endl;
+    return 2;
+  }
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string path (argv[i]);
+    std::string target = path.size () > 3 && path.compare (path.size () - 3, 3, ".lz") == 0
+                           ? path.substr (0, path.size () - 3)
+                           : path + ".xml";
+    std::string error;
+    if (!Unpack (path, target, &error))
+    {
+      std::cerr << error << std::endl;
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,160 @@
+// Lê logs de eventos (util/event-log.h) em fluxo e monta o texto que o
+// LOG_LEVEL_ALL imprimiria durante a simulação.
+//
+//   g++ -O2 -std=c++17 -pthread -o log_dump tools/log_dump.cc
+//   ./log_dump tp2-rip.evl                     # uma linha de texto por evento
+//   ./log_dump tp2-rip.evl --csv               # CSV: time,node,type,thread,a,b,c
+//   ./log_dump tp2-rip.evl --stats             # contagens por tipo, por nó e descartes por motivo
+//   ./log_dump tp2-rip.evl --node=3            # só os eventos do nó 3
+//   ./log_dump tp2-rip.evl --type=ip-drop,rip-route
+//
+// No CSV os argumentos saem crus (ver EventType em util/event-log.h para o
+// que cada um guarda).
+//
+// Não depende do ns-3.
+
+#include "../util/event-log.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+
+using namespace ns3;
+
+int main (int argc, char **argv)
+{
+  std::string path;
+  std::string mode ("text");
+  long node = -1;
+  std::set<uint16_t> types; // vazio: todos
+  for (int i = 1; i < argc; ++i)
+  {
+    if (std::strcmp (argv[i], "--csv") == 0)
+    {
+      mode = "csv";
+    }
+    else if (std::strcmp (argv[i], "--stats") == 0)
+    {
+      mode = "stats";
+    }
+    else if (std::strncmp (argv[i], "--node=", 7) == 0)
+    {
+      node = std::strtol (argv[i] + 7, nullptr, 10);
+    }
+    else if (std::strncmp (argv[i], "--type=", 7) == 0)
+    {
+      std::istringstream list (argv[i] + 7);
+      std::string name;
+      while (std::getline (list, name, ','))
+      {
+        uint16_t type = 1;
+        while (type < EVENT_TYPES && name != GetEventName (type))
+        {
+          ++type;
+        }
+        if (type == EVENT_TYPES)
+        {
+          std::cerr << "tipo de evento desconhecido: " << name << std::endl;
+          return 2;
+        }
+        types.insert (type);
+      }
+    }
+    else if (path.empty () && argv[i][0] != '-')
+    {
+      path = argv[i];
+    }
+    else
+    {
+      path.clear ();
+      break;
+    }
+  }
+  if (path.empty ())
+  {
+    std::cerr << "uso: " << argv[0] << " <log.evl> [--csv|--stats] [--node=N] [--type=<tipo>[,<tipo>...]]"
+              << std::endl;
+    return 2;
+  }
+
+  EventLogReader reader;
+  std::string error;
+  if (!reader.Open (path, &error))
+  {
+    std::cerr << error << std::endl;
+    return 1;
+  }
+
+  std::map<uint16_t, uint64_t> byType;
+  std::map<uint32_t, uint64_t> byNode;
+  std::map<uint32_t, uint64_t> byReason;
+  std::set<uint16_t> threads;
+  uint64_t records = 0;
+  uint64_t lastTime = 0;
+  char line[256];
+  if (mode == "csv")
+  {
+    std::cout << "time,node,type,thread,a,b,c\n";
+  }
+  EventRecord record;
+  while (reader.Next (record, &error))
+  {
+    if ((node >= 0 && record.node != uint32_t (node)) || (!types.empty () && !types.count (record.type)))
+    {
+      continue;
+    }
+    ++records;
+    lastTime = std::max (lastTime, record.timeNs);
+    if (mode == "stats")
+    {
+      ++byType[record.type];
+      ++byNode[record.node];
+      threads.insert (record.thread);
+      if (record.type == EVENT_IP_DROP)
+      {
+        ++byReason[uint32_t (record.b)];
+      }
+    }
+    else if (mode == "csv")
+    {
+      std::snprintf (line, sizeof (line), "%.9f,%u,%s,%u,%llu,%llu,%llu\n", record.timeNs / 1e9, record.node,
+                     GetEventName (record.type), record.thread, (unsigned long long) record.a,
+                     (unsigned long long) record.b, (unsigned long long) record.c);
+      std::cout << line;
+    }
+    else
+    {
+      std::snprintf (line, sizeof (line), "%.9f /NodeList/%u %-10s %s\n", record.timeNs / 1e9, record.node,
+                     GetEventName (record.type), FormatEventArgs (record).c_str ());
+      std::cout << line;
+    }
+  }
+  if (!error.empty ())
+  {
+    std::cerr << path << ": " << error << std::endl;
+    return 1;
+  }
+
+  if (mode == "stats")
+  {
+    std::cout << records << " eventos ate " << lastTime / 1e9 << " s, de " << threads.size () << " thread(s)\n";
+    for (const std::pair<const uint16_t, uint64_t> &type : byType)
+    {
+      std::cout << "  " << GetEventName (type.first) << " " << type.second << "\n";
+    }
+    for (const std::pair<const uint32_t, uint64_t> &reason : byReason)
+    {
+      std::cout << "  ip-drop " << eventlog::GetDropReason (reason.first) << " " << reason.second << "\n";
+    }
+    for (const std::pair<const uint32_t, uint64_t> &count : byNode)
+    {
+      std::cout << "  /NodeList/" << count.first << ": " << count.second << " eventos\n";
+    }
+  }
+  return 0;
+}
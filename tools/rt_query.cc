@@ -0,0 +1,179 @@
+// Consulta o registro de mudanças de rotas (util/route-log.h) gravado pelo
+// RouteRecorder.
+//
+//   g++ -O2 -std=c++17 -o rt_query tools/rt_query.cc
+//   ./rt_query tp2-rip.rtl --node=2 --time=35    # tabela do nó 2 aos 35 s
+//   ./rt_query tp2-rip.rtl --time=35             # todos os nós aos 35 s
+//   ./rt_query tp2-rip.rtl                       # todos os nós no fim
+//   ./rt_query tp2-rip.rtl --changes [--node=2]  # cada rota removida (-) ou acrescentada (+)
+//   ./rt_query tp2-rip.rtl --stats               # mudanças por nó
+//   ./rt_query tp2-rip.rtl --links=tp2-rip.links # nome do enlace de cada destino
+//
+// A tabela num instante parte do último quadro-chave antes dele (ver
+// util/route-log.h), sem ler o arquivo desde o início.
+//
+// Não depende do ns-3.
+
+#include "../util/address-plan.h"
+#include "../util/route-log.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <utility>
+
+using namespace ns3;
+
+namespace {
+
+// 'links' (opcional): índice do TopologyLoader::WriteLinkIndex, para o nome
+// do enlace do destino
+void
+PrintRoute (const char *prefix, const RouteEntry &route, const AddressPlan *links)
+{
+  uint32_t mask = route.prefixLength ? 0xffffffffu << (32 - route.prefixLength) : 0;
+  std::printf ("%s%-15s %-15s %-15s %c     %-6u %-5u", prefix, AddressPlan::FormatAddress (route.destination).c_str (),
+               AddressPlan::FormatAddress (route.gateway).c_str (), AddressPlan::FormatAddress (mask).c_str (),
+               route.protocol, route.metric, route.interface);
+  int64_t link = links ? links->FindLink (route.destination) : -1;
+  std::printf (" %s\n", link >= 0 ? links->GetLink (link).name.c_str () : "");
+}
+
+} // namespace
+
+int main (int argc, char **argv)
+{
+  std::string path;
+  std::string mode ("table");
+  long node = -1;
+  double time = std::numeric_limits<double>::infinity ();
+  std::string linksPath;
+  for (int i = 1; i < argc; ++i)
+  {
+    if (std::strcmp (argv[i], "--changes") == 0)
+    {
+      mode = "changes";
+    }
+    else if (std::strcmp (argv[i], "--stats") == 0)
+    {
+      mode = "stats";
+    }
+    else if (std::strncmp (argv[i], "--node=", 7) == 0)
+    {
+      node = std::strtol (argv[i] + 7, nullptr, 10);
+    }
+    else if (std::strncmp (argv[i], "--time=", 7) == 0)
+    {
+      time = std::strtod (argv[i] + 7, nullptr);
+    }
+    else if (std::strncmp (argv[i], "--links=", 8) == 0)
+    {
+      linksPath = argv[i] + 8;
+    }
+    else if (path.empty () && argv[i][0] != '-')
+    {
+      path = argv[i];
+    }
+    else
+    {
+      path.clear ();
+      break;
+    }
+  }
+  if (path.empty ())
+  {
+    std::cerr << "uso: " << argv[0] << " <rotas.rtl> [--node=N] [--time=T] [--changes|--stats] [--links=<indice>]" << std::endl;
+    return 2;
+  }
+
+  RouteLogReader reader;
+  std::string error;
+  AddressPlan links;
+  if (!linksPath.empty () && !links.ReadFile (linksPath, &error))
+  {
+    std::cerr << error << std::endl;
+    return 1;
+  }
+  const AddressPlan *linkIndex = linksPath.empty () ? nullptr : &links;
+  if (!reader.Open (path, &error))
+  {
+    std::cerr << error << std::endl;
+    return 1;
+  }
+
+  if (mode == "table")
+  {
+    reader.Seek (uint64_t (std::min (std::max (time, 0.0), 1.8e10) * 1e9));
+  }
+
+  RouteTableReplay replay;
+  std::map<uint32_t, std::pair<uint64_t, uint64_t> > changes; // registros, rotas
+  uint64_t records = 0;
+  RouteDelta delta;
+  while (reader.Next (delta, &error))
+  {
+    if (delta.timeNs / 1e9 > time)
+    {
+      break;
+    }
+    if (node >= 0 && delta.node != uint32_t (node))
+    {
+      continue;
+    }
+    ++records;
+    if (mode == "table")
+    {
+      replay.Apply (delta);
+    }
+    else if (mode == "changes")
+    {
+      std::printf ("%.9f node %u\n", delta.timeNs / 1e9, delta.node);
+      for (const RouteEntry &route : delta.removed)
+      {
+        PrintRoute ("  - ", route, linkIndex);
+      }
+      for (const RouteEntry &route : delta.added)
+      {
+        PrintRoute ("  + ", route, linkIndex);
+      }
+    }
+    else
+    {
+      std::pair<uint64_t, uint64_t> &count = changes[delta.node];
+      ++count.first;
+      count.second += delta.removed.size () + delta.added.size ();
+    }
+  }
+  if (!error.empty ())
+  {
+    std::cerr << path << ": " << error << std::endl;
+    return 1;
+  }
+
+  if (mode == "table")
+  {
+    for (const auto &table : replay.GetTables ())
+    {
+      std::printf ("Node: %u\nDestination     Gateway         Genmask         Proto Metric Iface  Link\n", table.first);
+      for (const RouteEntry &route : table.second)
+      {
+        PrintRoute ("", route, linkIndex);
+      }
+      std::printf ("\n");
+    }
+  }
+  else if (mode == "stats")
+  {
+    std::cout << records << " registros, " << reader.GetKeyframes () << " quadros-chave\n";
+    for (const auto &count : changes)
+    {
+      std::cout << "  node " << count.first << ": " << count.second.first << " registros, " << count.second.second
+                << " rotas alteradas\n";
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,934 @@
+// Varredura de parâmetros: expande a grade de valores, roda cada combinação
+// como um processo independente (um por núcleo, com fila de trabalho) e junta
+// as linhas de --results de todas as execuções numa tabela só.
+//
+//   g++ -O2 -std=c++17 -o sweep tools/sweep.cc
+//   ./sweep --program=build/scratch/rip_tp2
+//           --param=splitHorizonStrategy=NoSplitHorizon,SplitHorizon,PoisonReverse
+//           --param=delay=1ms,2ms,10ms --param=failureDown1=20:40:10
+//           --jobs=8 --out=varredura.csv
+//
+// Cada execução roda no seu próprio diretório (<workdir>/run-NNNN), onde ficam
+// os traces, o stdout/stderr e o results.csv dela. Com o waf, use {args} para
+// colocar os parâmetros dentro do --run e {dir} para o diretório da execução:
+//
+//   ./sweep --launchDir=$NS3 --program='./waf --run-no-build "rip_tp2 {args}" --cwd={dir}' ...
+//
+// Com --metric, cada combinação vira um ponto com replicações (--RngRun=1,
+// 2, ...), lançadas enquanto o intervalo de confiança de alguma das métricas
+// (colunas do --results) for mais largo que --ciWidth, em vez de um número
+// fixo de sementes. O número de replicações que ainda faltam é estimado pela
+// variância das que já terminaram, o que deixa os núcleos ocupados com as
+// replicações que de fato vão ser usadas:
+//
+//   ./sweep --program=build/scratch/rip_tp2 --param=splitHorizonStrategy=SplitHorizon,PoisonReverse
+//           --arg=--convergence=convergence.csv --metric=convergenceSeconds --metric=convergenceLost
+//           --ciWidth=10% --confidence=0.95 --minRuns=5 --maxRuns=50
+//
+// O resumo por ponto (média e meia largura de cada métrica) vai para
+// <workdir>/summary.csv.
+//
+// Não depende do ns-3.
+
+#include "../util/run-results.h"
+#include "../util/resource-usage.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace ns3;
+
+namespace {
+
+struct SweepParam
+{
+  std::string name;
+  std::vector<std::string> values;
+};
+
+// uma combinação dos parâmetros e as suas replicações
+struct SweepPoint
+{
+  std::vector<std::string> values; // um por parâmetro, na ordem de --param
+  uint32_t launched;
+  uint32_t finished;
+  std::vector<std::vector<double> > samples; // por métrica, das execuções com resultados
+  bool done;                                 // intervalos dentro da largura pedida
+};
+
+// critério de parada das replicações
+struct ReplicationTarget
+{
+  std::vector<std::string> metrics; // vazio: uma execução por ponto, sem --RngRun
+  double width;                     // largura máxima do intervalo (2 x meia largura)
+  bool relative;                    // width é uma fração da média
+  double confidence;
+  uint32_t minRuns;
+  uint32_t maxRuns;
+  uint32_t firstRun; // RngRun da primeira replicação
+};
+
+struct SweepRun
+{
+  uint32_t id;
+  uint32_t point;
+  uint32_t replication;
+  uint32_t rngRun; // 0: sem --RngRun
+  std::vector<std::string> values;
+  std::string dir;
+  pid_t pid;
+  int status;
+  WallClock clock;
+  double seconds;
+  std::string rejected; // por que o CollectSamples recusou as métricas
+};
+
+// separa a linha de comando como o shell faria com aspas simples e duplas
+std::vector<std::string>
+SplitCommand (const std::string &command)
+{
+  std::vector<std::string> words;
+  std::string word;
+  bool inWord = false;
+  char quote = 0;
+  for (char ch : command)
+  {
+    if (quote)
+    {
+      if (ch == quote)
+      {
+        quote = 0;
+      }
+      else
+      {
+        word += ch;
+      }
+    }
+    else if (ch == '"' || ch == '\'')
+    {
+      quote = ch;
+      inWord = true;
+    }
+    else if (ch == ' ' || ch == '\t')
+    {
+      if (inWord)
+      {
+        words.push_back (word);
+        word.clear ();
+        inWord = false;
+      }
+    }
+    else
+    {
+      word += ch;
+      inWord = true;
+    }
+  }
+  if (inWord)
+  {
+    words.push_back (word);
+  }
+  return words;
+}
+
+void
+ReplaceAll (std::string &text, const std::string &from, const std::string &to)
+{
+  for (std::string::size_type pos = text.find (from); pos != std::string::npos;
+       pos = text.find (from, pos + to.size ()))
+  {
+    text.replace (pos, from.size (), to);
+  }
+}
+
+// "a,b,c" ou a faixa numérica "início:fim:passo" (inclusiva)
+bool
+ParseValues (const std::string &text, std::vector<std::string> &values, std::string *error)
+{
+  double first = 0;
+  double last = 0;
+  double step = 0;
+  char tail = 0;
+  if (text.find (',') == std::string::npos
+      && std::sscanf (text.c_str (), "%lf:%lf:%lf%c", &first, &last, &step, &tail) == 3)
+  {
+    if (step <= 0 || last < first)
+    {
+      *error = "faixa invalida '" + text + "'";
+      return false;
+    }
+    uint64_t count = (uint64_t) ((last - first) / step + 1e-9) + 1;
+    for (uint64_t i = 0; i < count; ++i)
+    {
+      std::ostringstream value;
+      value << first + i * step;
+      values.push_back (value.str ());
+    }
+    return true;
+  }
+  std::string::size_type start = 0;
+  while (true)
+  {
+    std::string::size_type comma = text.find (',', start);
+    values.push_back (text.substr (start, comma - start));
+    if (comma == std::string::npos)
+    {
+      break;
+    }
+    start = comma + 1;
+  }
+  return true;
+}
+
+std::string
+RunDirName (const std::string &workdir, uint32_t id)
+{
+  std::ostringstream name;
+  name << workdir << "/run-" << std::setw (4) << std::setfill ('0') << id;
+  return name.str ();
+}
+
+// run-<ponto>-<replicação>, estável entre execuções para o --resume
+std::string
+ReplicationDirName (const std::string &workdir, uint32_t point, uint32_t replication)
+{
+  std::ostringstream name;
+  name << RunDirName (workdir, point) << "-" << std::setw (3) << std::setfill ('0') << replication;
+  return name.str ();
+}
+
+// quantil da normal padrão (aproximação racional de Acklam, erro relativo
+// abaixo de 1.2e-9)
+double
+NormalQuantile (double p)
+{
+  static const double a[] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                             1.383577518672690e+02,  -3.066479806614716e+01, 2.506628277459239e+00};
+  static const double b[] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                             6.680131188771972e+01,  -1.328068155288572e+01};
+  static const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                             -2.549732539343734e+00, 4.374664141464968e+00,  2.938163982698783e+00};
+  static const double d[] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                             3.754408661907416e+00};
+  if (p < 0.02425 || p > 1 - 0.02425)
+  {
+    double q = std::sqrt (-2 * std::log (p < 0.5 ? p : 1 - p));
+    double x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5])
+               / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+    return p < 0.5 ? x : -x;
+  }
+  double q = p - 0.5;
+  double r = q * q;
+  return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q
+         / (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+}
+
+// quantil da t de Student: exato com 1 e 2 graus de liberdade, expansão de
+// Cornish-Fisher (Abramowitz e Stegun 26.7.5) a partir de 3 (erro abaixo de
+// 1% com 3 graus, desprezível a partir de 10)
+double
+StudentQuantile (double p, uint32_t df)
+{
+  if (df == 1)
+  {
+    return std::tan (M_PI * (p - 0.5));
+  }
+  if (df == 2)
+  {
+    return (2 * p - 1) / std::sqrt (2 * p * (1 - p));
+  }
+  double z = NormalQuantile (p);
+  double z2 = z * z;
+  double g1 = (z2 + 1) * z / 4;
+  double g2 = ((5 * z2 + 16) * z2 + 3) * z / 96;
+  double g3 = (((3 * z2 + 19) * z2 + 17) * z2 - 15) * z / 384;
+  double g4 = ((((79 * z2 + 776) * z2 + 1482) * z2 - 1920) * z2 - 945) * z / 92160;
+  double v = df;
+  return z + g1 / v + g2 / (v * v) + g3 / (v * v * v) + g4 / (v * v * v * v);
+}
+
+// média e meia largura do intervalo de confiança (infinita com menos de 2 amostras)
+std::pair<double, double>
+ConfidenceInterval (const std::vector<double> &samples, double confidence)
+{
+  double n = samples.size ();
+  double mean = 0;
+  for (double x : samples)
+  {
+    mean += x;
+  }
+  mean = samples.empty () ? 0 : mean / n;
+  if (samples.size () < 2)
+  {
+    return std::make_pair (mean, std::numeric_limits<double>::infinity ());
+  }
+  double squares = 0;
+  for (double x : samples)
+  {
+    squares += (x - mean) * (x - mean);
+  }
+  double t = StudentQuantile (1 - (1 - confidence) / 2, samples.size () - 1);
+  return std::make_pair (mean, t * std::sqrt (squares / (n - 1) / n));
+}
+
+uint32_t
+GetSamples (const SweepPoint &point)
+{
+  return point.samples.empty () ? 0 : point.samples[0].size ();
+}
+
+// largura pedida para a métrica, dada a média atual
+double
+GetWidthLimit (const ReplicationTarget &target, double mean)
+{
+  return target.relative ? target.width * std::fabs (mean) : target.width;
+}
+
+bool
+IsSatisfied (const SweepPoint &point, const ReplicationTarget &target)
+{
+  if (GetSamples (point) < target.minRuns)
+  {
+    return false;
+  }
+  for (const std::vector<double> &samples : point.samples)
+  {
+    std::pair<double, double> ci = ConfidenceInterval (samples, target.confidence);
+    if (!(2 * ci.second <= GetWidthLimit (target, ci.first))) // NaN não converge
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+// amostras que o ponto deve ter, estimadas pela variância atual: a largura
+// cai com 1/sqrt (n)
+uint32_t
+GetWantedSamples (const SweepPoint &point, const ReplicationTarget &target)
+{
+  uint32_t n = GetSamples (point);
+  if (n < target.minRuns)
+  {
+    return target.minRuns;
+  }
+  double wanted = n + 1;
+  for (const std::vector<double> &samples : point.samples)
+  {
+    std::pair<double, double> ci = ConfidenceInterval (samples, target.confidence);
+    double limit = GetWidthLimit (target, ci.first);
+    double ratio = limit > 0 ? 2 * ci.second / limit : std::numeric_limits<double>::infinity ();
+    wanted = std::max (wanted, std::ceil (n * ratio * ratio));
+  }
+  return std::min<double> (wanted, target.maxRuns);
+}
+
+bool
+WantsRun (const SweepPoint &point, const ReplicationTarget &target)
+{
+  if (target.metrics.empty ())
+  {
+    return point.launched == 0;
+  }
+  if (point.done || point.launched >= target.maxRuns)
+  {
+    return false;
+  }
+  return GetSamples (point) + (point.launched - point.finished) < GetWantedSamples (point, target);
+}
+
+// acrescenta ao ponto as métricas do results.csv da execução; falso se
+// alguma coluna falta, não é numérica ou não é finita
+bool
+CollectSamples (const SweepRun &run, const ReplicationTarget &target, SweepPoint &point, std::string *error)
+{
+  std::vector<std::string> header;
+  std::vector<std::vector<std::string> > rows;
+  if (!ReadCsv (run.dir + "/results.csv", header, rows, error) || rows.empty ())
+  {
+    *error = "sem resultados";
+    return false;
+  }
+  std::vector<double> values;
+  for (const std::string &metric : target.metrics)
+  {
+    std::vector<std::string>::const_iterator column = std::find (header.begin (), header.end (), metric);
+    if (column == header.end ())
+    {
+      *error = "sem a coluna " + metric;
+      return false;
+    }
+    const std::string &text = rows.back ()[column - header.begin ()];
+    char *end = nullptr;
+    double value = std::strtod (text.c_str (), &end);
+    if (text.empty () || *end != '\0')
+    {
+      *error = metric + " nao numerica: '" + text + "'";
+      return false;
+    }
+    // o strtod aceita "nan" e "inf", que fariam o intervalo de confiança
+    // (e a comparação com a largura) sem sentido
+    if (!std::isfinite (value))
+    {
+      *error = metric + " nao finita: '" + text + "'";
+      return false;
+    }
+    values.push_back (value);
+  }
+  for (std::size_t m = 0; m < values.size (); ++m)
+  {
+    point.samples[m].push_back (values[m]);
+  }
+  return true;
+}
+
+bool
+MakeDir (const std::string &path)
+{
+  return mkdir (path.c_str (), 0755) == 0 || errno == EEXIST;
+}
+
+std::string
+AbsolutePath (const std::string &path)
+{
+  if (!path.empty () && path[0] == '/')
+  {
+    return path;
+  }
+  char cwd[4096];
+  if (getcwd (cwd, sizeof (cwd)) == nullptr)
+  {
+    return path;
+  }
+  return std::string (cwd) + "/" + path;
+}
+
+// monta o argv da execução e cria o processo filho com stdout/stderr
+// redirecionados para o diretório dela
+pid_t
+Launch (const std::vector<std::string> &command, const std::vector<SweepParam> &params,
+        const std::vector<std::string> &fixedArgs, SweepRun &run, const std::string &launchDir)
+{
+  std::vector<std::string> args;
+  for (std::vector<SweepParam>::size_type i = 0; i < params.size (); ++i)
+  {
+    args.push_back ("--" + params[i].name + "=" + run.values[i]);
+  }
+  args.insert (args.end (), fixedArgs.begin (), fixedArgs.end ());
+  if (run.rngRun != 0)
+  {
+    args.push_back ("--RngRun=" + std::to_string (run.rngRun));
+  }
+  args.push_back ("--results=" + run.dir + "/results.csv");
+
+  std::string joined;
+  for (const std::string &arg : args)
+  {
+    joined += (joined.empty () ? "" : " ") + arg;
+  }
+  std::vector<std::string> argv;
+  bool inlineArgs = false;
+  for (std::string word : command)
+  {
+    if (word.find ("{args}") != std::string::npos)
+    {
+      inlineArgs = true;
+      ReplaceAll (word, "{args}", joined);
+    }
+    ReplaceAll (word, "{dir}", run.dir);
+    argv.push_back (word);
+  }
+  if (!inlineArgs)
+  {
+    argv.insert (argv.end (), args.begin (), args.end ());
+  }
+
+  pid_t pid = fork ();
+  if (pid != 0)
+  {
+    return pid;
+  }
+  if (chdir (launchDir.empty () ? run.dir.c_str () : launchDir.c_str ()) != 0)
+  {
+    _exit (126);
+  }
+  int out = open ((run.dir + "/stdout.txt").c_str (), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  int err = open ((run.dir + "/stderr.txt").c_str (), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (out < 0 || err < 0)
+  {
+    _exit (126);
+  }
+  dup2 (out, STDOUT_FILENO);
+  dup2 (err, STDERR_FILENO);
+  std::vector<char *> cargv;
+  for (std::string &word : argv)
+  {
+    cargv.push_back (&word[0]);
+  }
+  cargv.push_back (nullptr);
+  execvp (cargv[0], cargv.data ());
+  _exit (127);
+}
+
+void
+Usage (const char *name)
+{
+  std::cerr << "uso: " << name << " --program=<comando> --param=<nome>=<v1,v2,...|ini:fim:passo> ...\n"
+            << "  --jobs=N        execucoes simultaneas (padrao: numero de nucleos)\n"
+            << "  --workdir=DIR   diretorio das execucoes (padrao: sweep-runs)\n"
+            << "  --out=ARQ       tabela combinada em CSV (padrao: <workdir>/sweep.csv)\n"
+            << "  --arg=ARG       argumento fixo repassado a todas as execucoes\n"
+            << "  --launchDir=DIR diretorio de onde o programa e chamado (padrao: o da execucao)\n"
+            << "  --resume        reaproveita execucoes que ja tem results.csv\n"
+            << "  --dry-run       so lista as combinacoes\n"
+            << "replicacoes ate o intervalo de confianca caber na largura:\n"
+            << "  --metric=COL    coluna do --results medida (repetivel)\n"
+            << "  --ciWidth=W     largura maxima do intervalo, absoluta ou relativa a media (10%)\n"
+            << "  --confidence=C  nivel de confianca (padrao: 0.95)\n"
+            << "  --minRuns=N     replicacoes antes de testar o intervalo (padrao: 5)\n"
+            << "  --maxRuns=N     limite de replicacoes por ponto (padrao: 100)\n"
+            << "  --firstRun=N    RngRun da primeira replicacao (padrao: 1)\n"
+            << "  --summary=ARQ   media e meia largura por ponto (padrao: <workdir>/summary.csv)\n";
+}
+
+} // namespace
+
+int main (int argc, char **argv)
+{
+  std::string program;
+  std::vector<SweepParam> params;
+  std::vector<std::string> fixedArgs;
+  unsigned jobs = std::max (1u, std::thread::hardware_concurrency ());
+  std::string workdir ("sweep-runs");
+  std::string outFile;
+  std::string summaryFile;
+  std::string launchDir;
+  bool resume = false;
+  bool dryRun = false;
+  ReplicationTarget target {{}, 0, false, 0.95, 5, 100, 1};
+
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg (argv[i]);
+    std::string value = arg.substr (arg.find ('=') + 1);
+    if (arg.compare (0, 10, "--program=") == 0)
+    {
+      program = value;
+    }
+    else if (arg.compare (0, 8, "--param=") == 0 && value.find ('=') != std::string::npos)
+    {
+      SweepParam param;
+      param.name = value.substr (0, value.find ('='));
+      std::string error;
+      if (!ParseValues (value.substr (value.find ('=') + 1), param.values, &error))
+      {
+        std::cerr << error << std::endl;
+        return 2;
+      }
+      params.push_back (param);
+    }
+    else if (arg.compare (0, 6, "--arg=") == 0)
+    {
+      fixedArgs.push_back (value);
+    }
+    else if (arg.compare (0, 7, "--jobs=") == 0)
+    {
+      jobs = std::max (1ul, std::strtoul (value.c_str (), nullptr, 10));
+    }
+    else if (arg.compare (0, 10, "--workdir=") == 0)
+    {
+      workdir = value;
+    }
+    else if (arg.compare (0, 6, "--out=") == 0)
+    {
+      outFile = value;
+    }
+    else if (arg.compare (0, 10, "--summary=") == 0)
+    {
+      summaryFile = value;
+    }
+    else if (arg.compare (0, 12, "--launchDir=") == 0)
+    {
+      launchDir = value;
+    }
+    else if (arg.compare (0, 9, "--metric=") == 0)
+    {
+      target.metrics.push_back (value);
+    }
+    else if (arg.compare (0, 10, "--ciWidth=") == 0)
+    {
+      target.relative = !value.empty () && value.back () == '%';
+      target.width = std::strtod (value.c_str (), nullptr) / (target.relative ? 100 : 1);
+    }
+    else if (arg.compare (0, 13, "--confidence=") == 0)
+    {
+      target.confidence = std::strtod (value.c_str (), nullptr);
+    }
+    else if (arg.compare (0, 10, "--minRuns=") == 0)
+    {
+      target.minRuns = std::strtoul (value.c_str (), nullptr, 10);
+    }
+    else if (arg.compare (0, 10, "--maxRuns=") == 0)
+    {
+      target.maxRuns = std::strtoul (value.c_str (), nullptr, 10);
+    }
+    else if (arg.compare (0, 11, "--firstRun=") == 0)
+    {
+      target.firstRun = std::max (1ul, std::strtoul (value.c_str (), nullptr, 10));
+    }
+    else if (arg == "--resume")
+    {
+      resume = true;
+    }
+    else if (arg == "--dry-run")
+    {
+      dryRun = true;
+    }
+    else
+    {
+      Usage (argv[0]);
+      return 2;
+    }
+  }
+  if (program.empty ())
+  {
+    Usage (argv[0]);
+    return 2;
+  }
+  bool replicate = !target.metrics.empty ();
+  if (replicate
+      && (target.width <= 0 || target.confidence <= 0 || target.confidence >= 1 || target.minRuns < 2
+          || target.maxRuns < target.minRuns))
+  {
+    std::cerr << "--metric pede --ciWidth > 0, 0 < --confidence < 1 e 2 <= --minRuns <= --maxRuns" << std::endl;
+    return 2;
+  }
+  workdir = AbsolutePath (workdir);
+  if (outFile.empty ())
+  {
+    outFile = workdir + "/sweep.csv";
+  }
+  if (summaryFile.empty ())
+  {
+    summaryFile = workdir + "/summary.csv";
+  }
+
+  // produto cartesiano, com o último parâmetro variando mais rápido
+  std::vector<SweepPoint> points;
+  std::vector<std::size_t> index (params.size (), 0);
+  while (true)
+  {
+    SweepPoint point;
+    for (std::size_t p = 0; p < params.size (); ++p)
+    {
+      point.values.push_back (params[p].values[index[p]]);
+    }
+    point.launched = 0;
+    point.finished = 0;
+    point.samples.resize (target.metrics.size ());
+    point.done = false;
+    points.push_back (point);
+    std::size_t p = params.size ();
+    while (p > 0 && ++index[p - 1] == params[p - 1].values.size ())
+    {
+      index[--p] = 0;
+    }
+    if (p == 0)
+    {
+      break;
+    }
+  }
+
+  if (dryRun)
+  {
+    for (std::size_t i = 0; i < points.size (); ++i)
+    {
+      std::cout << i;
+      for (std::size_t p = 0; p < params.size (); ++p)
+      {
+        std::cout << " --" << params[p].name << "=" << points[i].values[p];
+      }
+      if (replicate)
+      {
+        std::cout << " (" << target.minRuns << " a " << target.maxRuns << " replicacoes)";
+      }
+      std::cout << "\n";
+    }
+    return 0;
+  }
+
+  if (!MakeDir (workdir))
+  {
+    std::cerr << "nao foi possivel criar " << workdir << ": " << std::strerror (errno) << std::endl;
+    return 1;
+  }
+  std::vector<std::string> command = SplitCommand (program);
+  std::vector<SweepRun> runs;
+  std::map<pid_t, std::size_t> running;
+  std::vector<std::size_t> reused; // execuções do --resume, contadas sem rodar
+  std::size_t cursor = 0;          // rodízio entre os pontos
+  WallClock total;
+  while (true)
+  {
+    while (running.size () < jobs || !reused.empty ())
+    {
+      std::size_t id;
+      if (!reused.empty ())
+      {
+        id = reused.back ();
+        reused.pop_back ();
+      }
+      else
+      {
+        std::size_t offset = 0;
+        while (offset < points.size () && !WantsRun (points[(cursor + offset) % points.size ()], target))
+        {
+          ++offset;
+        }
+        if (offset == points.size ())
+        {
+          break;
+        }
+        uint32_t p = (cursor + offset) % points.size ();
+        cursor = p + 1;
+        SweepPoint &point = points[p];
+        SweepRun run;
+        run.id = runs.size ();
+        run.point = p;
+        run.replication = point.launched++;
+        run.rngRun = replicate ? target.firstRun + run.replication : 0;
+        run.values = point.values;
+        run.dir = replicate ? ReplicationDirName (workdir, p, run.replication) : RunDirName (workdir, p);
+        run.pid = 0;
+        run.status = -1;
+        run.seconds = 0;
+        runs.push_back (run);
+        if (resume && access ((run.dir + "/results.csv").c_str (), R_OK) == 0)
+        {
+          runs.back ().status = 0;
+          reused.push_back (run.id);
+          continue;
+        }
+        if (!MakeDir (run.dir))
+        {
+          std::cerr << "nao foi possivel criar " << run.dir << std::endl;
+          return 1;
+        }
+        std::remove ((run.dir + "/results.csv").c_str ());
+        runs.back ().clock.Restart ();
+        runs.back ().pid = Launch (command, params, fixedArgs, runs.back (), launchDir);
+        if (runs.back ().pid < 0)
+        {
+          std::cerr << "fork: " << std::strerror (errno) << std::endl;
+          return 1;
+        }
+        running[runs.back ().pid] = run.id;
+        continue;
+      }
+
+      // execução reaproveitada: conta como terminada
+      SweepRun &run = runs[id];
+      SweepPoint &point = points[run.point];
+      ++point.finished;
+      std::string error;
+      if (replicate)
+      {
+        if (CollectSamples (run, target, point, &error))
+        {
+          point.done = IsSatisfied (point, target);
+        }
+        else
+        {
+          run.rejected = error;
+          std::cerr << "  " << run.dir.substr (workdir.size () + 1) << ": " << error << std::endl;
+        }
+      }
+    }
+    if (running.empty ())
+    {
+      break;
+    }
+    int status = 0;
+    pid_t pid = waitpid (-1, &status, 0);
+    if (pid < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      break;
+    }
+    std::map<pid_t, std::size_t>::iterator it = running.find (pid);
+    if (it == running.end ())
+    {
+      continue;
+    }
+    SweepRun &run = runs[it->second];
+    SweepPoint &point = points[run.point];
+    running.erase (it);
+    run.status = WIFEXITED (status) ? WEXITSTATUS (status) : 128 + WTERMSIG (status);
+    run.seconds = run.clock.GetSeconds ();
+    ++point.finished;
+    std::cerr << "[" << runs.size () - running.size () << (replicate ? "" : "/" + std::to_string (points.size ()))
+              << "] " << run.dir.substr (workdir.size () + 1) << (run.status == 0 ? " ok " : " FALHOU ") << std::fixed
+              << std::setprecision (1) << run.seconds << " s" << std::endl;
+    std::string error;
+    if (replicate && run.status == 0)
+    {
+      if (CollectSamples (run, target, point, &error))
+      {
+        point.done = IsSatisfied (point, target);
+      }
+      else
+      {
+        run.rejected = error;
+        std::cerr << "  " << error << std::endl;
+      }
+    }
+  }
+
+  // tabela combinada: run, status, ponto e RngRun das replicações, parâmetros
+  // da varredura e as colunas que as execuções gravaram (união, na ordem em
+  // que aparecem)
+  std::vector<std::string> columns;
+  columns.push_back ("run");
+  columns.push_back ("status");
+  if (replicate)
+  {
+    columns.push_back ("point");
+    columns.push_back ("RngRun");
+  }
+  for (const SweepParam &param : params)
+  {
+    columns.push_back (param.name);
+  }
+  std::vector<std::map<std::string, std::string> > tables (runs.size ());
+  uint32_t failed = 0;
+  for (SweepRun &run : runs)
+  {
+    std::map<std::string, std::string> &row = tables[run.id];
+    row["run"] = std::to_string (run.id);
+    row["status"] = std::to_string (run.status);
+    row["point"] = std::to_string (run.point);
+    row["RngRun"] = std::to_string (run.rngRun);
+    for (std::size_t p = 0; p < params.size (); ++p)
+    {
+      row[params[p].name] = run.values[p];
+    }
+    std::vector<std::string> header;
+    std::vector<std::vector<std::string> > rows;
+    std::string error;
+    if (!ReadCsv (run.dir + "/results.csv", header, rows, &error) || rows.empty ())
+    {
+      ++failed;
+      if (row["status"] == "0")
+      {
+        row["status"] = "sem-resultados";
+      }
+      continue;
+    }
+    if (!run.rejected.empty ())
+    {
+      ++failed;
+      if (row["status"] == "0")
+      {
+        row["status"] = "metrica-invalida";
+      }
+    }
+    for (std::size_t c = 0; c < header.size (); ++c)
+    {
+      if (std::find (columns.begin (), columns.end (), header[c]) == columns.end ())
+      {
+        columns.push_back (header[c]);
+      }
+      row[header[c]] = rows.back ()[c];
+    }
+  }
+
+  std::ofstream out (outFile);
+  if (!out)
+  {
+    std::cerr << "nao foi possivel gravar " << outFile << std::endl;
+    return 1;
+  }
+  WriteCsvRow (out, columns);
+  for (std::map<std::string, std::string> &row : tables)
+  {
+    std::vector<std::string> fields;
+    for (const std::string &column : columns)
+    {
+      fields.push_back (row[column]);
+    }
+    WriteCsvRow (out, fields);
+  }
+
+  // resumo por ponto: replicações usadas, se o intervalo coube na largura e,
+  // por métrica, a média e a meia largura
+  uint32_t unconverged = 0;
+  if (replicate)
+  {
+    std::ofstream summary (summaryFile);
+    if (!summary)
+    {
+      std::cerr << "nao foi possivel gravar " << summaryFile << std::endl;
+      return 1;
+    }
+    std::vector<std::string> header;
+    for (const SweepParam &param : params)
+    {
+      header.push_back (param.name);
+    }
+    header.push_back ("runs");
+    header.push_back ("converged");
+    for (const std::string &metric : target.metrics)
+    {
+      header.push_back (metric + "Mean");
+      header.push_back (metric + "HalfWidth");
+    }
+    WriteCsvRow (summary, header);
+    for (std::size_t i = 0; i < points.size (); ++i)
+    {
+      SweepPoint &point = points[i];
+      bool converged = IsSatisfied (point, target);
+      unconverged += !converged;
+      std::vector<std::string> fields (point.values);
+      fields.push_back (std::to_string (GetSamples (point)));
+      fields.push_back (converged ? "1" : "0");
+      std::cerr << "ponto " << i << ": " << GetSamples (point) << " replicacoes";
+      for (std::size_t m = 0; m < target.metrics.size (); ++m)
+      {
+        std::pair<double, double> ci = ConfidenceInterval (point.samples[m], target.confidence);
+        std::ostringstream mean;
+        std::ostringstream half;
+        mean << ci.first;
+        half << ci.second;
+        fields.push_back (mean.str ());
+        fields.push_back (half.str ());
+        std::cerr << ", " << target.metrics[m] << " " << mean.str () << " +- " << half.str ();
+      }
+      std::cerr << (converged ? "" : " (sem atingir a largura)") << std::endl;
+      WriteCsvRow (summary, fields);
+    }
+  }
+  std::cerr << runs.size () << " execucoes em " << std::fixed << std::setprecision (1) << total.GetSeconds ()
+            << " s com " << jobs << " processos; " << failed << " sem resultados validos; tabela em " << outFile;
+  if (replicate)
+  {
+    std::cerr << "; " << unconverged << " de " << points.size () << " pontos sem atingir a largura; resumo em "
+              << summaryFile;
+  }
+  std::cerr << std::endl;
+  return failed ? 1 : 0;
+}
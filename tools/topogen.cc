@@ -0,0 +1,53 @@
+// Gera topologias sintéticas em lista de arestas para o TopologyLoader.
+//
+//   g++ -O2 -std=c++17 -o topogen tools/topogen.cc
+//   ./topogen grid:100x100 --hosts=2 > grade.topo
+//
+// Não depende do ns-3.
+
+#include "../util/topology-generator.h"
+
+#include <cstring>
+#include <iostream>
+
+using namespace ns3;
+
+int main (int argc, char **argv)
+{
+  std::string description;
+  unsigned long hosts = 0;
+  for (int i = 1; i < argc; ++i)
+  {
+    if (std::strncmp (argv[i], "--hosts=", 8) == 0)
+    {
+      hosts = std::strtoul (argv[i] + 8, nullptr, 10);
+    }
+    else if (description.empty () && argv[i][0] != '-')
+    {
+      description = argv[i];
+    }
+    else
+    {
+      description.clear ();
+      break;
+    }
+  }
+  if (description.empty ())
+  {
+    std::cerr << "uso: " << argv[0] << " ring:N|grid:RxC|mesh:N[:grau[:semente]]|regular:N:grau[:semente]|fattree:K [--hosts=K]" << std::endl;
+    return 2;
+  }
+
+  TopologySpec spec;
+  std::string error;
+  if (!GenerateTopology (spec, description, &error))
+  {
+    std::cerr << error << std::endl;
+    return 1;
+  }
+  AttachHosts (spec, hosts);
+  std::cout << "# " << description << ": " << spec.nodes.size () << " nos, "
+            << spec.links.size () << " enlaces\n";
+  spec.WriteEdgeList (std::cout);
+  return 0;
+}
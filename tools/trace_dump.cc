@@ -0,0 +1,157 @@
+// Lê traces binários (util/binary-trace.h) em fluxo, um bloco por vez.
+//
+//   g++ -O2 -std=c++17 -o trace_dump tools/trace_dump.cc
+//   ./trace_dump tp2-rip.btr              # uma linha de texto por registro
+//   ./trace_dump tp2-rip.btr --csv        # CSV: type,time,node,device,uid,size
+//   ./trace_dump tp2-rip.btr --stats      # contagens por tipo e por dispositivo
+//   ./trace_dump tp2-rip.btr --node=3     # só os registros do nó 3
+//   ./trace_dump tp2-rip.btr --links=tp2-rip.links  # com o enlace de cada dispositivo
+//
+// O índice de enlaces vem do --linkIndex dos cenários (AddressPlan, em
+// util/address-plan.h); com ele cada registro ganha o nome do enlace do
+// dispositivo (coluna link no CSV).
+//
+// Não depende do ns-3.
+
+#include "../util/address-plan.h"
+#include "../util/binary-trace.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <utility>
+
+using namespace ns3;
+
+int main (int argc, char **argv)
+{
+  std::string path;
+  std::string mode ("text");
+  long node = -1;
+  std::string linksPath;
+  for (int i = 1; i < argc; ++i)
+  {
+    if (std::strcmp (argv[i], "--csv") == 0)
+    {
+      mode = "csv";
+    }
+    else if (std::strcmp (argv[i], "--stats") == 0)
+    {
+      mode = "stats";
+    }
+    else if (std::strncmp (argv[i], "--node=", 7) == 0)
+    {
+      node = std::strtol (argv[i] + 7, nullptr, 10);
+    }
+    else if (std::strncmp (argv[i], "--links=", 8) == 0)
+    {
+      linksPath = argv[i] + 8;
+    }
+    else if (path.empty () && argv[i][0] != '-')
+    {
+      path = argv[i];
+    }
+    else
+    {
+      path.clear ();
+      break;
+    }
+  }
+  if (path.empty ())
+  {
+    std::cerr << "uso: " << argv[0] << " <trace.btr> [--csv|--stats] [--node=N] [--links=<indice>]" << std::endl;
+    return 2;
+  }
+
+  BinaryTraceReader reader;
+  std::string error;
+  if (!reader.Open (path, &error))
+  {
+    std::cerr << error << std::endl;
+    return 1;
+  }
+  AddressPlan links;
+  if (!linksPath.empty () && !links.ReadFile (linksPath, &error))
+  {
+    std::cerr << error << std::endl;
+    return 1;
+  }
+  // nome do enlace do dispositivo, vazio sem índice ou fora dele
+  auto linkName = [&] (uint32_t node, uint32_t device) -> std::string {
+    int64_t link = linksPath.empty () ? -1 : links.FindDevice (node, device);
+    return link >= 0 ? links.GetLink (link).name : "";
+  };
+
+  std::map<char, uint64_t> byType;
+  std::map<std::pair<uint32_t, uint32_t>, std::pair<uint64_t, uint64_t> > byDevice; // registros, bytes
+  uint64_t records = 0;
+  uint64_t lastTime = 0;
+  char line[160];
+  if (mode == "csv")
+  {
+    std::cout << "type,time,node,device,uid,size" << (linksPath.empty () ? "" : ",link") << "\n";
+  }
+  TraceRecord record;
+  while (reader.Next (record, &error))
+  {
+    if (node >= 0 && record.node != uint32_t (node))
+    {
+      continue;
+    }
+    ++records;
+    lastTime = record.timeNs;
+    if (mode == "stats")
+    {
+      ++byType[record.type];
+      std::pair<uint64_t, uint64_t> &device = byDevice[std::make_pair (record.node, record.device)];
+      ++device.first;
+      device.second += record.size;
+    }
+    else if (mode == "csv")
+    {
+      std::snprintf (line, sizeof (line), "%c,%.9f,%u,%u,%llu,%u", record.type, record.timeNs / 1e9, record.node,
+                     record.device, (unsigned long long) record.uid, record.size);
+      std::cout << line;
+      if (!linksPath.empty ())
+      {
+        std::cout << "," << linkName (record.node, record.device);
+      }
+      std::cout << "\n";
+    }
+    else
+    {
+      std::snprintf (line, sizeof (line), "%c %.9f /NodeList/%u/DeviceList/%u uid=%llu size=%u", record.type,
+                     record.timeNs / 1e9, record.node, record.device, (unsigned long long) record.uid, record.size);
+      std::cout << line;
+      std::string name = linkName (record.node, record.device);
+      if (!name.empty ())
+      {
+        std::cout << " link=" << name;
+      }
+      std::cout << "\n";
+    }
+  }
+  if (!error.empty ())
+  {
+    std::cerr << path << ": " << error << std::endl;
+    return 1;
+  }
+
+  if (mode == "stats")
+  {
+    std::cout << records << " registros ate " << lastTime / 1e9 << " s\n";
+    for (const std::pair<const char, uint64_t> &type : byType)
+    {
+      std::cout << "  " << type.first << " " << type.second << "\n";
+    }
+    for (const auto &device : byDevice)
+    {
+      std::string name = linkName (device.first.first, device.first.second);
+      std::cout << "  /NodeList/" << device.first.first << "/DeviceList/" << device.first.second
+                << (name.empty () ? "" : " (" + name + ")") << ": " << device.second.first << " registros, " << device.second.second << " bytes\n";
+    }
+  }
+  return 0;
+}
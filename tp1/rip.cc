@@ -13,33 +13,169 @@
 #include "ns3/netanim-module.h" //the header file for animation
 #include "ns3/mobility-helper.h"
 #include "ns3/applications-module.h"
+#include "../util/animation-output.h"
+#include "../util/batched-rip.h"
+#include "../util/binary-trace-helper.h"
+#include "../util/control-overhead.h"
+#include "../util/convergence-monitor.h"
+#include "../util/echo-counter.h"
+#include "../util/event-log-helper.h"
+#include "../util/event-profiler.h"
+#include "../util/failure-scheduler.h"
+#include "../util/filtered-pcap.h"
+#include "../util/flow-window-stats.h"
+#include "../util/route-cache.h"
+#include "../util/route-recorder.h"
+#include "../util/run-results.h"
+#include "../util/topology-loader.h"
+#include "../util/traffic-source.h"
+#include "../util/warm-start.h"
 
 using namespace ns3;
 
+// Topologia padrão (lista de arestas, ver util/topology-spec.h); --topology
+// troca por outro arquivo com os mesmos nomes de nós e enlaces
+static const char *g_defaultTopology =
+  "node HostT host\n"
+  "node HostR host\n"
+  "node RouterA\n"
+  "node RouterB\n"
+  "node RouterC\n"
+  "link HostT RouterA name=net1\n"
+  "link RouterA RouterB name=net2\n"
+  "link RouterB RouterC name=net3\n"
+  "link RouterC HostR name=net4\n";
+
 NS_LOG_COMPONENT_DEFINE ("RipSimpleRouting");
 
 int main (int argc, char **argv)
 {
   bool verbose = false;
+  bool verboseText = false;
   bool printRoutingTables = false;
   bool showPings = false;
   double simulationTime = 131.0; //seconds
   std::string SplitHorizon ("PoisonReverse");
   std::string transportProt = "Udp";
+  std::string topologyFile;
+  bool topologyReport = false;
+  std::string dataRate ("5Mbps");
+  std::string delay ("2ms");
+  std::string linkMetrics;
+  std::string linkIndexFile;
+  std::string hostProfile ("full");
+  bool batchedRip = false;
+  double coalesceWindow = 0.0; //seconds
+  uint32_t ripMaxEntries = 0;
+  bool ripDamping = false;
+  bool routeCache = false;
+  uint32_t routeCacheSize = 1024;
+  double failureDown = 30.0; //seconds
+  double failureUp = 40.0;
+  std::string resultsFile;
+  std::string traceFormat ("binary");
+  std::string eventLogFile;
+  std::string convergenceFile;
+  std::string failuresFile;
+  std::string routeLogFile;
+  double routeLogInterval = 0.1;
+  std::string flowStatsFile;
+  std::string profileFile;
+  double flowWindow = 1.0;
+  std::string overheadFile;
+  double overheadInterval = 1.0;
+  std::string checkpointFile;
+  double checkpointTime = 25.0; //seconds
+  std::string warmStartFile;
+  std::string pcapFilter ("all");
+  uint32_t pcapSnaplen = 65535;
+  std::string pcapNodes;
+  uint64_t pcapMaxBytes = 0;
+  uint32_t pcapFiles = 1;
+  std::string animMode ("full");
+  double animStart = 0.0;
+  double animStop = 0.0;
+  std::string animNodes;
+  uint32_t animChunk = 0;
+  bool animCompress = false;
+  std::string trafficMode ("none");
+  std::string trafficRate ("1Mbps");
+  uint32_t trafficPacketSize = 1024;
+  uint32_t trafficFlows = 2;
+  std::string trafficTrace;
 
   CommandLine cmd (__FILE__);
-  cmd.AddValue ("verbose", "turn on log components", verbose);
+  cmd.AddValue ("verbose", "turn on log components and write the binary event log (tp1-rip.evl unless eventLog is given)", verbose);
+  cmd.AddValue ("verboseText", "Print every packet and routing step as text (LOG_LEVEL_ALL); much slower than the binary event log", verboseText);
   cmd.AddValue ("printRountingTables", "Print routing tables at 30, 60 and 90 seconds", printRoutingTables);
   cmd.AddValue ("showPings", "Show Ping6 reception", showPings);
   cmd.AddValue ("splitHorizonStrategy", "Split Horizon strategy to use (NoSplitHorizon, SplitHorizon, PoisonReverse)", SplitHorizon);
   cmd.AddValue ("transportProt", "Transport protocol to use: Tcp, Udp", transportProt);
+  cmd.AddValue ("topology", "Edge list or GraphML file replacing the built-in topology", topologyFile);
+  cmd.AddValue ("topologyReport", "Print topology build time and memory", topologyReport);
+  cmd.AddValue ("simulationTime", "Simulation time in seconds", simulationTime);
+  cmd.AddValue ("dataRate", "Default link data rate (e.g. 5Mbps)", dataRate);
+  cmd.AddValue ("delay", "Default link delay (e.g. 2ms)", delay);
+  cmd.AddValue ("linkMetrics", "Comma separated link metrics overriding the topology (e.g. net7=1,net8=1)", linkMetrics);
+  cmd.AddValue ("linkIndex", "Write the link -> subnet and device index to this file (for tools/trace_dump and tools/rt_query --links)", linkIndexFile);
+  cmd.AddValue ("hostProfile", "Host stack: full (InternetStackHelper) or light (IPv4, ICMP and UDP only, see util/topology-loader.h)", hostProfile);
+  cmd.AddValue ("batchedRip", "Run BatchedRip (see util/batched-rip.h) instead of ns3::Rip; same timers, plus the three options below", batchedRip);
+  cmd.AddValue ("coalesceWindow", "With batchedRip, minimum interval (s) between triggered updates; changes in between go together", coalesceWindow);
+  cmd.AddValue ("ripMaxEntries", "With batchedRip, route entries per update message, 0 to fill the MTU", ripMaxEntries);
+  cmd.AddValue ("ripDamping", "With batchedRip, suppress flapping routes (penalty per withdrawal, see util/batched-rip.h)", ripDamping);
+  cmd.AddValue ("routeCache", "Cache the route of each destination in front of the routing table, emptied on every table change (see util/route-cache.h)", routeCache);
+  cmd.AddValue ("routeCacheSize", "Entries of each routeCache table, rounded up to a power of 2", routeCacheSize);
+  cmd.AddValue ("failureDown", "Time (s) when RouterA's interface to HostT goes down", failureDown);
+  cmd.AddValue ("failureUp", "Time (s) when RouterA's interface to HostT comes back up", failureUp);
+  cmd.AddValue ("failures", "Failure scenario file (link/node failures by name, flaps, SRLGs; see util/failure-plan.h) replacing the built-in failures", failuresFile);
+  cmd.AddValue ("convergence", "Write per failure/recovery convergence times and losses as CSV to this file", convergenceFile);
+  cmd.AddValue ("routeLog", "Record routing table changes to this binary file (query with tools/rt_query)", routeLogFile);
+  cmd.AddValue ("routeLogInterval", "Routing table sampling interval (s) for routeLog", routeLogInterval);
+  cmd.AddValue ("flowStats", "Write per flow sent/received/lost packets, delay and jitter per time window to this file", flowStatsFile);
+  cmd.AddValue ("flowWindow", "Time window (s) of the flowStats table", flowWindow);
+  cmd.AddValue ("overhead", "Write control plane bytes and packets (rip, ospf, arp, icmp, data) per link and time interval as CSV to this file", overheadFile);
+  cmd.AddValue ("overheadInterval", "Time interval (s) of the overhead table", overheadInterval);
+  cmd.AddValue ("checkpoint", "Save the converged state (RIP routes, OSPF LSDB and adjacencies, ARP caches) to this file at checkpointTime (see util/warm-start.h)", checkpointFile);
+  cmd.AddValue ("checkpointTime", "Time (s) when the checkpoint is saved, after convergence and before the first failure", checkpointTime);
+  cmd.AddValue ("warmStart", "Restore the state saved by checkpoint at t = 0 instead of converging from scratch; move the failures earlier and shorten simulationTime accordingly", warmStartFile);
+  cmd.AddValue ("profile", "Profile the simulator events: print events/s and the cost of each handler type and write it per node as CSV to this file", profileFile);
+  cmd.AddValue ("traceFormat", "Device trace format: binary (tp1-rip.btr, read with tools/trace_dump), ascii (tp1-rip.tr) or none", traceFormat);
+  cmd.AddValue ("eventLog", "Write IP, ARP and routing events as fixed size binary records to this file (read with tools/log_dump, see util/event-log.h)", eventLogFile);
+  cmd.AddValue ("pcap", "Pcap capture filter (tp1-rip-<node>-<device>.pcap): all, none or a list such as rip,arp or udp:520 (see util/filtered-pcap.h)", pcapFilter);
+  cmd.AddValue ("pcapSnaplen", "Bytes captured per packet", pcapSnaplen);
+  cmd.AddValue ("pcapNodes", "Comma separated nodes to capture on (default: all)", pcapNodes);
+  cmd.AddValue ("pcapMaxBytes", "Size limit (bytes) of each pcap file, 0 for no limit", pcapMaxBytes);
+  cmd.AddValue ("pcapFiles", "Pcap files per device in the ring used with pcapMaxBytes", pcapFiles);
+  cmd.AddValue ("anim", "Animation: full (NetAnim, tp1-rip.anim.xml), sampled (window/node subset, see util/animation-output.h) or none for batch runs", animMode);
+  cmd.AddValue ("animStart", "Time (s) when the animation starts recording packets", animStart);
+  cmd.AddValue ("animStop", "Time (s) when the animation stops recording packets, 0 for the end", animStop);
+  cmd.AddValue ("animNodes", "Comma separated nodes whose packets are animated in sampled mode (default: all)", animNodes);
+  cmd.AddValue ("animChunk", "Packets per animation file, 0 for a single file", animChunk);
+  cmd.AddValue ("animCompress", "Compress the sampled animation files (read with tools/anim_unpack)", animCompress);
+  cmd.AddValue ("traffic", "Background load between HostT and HostR: none, cbr, poisson, onoff (Pareto on/off periods) or trace (see util/traffic-source.h)", trafficMode);
+  cmd.AddValue ("trafficRate", "Rate of each load flow (while on, in onoff mode)", trafficRate);
+  cmd.AddValue ("trafficPacketSize", "Payload bytes of the load packets", trafficPacketSize);
+  cmd.AddValue ("trafficFlows", "Load flows, alternating HostT to HostR and HostR to HostT", trafficFlows);
+  cmd.AddValue ("trafficTrace", "File with '<gap seconds> <bytes>' lines replayed by the trace mode", trafficTrace);
+  cmd.AddValue ("results", "Append a CSV row with the parameters and delivery metrics to this file", resultsFile);
   cmd.Parse (argc, argv);
 
-  if (verbose)
+  if (verbose || verboseText)
   {
     LogComponentEnableAll (LogLevel (LOG_PREFIX_TIME | LOG_PREFIX_NODE));
     LogComponentEnable ("RipSimpleRouting", LOG_LEVEL_INFO);
+    LogComponentEnable ("TopologyLoader", LOG_LEVEL_INFO);
+  }
+  // o texto por pacote fica só no verboseText; o verbose grava os mesmos
+  // eventos no log binário
+  if (verbose && eventLogFile.empty ())
+  {
+    eventLogFile = "tp1-rip.evl";
+  }
+  if (verboseText)
+  {
     LogComponentEnable ("Rip", LOG_LEVEL_ALL);
+    LogComponentEnable ("BatchedRip", LOG_LEVEL_ALL);
     LogComponentEnable ("Ipv4Interface", LOG_LEVEL_ALL);
     LogComponentEnable ("Icmpv4L4Protocol", LOG_LEVEL_ALL);
     LogComponentEnable ("Ipv4L3Protocol", LOG_LEVEL_ALL);
@@ -50,93 +186,64 @@ int main (int argc, char **argv)
   if (SplitHorizon == "NoSplitHorizon")
   {
     Config::SetDefault ("ns3::Rip::SplitHorizon", EnumValue (RipNg::NO_SPLIT_HORIZON));
+    Config::SetDefault ("ns3::BatchedRip::SplitHorizon", EnumValue (BatchedRip::NO_SPLIT_HORIZON));
   }
   else if (SplitHorizon == "SplitHorizon")
   {
     Config::SetDefault ("ns3::Rip::SplitHorizon", EnumValue (RipNg::SPLIT_HORIZON));
+    Config::SetDefault ("ns3::BatchedRip::SplitHorizon", EnumValue (BatchedRip::SPLIT_HORIZON));
   }
   else
   {
     Config::SetDefault ("ns3::Rip::SplitHorizon", EnumValue (RipNg::POISON_REVERSE));
+    Config::SetDefault ("ns3::BatchedRip::SplitHorizon", EnumValue (BatchedRip::POISON_REVERSE));
   }
 
-  NS_LOG_INFO ("Start create nodes.");
-  // Node: elemento da rede, pode ser um host, roteador ou até mais alto nivel como aplicacao
-  Ptr<Node> src = CreateObject<Node> ();
-  Names::Add ("HostT", src);
-  Ptr<Node> dst = CreateObject<Node> ();
-  Names::Add ("HostR", dst);
-  
-  Ptr<Node> a = CreateObject<Node> ();
-  Names::Add ("RouterA", a);
-  Ptr<Node> b = CreateObject<Node> ();
-  Names::Add ("RouterB", b);
-  Ptr<Node> c = CreateObject<Node> ();
-  Names::Add ("RouterC", c);
-
-  //redes: considerando que cada enlace é uma rede separada, sem meio compartilhado
-  NodeContainer net1 (src, a);
-  NodeContainer net2 (a, b);
-  NodeContainer net3 (b, c);
-  NodeContainer net4 (c, dst);
-  NodeContainer routers (a, b, c);
-  NodeContainer nodes (src, dst);
-  NS_LOG_INFO ("End create nodes.");
-  
-  NS_LOG_INFO ("Create channels.");
-  // Enlaces usam CSMA para controle de acesso ao meio
-  // É como se tivesse ligado os cabos entre as máquinas
-  CsmaHelper csma;
-  csma.SetChannelAttribute ("DataRate", DataRateValue (5000000));
-  csma.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (2)));
-  NetDeviceContainer ndc1 = csma.Install (net1);
-  NetDeviceContainer ndc2 = csma.Install (net2);
-  NetDeviceContainer ndc3 = csma.Install (net3);
-  NetDeviceContainer ndc4 = csma.Install (net4);
-
-  NS_LOG_INFO ("Create IPv4 and routing");
-  RipHelper ripRouting;
-  
-  // Exclui as interfaces entre hosts e roteadores, pois queremos que o RIP aconteça somente entre os roteadores
-  ripRouting.ExcludeInterface (a, 1); // exclui do RIP a interface entre src e a 
-  ripRouting.ExcludeInterface (c, 2); // exclui do RIP a interface entre c e dst
-
-  Ipv4ListRoutingHelper listRH;
-  listRH.Add (ripRouting, 0);
-
-  InternetStackHelper internet;
-  internet.SetIpv6StackInstall (false); //sem Ipv6
-  internet.SetRoutingHelper (listRH); //qual objeto de roteamento (instala o protocolo de roteamento)
-  internet.Install (routers);
-
-  InternetStackHelper internetNodes;
-  internetNodes.SetIpv6StackInstall (false); //sem Ipv6
-  internetNodes.Install (nodes);
-
-  NS_LOG_INFO ("Assign IPv4 Addresses.");
-  Ipv4AddressHelper ipv4;
-
-  //dando endereços de rede para os enlaces
-  //como se tivesse usado DHCP para os enlaces entre os nodos
-  
-  ipv4.SetBase (Ipv4Address ("10.0.0.0"), Ipv4Mask ("255.255.255.0"));
-  Ipv4InterfaceContainer iic1 = ipv4.Assign (ndc1);
+  Config::SetDefault ("ns3::BatchedRip::CoalesceWindow", TimeValue (Seconds (coalesceWindow)));
+  Config::SetDefault ("ns3::BatchedRip::MaxEntriesPerMessage", UintegerValue (ripMaxEntries));
+  Config::SetDefault ("ns3::BatchedRip::Damping", BooleanValue (ripDamping));
+  Config::SetDefault ("ns3::RouteCache::Size", UintegerValue (routeCacheSize));
 
-  ipv4.SetBase (Ipv4Address ("10.0.1.0"), Ipv4Mask ("255.255.255.0"));
-  Ipv4InterfaceContainer iic2 = ipv4.Assign (ndc2);
-
-  ipv4.SetBase (Ipv4Address ("10.0.2.0"), Ipv4Mask ("255.255.255.0"));
-  Ipv4InterfaceContainer iic3 = ipv4.Assign (ndc3);
+  NS_LOG_INFO ("Start create nodes.");
+  // Nós, enlaces CSMA e endereços saem da topologia; o loader também exclui do RIP
+  // as interfaces entre hosts e roteadores e configura a rota padrão dos hosts
+  TopologyLoader topology;
+  topology.SetLinkType (TopologyLoader::CSMA);
+  topology.SetRouting (batchedRip ? TopologyLoader::ROUTING_BATCHED_RIP : TopologyLoader::ROUTING_RIP);
+  topology.SetDefaultDataRate (DataRate (dataRate));
+  topology.SetDefaultDelay (Time (delay));
+  topology.SetHostProfile (hostProfile == "light" ? TopologyLoader::HOST_LIGHT : TopologyLoader::HOST_FULL);
+  topology.SetRouteCache (routeCache);
+  if (topologyFile.empty ())
+  {
+    topology.LoadString (g_defaultTopology);
+  }
+  else
+  {
+    topology.Load (topologyFile);
+  }
+  topology.SetLinkMetrics (linkMetrics);
+  topology.Build ();
+  if (!linkIndexFile.empty ())
+  {
+    topology.WriteLinkIndex (linkIndexFile);
+  }
+  if (topologyReport)
+  {
+    topology.PrintReport (std::cout);
+  }
 
-  ipv4.SetBase (Ipv4Address ("10.0.3.0"), Ipv4Mask ("255.255.255.0"));
-  Ipv4InterfaceContainer iic4 = ipv4.Assign (ndc4);
+  Ptr<Node> src = topology.GetNode ("HostT");
+  Ptr<Node> dst = topology.GetNode ("HostR");
+  Ptr<Node> a = topology.GetNode ("RouterA");
+  Ptr<Node> b = topology.GetNode ("RouterB");
+  Ptr<Node> c = topology.GetNode ("RouterC");
+  NodeContainer routers = topology.GetRouters ();
+  NodeContainer nodes = topology.GetHosts ();
+  NS_LOG_INFO ("End create nodes.");
 
-  // configuração da rota padrão para os hosts
-  Ptr<Ipv4StaticRouting> staticRouting;
-  staticRouting = Ipv4RoutingHelper::GetRouting <Ipv4StaticRouting> (src->GetObject<Ipv4> ()->GetRoutingProtocol ());
-  staticRouting->SetDefaultRoute ("10.0.0.2", 1 ); //src (10.0.0.1) ->  a (10.0.0.2)
-  staticRouting = Ipv4RoutingHelper::GetRouting <Ipv4StaticRouting> (dst->GetObject<Ipv4> ()->GetRoutingProtocol ());
-  staticRouting->SetDefaultRoute ("10.0.3.1", 1 ); //dst (10.0.3.2) -> c (10.0.3.1)
+  // CsmaHelper usado só para os traces dos dispositivos criados pelo loader
+  CsmaHelper csma;
 
   if (printRoutingTables)
   {
@@ -174,47 +281,240 @@ int main (int argc, char **argv)
   uint32_t packetSize = 1024;
   Time interPacketInterval = Seconds (1.0);
   
-  UdpEchoClientHelper client (iic4.GetAddress(1), port);
+  UdpEchoClientHelper client (topology.GetAddress ("HostR", "net4"), port);
   client.SetAttribute ("Interval", TimeValue (interPacketInterval));
   client.SetAttribute ("PacketSize", UintegerValue (packetSize));
   apps = client.Install (src);
   apps.Start (Seconds (2.0));
   apps.Stop (Seconds (simulationTime - 20.0));
 
-  AsciiTraceHelper ascii;
-  csma.EnableAsciiAll (ascii.CreateFileStream ("tp1-rip.tr"));
-  csma.EnablePcapAll ("tp1-rip", true);
+  EchoCounter echo;
+  echo.Install ();
 
-  NS_LOG_INFO ("Configuring Animation.");
+  TrafficMeter trafficMeter;
+  if (trafficMode != "none")
+  {
+    uint16_t trafficPort = 5000;
+    TrafficHelper load (trafficMode);
+    load.SetAttribute ("DataRate", DataRateValue (DataRate (trafficRate)));
+    load.SetAttribute ("PacketSize", UintegerValue (trafficPacketSize));
+    load.SetAttribute ("TraceFile", StringValue (trafficTrace));
+    apps = load.InstallSink (NodeContainer (src, dst), trafficPort);
+    apps.Start (Seconds (1.0));
+    apps = load.InstallFlows (src, topology.GetAddress ("HostT", "net1"), dst, topology.GetAddress ("HostR", "net4"),
+                              trafficFlows, trafficPort);
+    apps.Start (Seconds (2.0));
+    apps.Stop (Seconds (simulationTime - 20.0));
+    trafficMeter.Install ();
+  }
+
+  ConvergenceMonitor convergence;
+  if (!convergenceFile.empty ())
+  {
+    convergence.Install (topology.GetNodes (), Seconds (simulationTime));
+    if (failuresFile.empty ())
+    {
+      convergence.AddEvent (Seconds (failureDown), "RouterA-net1-down");
+      convergence.AddEvent (Seconds (failureUp), "RouterA-net1-up");
+    }
+  }
+
+  RouteRecorder routeLog;
+  if (!routeLogFile.empty ())
+  {
+    routeLog.SetInterval (Seconds (routeLogInterval));
+    routeLog.Open (routeLogFile);
+    routeLog.Install (topology.GetNodes (), Seconds (simulationTime));
+  }
+
+  FlowWindowStats flowStats;
+  if (!flowStatsFile.empty ())
+  {
+    flowStats.Install (Seconds (flowWindow), Seconds (simulationTime));
+  }
+
+  ControlOverhead overhead;
+  if (!overheadFile.empty ())
+  {
+    overhead.SetInterval (Seconds (overheadInterval));
+    overhead.Install (topology.GetNodes (), topology.GetAddressPlan ());
+  }
 
-  MobilityHelper mobility;
-  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
-  mobility.Install (nodes);
-  mobility.Install (routers);
+  BinaryTraceHelper binaryTrace;
+  if (traceFormat == "binary")
+  {
+    binaryTrace.Open ("tp1-rip.btr");
+    binaryTrace.EnableAll ();
+  }
+  else if (traceFormat == "ascii")
+  {
+    AsciiTraceHelper ascii;
+    csma.EnableAsciiAll (ascii.CreateFileStream ("tp1-rip.tr"));
+  }
+
+  EventLogHelper eventLog;
+  if (!eventLogFile.empty ())
+  {
+    eventLog.Open (eventLogFile);
+    eventLog.EnableAll ();
+  }
+
+  FilteredPcapHelper pcapCapture;
+  if (pcapFilter != "none")
+  {
+    pcapCapture.SetFilter (pcapFilter);
+    pcapCapture.SetSnaplen (pcapSnaplen);
+    pcapCapture.SetRing (pcapMaxBytes, pcapFiles);
+    pcapCapture.Enable ("tp1-rip", pcapNodes.empty () ? topology.GetNodes () : topology.GetNodes (pcapNodes));
+  }
 
-  AnimationInterface anim ("tp1-rip.anim.xml");
-  anim.SetConstantPosition(src, 10.0, 10.0); //for node src
-  anim.SetConstantPosition(a, 20.0, 10.0); //for router a
-  anim.SetConstantPosition(b, 30.0, 10.0); //for router b
-  anim.SetConstantPosition(c, 40.0, 10.0); //for router b
-  anim.SetConstantPosition(dst, 50.0, 10.0); //for node dst
+  NS_LOG_INFO ("Configuring Animation.");
 
-  anim.UpdateNodeDescription(0, "Host_T");
-  anim.UpdateNodeDescription(1, "Host_R");
-  anim.UpdateNodeDescription(2, "Router_A");
-  anim.UpdateNodeDescription(3, "Router_B");
-  anim.UpdateNodeDescription(4, "Router_C");
+  AnimationOutput animation;
+  animation.SetMode (animMode);
+  animation.SetWindow (Seconds (animStart), Seconds (animStop));
+  animation.SetNodes (topology.GetNodes (animNodes));
+  animation.SetChunkPackets (animChunk);
+  animation.SetCompress (animCompress);
+
+  animation.SetConstantPosition(src, 10.0, 10.0); //for node src
+  animation.SetConstantPosition(a, 20.0, 10.0); //for router a
+  animation.SetConstantPosition(b, 30.0, 10.0); //for router b
+  animation.SetConstantPosition(c, 40.0, 10.0); //for router b
+  animation.SetConstantPosition(dst, 50.0, 10.0); //for node dst
+
+  animation.UpdateNodeDescription(0, "Host_T");
+  animation.UpdateNodeDescription(1, "Host_R");
+  animation.UpdateNodeDescription(2, "Router_A");
+  animation.UpdateNodeDescription(3, "Router_B");
+  animation.UpdateNodeDescription(4, "Router_C");
+  animation.Install ("tp1-rip");
 
   NS_LOG_INFO ("Run Simulation.");
-  Ptr<Ipv4> ipv4A = a->GetObject<Ipv4> ();
-  // The first ifIndex is 0 for loopback, then the first p2p is numbered 1,
-  // then the next p2p is numbered 2
-  uint32_t ipv4ifIndex1 = 1;
-  Simulator::Schedule (Seconds (30.00),&Ipv4::SetDown,ipv4A, ipv4ifIndex1);
-  Simulator::Schedule (Seconds (40.00),&Ipv4::SetUp,ipv4A, ipv4ifIndex1);
-
-  Simulator::Stop (Seconds(simulationTime)); // parar a simulação após 131 segundos
+  FailureScheduler failures (topology);
+  if (!failuresFile.empty ())
+  {
+    failures.Load (failuresFile);
+    failures.Install (Seconds (simulationTime));
+    if (!convergenceFile.empty ())
+    {
+      for (const std::pair<Time, std::string> &failure : failures.GetScheduledFailures ())
+      {
+        convergence.AddEvent (failure.first, failure.second);
+      }
+    }
+  }
+  else
+  {
+    Ptr<Ipv4> ipv4A = a->GetObject<Ipv4> ();
+    // interface de A no enlace com HostT (net1)
+    uint32_t ipv4ifIndex1 = topology.GetInterface ("RouterA", "net1");
+    Simulator::Schedule (Seconds (failureDown),&Ipv4::SetDown,ipv4A, ipv4ifIndex1);
+    Simulator::Schedule (Seconds (failureUp),&Ipv4::SetUp,ipv4A, ipv4ifIndex1);
+  }
+
+  WarmStart warmStart (topology);
+  if (!checkpointFile.empty ())
+  {
+    warmStart.Save (Seconds (checkpointTime), checkpointFile);
+  }
+  if (!warmStartFile.empty ())
+  {
+    warmStart.Restore (warmStartFile);
+    warmStart.Report (std::cout);
+  }
+
+  Simulator::Stop (Seconds(simulationTime)); // parar a simulação após simulationTime segundos
+  EventProfiler profiler;
+  if (!profileFile.empty ())
+  {
+    profiler.Enable ();
+  }
+  WallClock runClock;
   Simulator::Run ();
+  profiler.Stop ();
+  double wallSeconds = runClock.GetSeconds ();
+  binaryTrace.Close ();
+  eventLog.Close ();
+  animation.Close ();
+  routeLog.Close ();
+  if (trafficMode != "none")
+  {
+    trafficMeter.Report (std::cout, wallSeconds);
+  }
+  if (batchedRip)
+  {
+    BatchedRip::Report (std::cout, topology.GetRouters ());
+  }
+  if (routeCache)
+  {
+    RouteCache::Report (std::cout, topology.GetRouters ());
+  }
+  if (!convergenceFile.empty ())
+  {
+    convergence.WriteCsv (convergenceFile);
+  }
+  if (!flowStatsFile.empty ())
+  {
+    flowStats.Write (flowStatsFile);
+  }
+  if (!overheadFile.empty ())
+  {
+    overhead.Report (std::cout);
+    overhead.WriteCsv (overheadFile);
+  }
+  if (!profileFile.empty ())
+  {
+    profiler.Report (std::cout);
+    profiler.WriteCsv (profileFile);
+  }
+
+  if (!resultsFile.empty ())
+  {
+    RunResults results;
+    results.Set ("scenario", "tp1-rip");
+    results.Set ("splitHorizonStrategy", SplitHorizon);
+    results.Set ("dataRate", dataRate);
+    results.Set ("delay", delay);
+    results.Set ("linkMetrics", linkMetrics);
+    results.Set ("hostProfile", hostProfile);
+    results.Set ("failureDown", failureDown);
+    results.Set ("failureUp", failureUp);
+    results.Set ("failures", failuresFile);
+    results.Set ("simulationTime", simulationTime);
+    results.Set ("sent", echo.GetSent ());
+    results.Set ("delivered", echo.GetDelivered ());
+    results.Set ("echoed", echo.GetEchoed ());
+    results.Set ("deliveryRatio", echo.GetDeliveryRatio ());
+    results.Set ("traffic", trafficMode);
+    results.Set ("trafficSent", trafficMeter.GetSent ());
+    results.Set ("trafficReceived", trafficMeter.GetReceived ());
+    results.Set ("throughputMbps", trafficMeter.GetThroughput () / 1e6);
+    results.Set ("linkTransmissions", trafficMeter.GetTransmissions ());
+    results.Set ("wallSeconds", wallSeconds);
+    results.Set ("packetsPerWallSecond", trafficMeter.GetTransmissions () / wallSeconds);
+    BatchedRip::Stats rip = BatchedRip::GetTotalStats (topology.GetRouters ());
+    results.Set ("batchedRip", batchedRip);
+    results.Set ("coalesceWindow", coalesceWindow);
+    results.Set ("ripMaxEntries", ripMaxEntries);
+    results.Set ("ripDamping", ripDamping);
+    results.Set ("ripControlBytes", rip.bytesSent);
+    results.Set ("triggeredUpdates", rip.triggeredUpdates);
+    results.Set ("coalescedChanges", rip.coalescedChanges);
+    results.Set ("routeSuppressions", rip.suppressions);
+    results.Set ("controlPackets", overhead.GetControlPackets ());
+    results.Set ("controlBytes", overhead.GetControlBytes ());
+    results.Set ("warmStart", warmStartFile);
+    results.Set ("convergenceSeconds", convergence.GetTotalConvergence ());
+    results.Set ("convergenceLost", convergence.GetTotalLost ());
+    results.Set ("routeCache", routeCache);
+    results.Set ("routeCacheHitRate", routeCache ? RouteCache::GetHitRate (RouteCache::GetTotalStats (topology.GetRouters ())) : 0.0);
+    std::string error;
+    if (!results.Write (resultsFile, &error))
+    {
+      NS_FATAL_ERROR (error);
+    }
+  }
   Simulator::Destroy ();
   NS_LOG_INFO ("Done.");
 }
\ No newline at end of file
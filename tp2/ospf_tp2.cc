@@ -15,9 +15,11 @@ HostT               X               HostR
        \ RouterC ------- RouterD /
                   net5
 
+ As diagonais net7 e net8 têm métrica 2 (--linkMetrics troca)
 */
 
 #include <fstream>
+#include <memory>
 #include "ns3/core-module.h"
 #include "ns3/network-module.h"
 #include "ns3/csma-module.h"
@@ -27,9 +29,46 @@ HostT               X               HostR
 #include "ns3/ipv4-global-routing-helper.h"
 #include "ns3/netanim-module.h" //the header file for animation
 #include "ns3/mobility-helper.h"
+#include "../util/animation-output.h"
+#include "../util/binary-trace-helper.h"
+#include "../util/control-overhead.h"
+#include "../util/convergence-monitor.h"
+#include "../util/echo-counter.h"
+#include "../util/ecmp-routing.h"
+#include "../util/event-log-helper.h"
+#include "../util/event-profiler.h"
+#include "../util/failure-scheduler.h"
+#include "../util/filtered-pcap.h"
+#include "../util/flow-window-stats.h"
+#include "../util/incremental-global-routing.h"
+#include "../util/ospf-routing.h"
+#include "../util/route-cache.h"
+#include "../util/route-recorder.h"
+#include "../util/run-results.h"
+#include "../util/topology-loader.h"
+#include "../util/traffic-source.h"
+#include "../util/warm-start.h"
 
 using namespace ns3;
 
+// Topologia padrão (lista de arestas, ver util/topology-spec.h); --topology
+// troca por outro arquivo com os mesmos nomes de nós e enlaces
+static const char *g_defaultTopology =
+  "node HostT host\n"
+  "node HostR host\n"
+  "node RouterA\n"
+  "node RouterB\n"
+  "node RouterC\n"
+  "node RouterD\n"
+  "link HostT RouterA name=net1\n"
+  "link RouterA RouterB name=net2\n"
+  "link RouterB HostR name=net3\n"
+  "link HostT RouterC name=net4\n"
+  "link RouterC RouterD name=net5\n"
+  "link RouterD HostR name=net6\n"
+  "link RouterA RouterD name=net7 metric=2\n"
+  "link RouterC RouterB name=net8 metric=2\n";
+
 NS_LOG_COMPONENT_DEFINE ("DynamicGlobalRoutingExample");
 
 int main (int argc, char *argv[])
@@ -38,121 +77,182 @@ int main (int argc, char *argv[])
   bool verbose = true;
   double simulationTime = 300.0; //seconds
   std::string transportProt = "Udp";
+  std::string topologyFile;
+  bool topologyReport = false;
+  std::string dataRate ("5Mbps");
+  std::string delay ("2ms");
+  std::string linkMetrics;
+  std::string linkIndexFile;
+  std::string hostProfile ("full");
+  double failureDown1 = 30.0; //seconds
+  double failureUp1 = 40.0;
+  double failureDown2 = 70.0;
+  double failureUp2 = 90.0;
+  std::string resultsFile;
+  std::string traceFormat ("binary");
+  std::string eventLogFile;
+  std::string convergenceFile;
+  std::string failuresFile;
+  std::string routeLogFile;
+  double routeLogInterval = 0.1;
+  std::string flowStatsFile;
+  std::string profileFile;
+  double flowWindow = 1.0;
+  std::string overheadFile;
+  double overheadInterval = 1.0;
+  std::string checkpointFile;
+  double checkpointTime = 25.0; //seconds
+  std::string warmStartFile;
+  std::string pcapFilter ("all");
+  uint32_t pcapSnaplen = 65535;
+  std::string pcapNodes;
+  uint64_t pcapMaxBytes = 0;
+  uint32_t pcapFiles = 1;
+  std::string animMode ("full");
+  double animStart = 0.0;
+  double animStop = 0.0;
+  std::string animNodes;
+  uint32_t animChunk = 0;
+  bool animCompress = false;
+  std::string trafficMode ("none");
+  std::string trafficRate ("1Mbps");
+  uint32_t trafficPacketSize = 1024;
+  uint32_t trafficFlows = 2;
+  std::string trafficTrace;
+  bool incrementalSpf = false;
+  bool ecmp = false;
+  bool ospf = false;
+  bool routeCache = false;
+  uint32_t routeCacheSize = 1024;
 
   // The below value configures the default behavior of global routing.
   // By default, it is disabled.  To respond to interface events, set to true
   Config::SetDefault ("ns3::Ipv4GlobalRouting::RespondToInterfaceEvents", BooleanValue (true));
-  //Config::SetDefault ("ns3::Ipv4GlobalRouting::RandomEcmpRouting", BooleanValue (true));
+  // Caminhos de mesmo custo: --ecmp divide por fluxo (util/ecmp-routing.h), no
+  // lugar do RandomEcmpRouting, que sorteia a saída a cada pacote e reordena os fluxos
 
   // Allow the user to override any of the defaults and the above
   // Bind ()s at run-time, via command-line arguments
   CommandLine cmd (__FILE__);
   cmd.AddValue ("verbose", "turn on log components", verbose);
+  cmd.AddValue ("topology", "Edge list or GraphML file replacing the built-in topology", topologyFile);
+  cmd.AddValue ("topologyReport", "Print topology build time and memory", topologyReport);
+  cmd.AddValue ("simulationTime", "Simulation time in seconds", simulationTime);
+  cmd.AddValue ("dataRate", "Default link data rate (e.g. 5Mbps)", dataRate);
+  cmd.AddValue ("delay", "Default link delay (e.g. 2ms)", delay);
+  cmd.AddValue ("linkMetrics", "Comma separated link metrics overriding the topology (e.g. net7=1,net8=1)", linkMetrics);
+  cmd.AddValue ("linkIndex", "Write the link -> subnet and device index to this file (for tools/trace_dump and tools/rt_query --links)", linkIndexFile);
+  cmd.AddValue ("hostProfile", "Host stack: full (InternetStackHelper) or light (IPv4, ICMP and UDP only, see util/topology-loader.h)", hostProfile);
+  cmd.AddValue ("failureDown1", "Time (s) when RouterB's interface to RouterA goes down", failureDown1);
+  cmd.AddValue ("failureUp1", "Time (s) when RouterB's interface to RouterA comes back up", failureUp1);
+  cmd.AddValue ("failureDown2", "Time (s) when RouterD's interface to RouterC goes down", failureDown2);
+  cmd.AddValue ("failureUp2", "Time (s) when RouterD's interface to RouterC comes back up", failureUp2);
+  cmd.AddValue ("incrementalSpf", "Update only the routes affected by interface events instead of recomputing every SPF tree", incrementalSpf);
+  cmd.AddValue ("ecmp", "Split traffic over equal-cost paths per flow (hash of addresses, protocol and ports; see util/ecmp-routing.h)", ecmp);
+  cmd.AddValue ("ospf", "Run the OSPF protocol (hellos, LSA flooding, SPF throttling; see util/ospf-routing.h) instead of the global routing oracle", ospf);
+  cmd.AddValue ("routeCache", "With ospf, cache the route of each destination in front of the routing table, emptied on every table change (see util/route-cache.h)", routeCache);
+  cmd.AddValue ("routeCacheSize", "Entries of each routeCache table, rounded up to a power of 2", routeCacheSize);
+  cmd.AddValue ("failures", "Failure scenario file (link/node failures by name, flaps, SRLGs; see util/failure-plan.h) replacing the built-in failures", failuresFile);
+  cmd.AddValue ("convergence", "Write per failure/recovery convergence times and losses as CSV to this file", convergenceFile);
+  cmd.AddValue ("routeLog", "Record routing table changes to this binary file (query with tools/rt_query)", routeLogFile);
+  cmd.AddValue ("routeLogInterval", "Routing table sampling interval (s) for routeLog", routeLogInterval);
+  cmd.AddValue ("flowStats", "Write per flow sent/received/lost packets, delay and jitter per time window to this file", flowStatsFile);
+  cmd.AddValue ("flowWindow", "Time window (s) of the flowStats table", flowWindow);
+  cmd.AddValue ("overhead", "Write control plane bytes and packets (rip, ospf, arp, icmp, data) per link and time interval as CSV to this file", overheadFile);
+  cmd.AddValue ("overheadInterval", "Time interval (s) of the overhead table", overheadInterval);
+  cmd.AddValue ("checkpoint", "Save the converged state (RIP routes, OSPF LSDB and adjacencies, ARP caches) to this file at checkpointTime (see util/warm-start.h)", checkpointFile);
+  cmd.AddValue ("checkpointTime", "Time (s) when the checkpoint is saved, after convergence and before the first failure", checkpointTime);
+  cmd.AddValue ("warmStart", "Restore the state saved by checkpoint at t = 0 instead of converging from scratch; move the failures earlier and shorten simulationTime accordingly", warmStartFile);
+  cmd.AddValue ("profile", "Profile the simulator events: print events/s and the cost of each handler type and write it per node as CSV to this file", profileFile);
+  cmd.AddValue ("traceFormat", "Device trace format: binary (tp2-ospf.btr, read with tools/trace_dump), ascii (tp2-ospf.tr) or none", traceFormat);
+  cmd.AddValue ("eventLog", "Write IP, ARP and routing events as fixed size binary records to this file (read with tools/log_dump, see util/event-log.h)", eventLogFile);
+  cmd.AddValue ("pcap", "Pcap capture filter (tp2-ospf-<node>-<device>.pcap): all, none or a list such as ospf,arp or udp:520 (see util/filtered-pcap.h)", pcapFilter);
+  cmd.AddValue ("pcapSnaplen", "Bytes captured per packet", pcapSnaplen);
+  cmd.AddValue ("pcapNodes", "Comma separated nodes to capture on (default: all)", pcapNodes);
+  cmd.AddValue ("pcapMaxBytes", "Size limit (bytes) of each pcap file, 0 for no limit", pcapMaxBytes);
+  cmd.AddValue ("pcapFiles", "Pcap files per device in the ring used with pcapMaxBytes", pcapFiles);
+  cmd.AddValue ("anim", "Animation: full (NetAnim, tp2-ospf.anim.xml), sampled (window/node subset, see util/animation-output.h) or none for batch runs", animMode);
+  cmd.AddValue ("animStart", "Time (s) when the animation starts recording packets", animStart);
+  cmd.AddValue ("animStop", "Time (s) when the animation stops recording packets, 0 for the end", animStop);
+  cmd.AddValue ("animNodes", "Comma separated nodes whose packets are animated in sampled mode (default: all)", animNodes);
+  cmd.AddValue ("animChunk", "Packets per animation file, 0 for a single file", animChunk);
+  cmd.AddValue ("animCompress", "Compress the sampled animation files (read with tools/anim_unpack)", animCompress);
+  cmd.AddValue ("traffic", "Background load between HostT and HostR: none, cbr, poisson, onoff (Pareto on/off periods) or trace (see util/traffic-source.h)", trafficMode);
+  cmd.AddValue ("trafficRate", "Rate of each load flow (while on, in onoff mode)", trafficRate);
+  cmd.AddValue ("trafficPacketSize", "Payload bytes of the load packets", trafficPacketSize);
+  cmd.AddValue ("trafficFlows", "Load flows, alternating HostT to HostR and HostR to HostT", trafficFlows);
+  cmd.AddValue ("trafficTrace", "File with '<gap seconds> <bytes>' lines replayed by the trace mode", trafficTrace);
+  cmd.AddValue ("results", "Append a CSV row with the parameters and delivery metrics to this file", resultsFile);
   cmd.Parse (argc, argv);
+  NS_ABORT_MSG_IF (ospf && (incrementalSpf || ecmp), "--ospf cannot be combined with --incrementalSpf or --ecmp");
+  NS_ABORT_MSG_IF (routeCache && !ospf, "--routeCache needs --ospf");
+  Config::SetDefault ("ns3::RouteCache::Size", UintegerValue (routeCacheSize));
+
+  if (incrementalSpf)
+  {
+    // as quedas e voltas passam pelo IncrementalGlobalRouting
+    Config::SetDefault ("ns3::Ipv4GlobalRouting::RespondToInterfaceEvents", BooleanValue (false));
+  }
 
    if (verbose)
   {
     LogComponentEnableAll (LogLevel (LOG_PREFIX_TIME | LOG_PREFIX_NODE));
     LogComponentEnable ("DynamicGlobalRoutingExample", LOG_LEVEL_WARN);
+    LogComponentEnable ("TopologyLoader", LOG_LEVEL_INFO);
   }
 
   NS_LOG_WARN ("Create nodes.");
 
-  // Node: elemento da rede, pode ser um host, roteador ou até mais alto nivel como aplicacao
-  Ptr<Node> src = CreateObject<Node> ();
-  Names::Add ("HostT", src);
-  Ptr<Node> dst = CreateObject<Node> ();
-  Names::Add ("HostR", dst);
-  
-  Ptr<Node> a = CreateObject<Node> ();
-  Names::Add ("RouterA", a);
-  Ptr<Node> b = CreateObject<Node> ();
-  Names::Add ("RouterB", b);
-  Ptr<Node> c = CreateObject<Node> ();
-  Names::Add ("RouterC", c);
-  Ptr<Node> d = CreateObject<Node> ();
-  Names::Add ("RouterD", d);
-  
-//redes: considerando que cada enlace é uma rede separada, sem meio compartilhado
-  NodeContainer net1 (src, a); 
-  NodeContainer net2 (a, b);   
-  NodeContainer net3 (b, dst);
-  NodeContainer net4 (src, c);
-  NodeContainer net5 (c, d);
-  NodeContainer net6 (d, dst);
-  NodeContainer net7 (a, d);
-  NodeContainer net8 (c, b);
-
-  NodeContainer routers (a, b, c, d);
-  NodeContainer nodes (src, dst);
+  // Nós, enlaces ponto a ponto e endereços saem da topologia; as tabelas do roteamento
+  // global são preenchidas pelo loader (Ipv4GlobalRoutingHelper::PopulateRoutingTables)
+  // ou, com --ospf, pela OspfRouting de cada roteador
+  TopologyLoader topology;
+  topology.SetLinkType (TopologyLoader::POINT_TO_POINT);
+  topology.SetRouting (ospf             ? TopologyLoader::ROUTING_OSPF
+                       : incrementalSpf ? TopologyLoader::ROUTING_NONE
+                                        : TopologyLoader::ROUTING_GLOBAL);
+  topology.SetDefaultDataRate (DataRate (dataRate));
+  topology.SetDefaultDelay (Time (delay));
+  topology.SetHostProfile (hostProfile == "light" ? TopologyLoader::HOST_LIGHT : TopologyLoader::HOST_FULL);
+  topology.SetFlowHashEcmp (ecmp);
+  topology.SetRouteCache (routeCache);
+  if (topologyFile.empty ())
+  {
+    topology.LoadString (g_defaultTopology);
+  }
+  else
+  {
+    topology.Load (topologyFile);
+  }
+  topology.SetLinkMetrics (linkMetrics);
+  topology.Build ();
+  if (!linkIndexFile.empty ())
+  {
+    topology.WriteLinkIndex (linkIndexFile);
+  }
+  if (topologyReport)
+  {
+    topology.PrintReport (std::cout);
+  }
+  std::unique_ptr<IncrementalGlobalRouting> spf;
+  if (incrementalSpf)
+  {
+    spf.reset (new IncrementalGlobalRouting (topology));
+    spf->Install ();
+  }
+
+  Ptr<Node> src = topology.GetNode ("HostT");
+  Ptr<Node> dst = topology.GetNode ("HostR");
+  Ptr<Node> a = topology.GetNode ("RouterA");
+  Ptr<Node> b = topology.GetNode ("RouterB");
+  Ptr<Node> c = topology.GetNode ("RouterC");
+  Ptr<Node> d = topology.GetNode ("RouterD");
+  NodeContainer routers = topology.GetRouters ();
+  NodeContainer nodes = topology.GetHosts ();
   NS_LOG_WARN ("End create nodes.");
 
-  NS_LOG_WARN ("Create channels.");
-  // Enlaces usam CSMA e P2P para controle de acesso ao meio
-  // É como se tivesse ligado os cabos entre as máquinas
+  // PointToPointHelper usado só para os traces dos dispositivos criados pelo loader
   PointToPointHelper p2p;
-  p2p.SetDeviceAttribute ("DataRate", DataRateValue (5000000));
-  p2p.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (2)));
-  NetDeviceContainer ndc1 = p2p.Install (net1);
-  NetDeviceContainer ndc2 = p2p.Install (net2);
-  NetDeviceContainer ndc3 = p2p.Install (net3);
-  NetDeviceContainer ndc4 = p2p.Install (net4);
-  NetDeviceContainer ndc5 = p2p.Install (net5);
-  NetDeviceContainer ndc6 = p2p.Install (net6);
-  NetDeviceContainer ndc7 = p2p.Install (net7);
-  NetDeviceContainer ndc8 = p2p.Install (net8);
-
-  NS_LOG_WARN ("Create IPv4 and routing.");
-
-  // Na implementacao do Global routing nao tem essa parte do RoutingHelper.
-  
-  InternetStackHelper internet;
-  internet.SetIpv6StackInstall (false); //sem Ipv6
-  internet.Install (routers);
-
-  InternetStackHelper internetNodes;
-  internetNodes.SetIpv6StackInstall (false); //sem Ipv6
-  internetNodes.Install (nodes);
-
-  // Later, we add IP addresses.
-  NS_LOG_WARN ("Assign IP Addresses.");
-  Ipv4AddressHelper ipv4;
-
-  //dando endereços de rede para os enlaces
-  //como se tivesse usado DHCP para os enlaces entre os nodos
-
-  ipv4.SetBase (Ipv4Address ("10.0.0.0"), Ipv4Mask ("255.255.255.0"));
-  Ipv4InterfaceContainer iic1 = ipv4.Assign (ndc1);
-
-  ipv4.SetBase (Ipv4Address ("10.0.1.0"), Ipv4Mask ("255.255.255.0"));
-  Ipv4InterfaceContainer iic2 = ipv4.Assign (ndc2);
-
-  ipv4.SetBase (Ipv4Address ("10.0.2.0"), Ipv4Mask ("255.255.255.0"));
-  Ipv4InterfaceContainer iic3 = ipv4.Assign (ndc3);
-
-  ipv4.SetBase (Ipv4Address ("10.0.3.0"), Ipv4Mask ("255.255.255.0"));
-  Ipv4InterfaceContainer iic4 = ipv4.Assign (ndc4);
-
-  ipv4.SetBase (Ipv4Address ("10.0.4.0"), Ipv4Mask ("255.255.255.0"));
-  Ipv4InterfaceContainer iic5 = ipv4.Assign (ndc5);
-
-  ipv4.SetBase (Ipv4Address ("10.0.5.0"), Ipv4Mask ("255.255.255.0"));
-  Ipv4InterfaceContainer iic6 = ipv4.Assign (ndc6);
-
-  ipv4.SetBase (Ipv4Address ("10.0.6.0"), Ipv4Mask ("255.255.255.0"));
-  Ipv4InterfaceContainer iic7 = ipv4.Assign (ndc7);
-
-  ipv4.SetBase (Ipv4Address ("10.0.7.0"), Ipv4Mask ("255.255.255.0"));
-  Ipv4InterfaceContainer iic8 = ipv4.Assign (ndc8);
-
-  // Create router nodes, initialize routing database and set up the routing
-  // tables in the nodes.
-  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
-
-  //NS_LOG_WARN ("DEBUG: Problem here.");
-
-  // Creio que isso fico no lugar do Ptr<Ipv4StaticRouting> staticRouting; 
-  // no caso do rip
 
   NS_LOG_WARN ("Create Applications.");
   //
@@ -172,7 +272,7 @@ int main (int argc, char *argv[])
   uint32_t maxPackets = simulationTime;
   Time interPacketInterval = Seconds (1.0);
 
-  Ipv4Address serverAddress1 = iic3.GetAddress(1);
+  Ipv4Address serverAddress1 = topology.GetAddress ("HostR", "net3");
   UdpEchoClientHelper client1 (serverAddress1, port);
   client1.SetAttribute ("Interval", TimeValue (interPacketInterval));
   client1.SetAttribute ("PacketSize", UintegerValue (packetSize));
@@ -181,7 +281,7 @@ int main (int argc, char *argv[])
   apps.Start (Seconds (2.0));
   apps.Stop (Seconds (simulationTime));
 
-  Ipv4Address serverAddress2 = iic6.GetAddress(1);
+  Ipv4Address serverAddress2 = topology.GetAddress ("HostR", "net6");
   UdpEchoClientHelper client2 (serverAddress2, port);
   client2.SetAttribute ("Interval", TimeValue (interPacketInterval));
   client2.SetAttribute ("PacketSize", UintegerValue (packetSize));
@@ -190,48 +290,279 @@ int main (int argc, char *argv[])
   apps.Start (Seconds (1.5));
   apps.Stop (Seconds (simulationTime));  
 
-  AsciiTraceHelper ascii;
-  p2p.EnableAsciiAll (ascii.CreateFileStream ("tp2-ospf.tr"));
-  p2p.EnablePcapAll ("tp2-ospf", true);
+  EchoCounter echo;
+  echo.Install ();
+
+  TrafficMeter trafficMeter;
+  if (trafficMode != "none")
+  {
+    uint16_t trafficPort = 5000;
+    TrafficHelper load (trafficMode);
+    load.SetAttribute ("DataRate", DataRateValue (DataRate (trafficRate)));
+    load.SetAttribute ("PacketSize", UintegerValue (trafficPacketSize));
+    load.SetAttribute ("TraceFile", StringValue (trafficTrace));
+    apps = load.InstallSink (NodeContainer (src, dst), trafficPort);
+    apps.Start (Seconds (1.0));
+    apps = load.InstallFlows (src, topology.GetAddress ("HostT", "net1"), dst, topology.GetAddress ("HostR", "net3"),
+                              trafficFlows, trafficPort);
+    apps.Start (Seconds (2.0));
+    apps.Stop (Seconds (simulationTime - 20.0));
+    trafficMeter.Install ();
+  }
+
+  ConvergenceMonitor convergence;
+  if (!convergenceFile.empty ())
+  {
+    convergence.Install (topology.GetNodes (), Seconds (simulationTime));
+    if (failuresFile.empty ())
+    {
+      convergence.AddEvent (Seconds (failureDown1), "RouterB-net2-down");
+      convergence.AddEvent (Seconds (failureUp1), "RouterB-net2-up");
+      convergence.AddEvent (Seconds (failureDown2), "RouterD-net5-down");
+      convergence.AddEvent (Seconds (failureUp2), "RouterD-net5-up");
+    }
+  }
+
+  RouteRecorder routeLog;
+  if (!routeLogFile.empty ())
+  {
+    routeLog.SetInterval (Seconds (routeLogInterval));
+    routeLog.Open (routeLogFile);
+    routeLog.Install (topology.GetNodes (), Seconds (simulationTime));
+  }
+
+  FlowWindowStats flowStats;
+  if (!flowStatsFile.empty ())
+  {
+    flowStats.Install (Seconds (flowWindow), Seconds (simulationTime));
+  }
+
+  ControlOverhead overhead;
+  if (!overheadFile.empty ())
+  {
+    overhead.SetInterval (Seconds (overheadInterval));
+    overhead.Install (topology.GetNodes (), topology.GetAddressPlan ());
+  }
+
+  BinaryTraceHelper binaryTrace;
+  if (traceFormat == "binary")
+  {
+    binaryTrace.Open ("tp2-ospf.btr");
+    binaryTrace.EnableAll ();
+  }
+  else if (traceFormat == "ascii")
+  {
+    AsciiTraceHelper ascii;
+    p2p.EnableAsciiAll (ascii.CreateFileStream ("tp2-ospf.tr"));
+  }
+
+  EventLogHelper eventLog;
+  if (!eventLogFile.empty ())
+  {
+    eventLog.Open (eventLogFile);
+    eventLog.EnableAll ();
+  }
+
+  FilteredPcapHelper pcapCapture;
+  if (pcapFilter != "none")
+  {
+    pcapCapture.SetFilter (pcapFilter);
+    pcapCapture.SetSnaplen (pcapSnaplen);
+    pcapCapture.SetRing (pcapMaxBytes, pcapFiles);
+    pcapCapture.Enable ("tp2-ospf", pcapNodes.empty () ? topology.GetNodes () : topology.GetNodes (pcapNodes));
+  }
 
   NS_LOG_WARN ("Configuring Animation.");
 
-  MobilityHelper mobility;
-  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
-  mobility.Install (nodes);
-  mobility.Install (routers);
-
-  AnimationInterface anim ("tp2-ospf.anim.xml");
-  anim.SetConstantPosition(src, 10.0, 10.0); //for node src
-  anim.SetConstantPosition(a, 20.0, 0.0); //for router a
-  anim.SetConstantPosition(b, 30.0, 0.0); //for router b
-  anim.SetConstantPosition(c, 20.0, 20.0); //for router c
-  anim.SetConstantPosition(d, 30.0, 20.0); //for router d
-  anim.SetConstantPosition(dst, 40.0, 10.0); //for node dst
-
-  anim.UpdateNodeDescription(0, "Host_T");
-  anim.UpdateNodeDescription(1, "Host_R");
-  anim.UpdateNodeDescription(2, "Router_A");
-  anim.UpdateNodeDescription(3, "Router_B");
-  anim.UpdateNodeDescription(4, "Router_C");
-  anim.UpdateNodeDescription(5, "Router_D");
+  AnimationOutput animation;
+  animation.SetMode (animMode);
+  animation.SetWindow (Seconds (animStart), Seconds (animStop));
+  animation.SetNodes (topology.GetNodes (animNodes));
+  animation.SetChunkPackets (animChunk);
+  animation.SetCompress (animCompress);
+
+  animation.SetConstantPosition(src, 10.0, 10.0); //for node src
+  animation.SetConstantPosition(a, 20.0, 0.0); //for router a
+  animation.SetConstantPosition(b, 30.0, 0.0); //for router b
+  animation.SetConstantPosition(c, 20.0, 20.0); //for router c
+  animation.SetConstantPosition(d, 30.0, 20.0); //for router d
+  animation.SetConstantPosition(dst, 40.0, 10.0); //for node dst
+
+  animation.UpdateNodeDescription(0, "Host_T");
+  animation.UpdateNodeDescription(1, "Host_R");
+  animation.UpdateNodeDescription(2, "Router_A");
+  animation.UpdateNodeDescription(3, "Router_B");
+  animation.UpdateNodeDescription(4, "Router_C");
+  animation.UpdateNodeDescription(5, "Router_D");
+  animation.Install ("tp2-ospf");
 
   NS_LOG_WARN ("Run Simulation.");
-  Ptr<Ipv4> ipv4B = b->GetObject<Ipv4> ();
-  // The first ifIndex is 0 for loopback, then the first p2p is numbered 1,
-  // then the next p2p is numbered 2
-  uint32_t ipv4ifIndex1 = 1;
-  Simulator::Schedule (Seconds (30.00), &Ipv4::SetDown, ipv4B, ipv4ifIndex1);
-  Simulator::Schedule (Seconds (40.00), &Ipv4::SetUp, ipv4B, ipv4ifIndex1);
-
-  Ptr<Ipv4> ipv4D = d->GetObject<Ipv4> ();
-  // The first ifIndex is 0 for loopback, then the first p2p is numbered 1,
-  // then the next p2p is numbered 2
-  Simulator::Schedule (Seconds (70.00), &Ipv4::SetDown, ipv4D, ipv4ifIndex1);
-  Simulator::Schedule (Seconds (90.00), &Ipv4::SetUp, ipv4D, ipv4ifIndex1);
-
-  Simulator::Stop (Seconds(simulationTime)); // parar a simulação após 131 segundos
+  FailureScheduler failures (topology);
+  if (!failuresFile.empty ())
+  {
+    if (spf)
+    {
+      IncrementalGlobalRouting *routing = spf.get ();
+      failures.SetInterfaceCallback ([routing] (Ptr<Node> node, uint32_t interface, bool up) {
+        if (up)
+        {
+          routing->SetUp (node, interface);
+        }
+        else
+        {
+          routing->SetDown (node, interface);
+        }
+      });
+    }
+    failures.Load (failuresFile);
+    failures.Install (Seconds (simulationTime));
+    if (!convergenceFile.empty ())
+    {
+      for (const std::pair<Time, std::string> &failure : failures.GetScheduledFailures ())
+      {
+        convergence.AddEvent (failure.first, failure.second);
+      }
+    }
+  }
+  else
+  {
+    Ptr<Ipv4> ipv4B = b->GetObject<Ipv4> ();
+    // interface de B no enlace com A (net2)
+    uint32_t ipv4ifIndexB = topology.GetInterface ("RouterB", "net2");
+    if (spf)
+    {
+      Simulator::Schedule (Seconds (failureDown1), &IncrementalGlobalRouting::SetDown, spf.get (), b, ipv4ifIndexB);
+      Simulator::Schedule (Seconds (failureUp1), &IncrementalGlobalRouting::SetUp, spf.get (), b, ipv4ifIndexB);
+    }
+    else
+    {
+      Simulator::Schedule (Seconds (failureDown1), &Ipv4::SetDown, ipv4B, ipv4ifIndexB);
+      Simulator::Schedule (Seconds (failureUp1), &Ipv4::SetUp, ipv4B, ipv4ifIndexB);
+    }
+
+    Ptr<Ipv4> ipv4D = d->GetObject<Ipv4> ();
+    // interface de D no enlace com C (net5)
+    uint32_t ipv4ifIndexD = topology.GetInterface ("RouterD", "net5");
+    if (spf)
+    {
+      Simulator::Schedule (Seconds (failureDown2), &IncrementalGlobalRouting::SetDown, spf.get (), d, ipv4ifIndexD);
+      Simulator::Schedule (Seconds (failureUp2), &IncrementalGlobalRouting::SetUp, spf.get (), d, ipv4ifIndexD);
+    }
+    else
+    {
+      Simulator::Schedule (Seconds (failureDown2), &Ipv4::SetDown, ipv4D, ipv4ifIndexD);
+      Simulator::Schedule (Seconds (failureUp2), &Ipv4::SetUp, ipv4D, ipv4ifIndexD);
+    }
+  }
+
+  WarmStart warmStart (topology);
+  if (!checkpointFile.empty ())
+  {
+    warmStart.Save (Seconds (checkpointTime), checkpointFile);
+  }
+  if (!warmStartFile.empty ())
+  {
+    warmStart.Restore (warmStartFile);
+    warmStart.Report (std::cout);
+  }
+
+  Simulator::Stop (Seconds(simulationTime)); // parar a simulação após simulationTime segundos
+  EventProfiler profiler;
+  if (!profileFile.empty ())
+  {
+    profiler.Enable ();
+  }
+  WallClock runClock;
   Simulator::Run ();
+  profiler.Stop ();
+  double wallSeconds = runClock.GetSeconds ();
+  binaryTrace.Close ();
+  eventLog.Close ();
+  animation.Close ();
+  routeLog.Close ();
+  if (trafficMode != "none")
+  {
+    trafficMeter.Report (std::cout, wallSeconds);
+  }
+  if (ecmp)
+  {
+    FlowHashEcmpRouting::Report (std::cout, topology.GetNodes ());
+  }
+  if (ospf)
+  {
+    OspfRouting::Report (std::cout, topology.GetRouters ());
+  }
+  if (routeCache)
+  {
+    RouteCache::Report (std::cout, topology.GetRouters ());
+  }
+  if (!convergenceFile.empty ())
+  {
+    convergence.WriteCsv (convergenceFile);
+  }
+  if (!flowStatsFile.empty ())
+  {
+    flowStats.Write (flowStatsFile);
+  }
+  if (!overheadFile.empty ())
+  {
+    overhead.Report (std::cout);
+    overhead.WriteCsv (overheadFile);
+  }
+  if (!profileFile.empty ())
+  {
+    profiler.Report (std::cout);
+    profiler.WriteCsv (profileFile);
+  }
+  if (spf && topologyReport)
+  {
+    spf->PrintStats (std::cout);
+  }
+
+  if (!resultsFile.empty ())
+  {
+    RunResults results;
+    results.Set ("scenario", "tp2-ospf");
+    results.Set ("dataRate", dataRate);
+    results.Set ("delay", delay);
+    results.Set ("linkMetrics", linkMetrics);
+    results.Set ("hostProfile", hostProfile);
+    results.Set ("failureDown1", failureDown1);
+    results.Set ("failureUp1", failureUp1);
+    results.Set ("failureDown2", failureDown2);
+    results.Set ("failureUp2", failureUp2);
+    results.Set ("incrementalSpf", incrementalSpf);
+    results.Set ("ecmp", ecmp);
+    results.Set ("failures", failuresFile);
+    results.Set ("simulationTime", simulationTime);
+    results.Set ("sent", echo.GetSent ());
+    results.Set ("delivered", echo.GetDelivered ());
+    results.Set ("echoed", echo.GetEchoed ());
+    results.Set ("deliveryRatio", echo.GetDeliveryRatio ());
+    results.Set ("traffic", trafficMode);
+    results.Set ("trafficSent", trafficMeter.GetSent ());
+    results.Set ("trafficReceived", trafficMeter.GetReceived ());
+    results.Set ("throughputMbps", trafficMeter.GetThroughput () / 1e6);
+    results.Set ("linkTransmissions", trafficMeter.GetTransmissions ());
+    results.Set ("wallSeconds", wallSeconds);
+    results.Set ("packetsPerWallSecond", trafficMeter.GetTransmissions () / wallSeconds);
+    results.Set ("ospf", ospf);
+    OspfRouting::Stats ospfStats = OspfRouting::GetTotalStats (topology.GetRouters ());
+    results.Set ("ospfControlBytes", ospfStats.bytesSent);
+    results.Set ("spfRuns", ospfStats.spfRuns);
+    results.Set ("controlPackets", overhead.GetControlPackets ());
+    results.Set ("controlBytes", overhead.GetControlBytes ());
+    results.Set ("warmStart", warmStartFile);
+    results.Set ("convergenceSeconds", convergence.GetTotalConvergence ());
+    results.Set ("convergenceLost", convergence.GetTotalLost ());
+    results.Set ("routeCache", routeCache);
+    results.Set ("routeCacheHitRate", routeCache ? RouteCache::GetHitRate (RouteCache::GetTotalStats (topology.GetRouters ())) : 0.0);
+    std::string error;
+    if (!results.Write (resultsFile, &error))
+    {
+      NS_FATAL_ERROR (error);
+    }
+  }
   Simulator::Destroy ();
   NS_LOG_WARN ("Done.");
 }
\ No newline at end of file
@@ -0,0 +1,356 @@
+// Plano de endereços dos enlaces, independente do ns-3: cada enlace recebe
+// uma sub-rede de um pool (padrão 10.0.0.0/8), /30 (ou /31) entre roteadores
+// e /30 (ou o prefixo de host escolhido) nos enlaces com um host, no lugar de
+// uma /24 por enlace escrita à mão com Ipv4AddressHelper::SetBase.
+//
+// A alocação conta os enlaces de cada tamanho e dá a cada tamanho uma faixa
+// contígua do pool, dos blocos maiores para os menores (assim todo bloco fica
+// alinhado). O enlace k de um tamanho fica com o bloco k da faixa: O(1) por
+// enlace, sem busca de colisão. O caminho inverso (endereço -> enlace) é uma
+// tabela indexada pelo deslocamento do endereço no plano, em unidades do
+// menor bloco: um acesso por consulta.
+//
+// O índice enlace -> sub-rede (e os dispositivos de cada ponta, preenchidos
+// pelo TopologyLoader) é gravado em texto para as ferramentas de trace:
+//
+//   # link name network/prefix nodeA deviceA nodeB deviceB
+//   0 net1 10.0.0.0/30 0 0 2 0
+//
+// O primeiro endereço utilizável fica com a ponta a do enlace e o segundo com
+// a ponta b (numa /31, os dois endereços da sub-rede).
+
+#ifndef ADDRESS_PLAN_H
+#define ADDRESS_PLAN_H
+
+#include "topology-spec.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+class AddressPlan
+{
+public:
+  struct Link
+  {
+    uint32_t network;
+    uint32_t prefixLength;
+    std::string name;
+    uint32_t nodes[2];   // Node::GetId das pontas (UINT32_MAX se desconhecido)
+    uint32_t devices[2]; // NetDevice::GetIfIndex das pontas
+  };
+
+  AddressPlan ()
+    : m_pool (10u << 24),
+      m_poolLength (8),
+      m_routerPrefix (30),
+      m_hostPrefix (30),
+      m_base (0),
+      m_shift (0)
+  {
+  }
+
+  // pool das sub-redes, como "10.0.0.0/8"
+  bool SetPool (const std::string &prefix, std::string *error)
+  {
+    uint32_t network;
+    uint32_t length;
+    if (!ParsePrefix (prefix, &network, &length) || (length < 32 && (network << length) != 0))
+    {
+      *error = "pool invalido '" + prefix + "'";
+      return false;
+    }
+    m_pool = network;
+    m_poolLength = length;
+    return true;
+  }
+
+  // prefixo dos enlaces entre roteadores (30 ou 31) e dos enlaces com host
+  // (16 a 30)
+  bool SetPrefixes (uint32_t router, uint32_t host, std::string *error)
+  {
+    if (router != 30 && router != 31)
+    {
+      *error = "prefixo dos enlaces entre roteadores deve ser 30 ou 31";
+      return false;
+    }
+    if (host < 16 || host > 30)
+    {
+      *error = "prefixo dos enlaces com host deve estar entre 16 e 30";
+      return false;
+    }
+    m_routerPrefix = router;
+    m_hostPrefix = host;
+    return true;
+  }
+
+  bool Allocate (const TopologySpec &spec, std::string *error)
+  {
+    m_links.assign (spec.links.size (), Link {0, 0, "", {UINT32_MAX, UINT32_MAX}, {0, 0}});
+    std::map<uint32_t, uint32_t> counts; // prefixo -> enlaces
+    for (uint32_t i = 0; i < spec.links.size (); ++i)
+    {
+      const TopologyLinkSpec &link = spec.links[i];
+      bool host = spec.nodes[link.a].host || spec.nodes[link.b].host;
+      m_links[i].prefixLength = host ? m_hostPrefix : m_routerPrefix;
+      m_links[i].name = link.name.empty () ? std::to_string (i) : link.name;
+      ++counts[m_links[i].prefixLength];
+    }
+    // faixas em ordem crescente de prefixo: blocos maiores primeiro
+    uint64_t poolSize = uint64_t (1) << (32 - m_poolLength);
+    uint64_t cursor = 0;
+    std::map<uint32_t, uint64_t> next; // prefixo -> próximo bloco da faixa
+    for (const std::pair<const uint32_t, uint32_t> &count : counts)
+    {
+      next[count.first] = cursor;
+      cursor += uint64_t (count.second) << (32 - count.first);
+    }
+    if (cursor > poolSize)
+    {
+      *error = "o pool " + FormatPrefix (m_pool, m_poolLength) + " nao comporta " + std::to_string (m_links.size ())
+               + " enlaces (" + std::to_string (cursor) + " enderecos)";
+      return false;
+    }
+    for (uint32_t i = 0; i < m_links.size (); ++i)
+    {
+      uint64_t &block = next[m_links[i].prefixLength];
+      m_links[i].network = m_pool + uint32_t (block);
+      block += uint64_t (1) << (32 - m_links[i].prefixLength);
+    }
+    BuildIndex ();
+    return true;
+  }
+
+  uint32_t GetNLinks () const
+  {
+    return m_links.size ();
+  }
+
+  const Link &GetLink (uint32_t link) const
+  {
+    return m_links[link];
+  }
+
+  uint32_t GetMask (uint32_t link) const
+  {
+    return 0xffffffffu << (32 - m_links[link].prefixLength);
+  }
+
+  // endereço da ponta 'side' (0 = link.a, 1 = link.b)
+  uint32_t GetAddress (uint32_t link, uint32_t side) const
+  {
+    return m_links[link].network + side + (m_links[link].prefixLength == 31 ? 0 : 1);
+  }
+
+  void SetDevices (uint32_t link, uint32_t nodeA, uint32_t deviceA, uint32_t nodeB, uint32_t deviceB)
+  {
+    Link &entry = m_links[link];
+    entry.nodes[0] = nodeA;
+    entry.devices[0] = deviceA;
+    entry.nodes[1] = nodeB;
+    entry.devices[1] = deviceB;
+    m_devices[std::make_pair (nodeA, deviceA)] = link;
+    m_devices[std::make_pair (nodeB, deviceB)] = link;
+  }
+
+  // enlace cuja sub-rede contém 'address', ou -1
+  int64_t FindLink (uint32_t address) const
+  {
+    if (address < m_base)
+    {
+      return -1;
+    }
+    uint64_t slot = uint64_t (address - m_base) >> m_shift;
+    if (!m_slots.empty ())
+    {
+      return slot < m_slots.size () && m_slots[slot] != UINT32_MAX ? int64_t (m_slots[slot]) : -1;
+    }
+    // plano esparso lido de arquivo: busca binária pela sub-rede
+    std::vector<uint32_t>::const_iterator it =
+      std::upper_bound (m_sorted.begin (), m_sorted.end (), address,
+                        [this] (uint32_t a, uint32_t link) { return a < m_links[link].network; });
+    if (it == m_sorted.begin ())
+    {
+      return -1;
+    }
+    const Link &link = m_links[*(it - 1)];
+    return (address - link.network) >> (32 - link.prefixLength) == 0 ? int64_t (*(it - 1)) : -1;
+  }
+
+  // enlace do dispositivo (Node::GetId, NetDevice::GetIfIndex), ou -1
+  int64_t FindDevice (uint32_t node, uint32_t device) const
+  {
+    std::map<std::pair<uint32_t, uint32_t>, uint32_t>::const_iterator it =
+      m_devices.find (std::make_pair (node, device));
+    return it == m_devices.end () ? -1 : (int64_t) it->second;
+  }
+
+  bool WriteFile (const std::string &path, std::string *error) const
+  {
+    std::ofstream os (path);
+    if (!os)
+    {
+      *error = "nao foi possivel criar " + path;
+      return false;
+    }
+    os << "# link name network/prefix nodeA deviceA nodeB deviceB\n";
+    for (uint32_t i = 0; i < m_links.size (); ++i)
+    {
+      const Link &link = m_links[i];
+      os << i << " " << link.name << " " << FormatPrefix (link.network, link.prefixLength);
+      for (uint32_t side = 0; side < 2; ++side)
+      {
+        os << " " << (link.nodes[side] == UINT32_MAX ? int64_t (-1) : int64_t (link.nodes[side])) << " "
+           << link.devices[side];
+      }
+      os << "\n";
+    }
+    return bool (os);
+  }
+
+  bool ReadFile (const std::string &path, std::string *error)
+  {
+    std::ifstream is (path);
+    if (!is)
+    {
+      *error = "nao foi possivel abrir " + path;
+      return false;
+    }
+    m_links.clear ();
+    std::string line;
+    uint32_t lineNo = 0;
+    while (std::getline (is, line))
+    {
+      ++lineNo;
+      std::istringstream fields (line.substr (0, line.find ('#')));
+      uint32_t index;
+      std::string prefix;
+      int64_t nodes[2];
+      Link link {0, 0, "", {UINT32_MAX, UINT32_MAX}, {0, 0}};
+      if (!(fields >> index))
+      {
+        continue;
+      }
+      if (!(fields >> link.name >> prefix >> nodes[0] >> link.devices[0] >> nodes[1] >> link.devices[1])
+          || index != m_links.size () || !ParsePrefix (prefix, &link.network, &link.prefixLength))
+      {
+        *error = path + ": linha " + std::to_string (lineNo) + " invalida";
+        return false;
+      }
+      link.nodes[0] = nodes[0] < 0 ? UINT32_MAX : uint32_t (nodes[0]);
+      link.nodes[1] = nodes[1] < 0 ? UINT32_MAX : uint32_t (nodes[1]);
+      m_links.push_back (link);
+    }
+    BuildIndex ();
+    return true;
+  }
+
+  static std::string FormatAddress (uint32_t address)
+  {
+    char text[16];
+    std::snprintf (text, sizeof (text), "%u.%u.%u.%u", address >> 24, (address >> 16) & 0xff, (address >> 8) & 0xff,
+                   address & 0xff);
+    return text;
+  }
+
+  static std::string FormatPrefix (uint32_t network, uint32_t length)
+  {
+    return FormatAddress (network) + "/" + std::to_string (length);
+  }
+
+  // "a.b.c.d/n" ou "a.b.c.d" (/32)
+  static bool ParsePrefix (const std::string &text, uint32_t *network, uint32_t *length)
+  {
+    unsigned a, b, c, d;
+    unsigned n = 32;
+    char end;
+    int fields = std::sscanf (text.c_str (), "%u.%u.%u.%u/%u%c", &a, &b, &c, &d, &n, &end);
+    if ((fields != 4 && fields != 5) || a > 255 || b > 255 || c > 255 || d > 255 || n > 32
+        || (fields == 4 && text.find ('/') != std::string::npos))
+    {
+      return false;
+    }
+    *network = (a << 24) | (b << 16) | (c << 8) | d;
+    *length = n;
+    return true;
+  }
+
+private:
+  // caminho inverso: uma posição por bloco do menor prefixo entre o menor e
+  // o maior endereço do plano. Um plano lido de arquivo pode ser esparso (um
+  // bloco longe dos outros); se a tabela passar de quatro posições por enlace,
+  // fica a busca binária sobre os enlaces ordenados por sub-rede
+  void BuildIndex ()
+  {
+    m_base = 0;
+    m_shift = 0;
+    m_slots.clear ();
+    m_sorted.clear ();
+    m_devices.clear ();
+    if (m_links.empty ())
+    {
+      return;
+    }
+    uint32_t first = UINT32_MAX;
+    uint64_t last = 0;
+    uint32_t shift = 32;
+    for (uint32_t i = 0; i < m_links.size (); ++i)
+    {
+      const Link &link = m_links[i];
+      first = std::min (first, link.network);
+      last = std::max (last, uint64_t (link.network) + (uint64_t (1) << (32 - link.prefixLength)));
+      shift = std::min (shift, 32 - link.prefixLength);
+      for (uint32_t side = 0; side < 2; ++side)
+      {
+        if (link.nodes[side] != UINT32_MAX)
+        {
+          m_devices[std::make_pair (link.nodes[side], link.devices[side])] = i;
+        }
+      }
+    }
+    m_base = first;
+    m_shift = shift;
+    uint64_t slots = (last - first) >> shift;
+    if (slots <= 4 * uint64_t (m_links.size ()))
+    {
+      m_slots.assign (slots, UINT32_MAX);
+      for (uint32_t i = 0; i < m_links.size (); ++i)
+      {
+        uint64_t slot = uint64_t (m_links[i].network - m_base) >> m_shift;
+        uint64_t count = uint64_t (1) << (32 - m_links[i].prefixLength - m_shift);
+        std::fill (m_slots.begin () + slot, m_slots.begin () + slot + count, i);
+      }
+      return;
+    }
+    m_sorted.resize (m_links.size ());
+    for (uint32_t i = 0; i < m_sorted.size (); ++i)
+    {
+      m_sorted[i] = i;
+    }
+    std::sort (m_sorted.begin (), m_sorted.end (),
+               [this] (uint32_t x, uint32_t y) { return m_links[x].network < m_links[y].network; });
+  }
+
+  uint32_t m_pool;
+  uint32_t m_poolLength;
+  uint32_t m_routerPrefix;
+  uint32_t m_hostPrefix;
+  std::vector<Link> m_links;
+  uint32_t m_base;                // menor endereço do plano
+  uint32_t m_shift;               // bits do menor bloco
+  std::vector<uint32_t> m_slots;  // bloco -> enlace (UINT32_MAX = livre)
+  std::vector<uint32_t> m_sorted; // enlaces por sub-rede, se m_slots vazio
+  std::map<std::pair<uint32_t, uint32_t>, uint32_t> m_devices;
+};
+
+} // namespace ns3
+
+#endif /* ADDRESS_PLAN_H */
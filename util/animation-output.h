@@ -0,0 +1,441 @@
+// Saída de animação dos cenários, com três modos:
+//
+//   full     AnimationInterface do NetAnim, como antes (<prefixo>.anim.xml),
+//            limitado à janela de tempo e dividido a cada 'chunk' pacotes
+//   sampled  gravador próprio, só com os pacotes da janela de tempo que saem
+//            de ou chegam a um dos nós escolhidos, em arquivos de 'chunk'
+//            pacotes, opcionalmente comprimidos
+//   none     nada: nem o AnimationInterface nem os modelos de mobilidade
+//
+// No modo sampled cada arquivo (<prefixo>.anim-0.xml, <prefixo>.anim-1.xml,
+// ...) é um XML do NetAnim completo, com nós, descrições e enlaces, e só os
+// elementos <p> dos pacotes. Comprimido, o arquivo ganha a extensão .lz:
+// ANIM_CHUNK_MAGIC seguida de blocos
+//
+//   <tamanho original: varint> <tamanho comprimido: varint> <bloco>
+//
+// comprimidos pelo BlockCompress (block-codec.h); tools/anim_unpack.cc
+// devolve o XML.
+
+#ifndef ANIMATION_OUTPUT_H
+#define ANIMATION_OUTPUT_H
+
+#include "block-codec.h"
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/csma-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/netanim-module.h"
+#include "ns3/mobility-helper.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+const char ANIM_CHUNK_MAGIC[8] = {'N', 'S', '3', 'A', 'N', 'Z', '1', '\n'};
+
+namespace anim {
+
+NS_LOG_COMPONENT_DEFINE ("AnimationOutput");
+
+class AnimationOutput
+{
+public:
+  enum Mode
+  {
+    FULL,
+    SAMPLED,
+    NONE
+  };
+
+  AnimationOutput ()
+    : m_mode (FULL),
+      m_start (Seconds (0)),
+      m_stop (Seconds (0)),
+      m_chunkPackets (0),
+      m_compress (false),
+      m_chunk (0),
+      m_chunkCount (0),
+      m_packets (0)
+  {
+  }
+
+  ~AnimationOutput ()
+  {
+    Close ();
+  }
+
+  void SetMode (const std::string &mode)
+  {
+    if (mode == "full")
+    {
+      m_mode = FULL;
+    }
+    else if (mode == "sampled")
+    {
+      m_mode = SAMPLED;
+    }
+    else if (mode == "none")
+    {
+      m_mode = NONE;
+    }
+    else
+    {
+      NS_FATAL_ERROR ("Unknown animation mode " << mode << " (full, sampled or none)");
+    }
+  }
+
+  bool IsEnabled () const
+  {
+    return m_mode != NONE;
+  }
+
+  // pacotes que começam a ser transmitidos em [start, stop); stop <= start: até o fim
+  void SetWindow (Time start, Time stop)
+  {
+    m_start = start;
+    m_stop = stop;
+  }
+
+  // só no modo sampled; vazio: todos os nós
+  void SetNodes (NodeContainer nodes)
+  {
+    m_nodes.clear ();
+    for (NodeContainer::Iterator node = nodes.Begin (); node != nodes.End (); ++node)
+    {
+      m_nodes.insert ((*node)->GetId ());
+    }
+  }
+
+  // pacotes por arquivo, 0 para um arquivo só
+  void SetChunkPackets (uint32_t packets)
+  {
+    m_chunkPackets = packets;
+  }
+
+  // só no modo sampled
+  void SetCompress (bool compress)
+  {
+    m_compress = compress;
+  }
+
+  void SetConstantPosition (Ptr<Node> node, double x, double y)
+  {
+    m_positions[node->GetId ()] = std::make_pair (x, y);
+  }
+
+  void UpdateNodeDescription (uint32_t node, const std::string &description)
+  {
+    m_descriptions[node] = description;
+  }
+
+  // depois de criados os nós e dispositivos, antes do Simulator::Run
+  void Install (const std::string &prefix)
+  {
+    if (m_mode == FULL)
+    {
+      InstallFull (prefix);
+    }
+    else if (m_mode == SAMPLED)
+    {
+      InstallSampled (prefix);
+    }
+  }
+
+  // fecha o arquivo corrente do modo sampled
+  void Close ()
+  {
+    if (m_out.is_open ())
+    {
+      CloseChunk ();
+      NS_LOG_INFO ("Wrote " << m_packets << " animation packets in " << m_chunkCount << " files");
+    }
+  }
+
+  uint64_t GetPackets () const
+  {
+    return m_packets;
+  }
+
+private:
+  struct Transmission
+  {
+    uint32_t node;
+    double firstBit;
+    double lastBit;
+  };
+
+  class DeviceSink
+  {
+  public:
+    DeviceSink (AnimationOutput *output, uint32_t node)
+      : m_output (output),
+        m_node (node)
+    {
+    }
+
+    void TxBegin (Ptr<const Packet> packet)
+    {
+      m_output->TxBegin (m_node, packet->GetUid ());
+    }
+
+    void TxEnd (Ptr<const Packet> packet)
+    {
+      m_output->TxEnd (packet->GetUid ());
+    }
+
+    void RxEnd (Ptr<const Packet> packet)
+    {
+      m_output->RxEnd (m_node, packet->GetUid ());
+    }
+
+  private:
+    AnimationOutput *m_output;
+    uint32_t m_node;
+  };
+
+  void InstallFull (const std::string &prefix)
+  {
+    MobilityHelper mobility;
+    mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+    mobility.Install (NodeContainer::GetGlobal ());
+
+    m_interface.reset (new AnimationInterface (prefix + ".anim.xml"));
+    m_interface->SetStartTime (m_start);
+    if (m_stop > m_start)
+    {
+      m_interface->SetStopTime (m_stop);
+    }
+    if (m_chunkPackets)
+    {
+      m_interface->SetMaxPktsPerTraceFile (m_chunkPackets);
+    }
+    for (const auto &position : m_positions)
+    {
+      m_interface->SetConstantPosition (NodeList::GetNode (position.first), position.second.first,
+                                        position.second.second);
+    }
+    for (const auto &description : m_descriptions)
+    {
+      m_interface->UpdateNodeDescription (description.first, description.second);
+    }
+    if (!m_nodes.empty () || m_compress)
+    {
+      NS_LOG_WARN ("Node subset and compression only apply to the sampled animation mode");
+    }
+  }
+
+  void InstallSampled (const std::string &prefix)
+  {
+    m_prefix = prefix + ".anim";
+    std::set<std::pair<uint32_t, uint32_t> > links;
+    for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); ++node)
+    {
+      for (uint32_t i = 0; i < (*node)->GetNDevices (); ++i)
+      {
+        Ptr<NetDevice> device = (*node)->GetDevice (i);
+        if (!DynamicCast<CsmaNetDevice> (device) && !DynamicCast<PointToPointNetDevice> (device))
+        {
+          continue;
+        }
+        m_sinks.emplace_back (new DeviceSink (this, (*node)->GetId ()));
+        DeviceSink *sink = m_sinks.back ().get ();
+        device->TraceConnectWithoutContext ("PhyTxBegin", MakeCallback (&DeviceSink::TxBegin, sink));
+        device->TraceConnectWithoutContext ("PhyTxEnd", MakeCallback (&DeviceSink::TxEnd, sink));
+        device->TraceConnectWithoutContext ("PhyRxEnd", MakeCallback (&DeviceSink::RxEnd, sink));
+
+        Ptr<Channel> channel = device->GetChannel ();
+        for (std::size_t j = 0; channel && j < channel->GetNDevices (); ++j)
+        {
+          uint32_t peer = channel->GetDevice (j)->GetNode ()->GetId ();
+          if (peer > (*node)->GetId ())
+          {
+            links.insert (std::make_pair ((*node)->GetId (), peer));
+          }
+        }
+      }
+    }
+    m_links.assign (links.begin (), links.end ());
+    OpenChunk ();
+  }
+
+  bool Selected (uint32_t node) const
+  {
+    return m_nodes.empty () || m_nodes.count (node);
+  }
+
+  void TxBegin (uint32_t node, uint64_t uid)
+  {
+    Time now = Simulator::Now ();
+    if (now < m_start || (m_stop > m_start && now >= m_stop))
+    {
+      return;
+    }
+    // o UID se mantém de salto em salto; a transmissão seguinte substitui a anterior
+    m_pending[uid] = Transmission {node, now.GetSeconds (), now.GetSeconds ()};
+    if (m_pending.size () > 4096)
+    {
+      Prune (now.GetSeconds () - 1.0);
+    }
+  }
+
+  void TxEnd (uint64_t uid)
+  {
+    std::unordered_map<uint64_t, Transmission>::iterator it = m_pending.find (uid);
+    if (it != m_pending.end ())
+    {
+      it->second.lastBit = Simulator::Now ().GetSeconds ();
+    }
+  }
+
+  void RxEnd (uint32_t node, uint64_t uid)
+  {
+    std::unordered_map<uint64_t, Transmission>::iterator it = m_pending.find (uid);
+    if (it == m_pending.end () || it->second.node == node)
+    {
+      return;
+    }
+    const Transmission &tx = it->second;
+    if (!Selected (tx.node) && !Selected (node))
+    {
+      return;
+    }
+    double lastBit = Simulator::Now ().GetSeconds ();
+    char line[256];
+    std::snprintf (line, sizeof (line), "<p fId=\"%u\" fbTx=\"%.9f\" lbTx=\"%.9f\" tId=\"%u\" fbRx=\"%.9f\" lbRx=\"%.9f\" />\n",
+                   tx.node, tx.firstBit, tx.lastBit, node, lastBit - (tx.lastBit - tx.firstBit), lastBit);
+    m_buffer += line;
+    ++m_packets;
+    if (m_buffer.size () >= 64 * 1024)
+    {
+      FlushBuffer ();
+    }
+    if (m_chunkPackets && ++m_chunk >= m_chunkPackets)
+    {
+      CloseChunk ();
+      OpenChunk ();
+    }
+  }
+
+  // transmissões sem recepção (descartadas ou de enlaces derrubados)
+  void Prune (double before)
+  {
+    for (std::unordered_map<uint64_t, Transmission>::iterator it = m_pending.begin (); it != m_pending.end ();)
+    {
+      it = it->second.lastBit < before ? m_pending.erase (it) : std::next (it);
+    }
+  }
+
+  void OpenChunk ()
+  {
+    std::string path = m_prefix;
+    if (m_chunkPackets)
+    {
+      path += "-" + std::to_string (m_chunkCount);
+    }
+    path += m_compress ? ".xml.lz" : ".xml";
+    m_out.open (path, std::ios::binary | std::ios::trunc);
+    NS_ABORT_MSG_IF (!m_out, "Cannot write " << path);
+    if (m_compress)
+    {
+      m_out.write (ANIM_CHUNK_MAGIC, sizeof (ANIM_CHUNK_MAGIC));
+    }
+    ++m_chunkCount;
+    m_chunk = 0;
+
+    char line[160];
+    m_buffer += "<anim ver=\"netanim-3.108\" filetype=\"animation\" >\n";
+    for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); ++node)
+    {
+      std::pair<double, double> position (0.0, 0.0);
+      std::map<uint32_t, std::pair<double, double> >::const_iterator it = m_positions.find ((*node)->GetId ());
+      if (it != m_positions.end ())
+      {
+        position = it->second;
+      }
+      std::snprintf (line, sizeof (line), "<node id=\"%u\" sysId=\"0\" locX=\"%g\" locY=\"%g\" />\n",
+                     (*node)->GetId (), position.first, position.second);
+      m_buffer += line;
+    }
+    for (const auto &description : m_descriptions)
+    {
+      m_buffer += "<nu p=\"d\" t=\"0\" id=\"" + std::to_string (description.first) + "\" descr=\""
+                  + description.second + "\" />\n";
+    }
+    for (const std::pair<uint32_t, uint32_t> &link : m_links)
+    {
+      std::snprintf (line, sizeof (line), "<link fromId=\"%u\" toId=\"%u\" fd=\"\" td=\"\" ld=\"\" />\n", link.first,
+                     link.second);
+      m_buffer += line;
+    }
+  }
+
+  void CloseChunk ()
+  {
+    m_buffer += "</anim>\n";
+    FlushBuffer ();
+    m_out.close ();
+  }
+
+  void FlushBuffer ()
+  {
+    if (m_buffer.empty ())
+    {
+      return;
+    }
+    if (m_compress)
+    {
+      std::vector<uint8_t> block;
+      PutVarint (block, m_buffer.size ());
+      std::vector<uint8_t> compressed;
+      BlockCompress (reinterpret_cast<const uint8_t *> (m_buffer.data ()), m_buffer.size (), compressed);
+      PutVarint (block, compressed.size ());
+      block.insert (block.end (), compressed.begin (), compressed.end ());
+      m_out.write (reinterpret_cast<const char *> (block.data ()), block.size ());
+    }
+    else
+    {
+      m_out.write (m_buffer.data (), m_buffer.size ());
+    }
+    m_buffer.clear ();
+  }
+
+  Mode m_mode;
+  Time m_start;
+  Time m_stop;
+  uint32_t m_chunkPackets;
+  bool m_compress;
+  std::set<uint32_t> m_nodes;
+  std::map<uint32_t, std::pair<double, double> > m_positions;
+  std::map<uint32_t, std::string> m_descriptions;
+
+  std::unique_ptr<AnimationInterface> m_interface;
+
+  std::string m_prefix;
+  std::vector<std::pair<uint32_t, uint32_t> > m_links;
+  std::vector<std::unique_ptr<DeviceSink> > m_sinks;
+  std::unordered_map<uint64_t, Transmission> m_pending;
+  std::ofstream m_out;
+  std::string m_buffer;
+  uint32_t m_chunk;
+  uint32_t m_chunkCount;
+  uint64_t m_packets;
+};
+
+} // namespace anim
+
+using anim::AnimationOutput;
+
+} // namespace ns3
+
+#endif /* ANIMATION_OUTPUT_H */
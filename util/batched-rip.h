@@ -0,0 +1,1038 @@
+// RIPv2 com controle dos updates disparados, para medir o custo do plano de
+// controle sob falhas em sequência. O ns3::Rip manda um update disparado a
+// cada mudança (depois de 1 a 5 s) e não tem como ser estendido: os métodos
+// de envio e de tratamento das respostas são privados. A BatchedRip refaz o
+// protocolo com o mesmo formato de mensagem (RipHeader/RipRte, UDP 520 para
+// 224.0.0.9), os mesmos temporizadores e o mesmo split horizon, e acrescenta
+// três mecanismos, todos desligados por padrão (com os atributos padrão ela
+// se comporta como o Rip, o que dá a linha de base das comparações):
+//
+//  - CoalesceWindow: intervalo mínimo entre dois updates disparados; as
+//    mudanças que chegam nesse meio tempo vão juntas no próximo;
+//  - Damping: penalidade por rota a cada retirada (métrica 16), com
+//    decaimento exponencial de meia-vida DampingHalfLife, como o route flap
+//    damping do BGP (RFC 2439). Acima de DampingSuppressLimit a rota fica
+//    suprimida: não é usada no encaminhamento e é anunciada com métrica 16
+//    até a penalidade cair abaixo de DampingReuseLimit;
+//  - MaxEntriesPerMessage: entradas por mensagem (25 no RFC 2453); 0 enche a
+//    mensagem até o MTU da interface, como o Rip.
+//
+// As requisições só são respondidas quando pedem a tabela inteira (uma
+// entrada com métrica 16 e prefixo 0), que é o que o Rip manda na partida.
+// A busca de rota do RouteOutput/RouteInput vai por uma PrefixTrie
+// (prefix-trie.h) mantida junto com a tabela, não por uma varredura dela; a
+// cada mudança na tabela a geração (route-generation.h) avança.
+// Os contadores de GetStats (updates periódicos e disparados, mensagens,
+// entradas e bytes enviados, mudanças agrupadas, supressões) são somados por
+// Report para um conjunto de nós.
+//
+//   BatchedRipHelper rip;
+//   rip.ExcludeInterface (router, 2);
+//   rip.Set ("CoalesceWindow", TimeValue (Seconds (5)));
+//   rip.Set ("Damping", BooleanValue (true));
+//   InternetStackHelper internet;
+//   internet.SetRoutingHelper (rip);
+//   ...
+//   BatchedRip::Report (std::cout, routers);
+
+#ifndef BATCHED_RIP_H
+#define BATCHED_RIP_H
+
+#include "prefix-trie.h"
+#include "route-generation.h"
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <ostream>
+#include <set>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+namespace rip {
+
+NS_LOG_COMPONENT_DEFINE ("BatchedRip");
+
+class BatchedRip : public Ipv4RoutingProtocol, public RouteGeneration
+{
+public:
+  static constexpr uint16_t RIP_PORT = 520;
+  static constexpr uint32_t INFINITY_METRIC = 16;
+
+  // mesmos valores do Rip e do RipNg
+  enum SplitHorizonType
+  {
+    NO_SPLIT_HORIZON,
+    SPLIT_HORIZON,
+    POISON_REVERSE
+  };
+
+  struct Stats
+  {
+    uint64_t regularUpdates;   // rodadas periódicas (todas as interfaces)
+    uint64_t triggeredUpdates; // rodadas disparadas
+    uint64_t messagesSent;     // respostas, periódicas, disparadas ou a requisições
+    uint64_t entriesSent;
+    uint64_t bytesSent; // com os cabeçalhos UDP e IP
+    uint64_t messagesReceived;
+    uint64_t bytesReceived;
+    uint64_t routeChanges;     // eventos (respostas, timeouts, interfaces) que mudaram rotas
+    uint64_t coalescedChanges; // dos quais já havia um update disparado agendado
+    uint64_t suppressions;     // rotas suprimidas pelo damping
+  };
+
+  // rede, máscara, gateway (0 nas conectadas), interface e métrica novos
+  typedef void (*RouteChangeTracedCallback) (Ipv4Address network, Ipv4Mask mask, Ipv4Address gateway,
+                                             uint32_t interface, uint32_t metric);
+
+  static TypeId GetTypeId ()
+  {
+    static TypeId tid =
+      TypeId ("ns3::BatchedRip")
+        .SetParent<Ipv4RoutingProtocol> ()
+        .AddConstructor<BatchedRip> ()
+        .AddAttribute ("UnsolicitedRoutingUpdate", "Interval between periodic updates", TimeValue (Seconds (30)),
+                       MakeTimeAccessor (&BatchedRip::m_unsolicitedUpdate), MakeTimeChecker ())
+        .AddAttribute ("StartupDelay", "Maximum random delay of the first periodic update", TimeValue (Seconds (1)),
+                       MakeTimeAccessor (&BatchedRip::m_startupDelay), MakeTimeChecker ())
+        .AddAttribute ("TimeoutDelay", "Time without updates after which a route is invalid",
+                       TimeValue (Seconds (180)), MakeTimeAccessor (&BatchedRip::m_timeoutDelay), MakeTimeChecker ())
+        .AddAttribute ("GarbageCollectionDelay", "Time an invalid route is kept (and advertised) before removal",
+                       TimeValue (Seconds (120)), MakeTimeAccessor (&BatchedRip::m_garbageCollectionDelay),
+                       MakeTimeChecker ())
+        .AddAttribute ("MinTriggeredUpdateDelay", "Minimum random delay of a triggered update",
+                       TimeValue (Seconds (1)), MakeTimeAccessor (&BatchedRip::m_minTriggeredDelay),
+                       MakeTimeChecker ())
+        .AddAttribute ("MaxTriggeredUpdateDelay", "Maximum random delay of a triggered update",
+                       TimeValue (Seconds (5)), MakeTimeAccessor (&BatchedRip::m_maxTriggeredDelay),
+                       MakeTimeChecker ())
+        .AddAttribute ("SplitHorizon", "Split horizon strategy", EnumValue (BatchedRip::POISON_REVERSE),
+                       MakeEnumAccessor (&BatchedRip::m_splitHorizon),
+                       MakeEnumChecker (BatchedRip::NO_SPLIT_HORIZON, "NoSplitHorizon", BatchedRip::SPLIT_HORIZON,
+                                        "SplitHorizon", BatchedRip::POISON_REVERSE, "PoisonReverse"))
+        .AddAttribute ("CoalesceWindow", "Minimum interval between triggered updates, 0 for the Rip behavior",
+                       TimeValue (Seconds (0)), MakeTimeAccessor (&BatchedRip::m_coalesceWindow),
+                       MakeTimeChecker ())
+        .AddAttribute ("MaxEntriesPerMessage", "Route entries per message, 0 to fill the interface MTU",
+                       UintegerValue (0), MakeUintegerAccessor (&BatchedRip::m_maxEntries),
+                       MakeUintegerChecker<uint32_t> ())
+        .AddAttribute ("Damping", "Suppress routes that flap", BooleanValue (false),
+                       MakeBooleanAccessor (&BatchedRip::m_damping), MakeBooleanChecker ())
+        .AddAttribute ("DampingPenalty", "Penalty added each time a route is withdrawn", DoubleValue (1000),
+                       MakeDoubleAccessor (&BatchedRip::m_dampingPenalty), MakeDoubleChecker<double> (0))
+        .AddAttribute ("DampingSuppressLimit", "Penalty above which a route is suppressed", DoubleValue (2000),
+                       MakeDoubleAccessor (&BatchedRip::m_suppressLimit), MakeDoubleChecker<double> (0))
+        .AddAttribute ("DampingReuseLimit", "Penalty below which a suppressed route is used again",
+                       DoubleValue (750), MakeDoubleAccessor (&BatchedRip::m_reuseLimit),
+                       MakeDoubleChecker<double> (1))
+        .AddAttribute ("DampingHalfLife", "Half-life of the penalty", TimeValue (Seconds (30)),
+                       MakeTimeAccessor (&BatchedRip::m_halfLife), MakeTimeChecker ())
+        .AddTraceSource ("RouteChange", "A route is added, changed or invalidated",
+                         MakeTraceSourceAccessor (&BatchedRip::m_routeChangeTrace),
+                         "ns3::BatchedRip::RouteChangeTracedCallback");
+    return tid;
+  }
+
+  BatchedRip ()
+    : m_initialized (false),
+      m_splitHorizon (POISON_REVERSE),
+      m_maxEntries (0),
+      m_damping (false),
+      m_dampingPenalty (1000),
+      m_suppressLimit (2000),
+      m_reuseLimit (750),
+      m_stats ()
+  {
+    m_rng = CreateObject<UniformRandomVariable> ();
+  }
+
+  void SetInterfaceExclusions (const std::set<uint32_t> &exclusions)
+  {
+    m_exclusions = exclusions;
+  }
+
+  void SetInterfaceMetric (uint32_t interface, uint8_t metric)
+  {
+    m_interfaceMetrics[interface] = metric;
+  }
+
+  int64_t AssignStreams (int64_t stream)
+  {
+    m_rng->SetStream (stream);
+    return 1;
+  }
+
+  const Stats &GetStats () const
+  {
+    return m_stats;
+  }
+
+  // rota aprendida, salva e restaurada pelo WarmStart (warm-start.h)
+  struct LearnedRoute
+  {
+    uint32_t network;
+    uint32_t mask;
+    uint32_t gateway;
+    uint32_t interface;
+    uint32_t metric;
+    Time timeout; // o que falta para a rota expirar
+  };
+
+  // rotas aprendidas válidas; as conectadas saem das interfaces
+  std::vector<LearnedRoute> ExportRoutes () const
+  {
+    std::vector<LearnedRoute> routes;
+    for (const std::pair<const Prefix, Route> &entry : m_routes)
+    {
+      const Route &route = entry.second;
+      if (route.gateway != 0 && route.metric < INFINITY_METRIC)
+      {
+        routes.push_back (LearnedRoute {entry.first.first, entry.first.second, route.gateway, route.interface,
+                                        route.metric, Simulator::GetDelayLeft (route.timeout)});
+      }
+    }
+    return routes;
+  }
+
+  // depois do DoInitialize; a rota não entra no update disparado e expira
+  // no tempo que faltava quando foi salva, se não for renovada antes
+  void ImportRoute (const LearnedRoute &learned)
+  {
+    NS_ABORT_MSG_IF (!m_initialized, "BatchedRip::ImportRoute before initialization");
+    NS_ABORT_MSG_IF (learned.interface >= m_ipv4->GetNInterfaces (), "Bad interface " << learned.interface);
+    Prefix prefix (learned.network, learned.mask);
+    std::map<Prefix, Route>::iterator it = m_routes.find (prefix);
+    if (it != m_routes.end () && it->second.gateway == 0)
+    {
+      return; // rede conectada
+    }
+    Route &route = AddRoute (prefix);
+    route.garbage.Cancel ();
+    route.timeout.Cancel ();
+    route.gateway = learned.gateway;
+    route.interface = learned.interface;
+    route.metric = learned.metric;
+    route.changed = false;
+    route.timeout = Simulator::Schedule (learned.timeout, &BatchedRip::Timeout, this, prefix);
+  }
+
+  Ptr<Ipv4Route> RouteOutput (Ptr<Packet> /* p */, const Ipv4Header &header, Ptr<NetDevice> oif,
+                              Socket::SocketErrno &sockerr) override
+  {
+    Ptr<Ipv4Route> route = Lookup (header.GetDestination (), oif);
+    sockerr = route ? Socket::ERROR_NOTERROR : Socket::ERROR_NOROUTETOHOST;
+    return route;
+  }
+
+  bool RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev,
+                   UnicastForwardCallback ucb, MulticastForwardCallback /* mcb */, LocalDeliverCallback lcb,
+                   ErrorCallback ecb) override
+  {
+    NS_ASSERT (m_ipv4->GetInterfaceForDevice (idev) >= 0);
+    uint32_t iif = m_ipv4->GetInterfaceForDevice (idev);
+    Ipv4Address destination = header.GetDestination ();
+    // inclui 224.0.0.9: os updates chegam ao socket de recepção por aqui
+    if (m_ipv4->IsDestinationAddress (destination, iif))
+    {
+      if (lcb.IsNull ())
+      {
+        return false;
+      }
+      lcb (p, header, iif);
+      return true;
+    }
+    if (destination.IsMulticast () || destination.IsBroadcast ())
+    {
+      return false;
+    }
+    if (!m_ipv4->IsForwarding (iif))
+    {
+      ecb (p, header, Socket::ERROR_NOROUTETOHOST);
+      return true;
+    }
+    Ptr<Ipv4Route> route = Lookup (destination, nullptr);
+    if (route == nullptr)
+    {
+      return false;
+    }
+    ucb (route, p, header);
+    return true;
+  }
+
+  void NotifyInterfaceUp (uint32_t interface) override
+  {
+    if (!m_initialized)
+    {
+      return;
+    }
+    for (uint32_t j = 0; j < m_ipv4->GetNAddresses (interface); ++j)
+    {
+      AddConnected (interface, m_ipv4->GetAddress (interface, j));
+    }
+    OpenInterface (interface);
+    RequestTriggeredUpdate ();
+  }
+
+  void NotifyInterfaceDown (uint32_t interface) override
+  {
+    if (!m_initialized)
+    {
+      return;
+    }
+    CloseInterface (interface);
+    for (std::pair<const Prefix, Route> &entry : m_routes)
+    {
+      if (entry.second.interface == interface && entry.second.metric < INFINITY_METRIC)
+      {
+        Invalidate (entry.first, entry.second);
+      }
+    }
+    RequestTriggeredUpdate ();
+  }
+
+  void NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address) override
+  {
+    if (m_initialized && m_ipv4->IsUp (interface))
+    {
+      AddConnected (interface, address);
+      OpenInterface (interface);
+      RequestTriggeredUpdate ();
+    }
+  }
+
+  void NotifyRemoveAddress (uint32_t /* interface */, Ipv4InterfaceAddress address) override
+  {
+    if (!m_initialized)
+    {
+      return;
+    }
+    Prefix prefix (address.GetLocal ().CombineMask (address.GetMask ()).Get (), address.GetMask ().Get ());
+    std::map<Prefix, Route>::iterator it = m_routes.find (prefix);
+    if (it != m_routes.end () && it->second.gateway == 0 && it->second.metric < INFINITY_METRIC)
+    {
+      Invalidate (it->first, it->second);
+      RequestTriggeredUpdate ();
+    }
+  }
+
+  void SetIpv4 (Ptr<Ipv4> ipv4) override
+  {
+    NS_ASSERT (m_ipv4 == nullptr && ipv4 != nullptr);
+    m_ipv4 = ipv4;
+  }
+
+  // no formato do Rip, só com as rotas em uso (válidas e não suprimidas);
+  // lido pelo RouteRecorder e pelo ConvergenceMonitor
+  void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const override
+  {
+    std::ostream *os = stream->GetStream ();
+    *os << "Node: " << m_ipv4->GetObject<Node> ()->GetId () << ", Time: " << Simulator::Now ().As (unit)
+        << ", IPv4 RIP table (batched)\n";
+    *os << "Destination     Gateway         Genmask         Flags Metric Ref    Use Iface\n";
+    char line[128];
+    for (const std::pair<const Prefix, Route> &entry : m_routes)
+    {
+      const Route &route = entry.second;
+      if (!IsUsable (entry.first, route))
+      {
+        continue;
+      }
+      std::ostringstream destination;
+      std::ostringstream gateway;
+      std::ostringstream mask;
+      destination << Ipv4Address (entry.first.first);
+      gateway << Ipv4Address (route.gateway);
+      mask << Ipv4Mask (entry.first.second);
+      std::snprintf (line, sizeof (line), "%-16s%-16s%-16s%-6s%-7u-      -   %u\n", destination.str ().c_str (),
+                     gateway.str ().c_str (), mask.str ().c_str (), route.gateway ? "UG" : "U", route.metric,
+                     route.interface);
+      *os << line;
+    }
+    *os << "\n";
+  }
+
+  // soma dos Stats dos nós com BatchedRip
+  static Stats GetTotalStats (NodeContainer nodes)
+  {
+    Stats total = Stats ();
+    for (uint32_t i = 0; i < nodes.GetN (); ++i)
+    {
+      Ptr<BatchedRip> routing = nodes.Get (i)->GetObject<BatchedRip> ();
+      if (routing == nullptr)
+      {
+        continue;
+      }
+      const Stats &stats = routing->GetStats ();
+      total.regularUpdates += stats.regularUpdates;
+      total.triggeredUpdates += stats.triggeredUpdates;
+      total.messagesSent += stats.messagesSent;
+      total.entriesSent += stats.entriesSent;
+      total.bytesSent += stats.bytesSent;
+      total.messagesReceived += stats.messagesReceived;
+      total.bytesReceived += stats.bytesReceived;
+      total.routeChanges += stats.routeChanges;
+      total.coalescedChanges += stats.coalescedChanges;
+      total.suppressions += stats.suppressions;
+    }
+    return total;
+  }
+
+  static void Report (std::ostream &os, NodeContainer nodes)
+  {
+    uint32_t routers = 0;
+    for (uint32_t i = 0; i < nodes.GetN (); ++i)
+    {
+      if (nodes.Get (i)->GetObject<BatchedRip> ())
+      {
+        ++routers;
+      }
+    }
+    if (routers == 0)
+    {
+      return;
+    }
+    Stats total = GetTotalStats (nodes);
+    os << "RIP (batched) " << routers << " routers: " << total.regularUpdates << " periodic and "
+       << total.triggeredUpdates << " triggered updates, " << total.messagesSent << " messages ("
+       << total.entriesSent << " entries), " << total.bytesSent << " bytes sent; " << total.routeChanges
+       << " route changes (" << total.coalescedChanges << " coalesced), " << total.suppressions
+       << " routes suppressed" << std::endl;
+  }
+
+private:
+  typedef std::pair<uint32_t, uint32_t> Prefix; // (rede, máscara)
+
+  struct Route
+  {
+    uint32_t gateway; // 0 nas redes conectadas
+    uint32_t interface;
+    uint32_t metric; // INFINITY_METRIC: inválida, esperando a remoção
+    bool changed;    // entra no próximo update disparado
+    EventId timeout;
+    EventId garbage;
+  };
+
+  typedef std::pair<const Prefix, Route> RouteEntry;
+  typedef PrefixTrie<const RouteEntry *> RouteTrie; // aponta para os nós de m_routes
+
+  struct Damping
+  {
+    double penalty;
+    Time updated;
+    bool suppressed;
+    EventId reuse;
+  };
+
+  static Ipv4Address AllRipRouters ()
+  {
+    return Ipv4Address ("224.0.0.9");
+  }
+
+  bool IsActive (uint32_t interface) const
+  {
+    return interface != 0 && m_ipv4->IsUp (interface) && m_ipv4->GetNAddresses (interface) > 0
+           && m_exclusions.find (interface) == m_exclusions.end ();
+  }
+
+  uint32_t GetInterfaceMetric (uint32_t interface) const
+  {
+    std::map<uint32_t, uint8_t>::const_iterator it = m_interfaceMetrics.find (interface);
+    return it == m_interfaceMetrics.end () ? 1 : it->second;
+  }
+
+  bool IsSuppressed (const Prefix &prefix) const
+  {
+    std::map<Prefix, Damping>::const_iterator it = m_dampingState.find (prefix);
+    return it != m_dampingState.end () && it->second.suppressed;
+  }
+
+  bool IsUsable (const Prefix &prefix, const Route &route) const
+  {
+    return route.metric < INFINITY_METRIC && !IsSuppressed (prefix);
+  }
+
+  void DoInitialize () override
+  {
+    m_initialized = true;
+    for (uint32_t i = 1; i < m_ipv4->GetNInterfaces (); ++i)
+    {
+      for (uint32_t j = 0; m_ipv4->IsUp (i) && j < m_ipv4->GetNAddresses (i); ++j)
+      {
+        AddConnected (i, m_ipv4->GetAddress (i, j));
+      }
+    }
+    m_recvSocket = Socket::CreateSocket (m_ipv4->GetObject<Node> (), UdpSocketFactory::GetTypeId ());
+    m_recvSocket->Bind (InetSocketAddress (AllRipRouters (), RIP_PORT));
+    m_recvSocket->SetRecvCallback (MakeCallback (&BatchedRip::Receive, this));
+    m_recvSocket->SetRecvPktInfo (true);
+    for (uint32_t i = 1; i < m_ipv4->GetNInterfaces (); ++i)
+    {
+      OpenInterface (i);
+    }
+    m_regularEvent = Simulator::Schedule (Seconds (m_rng->GetValue (0.01, m_startupDelay.GetSeconds ())),
+                                          &BatchedRip::SendRegularUpdate, this);
+    Ipv4RoutingProtocol::DoInitialize ();
+  }
+
+  void DoDispose () override
+  {
+    for (std::pair<const uint32_t, Ptr<Socket> > &socket : m_sockets)
+    {
+      socket.second->Close ();
+    }
+    m_sockets.clear ();
+    if (m_recvSocket)
+    {
+      m_recvSocket->Close ();
+      m_recvSocket = nullptr;
+    }
+    for (std::pair<const Prefix, Route> &entry : m_routes)
+    {
+      entry.second.timeout.Cancel ();
+      entry.second.garbage.Cancel ();
+    }
+    m_routes.clear ();
+    m_trie.Clear ();
+    for (std::pair<const Prefix, Damping> &entry : m_dampingState)
+    {
+      entry.second.reuse.Cancel ();
+    }
+    m_dampingState.clear ();
+    m_regularEvent.Cancel ();
+    m_triggeredEvent.Cancel ();
+    m_ipv4 = nullptr;
+    Ipv4RoutingProtocol::DoDispose ();
+  }
+
+  void AddConnected (uint32_t interface, Ipv4InterfaceAddress address)
+  {
+    if (interface == 0 || address.GetLocal () == Ipv4Address::GetLoopback ())
+    {
+      return;
+    }
+    Prefix prefix (address.GetLocal ().CombineMask (address.GetMask ()).Get (), address.GetMask ().Get ());
+    Route &route = AddRoute (prefix);
+    route.timeout.Cancel ();
+    route.garbage.Cancel ();
+    route.gateway = 0;
+    route.interface = interface;
+    route.metric = 0;
+    MarkChanged (prefix, route);
+  }
+
+  // socket de envio (e das respostas unicast) da interface; os updates
+  // multicast chegam pelo m_recvSocket
+  void OpenInterface (uint32_t interface)
+  {
+    if (!IsActive (interface) || m_sockets.find (interface) != m_sockets.end ())
+    {
+      return;
+    }
+    Ptr<Socket> socket = Socket::CreateSocket (m_ipv4->GetObject<Node> (), UdpSocketFactory::GetTypeId ());
+    socket->Bind (InetSocketAddress (m_ipv4->GetAddress (interface, 0).GetLocal (), RIP_PORT));
+    socket->BindToNetDevice (m_ipv4->GetNetDevice (interface));
+    socket->SetRecvCallback (MakeCallback (&BatchedRip::Receive, this));
+    socket->SetRecvPktInfo (true);
+    m_sockets[interface] = socket;
+    SendRequest (interface);
+  }
+
+  void CloseInterface (uint32_t interface)
+  {
+    std::map<uint32_t, Ptr<Socket> >::iterator it = m_sockets.find (interface);
+    if (it != m_sockets.end ())
+    {
+      it->second->Close ();
+      m_sockets.erase (it);
+    }
+  }
+
+  // pede a tabela inteira aos vizinhos (RFC 2453, 3.9.1)
+  void SendRequest (uint32_t interface)
+  {
+    RipHeader header;
+    header.SetCommand (RipHeader::REQUEST);
+    RipRte rte;
+    rte.SetPrefix (Ipv4Address::GetAny ());
+    rte.SetSubnetMask (Ipv4Mask::GetZero ());
+    rte.SetRouteMetric (INFINITY_METRIC);
+    header.AddRte (rte);
+    Send (interface, header, InetSocketAddress (AllRipRouters (), RIP_PORT));
+  }
+
+  void Send (uint32_t interface, const RipHeader &header, const InetSocketAddress &to)
+  {
+    Ptr<Packet> packet = Create<Packet> ();
+    packet->AddHeader (header);
+    ++m_stats.messagesSent;
+    m_stats.bytesSent += packet->GetSize () + 8 + 20;
+    m_sockets[interface]->SendTo (packet, 0, to);
+  }
+
+  // entradas por mensagem: o que cabe no MTU, limitado pelo MaxEntriesPerMessage
+  uint32_t GetMaxEntries (uint32_t interface) const
+  {
+    RipHeader header;
+    RipRte rte;
+    uint32_t mtu = m_ipv4->GetMtu (interface);
+    uint32_t fit = (mtu - 20 - 8 - header.GetSerializedSize ()) / rte.GetSerializedSize ();
+    return m_maxEntries > 0 ? std::min (fit, m_maxEntries) : fit;
+  }
+
+  // respostas com as rotas (só as mudadas num update disparado), em
+  // mensagens de até GetMaxEntries entradas
+  void SendRoutes (uint32_t interface, bool changedOnly, const InetSocketAddress &to)
+  {
+    uint32_t maxEntries = GetMaxEntries (interface);
+    RipHeader header;
+    header.SetCommand (RipHeader::RESPONSE);
+    for (const std::pair<const Prefix, Route> &entry : m_routes)
+    {
+      const Route &route = entry.second;
+      if (changedOnly && !route.changed)
+      {
+        continue;
+      }
+      uint32_t metric = IsSuppressed (entry.first) ? INFINITY_METRIC : route.metric;
+      if (route.interface == interface)
+      {
+        if (m_splitHorizon == SPLIT_HORIZON)
+        {
+          continue;
+        }
+        if (m_splitHorizon == POISON_REVERSE)
+        {
+          metric = INFINITY_METRIC;
+        }
+      }
+      RipRte rte;
+      rte.SetPrefix (Ipv4Address (entry.first.first));
+      rte.SetSubnetMask (Ipv4Mask (entry.first.second));
+      rte.SetRouteMetric (metric);
+      rte.SetRouteTag (0);
+      header.AddRte (rte);
+      ++m_stats.entriesSent;
+      if (header.GetRteNumber () == maxEntries)
+      {
+        Send (interface, header, to);
+        header.ClearRtes ();
+      }
+    }
+    if (header.GetRteNumber () > 0)
+    {
+      Send (interface, header, to);
+    }
+  }
+
+  void SendRegularUpdate ()
+  {
+    // o update periódico leva tudo: um disparado pendente fica sem objeto
+    m_triggeredEvent.Cancel ();
+    for (const std::pair<const uint32_t, Ptr<Socket> > &socket : m_sockets)
+    {
+      SendRoutes (socket.first, false, InetSocketAddress (AllRipRouters (), RIP_PORT));
+    }
+    for (std::pair<const Prefix, Route> &entry : m_routes)
+    {
+      entry.second.changed = false;
+    }
+    ++m_stats.regularUpdates;
+    Time delay = m_unsolicitedUpdate + Seconds (m_rng->GetValue (0, 0.5 * m_unsolicitedUpdate.GetSeconds ()));
+    m_regularEvent = Simulator::Schedule (delay, &BatchedRip::SendRegularUpdate, this);
+  }
+
+  // uma mudança de rota: agenda o update disparado ou entra no já agendado
+  void RequestTriggeredUpdate ()
+  {
+    ++m_stats.routeChanges;
+    if (m_triggeredEvent.IsRunning ())
+    {
+      ++m_stats.coalescedChanges;
+      return;
+    }
+    Time delay = Seconds (m_rng->GetValue (m_minTriggeredDelay.GetSeconds (), m_maxTriggeredDelay.GetSeconds ()));
+    if (m_lastTriggered.IsStrictlyPositive () && m_coalesceWindow.IsStrictlyPositive ())
+    {
+      delay = std::max (delay, m_lastTriggered + m_coalesceWindow - Simulator::Now ());
+    }
+    m_triggeredEvent = Simulator::Schedule (delay, &BatchedRip::SendTriggeredUpdate, this);
+  }
+
+  void SendTriggeredUpdate ()
+  {
+    for (const std::pair<const uint32_t, Ptr<Socket> > &socket : m_sockets)
+    {
+      SendRoutes (socket.first, true, InetSocketAddress (AllRipRouters (), RIP_PORT));
+    }
+    for (std::pair<const Prefix, Route> &entry : m_routes)
+    {
+      entry.second.changed = false;
+    }
+    ++m_stats.triggeredUpdates;
+    m_lastTriggered = Simulator::Now ();
+  }
+
+  void Receive (Ptr<Socket> socket)
+  {
+    Address from;
+    Ptr<Packet> packet = socket->RecvFrom (from);
+    InetSocketAddress sender = InetSocketAddress::ConvertFrom (from);
+    Ipv4PacketInfoTag info;
+    if (!packet->RemovePacketTag (info))
+    {
+      NS_ABORT_MSG ("No incoming interface on RIP message, aborting.");
+    }
+    int32_t interface = m_ipv4->GetInterfaceForDevice (m_ipv4->GetObject<Node> ()->GetDevice (info.GetRecvIf ()));
+    if (interface <= 0 || !IsActive (interface) || m_ipv4->GetInterfaceForAddress (sender.GetIpv4 ()) >= 0)
+    {
+      return;
+    }
+    ++m_stats.messagesReceived;
+    m_stats.bytesReceived += packet->GetSize () + 8 + 20;
+    RipHeader header;
+    packet->RemoveHeader (header);
+    if (header.GetCommand () == RipHeader::RESPONSE)
+    {
+      if (sender.GetPort () == RIP_PORT)
+      {
+        HandleResponse (header, sender.GetIpv4 (), interface);
+      }
+    }
+    else if (header.GetCommand () == RipHeader::REQUEST)
+    {
+      std::list<RipRte> rtes = header.GetRteList ();
+      if (rtes.size () == 1 && rtes.front ().GetPrefix () == Ipv4Address::GetAny ()
+          && rtes.front ().GetSubnetMask () == Ipv4Mask::GetZero ()
+          && rtes.front ().GetRouteMetric () == INFINITY_METRIC)
+      {
+        SendRoutes (interface, false, sender);
+      }
+    }
+  }
+
+  // RFC 2453, 3.9.2
+  void HandleResponse (const RipHeader &header, Ipv4Address sender, uint32_t interface)
+  {
+    bool changed = false;
+    std::list<RipRte> rtes = header.GetRteList ();
+    for (const RipRte &rte : rtes)
+    {
+      uint32_t metric = std::min<uint32_t> (rte.GetRouteMetric () + GetInterfaceMetric (interface), INFINITY_METRIC);
+      Prefix prefix (rte.GetPrefix ().CombineMask (rte.GetSubnetMask ()).Get (), rte.GetSubnetMask ().Get ());
+      std::map<Prefix, Route>::iterator it = m_routes.find (prefix);
+      if (it == m_routes.end ())
+      {
+        if (metric < INFINITY_METRIC)
+        {
+          Route &route = AddRoute (prefix);
+          route.gateway = sender.Get ();
+          route.interface = interface;
+          route.metric = metric;
+          MarkChanged (prefix, route);
+          Refresh (prefix, route);
+          changed = true;
+        }
+        continue;
+      }
+      Route &route = it->second;
+      if (route.gateway == 0)
+      {
+        continue; // rede conectada
+      }
+      if (route.gateway == sender.Get () && route.interface == interface)
+      {
+        if (metric < INFINITY_METRIC)
+        {
+          Refresh (prefix, route);
+        }
+        if (metric != route.metric)
+        {
+          if (metric == INFINITY_METRIC)
+          {
+            Invalidate (prefix, route);
+          }
+          else
+          {
+            route.metric = metric;
+            MarkChanged (prefix, route);
+          }
+          changed = true;
+        }
+      }
+      else if (metric < route.metric)
+      {
+        route.gateway = sender.Get ();
+        route.interface = interface;
+        route.metric = metric;
+        MarkChanged (prefix, route);
+        Refresh (prefix, route);
+        changed = true;
+      }
+    }
+    if (changed)
+    {
+      RequestTriggeredUpdate ();
+    }
+  }
+
+  void MarkChanged (const Prefix &prefix, Route &route)
+  {
+    route.changed = true;
+    NextRouteGeneration ();
+    m_routeChangeTrace (Ipv4Address (prefix.first), Ipv4Mask (prefix.second), Ipv4Address (route.gateway),
+                        route.interface, route.metric);
+  }
+
+  // entrada da tabela (a existente, se houver), registrada na trie da busca
+  Route &AddRoute (const Prefix &prefix)
+  {
+    std::map<Prefix, Route>::iterator it = m_routes.insert (std::make_pair (prefix, Route ())).first;
+    m_trie.Insert (prefix.first, RouteTrie::GetPrefixLength (prefix.second), &*it);
+    NextRouteGeneration ();
+    return it->second;
+  }
+
+  void Refresh (const Prefix &prefix, Route &route)
+  {
+    route.garbage.Cancel ();
+    route.timeout.Cancel ();
+    route.timeout = Simulator::Schedule (m_timeoutDelay, &BatchedRip::Timeout, this, prefix);
+  }
+
+  void Timeout (Prefix prefix)
+  {
+    Invalidate (prefix, m_routes.at (prefix));
+    RequestTriggeredUpdate ();
+  }
+
+  // métrica 16, anunciada até a coleta; uma retirada conta como flap
+  void Invalidate (const Prefix &prefix, Route &route)
+  {
+    bool learned = route.gateway != 0;
+    route.metric = INFINITY_METRIC;
+    MarkChanged (prefix, route);
+    route.timeout.Cancel ();
+    route.garbage.Cancel ();
+    route.garbage = Simulator::Schedule (m_garbageCollectionDelay, &BatchedRip::Collect, this, prefix);
+    if (m_damping && learned)
+    {
+      Flap (prefix);
+    }
+  }
+
+  void Collect (Prefix prefix)
+  {
+    m_trie.Remove (prefix.first, RouteTrie::GetPrefixLength (prefix.second));
+    m_routes.erase (prefix);
+    NextRouteGeneration ();
+  }
+
+  void Decay (Damping &damping) const
+  {
+    Time now = Simulator::Now ();
+    damping.penalty *= std::exp2 (-(now - damping.updated).GetSeconds () / m_halfLife.GetSeconds ());
+    damping.updated = now;
+  }
+
+  void Flap (const Prefix &prefix)
+  {
+    std::map<Prefix, Damping>::iterator it = m_dampingState.find (prefix);
+    if (it == m_dampingState.end ())
+    {
+      it = m_dampingState.insert (std::make_pair (prefix, Damping {0, Simulator::Now (), false, EventId ()})).first;
+    }
+    Damping &damping = it->second;
+    Decay (damping);
+    // teto de 2 * limite de supressão: uma rota que oscilou muito não fica
+    // suprimida por mais de log2 (2 * suppress / reuse) meias-vidas
+    damping.penalty = std::min (damping.penalty + m_dampingPenalty, 2 * m_suppressLimit);
+    if (!damping.suppressed && damping.penalty >= m_suppressLimit)
+    {
+      NS_LOG_INFO ("Route " << Ipv4Address (prefix.first) << "/" << Ipv4Mask (prefix.second) << " suppressed");
+      damping.suppressed = true;
+      NextRouteGeneration ();
+      ++m_stats.suppressions;
+    }
+    if (damping.suppressed)
+    {
+      ScheduleReuse (prefix, damping);
+    }
+  }
+
+  // quando a penalidade, sem novos flaps, cai ao limite de reuso
+  void ScheduleReuse (const Prefix &prefix, Damping &damping)
+  {
+    damping.reuse.Cancel ();
+    double halfLives = std::log2 (std::max (damping.penalty / m_reuseLimit, 1.0));
+    damping.reuse = Simulator::Schedule (Seconds (halfLives * m_halfLife.GetSeconds ()), &BatchedRip::Reuse,
+                                         this, prefix);
+  }
+
+  void Reuse (Prefix prefix)
+  {
+    Damping &damping = m_dampingState.at (prefix);
+    Decay (damping);
+    if (damping.penalty > m_reuseLimit * 1.001)
+    {
+      ScheduleReuse (prefix, damping);
+      return;
+    }
+    NS_LOG_INFO ("Route " << Ipv4Address (prefix.first) << "/" << Ipv4Mask (prefix.second) << " reused");
+    m_dampingState.erase (prefix);
+    std::map<Prefix, Route>::iterator it = m_routes.find (prefix);
+    if (it != m_routes.end () && it->second.metric < INFINITY_METRIC)
+    {
+      MarkChanged (prefix, it->second);
+      RequestTriggeredUpdate ();
+    }
+  }
+
+  // maior prefixo entre as rotas em uso
+  Ptr<Ipv4Route> Lookup (Ipv4Address destination, Ptr<NetDevice> oif) const
+  {
+    if (destination.IsLocalMulticast ())
+    {
+      NS_ASSERT_MSG (oif, "Local multicast sent without an output interface");
+      Ptr<Ipv4Route> route = Create<Ipv4Route> ();
+      route->SetSource (m_ipv4->GetAddress (m_ipv4->GetInterfaceForDevice (oif), 0).GetLocal ());
+      route->SetDestination (destination);
+      route->SetGateway (Ipv4Address::GetZero ());
+      route->SetOutputDevice (oif);
+      return route;
+    }
+    const RouteEntry *const *entry = m_trie.Lookup (destination.Get (), [this, oif] (const RouteEntry *candidate) {
+      return IsUsable (candidate->first, candidate->second)
+             && (!oif || m_ipv4->GetNetDevice (candidate->second.interface) == oif);
+    });
+    if (entry == nullptr)
+    {
+      return nullptr;
+    }
+    const Route *best = &(*entry)->second;
+    Ptr<Ipv4Route> route = Create<Ipv4Route> ();
+    route->SetDestination (destination);
+    route->SetSource (m_ipv4->GetAddress (best->interface, 0).GetLocal ());
+    route->SetGateway (Ipv4Address (best->gateway));
+    route->SetOutputDevice (m_ipv4->GetNetDevice (best->interface));
+    return route;
+  }
+
+  Ptr<Ipv4> m_ipv4;
+  Ptr<UniformRandomVariable> m_rng;
+  std::set<uint32_t> m_exclusions;
+  std::map<uint32_t, uint8_t> m_interfaceMetrics;
+  bool m_initialized;
+
+  Time m_unsolicitedUpdate;
+  Time m_startupDelay;
+  Time m_timeoutDelay;
+  Time m_garbageCollectionDelay;
+  Time m_minTriggeredDelay;
+  Time m_maxTriggeredDelay;
+  int m_splitHorizon;
+  Time m_coalesceWindow;
+  uint32_t m_maxEntries;
+  bool m_damping;
+  double m_dampingPenalty;
+  double m_suppressLimit;
+  double m_reuseLimit;
+  Time m_halfLife;
+
+  Ptr<Socket> m_recvSocket;
+  std::map<uint32_t, Ptr<Socket> > m_sockets; // só as interfaces que trocam updates
+  std::map<Prefix, Route> m_routes;
+  RouteTrie m_trie; // os mesmos prefixos de m_routes, para o Lookup
+  std::map<Prefix, Damping> m_dampingState; // rotas com penalidade
+  EventId m_regularEvent;
+  EventId m_triggeredEvent;
+  Time m_lastTriggered;
+  Stats m_stats;
+  TracedCallback<Ipv4Address, Ipv4Mask, Ipv4Address, uint32_t, uint32_t> m_routeChangeTrace;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (BatchedRip);
+
+// como o RipHelper: interfaces excluídas, métricas por interface e atributos
+class BatchedRipHelper : public Ipv4RoutingHelper
+{
+public:
+  BatchedRipHelper ()
+  {
+    m_factory.SetTypeId (BatchedRip::GetTypeId ());
+  }
+
+  BatchedRipHelper *Copy () const override
+  {
+    return new BatchedRipHelper (*this);
+  }
+
+  Ptr<Ipv4RoutingProtocol> Create (Ptr<Node> node) const override
+  {
+    Ptr<BatchedRip> rip = m_factory.Create<BatchedRip> ();
+    std::map<Ptr<Node>, std::set<uint32_t> >::const_iterator exclusions = m_exclusions.find (node);
+    if (exclusions != m_exclusions.end ())
+    {
+      rip->SetInterfaceExclusions (exclusions->second);
+    }
+    std::map<Ptr<Node>, std::map<uint32_t, uint8_t> >::const_iterator metrics = m_metrics.find (node);
+    if (metrics != m_metrics.end ())
+    {
+      for (const std::pair<const uint32_t, uint8_t> &metric : metrics->second)
+      {
+        rip->SetInterfaceMetric (metric.first, metric.second);
+      }
+    }
+    node->AggregateObject (rip);
+    return rip;
+  }
+
+  void Set (std::string name, const AttributeValue &value)
+  {
+    m_factory.Set (name, value);
+  }
+
+  void ExcludeInterface (Ptr<Node> node, uint32_t interface)
+  {
+    m_exclusions[node].insert (interface);
+  }
+
+  void SetInterfaceMetric (Ptr<Node> node, uint32_t interface, uint8_t metric)
+  {
+    m_metrics[node][interface] = metric;
+  }
+
+  int64_t AssignStreams (NodeContainer nodes, int64_t stream)
+  {
+    int64_t current = stream;
+    for (NodeContainer::Iterator it = nodes.Begin (); it != nodes.End (); ++it)
+    {
+      Ptr<BatchedRip> rip = (*it)->GetObject<BatchedRip> ();
+      if (rip != nullptr)
+      {
+        current += rip->AssignStreams (current);
+      }
+    }
+    return current - stream;
+  }
+
+private:
+  ObjectFactory m_factory;
+  std::map<Ptr<Node>, std::set<uint32_t> > m_exclusions;
+  std::map<Ptr<Node>, std::map<uint32_t, uint8_t> > m_metrics;
+};
+
+} // namespace rip
+
+using rip::BatchedRip;
+using rip::BatchedRipHelper;
+
+} // namespace ns3
+
+#endif /* BATCHED_RIP_H */
@@ -0,0 +1,154 @@
+// Liga o BinaryTraceWriter (binary-trace.h) aos dispositivos CSMA e ponto a
+// ponto: fila de transmissão (Enqueue/Dequeue/Drop), recepção (MacRx) e
+// descarte na recepção (PhyRxDrop), os mesmos pontos do EnableAsciiAll.
+//
+//   BinaryTraceHelper trace;
+//   trace.Open ("tp2-rip.btr");
+//   trace.EnableAll ();
+//   ...
+//   Simulator::Run ();
+//   trace.Close ();
+//
+// O arquivo é lido com tools/trace_dump.cc.
+
+#ifndef BINARY_TRACE_HELPER_H
+#define BINARY_TRACE_HELPER_H
+
+#include "binary-trace.h"
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/csma-module.h"
+#include "ns3/point-to-point-module.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+namespace tracing {
+
+NS_LOG_COMPONENT_DEFINE ("BinaryTraceHelper");
+
+class BinaryTraceHelper
+{
+public:
+  void Open (const std::string &path)
+  {
+    std::string error;
+    if (!m_writer.Open (path, &error))
+    {
+      NS_FATAL_ERROR (error);
+    }
+  }
+
+  // todos os dispositivos de todos os nós criados até aqui
+  void EnableAll ()
+  {
+    for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); ++node)
+    {
+      for (uint32_t i = 0; i < (*node)->GetNDevices (); ++i)
+      {
+        Enable ((*node)->GetDevice (i));
+      }
+    }
+  }
+
+  void Enable (NetDeviceContainer devices)
+  {
+    for (NetDeviceContainer::Iterator device = devices.Begin (); device != devices.End (); ++device)
+    {
+      Enable (*device);
+    }
+  }
+
+  void Enable (Ptr<NetDevice> device)
+  {
+    Ptr<Queue<Packet> > queue;
+    if (Ptr<CsmaNetDevice> csma = DynamicCast<CsmaNetDevice> (device))
+    {
+      queue = csma->GetQueue ();
+    }
+    else if (Ptr<PointToPointNetDevice> p2p = DynamicCast<PointToPointNetDevice> (device))
+    {
+      queue = p2p->GetQueue ();
+    }
+    else
+    {
+      return; // loopback e outros tipos ficam de fora
+    }
+    m_sinks.emplace_back (new DeviceSink (&m_writer, device->GetNode ()->GetId (), device->GetIfIndex ()));
+    DeviceSink *sink = m_sinks.back ().get ();
+    queue->TraceConnectWithoutContext ("Enqueue", MakeCallback (&DeviceSink::Enqueue, sink));
+    queue->TraceConnectWithoutContext ("Dequeue", MakeCallback (&DeviceSink::Dequeue, sink));
+    queue->TraceConnectWithoutContext ("Drop", MakeCallback (&DeviceSink::Drop, sink));
+    device->TraceConnectWithoutContext ("MacRx", MakeCallback (&DeviceSink::Receive, sink));
+    device->TraceConnectWithoutContext ("PhyRxDrop", MakeCallback (&DeviceSink::Drop, sink));
+  }
+
+  void Close ()
+  {
+    m_writer.Close ();
+    NS_LOG_INFO ("Wrote " << m_writer.GetRecords () << " trace records in " << m_writer.GetBytesWritten ()
+                          << " bytes");
+  }
+
+  uint64_t GetRecords () const
+  {
+    return m_writer.GetRecords ();
+  }
+
+private:
+  class DeviceSink
+  {
+  public:
+    DeviceSink (BinaryTraceWriter *writer, uint32_t node, uint32_t device)
+      : m_writer (writer),
+        m_node (node),
+        m_device (device)
+    {
+    }
+
+    void Enqueue (Ptr<const Packet> packet)
+    {
+      Write ('+', packet);
+    }
+
+    void Dequeue (Ptr<const Packet> packet)
+    {
+      Write ('-', packet);
+    }
+
+    void Drop (Ptr<const Packet> packet)
+    {
+      Write ('d', packet);
+    }
+
+    void Receive (Ptr<const Packet> packet)
+    {
+      Write ('r', packet);
+    }
+
+  private:
+    void Write (char type, Ptr<const Packet> packet)
+    {
+      m_writer->Write (TraceRecord {type, uint64_t (Simulator::Now ().GetNanoSeconds ()), m_node, m_device,
+                                    packet->GetUid (), packet->GetSize ()});
+    }
+
+    BinaryTraceWriter *m_writer;
+    uint32_t m_node;
+    uint32_t m_device;
+  };
+
+  BinaryTraceWriter m_writer;
+  std::vector<std::unique_ptr<DeviceSink> > m_sinks;
+};
+
+} // namespace tracing
+
+using tracing::BinaryTraceHelper;
+
+} // namespace ns3
+
+#endif /* BINARY_TRACE_HELPER_H */
@@ -0,0 +1,260 @@
+// Trace binário por registros, no lugar do texto do EnableAsciiAll.
+//
+// Cada registro guarda o tipo do evento ('+' enfileirado, '-' retirado da
+// fila, 'd' descartado, 'r' recebido, como no trace ASCII), o instante, o nó,
+// o dispositivo, o UID e o tamanho do pacote. Instante e UID são gravados
+// como diferença para o registro anterior, e todos os campos como varint.
+//
+// Arquivo: a assinatura BINARY_TRACE_MAGIC seguida de blocos
+//
+//   <tamanho original: u32> <tamanho comprimido: u32> <registros: u32> <bloco>
+//
+// com os inteiros em little-endian e o bloco comprimido pelo BlockCompress
+// (block-codec.h). As diferenças recomeçam em cada bloco, então os blocos
+// podem ser lidos um de cada vez.
+//
+// Não depende do ns-3; o BinaryTraceHelper (binary-trace-helper.h) liga o
+// escritor aos dispositivos.
+
+#ifndef BINARY_TRACE_H
+#define BINARY_TRACE_H
+
+#include "block-codec.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+const char BINARY_TRACE_MAGIC[8] = {'N', 'S', '3', 'B', 'T', 'R', '1', '\n'};
+
+struct TraceRecord
+{
+  char type;
+  uint64_t timeNs;
+  uint32_t node;
+  uint32_t device;
+  uint64_t uid;
+  uint32_t size;
+};
+
+class BinaryTraceWriter
+{
+public:
+  BinaryTraceWriter ()
+    : m_blockSize (64 * 1024),
+      m_blockRecords (0),
+      m_lastTime (0),
+      m_lastUid (0),
+      m_records (0),
+      m_bytes (0)
+  {
+  }
+
+  ~BinaryTraceWriter ()
+  {
+    Close ();
+  }
+
+  bool Open (const std::string &path, std::string *error)
+  {
+    m_out.open (path, std::ios::binary | std::ios::trunc);
+    if (!m_out)
+    {
+      *error = "nao foi possivel gravar " + path;
+      return false;
+    }
+    m_out.write (BINARY_TRACE_MAGIC, sizeof (BINARY_TRACE_MAGIC));
+    m_bytes = sizeof (BINARY_TRACE_MAGIC);
+    m_raw.reserve (m_blockSize + 64);
+    return true;
+  }
+
+  // tamanho do bloco antes da compressão
+  void SetBlockSize (uint32_t bytes)
+  {
+    m_blockSize = bytes;
+  }
+
+  void Write (const TraceRecord &record)
+  {
+    m_raw.push_back (uint8_t (record.type));
+    PutVarint (m_raw, record.timeNs - m_lastTime);
+    PutVarint (m_raw, record.node);
+    PutVarint (m_raw, record.device);
+    PutVarint (m_raw, ZigZagEncode (int64_t (record.uid - m_lastUid)));
+    PutVarint (m_raw, record.size);
+    m_lastTime = record.timeNs;
+    m_lastUid = record.uid;
+    ++m_blockRecords;
+    ++m_records;
+    if (m_raw.size () >= m_blockSize)
+    {
+      Flush ();
+    }
+  }
+
+  // comprime e grava o bloco corrente
+  void Flush ()
+  {
+    if (m_blockRecords == 0 || !m_out.is_open ())
+    {
+      return;
+    }
+    m_compressed.clear ();
+    BlockCompress (m_raw.data (), m_raw.size (), m_compressed);
+    PutU32 (m_out, m_raw.size ());
+    PutU32 (m_out, m_compressed.size ());
+    PutU32 (m_out, m_blockRecords);
+    m_out.write (reinterpret_cast<const char *> (m_compressed.data ()), m_compressed.size ());
+    m_bytes += 12 + m_compressed.size ();
+    m_raw.clear ();
+    m_blockRecords = 0;
+    m_lastTime = 0;
+    m_lastUid = 0;
+  }
+
+  void Close ()
+  {
+    if (m_out.is_open ())
+    {
+      Flush ();
+      m_out.close ();
+    }
+  }
+
+  uint64_t GetRecords () const
+  {
+    return m_records;
+  }
+
+  // bytes já gravados no arquivo (sem o bloco ainda não comprimido)
+  uint64_t GetBytesWritten () const
+  {
+    return m_bytes;
+  }
+
+private:
+  std::ofstream m_out;
+  uint32_t m_blockSize;
+  std::vector<uint8_t> m_raw;
+  std::vector<uint8_t> m_compressed;
+  uint32_t m_blockRecords;
+  uint64_t m_lastTime;
+  uint64_t m_lastUid;
+  uint64_t m_records;
+  uint64_t m_bytes;
+};
+
+// leitura sequencial, um bloco descomprimido por vez
+class BinaryTraceReader
+{
+public:
+  BinaryTraceReader ()
+    : m_pos (0),
+      m_blockRecords (0),
+      m_lastTime (0),
+      m_lastUid (0)
+  {
+  }
+
+  bool Open (const std::string &path, std::string *error)
+  {
+    m_in.open (path, std::ios::binary);
+    char magic[sizeof (BINARY_TRACE_MAGIC)];
+    if (!m_in || !m_in.read (magic, sizeof (magic))
+        || std::string (magic, sizeof (magic)) != std::string (BINARY_TRACE_MAGIC, sizeof (magic)))
+    {
+      *error = path + " nao e um trace binario";
+      return false;
+    }
+    return true;
+  }
+
+  // false no fim do arquivo ou em erro (error fica vazio no fim normal)
+  bool Next (TraceRecord &record, std::string *error)
+  {
+    error->clear ();
+    while (m_blockRecords == 0)
+    {
+      if (!ReadBlock (error))
+      {
+        return false;
+      }
+    }
+    const uint8_t *in = m_raw.data () + m_pos;
+    const uint8_t *end = m_raw.data () + m_raw.size ();
+    uint64_t delta;
+    uint64_t node;
+    uint64_t device;
+    uint64_t uid;
+    uint64_t size;
+    if (in >= end)
+    {
+      *error = "registro truncado";
+      return false;
+    }
+    record.type = char (*in++);
+    if (!GetVarint (in, end, delta) || !GetVarint (in, end, node) || !GetVarint (in, end, device)
+        || !GetVarint (in, end, uid) || !GetVarint (in, end, size))
+    {
+      *error = "registro truncado";
+      return false;
+    }
+    m_lastTime += delta;
+    m_lastUid += ZigZagDecode (uid);
+    record.timeNs = m_lastTime;
+    record.node = node;
+    record.device = device;
+    record.uid = m_lastUid;
+    record.size = size;
+    m_pos = in - m_raw.data ();
+    --m_blockRecords;
+    return true;
+  }
+
+private:
+  bool ReadBlock (std::string *error)
+  {
+    uint32_t rawSize;
+    uint32_t compressedSize;
+    if (!GetU32 (m_in, rawSize))
+    {
+      return false; // fim do arquivo
+    }
+    if (!GetU32 (m_in, compressedSize) || !GetU32 (m_in, m_blockRecords))
+    {
+      *error = "cabecalho de bloco truncado";
+      return false;
+    }
+    m_compressed.resize (compressedSize);
+    if (!m_in.read (reinterpret_cast<char *> (m_compressed.data ()), compressedSize))
+    {
+      *error = "bloco truncado";
+      return false;
+    }
+    m_raw.clear ();
+    if (!BlockDecompress (m_compressed.data (), compressedSize, rawSize, m_raw, error))
+    {
+      return false;
+    }
+    m_pos = 0;
+    m_lastTime = 0;
+    m_lastUid = 0;
+    return true;
+  }
+
+  std::ifstream m_in;
+  std::vector<uint8_t> m_compressed;
+  std::vector<uint8_t> m_raw;
+  std::size_t m_pos;
+  uint32_t m_blockRecords;
+  uint64_t m_lastTime;
+  uint64_t m_lastUid;
+};
+
+} // namespace ns3
+
+#endif /* BINARY_TRACE_H */
@@ -0,0 +1,204 @@
+// Inteiros de tamanho variável (varint) e um compressor LZ por blocos, leve e
+// sem dependências, para os formatos binários de trace e de log.
+//
+// Formato de um bloco comprimido: sequência de
+//
+//   <literais: varint> <bytes literais> <casamento: varint> [<distância: varint>]
+//
+// onde casamento = 0 termina o bloco e casamento > 0 copia (casamento + 3)
+// bytes de 'distância' bytes atrás na saída.
+//
+// Não depende do ns-3.
+
+#ifndef BLOCK_CODEC_H
+#define BLOCK_CODEC_H
+
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+inline void
+PutVarint (std::vector<uint8_t> &out, uint64_t value)
+{
+  while (value >= 0x80)
+  {
+    out.push_back (uint8_t (value) | 0x80);
+    value >>= 7;
+  }
+  out.push_back (uint8_t (value));
+}
+
+// devolve false se o varint passar do fim ou tiver mais de 10 bytes
+inline bool
+GetVarint (const uint8_t *&in, const uint8_t *end, uint64_t &value)
+{
+  value = 0;
+  for (uint32_t shift = 0; shift < 70 && in < end; shift += 7)
+  {
+    uint8_t byte = *in++;
+    value |= uint64_t (byte & 0x7f) << shift;
+    if (!(byte & 0x80))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+inline uint64_t
+ZigZagEncode (int64_t value)
+{
+  return (uint64_t (value) << 1) ^ uint64_t (value >> 63);
+}
+
+inline int64_t
+ZigZagDecode (uint64_t value)
+{
+  return int64_t (value >> 1) ^ -int64_t (value & 1);
+}
+
+// inteiros de 32 bits em little-endian, para os cabeçalhos de bloco
+inline void
+PutU32 (std::ostream &os, uint32_t value)
+{
+  char bytes[4] = {char (value), char (value >> 8), char (value >> 16), char (value >> 24)};
+  os.write (bytes, 4);
+}
+
+inline bool
+GetU32 (std::istream &is, uint32_t &value)
+{
+  unsigned char bytes[4];
+  if (!is.read (reinterpret_cast<char *> (bytes), 4))
+  {
+    return false;
+  }
+  value = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (uint32_t (bytes[3]) << 24);
+  return true;
+}
+
+namespace codec {
+
+const uint32_t MIN_MATCH = 4;
+const uint32_t HASH_BITS = 14;
+const uint32_t MAX_DISTANCE = 65535;
+
+inline uint32_t
+Hash4 (const uint8_t *p)
+{
+  uint32_t v;
+  std::memcpy (&v, p, 4);
+  return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+} // namespace codec
+
+// acrescenta a 'out' a versão comprimida de in[0, size)
+inline void
+BlockCompress (const uint8_t *in, std::size_t size, std::vector<uint8_t> &out)
+{
+  std::vector<int64_t> table (std::size_t (1) << codec::HASH_BITS, -1);
+  std::size_t anchor = 0;
+  std::size_t pos = 0;
+  while (size >= codec::MIN_MATCH && pos + codec::MIN_MATCH <= size)
+  {
+    uint32_t h = codec::Hash4 (in + pos);
+    int64_t candidate = table[h];
+    table[h] = pos;
+    if (candidate < 0 || pos - candidate > codec::MAX_DISTANCE
+        || std::memcmp (in + candidate, in + pos, codec::MIN_MATCH) != 0)
+    {
+      ++pos;
+      continue;
+    }
+    std::size_t length = codec::MIN_MATCH;
+    while (pos + length < size && in[candidate + length] == in[pos + length])
+    {
+      ++length;
+    }
+    PutVarint (out, pos - anchor);
+    out.insert (out.end (), in + anchor, in + pos);
+    PutVarint (out, length - codec::MIN_MATCH + 1);
+    PutVarint (out, pos - candidate);
+    // indexa algumas posições dentro do casamento para os próximos
+    std::size_t next = pos + length;
+    for (std::size_t p = pos + 1; p + codec::MIN_MATCH <= size && p < next; p += 3)
+    {
+      table[codec::Hash4 (in + p)] = p;
+    }
+    pos = next;
+    anchor = pos;
+  }
+  PutVarint (out, size - anchor);
+  out.insert (out.end (), in + anchor, in + size);
+  PutVarint (out, 0);
+}
+
+// descomprime um bloco inteiro; 'expected' é o tamanho original
+inline bool
+BlockDecompress (const uint8_t *in, std::size_t size, std::size_t expected, std::vector<uint8_t> &out,
+                 std::string *error)
+{
+  const uint8_t *end = in + size;
+  std::size_t start = out.size ();
+  out.reserve (start + expected);
+  while (true)
+  {
+    uint64_t literals;
+    uint64_t match;
+    if (!GetVarint (in, end, literals) || literals > uint64_t (end - in))
+    {
+      *error = "bloco comprimido truncado";
+      return false;
+    }
+    if (literals > expected - (out.size () - start))
+    {
+      *error = "literais alem do tamanho do bloco descomprimido";
+      return false;
+    }
+    out.insert (out.end (), in, in + literals);
+    in += literals;
+    if (!GetVarint (in, end, match))
+    {
+      *error = "bloco comprimido truncado";
+      return false;
+    }
+    if (match == 0)
+    {
+      break;
+    }
+    uint64_t distance;
+    if (!GetVarint (in, end, distance) || distance == 0 || distance > out.size () - start)
+    {
+      *error = "distancia invalida no bloco comprimido";
+      return false;
+    }
+    // comprimento do match: match + MIN_MATCH - 1, sem passar do esperado
+    std::size_t remaining = expected - (out.size () - start);
+    if (match > remaining || match - 1 + codec::MIN_MATCH > remaining)
+    {
+      *error = "match alem do tamanho do bloco descomprimido";
+      return false;
+    }
+    std::size_t from = out.size () - distance;
+    for (uint64_t i = 0; i < match + codec::MIN_MATCH - 1; ++i)
+    {
+      out.push_back (out[from + i]);
+    }
+  }
+  if (out.size () - start != expected)
+  {
+    *error = "tamanho do bloco descomprimido nao confere";
+    return false;
+  }
+  return true;
+}
+
+} // namespace ns3
+
+#endif /* BLOCK_CODEC_H */
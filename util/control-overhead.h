@@ -0,0 +1,318 @@
+// Custo do plano de controle por enlace: bytes e pacotes que o RIP, o OSPF,
+// o ARP e o ICMP ocupam em cada enlace, separados do tráfego de dados, em
+// intervalos de tempo fixos, sem ligar o trace ASCII.
+//
+// Cada dispositivo dos nós dados é ligado pelo PhyTxBegin, que traz o
+// quadro inteiro (cabeçalho de enlace incluído) na hora em que ele entra no
+// meio; só transmissões são contadas, então cada quadro conta uma vez no seu
+// enlace. A classe do quadro sai dos primeiros bytes, com o PacketFilter da
+// captura pcap (filtered-pcap.h): rip (UDP 520), ospf (IP 89), arp e icmp;
+// o resto é data. O enlace vem do índice do AddressPlan (address-plan.h).
+//
+// Os contadores do intervalo corrente ficam num vetor denso por (enlace,
+// classe); quando o primeiro quadro de um intervalo novo chega, as entradas
+// não nulas do anterior viram linhas do CSV, sem nenhum evento agendado.
+//
+//   ControlOverhead overhead;
+//   overhead.SetInterval (Seconds (1));
+//   overhead.Install (topology.GetNodes (), topology.GetAddressPlan ());
+//   ...
+//   Simulator::Run ();
+//   overhead.Report (std::cout);
+//   overhead.WriteCsv ("tp2-rip-overhead.csv");
+//
+// CSV: time,link,protocol,packets,bytes,packetsPerSecond,bytesPerSecond, uma
+// linha por intervalo, enlace e classe com algum quadro.
+
+#ifndef CONTROL_OVERHEAD_H
+#define CONTROL_OVERHEAD_H
+
+#include "address-plan.h"
+#include "filtered-pcap.h"
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/csma-module.h"
+#include "ns3/point-to-point-module.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+namespace overhead {
+
+NS_LOG_COMPONENT_DEFINE ("ControlOverhead");
+
+class ControlOverhead
+{
+public:
+  ControlOverhead ()
+    : m_interval (Seconds (1)),
+      m_current (0),
+      m_links (nullptr)
+  {
+    const char *classes[] = {"rip", "ospf", "arp", "icmp"};
+    for (const char *name : classes)
+    {
+      std::string error;
+      m_classes.push_back (Class {name, pcap::PacketFilter ()});
+      m_classes.back ().filter.Parse (name, &error);
+    }
+  }
+
+  void SetInterval (Time interval)
+  {
+    m_interval = interval;
+  }
+
+  // liga os dispositivos dos nós que estão no índice de enlaces
+  void Install (NodeContainer nodes, const AddressPlan &links)
+  {
+    m_links = &links;
+    m_start = Simulator::Now ();
+    m_counters.assign (links.GetNLinks () * GetNClasses (), Counter ());
+    m_totals.assign (m_counters.size (), Counter ());
+    for (NodeContainer::Iterator node = nodes.Begin (); node != nodes.End (); ++node)
+    {
+      for (uint32_t i = 0; i < (*node)->GetNDevices (); ++i)
+      {
+        Ptr<NetDevice> device = (*node)->GetDevice (i);
+        int64_t link = links.FindDevice ((*node)->GetId (), device->GetIfIndex ());
+        uint32_t linkType;
+        if (link < 0)
+        {
+          continue;
+        }
+        if (DynamicCast<CsmaNetDevice> (device))
+        {
+          linkType = pcap::DLT_EN10MB;
+        }
+        else if (DynamicCast<PointToPointNetDevice> (device))
+        {
+          linkType = pcap::DLT_PPP;
+        }
+        else
+        {
+          continue;
+        }
+        m_sinks.emplace_back (new DeviceSink {this, uint32_t (link), linkType});
+        device->TraceConnectWithoutContext ("PhyTxBegin",
+                                            MakeCallback (&DeviceSink::Transmit, m_sinks.back ().get ()));
+      }
+    }
+  }
+
+  // classes de controle mais "data"
+  uint32_t GetNClasses () const
+  {
+    return m_classes.size () + 1;
+  }
+
+  std::string GetClassName (uint32_t index) const
+  {
+    return index < m_classes.size () ? m_classes[index].name : "data";
+  }
+
+  // totais de uma classe em todos os enlaces
+  uint64_t GetPackets (const std::string &protocol) const
+  {
+    return GetTotal (protocol).packets;
+  }
+
+  uint64_t GetBytes (const std::string &protocol) const
+  {
+    return GetTotal (protocol).bytes;
+  }
+
+  // todas as classes menos data
+  uint64_t GetControlBytes () const
+  {
+    uint64_t bytes = 0;
+    for (uint32_t i = 0; i < m_classes.size (); ++i)
+    {
+      bytes += GetTotal (m_classes[i].name).bytes;
+    }
+    return bytes;
+  }
+
+  uint64_t GetControlPackets () const
+  {
+    uint64_t packets = 0;
+    for (uint32_t i = 0; i < m_classes.size (); ++i)
+    {
+      packets += GetTotal (m_classes[i].name).packets;
+    }
+    return packets;
+  }
+
+  // por classe: total, média por enlace e por segundo e o enlace mais carregado
+  void Report (std::ostream &os) const
+  {
+    if (m_links == nullptr)
+    {
+      return;
+    }
+    double seconds = std::max ((Simulator::Now () - m_start).GetSeconds (), 1e-9);
+    uint32_t nLinks = m_links->GetNLinks ();
+    os << "Control overhead on " << nLinks << " links:";
+    for (uint32_t c = 0; c < GetNClasses (); ++c)
+    {
+      Counter total = GetTotal (GetClassName (c));
+      uint32_t busiest = 0;
+      for (uint32_t link = 1; link < nLinks; ++link)
+      {
+        if (m_totals[link * GetNClasses () + c].bytes > m_totals[busiest * GetNClasses () + c].bytes)
+        {
+          busiest = link;
+        }
+      }
+      char line[200];
+      std::snprintf (line, sizeof (line), "\n  %-5s %10llu packets %12llu bytes  %10.1f B/s per link",
+                     GetClassName (c).c_str (), (unsigned long long) total.packets,
+                     (unsigned long long) total.bytes, nLinks ? total.bytes / seconds / nLinks : 0.0);
+      os << line;
+      if (total.bytes > 0)
+      {
+        os << ", busiest " << m_links->GetLink (busiest).name << " "
+           << m_totals[busiest * GetNClasses () + c].bytes / seconds << " B/s";
+      }
+    }
+    os << std::endl;
+  }
+
+  void WriteCsv (std::ostream &os)
+  {
+    Flush ();
+    double seconds = m_interval.GetSeconds ();
+    os << "time,link,protocol,packets,bytes,packetsPerSecond,bytesPerSecond\n";
+    for (const Row &row : m_rows)
+    {
+      os << m_start.GetSeconds () + row.interval * seconds << "," << m_links->GetLink (row.link).name << ","
+         << GetClassName (row.protocol) << "," << row.counter.packets << "," << row.counter.bytes << ","
+         << row.counter.packets / seconds << "," << row.counter.bytes / seconds << "\n";
+    }
+  }
+
+  void WriteCsv (const std::string &path)
+  {
+    std::ofstream out (path);
+    NS_ABORT_MSG_IF (!out, "Cannot write " << path);
+    WriteCsv (out);
+  }
+
+private:
+  struct Class
+  {
+    std::string name;
+    pcap::PacketFilter filter;
+  };
+
+  struct Counter
+  {
+    uint64_t packets;
+    uint64_t bytes;
+  };
+
+  struct Row
+  {
+    uint32_t interval;
+    uint32_t link;
+    uint32_t protocol;
+    Counter counter;
+  };
+
+  struct DeviceSink
+  {
+    ControlOverhead *monitor;
+    uint32_t link;
+    uint32_t linkType;
+
+    void Transmit (Ptr<const Packet> packet)
+    {
+      monitor->Count (link, linkType, packet);
+    }
+  };
+
+  Counter GetTotal (const std::string &protocol) const
+  {
+    Counter total = Counter ();
+    uint32_t c = 0;
+    while (c < m_classes.size () && m_classes[c].name != protocol)
+    {
+      ++c;
+    }
+    if (c == m_classes.size () && protocol != "data")
+    {
+      return total;
+    }
+    for (uint32_t i = c; i < m_totals.size (); i += GetNClasses ())
+    {
+      total.packets += m_totals[i].packets;
+      total.bytes += m_totals[i].bytes;
+    }
+    return total;
+  }
+
+  void Count (uint32_t link, uint32_t linkType, Ptr<const Packet> packet)
+  {
+    uint32_t interval = (Simulator::Now () - m_start).GetInteger () / m_interval.GetInteger ();
+    if (interval != m_current)
+    {
+      Flush ();
+      m_current = interval;
+    }
+    uint8_t head[pcap::FILTER_BYTES];
+    uint32_t size = packet->GetSize ();
+    uint32_t headBytes = packet->CopyData (head, std::min (size, pcap::FILTER_BYTES));
+    uint32_t c = 0;
+    while (c < m_classes.size () && !m_classes[c].filter.Match (head, headBytes, linkType))
+    {
+      ++c;
+    }
+    uint32_t index = link * GetNClasses () + c;
+    if (m_counters[index].packets == 0)
+    {
+      m_touched.push_back (index);
+    }
+    ++m_counters[index].packets;
+    m_counters[index].bytes += size;
+    ++m_totals[index].packets;
+    m_totals[index].bytes += size;
+  }
+
+  // linhas do intervalo corrente, em ordem de enlace e classe
+  void Flush ()
+  {
+    std::sort (m_touched.begin (), m_touched.end ());
+    for (uint32_t index : m_touched)
+    {
+      m_rows.push_back (Row {m_current, index / GetNClasses (), index % GetNClasses (), m_counters[index]});
+      m_counters[index] = Counter ();
+    }
+    m_touched.clear ();
+  }
+
+  Time m_interval;
+  Time m_start;
+  uint32_t m_current; // intervalo dos contadores em m_counters
+  const AddressPlan *m_links;
+  std::vector<Class> m_classes;
+  std::vector<Counter> m_counters; // intervalo corrente, por enlace * GetNClasses () + classe
+  std::vector<Counter> m_totals;
+  std::vector<uint32_t> m_touched; // entradas não nulas de m_counters
+  std::vector<Row> m_rows;
+  std::vector<std::unique_ptr<DeviceSink> > m_sinks;
+};
+
+} // namespace overhead
+
+using overhead::ControlOverhead;
+
+} // namespace ns3
+
+#endif /* CONTROL_OVERHEAD_H */
@@ -0,0 +1,437 @@
+// Mede a reconvergência depois de cada queda e volta de enlace.
+//
+// Plano de controle: nos nós com BatchedRip a mudança de rota é o trace
+// RouteChange, no instante exato; nos nós com OspfRouting, a tabela impressa
+// é comparada com a anterior a cada SpfRun (as LSAs que entram na base pelo
+// LsaInstall só mudam rotas no SPF seguinte). O Rip e o Ipv4GlobalRouting não
+// têm trace source para mudanças de tabela: nos nós com eles (ou com outro
+// protocolo que não os dois acima e a Ipv4StaticRouting) as tabelas são
+// impressas e comparadas a cada intervalo de amostragem, e a resolução dessas
+// mudanças é o intervalo. Nós só com rotas estáticas não são seguidos.
+//
+// Plano de dados: os pacotes dos UdpEchoClient são acompanhados pelo UID do
+// envio até a chegada no UdpEchoServer.
+//
+// Para cada evento registrado com AddEvent, o CSV traz o tempo até a última
+// mudança de rota antes do evento seguinte, o tempo até a primeira entrega
+// depois da primeira perda e os pacotes enviados e perdidos nesse intervalo;
+// a coluna resolution é a resolução do tempo da última mudança (0 quando
+// veio de um trace, o intervalo de amostragem quando veio da amostragem).
+
+#ifndef CONVERGENCE_MONITOR_H
+#define CONVERGENCE_MONITOR_H
+
+#include "batched-rip.h"
+#include "ospf-routing.h"
+#include "route-cache.h"
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+namespace convergence {
+
+NS_LOG_COMPONENT_DEFINE ("ConvergenceMonitor");
+
+class ConvergenceMonitor
+{
+public:
+  ConvergenceMonitor ();
+
+  void SetPollInterval (Time interval);
+  // começa a seguir as tabelas dos nós e os pacotes de eco; chamar depois de
+  // instalar as aplicações e o roteamento
+  void Install (NodeContainer nodes, Time stop);
+  // evento de falha ou recuperação cuja reconvergência será medida
+  void AddEvent (Time at, const std::string &label);
+  // instante (s) da última mudança de rota vista, 0 se nenhuma tabela mudou
+  double GetLastChange () const;
+  // somas, sobre os eventos, das colunas lastRouteChange e lost do CSV
+  double GetTotalConvergence () const;
+  uint32_t GetTotalLost () const;
+
+  void WriteCsv (std::ostream &os) const;
+  void WriteCsv (const std::string &path) const;
+
+private:
+  struct Event
+  {
+    double at;
+    std::string label;
+  };
+
+  struct RouteChange
+  {
+    double at;
+    uint32_t node;
+    bool polled; // vista pela amostragem, não por um trace
+  };
+
+  enum Source
+  {
+    SOURCE_STATIC, // só rotas estáticas: não muda sozinho
+    SOURCE_TRACED, // BatchedRip/OspfRouting
+    SOURCE_POLLED  // Rip, roteamento global ou desconhecido
+  };
+
+  // recebe os traces de roteamento de um nó
+  class NodeWatch
+  {
+  public:
+    NodeWatch (ConvergenceMonitor *monitor, uint32_t index)
+      : m_monitor (monitor),
+        m_index (index)
+    {
+    }
+
+    void RouteChange (Ipv4Address /* network */, Ipv4Mask /* mask */, Ipv4Address /* gateway */,
+                      uint32_t /* interface */, uint32_t /* metric */)
+    {
+      m_monitor->Record (m_index, false);
+    }
+
+    void SpfRun (uint32_t /* routes */)
+    {
+      m_monitor->Compare (m_index, false);
+    }
+
+  private:
+    ConvergenceMonitor *m_monitor;
+    uint32_t m_index;
+  };
+
+  // uma linha do CSV; lastChange e restored < 0 ficam vazios
+  struct Window
+  {
+    std::string label;
+    double start;
+    double lastChange;
+    double resolution;
+    uint32_t changes;
+    double restored;
+    uint32_t sent;
+    uint32_t lost;
+  };
+
+  std::vector<Window> Measure () const;
+  Source Subscribe (Ptr<Ipv4RoutingProtocol> protocol, NodeWatch *watch);
+  void Poll ();
+  void Compare (uint32_t index, bool polled);
+  void Record (uint32_t index, bool polled);
+  std::size_t Fingerprint (Ptr<Node> node) const;
+  void ClientTx (Ptr<const Packet> packet);
+  void ServerRx (Ptr<const Packet> packet);
+
+  Time m_interval;
+  Time m_stop;
+  NodeContainer m_nodes;
+  std::vector<std::size_t> m_fingerprints;
+  std::vector<uint32_t> m_polled; // índices em m_nodes sem trace
+  std::vector<std::unique_ptr<NodeWatch> > m_watches;
+  std::vector<RouteChange> m_changes;
+  std::vector<Event> m_events;
+  std::vector<std::pair<double, uint64_t> > m_sent; // (instante, UID)
+  std::unordered_map<uint64_t, double> m_delivered;
+};
+
+inline
+ConvergenceMonitor::ConvergenceMonitor ()
+  : m_interval (MilliSeconds (100))
+{
+}
+
+inline void
+ConvergenceMonitor::SetPollInterval (Time interval)
+{
+  m_interval = interval;
+}
+
+inline void
+ConvergenceMonitor::Install (NodeContainer nodes, Time stop)
+{
+  m_nodes = nodes;
+  m_stop = stop;
+  m_fingerprints.assign (nodes.GetN (), 0);
+  for (uint32_t i = 0; i < nodes.GetN (); ++i)
+  {
+    Ptr<Ipv4> ipv4 = nodes.Get (i)->GetObject<Ipv4> ();
+    if (ipv4 == nullptr || ipv4->GetRoutingProtocol () == nullptr)
+    {
+      continue;
+    }
+    m_watches.push_back (std::unique_ptr<NodeWatch> (new NodeWatch (this, i)));
+    if (Subscribe (ipv4->GetRoutingProtocol (), m_watches.back ().get ()) == SOURCE_POLLED)
+    {
+      m_polled.push_back (i);
+    }
+  }
+  Config::ConnectWithoutContext ("/NodeList/*/ApplicationList/*/$ns3::UdpEchoClient/Tx",
+                                 MakeCallback (&ConvergenceMonitor::ClientTx, this));
+  Config::ConnectWithoutContext ("/NodeList/*/ApplicationList/*/$ns3::UdpEchoServer/Rx",
+                                 MakeCallback (&ConvergenceMonitor::ServerRx, this));
+  Simulator::ScheduleNow (&ConvergenceMonitor::Poll, this);
+}
+
+// liga os traces do protocolo (direto, dentro da Ipv4ListRouting ou do
+// RouteCache); o pior caso entre os protocolos do nó
+inline ConvergenceMonitor::Source
+ConvergenceMonitor::Subscribe (Ptr<Ipv4RoutingProtocol> protocol, NodeWatch *watch)
+{
+  if (Ptr<Ipv4ListRouting> list = DynamicCast<Ipv4ListRouting> (protocol))
+  {
+    Source source = SOURCE_STATIC;
+    for (uint32_t i = 0; i < list->GetNRoutingProtocols (); ++i)
+    {
+      int16_t priority;
+      source = std::max (source, Subscribe (list->GetRoutingProtocol (i, priority), watch));
+    }
+    return source;
+  }
+  if (Ptr<RouteCache> cache = DynamicCast<RouteCache> (protocol))
+  {
+    return Subscribe (cache->GetRouting (), watch);
+  }
+  if (Ptr<BatchedRip> rip = DynamicCast<BatchedRip> (protocol))
+  {
+    rip->TraceConnectWithoutContext ("RouteChange", MakeCallback (&NodeWatch::RouteChange, watch));
+    return SOURCE_TRACED;
+  }
+  if (Ptr<OspfRouting> ospf = DynamicCast<OspfRouting> (protocol))
+  {
+    ospf->TraceConnectWithoutContext ("SpfRun", MakeCallback (&NodeWatch::SpfRun, watch));
+    return SOURCE_TRACED;
+  }
+  return DynamicCast<Ipv4StaticRouting> (protocol) ? SOURCE_STATIC : SOURCE_POLLED;
+}
+
+inline void
+ConvergenceMonitor::AddEvent (Time at, const std::string &label)
+{
+  m_events.push_back (Event {at.GetSeconds (), label});
+}
+
+inline double
+ConvergenceMonitor::GetLastChange () const
+{
+  return m_changes.empty () ? 0.0 : m_changes.back ().at;
+}
+
+// hash da tabela impressa, sem a linha de cabeçalho que traz o instante
+inline std::size_t
+ConvergenceMonitor::Fingerprint (Ptr<Node> node) const
+{
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  if (ipv4 == nullptr || ipv4->GetRoutingProtocol () == nullptr)
+  {
+    return 0;
+  }
+  std::ostringstream table;
+  Ptr<OutputStreamWrapper> stream = Create<OutputStreamWrapper> (&table);
+  ipv4->GetRoutingProtocol ()->PrintRoutingTable (stream);
+  std::istringstream lines (table.str ());
+  std::string line;
+  std::string routes;
+  while (std::getline (lines, line))
+  {
+    if (line.find ("Time:") == std::string::npos)
+    {
+      routes += line;
+      routes += '\n';
+    }
+  }
+  return std::hash<std::string> () (routes);
+}
+
+// t = 0: referência das tabelas comparadas; depois, só os nós sem trace
+inline void
+ConvergenceMonitor::Poll ()
+{
+  if (Simulator::Now ().IsZero ())
+  {
+    for (uint32_t i = 0; i < m_nodes.GetN (); ++i)
+    {
+      m_fingerprints[i] = Fingerprint (m_nodes.Get (i));
+    }
+  }
+  else
+  {
+    for (uint32_t i : m_polled)
+    {
+      Compare (i, true);
+    }
+  }
+  if (!m_polled.empty () && Simulator::Now () + m_interval <= m_stop)
+  {
+    Simulator::Schedule (m_interval, &ConvergenceMonitor::Poll, this);
+  }
+}
+
+inline void
+ConvergenceMonitor::Compare (uint32_t index, bool polled)
+{
+  std::size_t fingerprint = Fingerprint (m_nodes.Get (index));
+  if (fingerprint != m_fingerprints[index])
+  {
+    m_fingerprints[index] = fingerprint;
+    Record (index, polled);
+  }
+}
+
+// uma mudança por nó e instante, por mais rotas que mudem juntas
+inline void
+ConvergenceMonitor::Record (uint32_t index, bool polled)
+{
+  double now = Simulator::Now ().GetSeconds ();
+  uint32_t node = m_nodes.Get (index)->GetId ();
+  if (now == 0 || (!m_changes.empty () && m_changes.back ().at == now && m_changes.back ().node == node))
+  {
+    return;
+  }
+  NS_LOG_INFO ("Routing table of node " << node << " changed at " << now << " s");
+  m_changes.push_back (RouteChange {now, node, polled});
+}
+
+inline void
+ConvergenceMonitor::ClientTx (Ptr<const Packet> packet)
+{
+  m_sent.emplace_back (Simulator::Now ().GetSeconds (), packet->GetUid ());
+}
+
+inline void
+ConvergenceMonitor::ServerRx (Ptr<const Packet> packet)
+{
+  m_delivered.emplace (packet->GetUid (), Simulator::Now ().GetSeconds ());
+}
+
+inline double
+ConvergenceMonitor::GetTotalConvergence () const
+{
+  double total = 0;
+  for (const Window &window : Measure ())
+  {
+    total += std::max (window.lastChange, 0.0);
+  }
+  return total;
+}
+
+inline uint32_t
+ConvergenceMonitor::GetTotalLost () const
+{
+  uint32_t total = 0;
+  for (const Window &window : Measure ())
+  {
+    total += window.lost;
+  }
+  return total;
+}
+
+inline std::vector<ConvergenceMonitor::Window>
+ConvergenceMonitor::Measure () const
+{
+  std::vector<Event> events (m_events);
+  std::sort (events.begin (), events.end (), [] (const Event &a, const Event &b) { return a.at < b.at; });
+  std::vector<Window> windows;
+  for (std::size_t e = 0; e < events.size (); ++e)
+  {
+    double start = events[e].at;
+    double end = e + 1 < events.size () ? events[e + 1].at : std::numeric_limits<double>::infinity ();
+
+    uint32_t changes = 0;
+    double lastChange = -1;
+    double resolution = 0;
+    for (const RouteChange &change : m_changes)
+    {
+      if (change.at >= start && change.at < end)
+      {
+        ++changes;
+        lastChange = change.at - start;
+        resolution = change.polled ? m_interval.GetSeconds () : 0;
+      }
+    }
+
+    // perda: enviado na janela e nunca entregue; restauração: primeira
+    // entrega de um pacote enviado depois da primeira perda
+    uint32_t sent = 0;
+    uint32_t lost = 0;
+    double firstLoss = -1;
+    double restored = -1;
+    for (const std::pair<double, uint64_t> &packet : m_sent)
+    {
+      if (packet.first < start || packet.first >= end)
+      {
+        continue;
+      }
+      ++sent;
+      std::unordered_map<uint64_t, double>::const_iterator delivery = m_delivered.find (packet.second);
+      if (delivery == m_delivered.end ())
+      {
+        ++lost;
+        if (firstLoss < 0)
+        {
+          firstLoss = packet.first;
+        }
+      }
+      else if (firstLoss >= 0 && (restored < 0 || delivery->second - start < restored))
+      {
+        restored = delivery->second - start;
+      }
+    }
+    if (lost == 0)
+    {
+      restored = 0; // a entrega não chegou a ser interrompida
+    }
+    windows.push_back (Window {events[e].label, start, lastChange, resolution, changes, restored, sent, lost});
+  }
+  return windows;
+}
+
+inline void
+ConvergenceMonitor::WriteCsv (std::ostream &os) const
+{
+  os << "event,time,lastRouteChange,resolution,routeChanges,firstRestoredDelivery,sent,lost" << std::endl;
+  for (const Window &window : Measure ())
+  {
+    os << window.label << "," << window.start << ",";
+    if (window.lastChange >= 0)
+    {
+      os << window.lastChange << "," << window.resolution;
+    }
+    else
+    {
+      os << ",";
+    }
+    os << "," << window.changes << ",";
+    if (window.restored >= 0)
+    {
+      os << window.restored;
+    }
+    os << "," << window.sent << "," << window.lost << std::endl;
+  }
+}
+
+inline void
+ConvergenceMonitor::WriteCsv (const std::string &path) const
+{
+  std::ofstream out (path);
+  NS_ABORT_MSG_IF (!out, "Cannot write " << path);
+  WriteCsv (out);
+}
+
+} // namespace convergence
+
+using convergence::ConvergenceMonitor;
+
+} // namespace ns3
+
+#endif /* CONVERGENCE_MONITOR_H */
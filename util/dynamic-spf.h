@@ -0,0 +1,525 @@
+// Árvores de caminhos mínimos de todos os nós com atualização incremental.
+//
+// O roteamento global do ns-3 (RespondToInterfaceEvents) refaz o LSDB e roda
+// o Dijkstra a partir de todos os roteadores a cada SetDown/SetUp. Aqui cada
+// evento de enlace só mexe nas árvores que ele afeta:
+//
+//  - enlace cai ou fica mais caro: só as origens cuja árvore usa o enlace
+//    são refeitas, e só na subárvore pendurada nele (os nós dela são
+//    reinicializados e o Dijkstra recomeça a partir dos vizinhos de fora);
+//  - enlace volta ou fica mais barato: só as origens para as quais ele
+//    encurta a distância até uma das pontas, propagando a melhora a partir
+//    dessa ponta.
+//
+// Os enlaces são bidirecionais com o mesmo custo nos dois sentidos (a
+// métrica do TopologySpec). Não depende do ns-3.
+//
+// Memória: distância, enlace pai e primeiro salto ficam em matrizes densas
+// origem x nó, 12 bytes por par (1,2 GB com 10 mil nós). CheckSize recusa
+// topologias acima de MAX_NODES nós (cerca de 800 MB); quem constrói um
+// DynamicSpf deve chamá-lo antes.
+
+#ifndef DYNAMIC_SPF_H
+#define DYNAMIC_SPF_H
+
+#include "topology-spec.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+class DynamicSpf
+{
+public:
+  static const uint32_t INFINITE_DISTANCE = UINT32_MAX;
+  static const int32_t NO_LINK = -1;
+  static const uint32_t MAX_NODES = 8192;
+  static const uint32_t BYTES_PER_PAIR = 12;
+
+  explicit DynamicSpf (const TopologySpec &spec);
+
+  // false, com a memória que as matrizes ocupariam, se a topologia tiver
+  // mais de MAX_NODES nós
+  static bool CheckSize (const TopologySpec &spec, std::string *error);
+
+  uint32_t GetNNodes () const;
+  uint32_t GetNLinks () const;
+
+  // Dijkstra a partir de todas as origens (o que o ns-3 faz a cada evento)
+  void ComputeAll ();
+
+  // devolvem quantas origens tiveram algum primeiro salto alterado
+  uint32_t SetLinkUp (uint32_t link, bool up);
+  uint32_t SetLinkMetric (uint32_t link, uint32_t metric);
+  // só muda o estado do enlace, sem atualizar as árvores (para ComputeAll)
+  void SetLinkState (uint32_t link, bool up);
+
+  bool IsLinkUp (uint32_t link) const;
+  uint32_t GetLinkMetric (uint32_t link) const;
+  uint32_t GetLinkEnd (uint32_t link, uint32_t side) const;
+
+  uint32_t GetDistance (uint32_t source, uint32_t destination) const;
+  // enlace por onde a origem sai para chegar ao destino (NO_LINK se for a
+  // própria origem ou se o destino estiver inalcançável)
+  int32_t GetFirstHop (uint32_t source, uint32_t destination) const;
+
+  // origens com primeiro salto alterado na última atualização
+  const std::vector<uint32_t> &GetChangedSources () const;
+  // origens processadas e nós retirados do heap na última atualização ou
+  // no último ComputeAll, como medida do trabalho feito
+  uint32_t GetLastSources () const;
+  uint64_t GetLastSettled () const;
+
+private:
+  struct Adjacency
+  {
+    uint32_t neighbor;
+    uint32_t link;
+  };
+
+  typedef std::pair<uint32_t, uint32_t> HeapEntry; // (distância, nó)
+  typedef std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry> > Heap;
+
+  std::size_t Index (uint32_t source, uint32_t node) const;
+  uint32_t Other (uint32_t link, uint32_t node) const;
+  void ComputeSource (uint32_t source);
+  void Run (uint32_t source, Heap &heap);
+  void Touch (uint32_t source, uint32_t node);
+  void Set (uint32_t source, uint32_t node, uint32_t distance, uint32_t link, uint32_t via);
+  void BeginSource ();
+  void EndSource (uint32_t source);
+  void BeginUpdate ();
+  // enlace com custo maior ou fora do ar
+  void Worsen (uint32_t link);
+  // enlace com custo menor ou de volta
+  void Improve (uint32_t link);
+
+  uint32_t m_nNodes;
+  std::vector<std::vector<Adjacency> > m_adjacency;
+  std::vector<uint32_t> m_linkEnds; // 2 por enlace
+  std::vector<uint32_t> m_metric;
+  std::vector<bool> m_up;
+
+  // matrizes origem x nó
+  std::vector<uint32_t> m_distance;
+  std::vector<int32_t> m_parentLink;
+  std::vector<int32_t> m_firstHop;
+
+  // nós alterados na origem corrente, com o primeiro salto anterior
+  std::vector<std::pair<uint32_t, int32_t> > m_touched;
+  std::vector<uint32_t> m_stamp;
+  uint32_t m_epoch;
+  std::vector<uint8_t> m_mark;
+  std::vector<uint32_t> m_path;
+
+  std::vector<uint32_t> m_changed;
+  uint32_t m_lastSources;
+  uint64_t m_lastSettled;
+};
+
+inline
+DynamicSpf::DynamicSpf (const TopologySpec &spec)
+  : m_nNodes (spec.nodes.size ()),
+    m_adjacency (spec.nodes.size ()),
+    m_up (spec.links.size (), true),
+    m_stamp (spec.nodes.size (), 0),
+    m_epoch (0),
+    m_mark (spec.nodes.size (), 0),
+    m_lastSources (0),
+    m_lastSettled (0)
+{
+  for (uint32_t i = 0; i < spec.links.size (); ++i)
+  {
+    const TopologyLinkSpec &link = spec.links[i];
+    m_linkEnds.push_back (link.a);
+    m_linkEnds.push_back (link.b);
+    m_metric.push_back (link.metric);
+    m_adjacency[link.a].push_back (Adjacency {link.b, i});
+    m_adjacency[link.b].push_back (Adjacency {link.a, i});
+  }
+  std::size_t cells = (std::size_t) m_nNodes * m_nNodes;
+  m_distance.assign (cells, uint32_t (INFINITE_DISTANCE));
+  m_parentLink.assign (cells, int32_t (NO_LINK));
+  m_firstHop.assign (cells, int32_t (NO_LINK));
+}
+
+inline bool
+DynamicSpf::CheckSize (const TopologySpec &spec, std::string *error)
+{
+  if (spec.nodes.size () <= MAX_NODES)
+  {
+    return true;
+  }
+  if (error)
+  {
+    uint64_t bytes = uint64_t (BYTES_PER_PAIR) * spec.nodes.size () * spec.nodes.size ();
+    *error = "SPF incremental: " + std::to_string (spec.nodes.size ()) + " nos precisariam de "
+             + std::to_string (bytes >> 20) + " MiB (limite de " + std::to_string (MAX_NODES) + " nos)";
+  }
+  return false;
+}
+
+inline uint32_t
+DynamicSpf::GetNNodes () const
+{
+  return m_nNodes;
+}
+
+inline uint32_t
+DynamicSpf::GetNLinks () const
+{
+  return m_metric.size ();
+}
+
+inline bool
+DynamicSpf::IsLinkUp (uint32_t link) const
+{
+  return m_up[link];
+}
+
+inline uint32_t
+DynamicSpf::GetLinkMetric (uint32_t link) const
+{
+  return m_metric[link];
+}
+
+inline uint32_t
+DynamicSpf::GetLinkEnd (uint32_t link, uint32_t side) const
+{
+  return m_linkEnds[2 * link + side];
+}
+
+inline std::size_t
+DynamicSpf::Index (uint32_t source, uint32_t node) const
+{
+  return (std::size_t) source * m_nNodes + node;
+}
+
+inline uint32_t
+DynamicSpf::Other (uint32_t link, uint32_t node) const
+{
+  return m_linkEnds[2 * link] == node ? m_linkEnds[2 * link + 1] : m_linkEnds[2 * link];
+}
+
+inline uint32_t
+DynamicSpf::GetDistance (uint32_t source, uint32_t destination) const
+{
+  return m_distance[Index (source, destination)];
+}
+
+inline int32_t
+DynamicSpf::GetFirstHop (uint32_t source, uint32_t destination) const
+{
+  return m_firstHop[Index (source, destination)];
+}
+
+inline const std::vector<uint32_t> &
+DynamicSpf::GetChangedSources () const
+{
+  return m_changed;
+}
+
+inline uint32_t
+DynamicSpf::GetLastSources () const
+{
+  return m_lastSources;
+}
+
+inline uint64_t
+DynamicSpf::GetLastSettled () const
+{
+  return m_lastSettled;
+}
+
+inline void
+DynamicSpf::Touch (uint32_t source, uint32_t node)
+{
+  if (m_stamp[node] != m_epoch)
+  {
+    m_stamp[node] = m_epoch;
+    m_touched.emplace_back (node, m_firstHop[Index (source, node)]);
+  }
+}
+
+// node passa a ser alcançado com a distância dada pelo enlace link, vindo de via
+inline void
+DynamicSpf::Set (uint32_t source, uint32_t node, uint32_t distance, uint32_t link, uint32_t via)
+{
+  Touch (source, node);
+  std::size_t i = Index (source, node);
+  m_distance[i] = distance;
+  m_parentLink[i] = link;
+  m_firstHop[i] = via == source ? (int32_t) link : m_firstHop[Index (source, via)];
+}
+
+inline void
+DynamicSpf::Run (uint32_t source, Heap &heap)
+{
+  while (!heap.empty ())
+  {
+    HeapEntry top = heap.top ();
+    heap.pop ();
+    uint32_t node = top.second;
+    if (top.first != m_distance[Index (source, node)])
+    {
+      continue;
+    }
+    ++m_lastSettled;
+    for (const Adjacency &adjacency : m_adjacency[node])
+    {
+      if (!m_up[adjacency.link])
+      {
+        continue;
+      }
+      uint32_t distance = top.first + m_metric[adjacency.link];
+      if (distance < m_distance[Index (source, adjacency.neighbor)])
+      {
+        Set (source, adjacency.neighbor, distance, adjacency.link, node);
+        heap.emplace (distance, adjacency.neighbor);
+      }
+    }
+  }
+}
+
+inline void
+DynamicSpf::ComputeSource (uint32_t source)
+{
+  std::size_t base = Index (source, 0);
+  std::fill (m_distance.begin () + base, m_distance.begin () + base + m_nNodes, uint32_t (INFINITE_DISTANCE));
+  std::fill (m_parentLink.begin () + base, m_parentLink.begin () + base + m_nNodes, int32_t (NO_LINK));
+  std::fill (m_firstHop.begin () + base, m_firstHop.begin () + base + m_nNodes, int32_t (NO_LINK));
+  m_distance[base + source] = 0;
+  Heap heap;
+  heap.emplace (0, source);
+  Run (source, heap);
+}
+
+inline void
+DynamicSpf::ComputeAll ()
+{
+  BeginUpdate ();
+  for (uint32_t source = 0; source < m_nNodes; ++source)
+  {
+    BeginSource ();
+    ComputeSource (source);
+    m_touched.clear ();
+    m_changed.push_back (source);
+  }
+  m_lastSources = m_nNodes;
+}
+
+inline void
+DynamicSpf::BeginUpdate ()
+{
+  m_changed.clear ();
+  m_lastSources = 0;
+  m_lastSettled = 0;
+}
+
+inline void
+DynamicSpf::BeginSource ()
+{
+  m_touched.clear ();
+  if (++m_epoch == 0)
+  {
+    std::fill (m_stamp.begin (), m_stamp.end (), 0);
+    m_epoch = 1;
+  }
+  ++m_lastSources;
+}
+
+inline void
+DynamicSpf::EndSource (uint32_t source)
+{
+  for (const std::pair<uint32_t, int32_t> &touched : m_touched)
+  {
+    if (m_firstHop[Index (source, touched.first)] != touched.second)
+    {
+      m_changed.push_back (source);
+      break;
+    }
+  }
+}
+
+inline void
+DynamicSpf::Worsen (uint32_t link)
+{
+  uint32_t u = m_linkEnds[2 * link];
+  uint32_t v = m_linkEnds[2 * link + 1];
+  std::vector<uint32_t> subtree;
+  for (uint32_t source = 0; source < m_nNodes; ++source)
+  {
+    uint32_t root;
+    if (m_parentLink[Index (source, v)] == (int32_t) link)
+    {
+      root = v;
+    }
+    else if (m_parentLink[Index (source, u)] == (int32_t) link)
+    {
+      root = u;
+    }
+    else
+    {
+      continue; // a árvore desta origem não usa o enlace
+    }
+    BeginSource ();
+
+    // subárvore abaixo de root: sobe pelos pais de cada nó até achar um nó
+    // já classificado (1 = dentro, 2 = fora), memorizando o caminho
+    std::fill (m_mark.begin (), m_mark.end (), 0);
+    m_mark[root] = 1;
+    m_mark[source] = 2;
+    subtree.clear ();
+    for (uint32_t node = 0; node < m_nNodes; ++node)
+    {
+      uint32_t current = node;
+      m_path.clear ();
+      while (m_mark[current] == 0)
+      {
+        int32_t parent = m_parentLink[Index (source, current)];
+        if (parent == NO_LINK)
+        {
+          m_mark[current] = 2;
+          break;
+        }
+        m_path.push_back (current);
+        current = Other (parent, current);
+      }
+      for (uint32_t onPath : m_path)
+      {
+        m_mark[onPath] = m_mark[current];
+      }
+      if (m_mark[node] == 1)
+      {
+        subtree.push_back (node);
+      }
+    }
+
+    for (uint32_t node : subtree)
+    {
+      Touch (source, node);
+      std::size_t i = Index (source, node);
+      m_distance[i] = INFINITE_DISTANCE;
+      m_parentLink[i] = NO_LINK;
+      m_firstHop[i] = NO_LINK;
+    }
+    // semeia a subárvore pelos vizinhos de fora dela
+    Heap heap;
+    for (uint32_t node : subtree)
+    {
+      std::size_t i = Index (source, node);
+      for (const Adjacency &adjacency : m_adjacency[node])
+      {
+        uint32_t distance = m_distance[Index (source, adjacency.neighbor)];
+        if (!m_up[adjacency.link] || m_mark[adjacency.neighbor] == 1 || distance == INFINITE_DISTANCE)
+        {
+          continue;
+        }
+        distance += m_metric[adjacency.link];
+        if (distance < m_distance[i])
+        {
+          Set (source, node, distance, adjacency.link, adjacency.neighbor);
+        }
+      }
+      if (m_distance[i] != INFINITE_DISTANCE)
+      {
+        heap.emplace (m_distance[i], node);
+      }
+    }
+    Run (source, heap);
+    EndSource (source);
+  }
+}
+
+inline void
+DynamicSpf::Improve (uint32_t link)
+{
+  uint32_t u = m_linkEnds[2 * link];
+  uint32_t v = m_linkEnds[2 * link + 1];
+  uint32_t metric = m_metric[link];
+  for (uint32_t source = 0; source < m_nNodes; ++source)
+  {
+    uint32_t du = m_distance[Index (source, u)];
+    uint32_t dv = m_distance[Index (source, v)];
+    uint32_t from;
+    uint32_t to;
+    if (du != INFINITE_DISTANCE && du + metric < dv)
+    {
+      from = u;
+      to = v;
+    }
+    else if (dv != INFINITE_DISTANCE && dv + metric < du)
+    {
+      from = v;
+      to = u;
+    }
+    else
+    {
+      continue; // o enlace não encurta nenhum caminho desta origem
+    }
+    BeginSource ();
+    uint32_t distance = m_distance[Index (source, from)] + metric;
+    Set (source, to, distance, link, from);
+    Heap heap;
+    heap.emplace (distance, to);
+    Run (source, heap);
+    EndSource (source);
+  }
+}
+
+inline uint32_t
+DynamicSpf::SetLinkUp (uint32_t link, bool up)
+{
+  BeginUpdate ();
+  if (m_up[link] == up)
+  {
+    return 0;
+  }
+  m_up[link] = up;
+  if (up)
+  {
+    Improve (link);
+  }
+  else
+  {
+    Worsen (link);
+  }
+  return m_changed.size ();
+}
+
+inline void
+DynamicSpf::SetLinkState (uint32_t link, bool up)
+{
+  m_up[link] = up;
+}
+
+inline uint32_t
+DynamicSpf::SetLinkMetric (uint32_t link, uint32_t metric)
+{
+  BeginUpdate ();
+  uint32_t old = m_metric[link];
+  m_metric[link] = metric;
+  if (!m_up[link] || metric == old)
+  {
+    return 0;
+  }
+  if (metric < old)
+  {
+    Improve (link);
+  }
+  else
+  {
+    Worsen (link);
+  }
+  return m_changed.size ();
+}
+
+} // namespace ns3
+
+#endif /* DYNAMIC_SPF_H */
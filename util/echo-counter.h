@@ -0,0 +1,80 @@
+// Conta os pacotes das aplicações de eco (UdpEchoClient/UdpEchoServer) de
+// todos os nós, para as métricas de entrega gravadas em --results.
+
+#ifndef ECHO_COUNTER_H
+#define ECHO_COUNTER_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+
+namespace ns3 {
+
+class EchoCounter
+{
+public:
+  EchoCounter ()
+    : m_sent (0),
+      m_delivered (0),
+      m_echoed (0)
+  {
+  }
+
+  // deve ser chamado depois de instalar as aplicações, pois os caminhos do
+  // Config são resolvidos na hora da conexão
+  void Install ()
+  {
+    Config::ConnectWithoutContext ("/NodeList/*/ApplicationList/*/$ns3::UdpEchoClient/Tx",
+                                   MakeCallback (&EchoCounter::ClientTx, this));
+    Config::ConnectWithoutContext ("/NodeList/*/ApplicationList/*/$ns3::UdpEchoServer/Rx",
+                                   MakeCallback (&EchoCounter::ServerRx, this));
+    Config::ConnectWithoutContext ("/NodeList/*/ApplicationList/*/$ns3::UdpEchoClient/Rx",
+                                   MakeCallback (&EchoCounter::ClientRx, this));
+  }
+
+  // requisições enviadas pelos clientes
+  uint64_t GetSent () const
+  {
+    return m_sent;
+  }
+
+  // requisições que chegaram ao servidor
+  uint64_t GetDelivered () const
+  {
+    return m_delivered;
+  }
+
+  // respostas que voltaram aos clientes
+  uint64_t GetEchoed () const
+  {
+    return m_echoed;
+  }
+
+  double GetDeliveryRatio () const
+  {
+    return m_sent ? double (m_delivered) / m_sent : 0.0;
+  }
+
+private:
+  void ClientTx (Ptr<const Packet>)
+  {
+    ++m_sent;
+  }
+
+  void ServerRx (Ptr<const Packet>)
+  {
+    ++m_delivered;
+  }
+
+  void ClientRx (Ptr<const Packet>)
+  {
+    ++m_echoed;
+  }
+
+  uint64_t m_sent;
+  uint64_t m_delivered;
+  uint64_t m_echoed;
+};
+
+} // namespace ns3
+
+#endif /* ECHO_COUNTER_H */
@@ -0,0 +1,398 @@
+// ECMP por fluxo para o roteamento global: quando a Ipv4GlobalRouting tem
+// mais de uma rota de mesmo custo para o destino (o SPF do
+// GlobalRouteManager instala uma por saída), o próximo salto é escolhido por
+// um hash da quíntupla (origem, destino, protocolo, portas) em vez do sorteio
+// por pacote do RandomEcmpRouting. Pacotes do mesmo fluxo seguem o mesmo
+// caminho (sem reordenação) e fluxos diferentes se espalham pelos caminhos.
+//
+// Nos pacotes repassados as portas vêm do cabeçalho UDP/TCP. Nos gerados no
+// próprio nó o RouteOutput acontece antes do cabeçalho de transporte; ali as
+// portas vêm do FlowLabelTag (o TrafficSource o coloca, como o flow label do
+// IPv6) e, sem ele, o hash usa só endereços e protocolo. O hash de cada nó leva
+// o id do nó, para que nós em sequência não escolham sempre a mesma posição
+// (polarização).
+//
+// Os conjuntos de próximos saltos de mesmo custo de cada destino são montados
+// uma vez por versão da tabela, numa PrefixTrie (prefix-trie.h) com as
+// Ipv4Route já prontas; o pacote só busca o maior prefixo e escolhe pelo hash.
+// As tabelas do roteamento global mudam por fora da Ipv4GlobalRouting (o
+// GlobalRouteManager reescreve as de todos os nós), então a versão é uma só
+// para todos os nós: avança nos Notify* de qualquer nó (onde o
+// RespondToInterfaceEvents recalcula tudo) e em InvalidateAll, que quem
+// reescreve rotas chama (TopologyLoader, IncrementalGlobalRouting). Um número
+// de rotas diferente do da montagem também refaz os conjuntos.
+//
+//   TopologyLoader topology;
+//   topology.SetRouting (TopologyLoader::ROUTING_GLOBAL);
+//   topology.SetFlowHashEcmp (true);
+//   ...
+//   FlowHashEcmpRouting::Report (std::cout, topology.GetNodes ());
+
+#ifndef ECMP_ROUTING_H
+#define ECMP_ROUTING_H
+
+#include "prefix-trie.h"
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/global-router-interface.h"
+#include "ns3/ipv4-list-routing.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+namespace ecmp {
+
+NS_LOG_COMPONENT_DEFINE ("FlowHashEcmpRouting");
+
+// portas de origem e destino do fluxo, para o RouteOutput de pacotes que ainda
+// não têm o cabeçalho de transporte
+class FlowLabelTag : public Tag
+{
+public:
+  FlowLabelTag ()
+    : m_label (0)
+  {
+  }
+
+  FlowLabelTag (uint16_t sourcePort, uint16_t destinationPort)
+    : m_label ((uint32_t (sourcePort) << 16) | destinationPort)
+  {
+  }
+
+  static TypeId GetTypeId ()
+  {
+    static TypeId tid = TypeId ("ns3::FlowLabelTag").SetParent<Tag> ().AddConstructor<FlowLabelTag> ();
+    return tid;
+  }
+
+  TypeId GetInstanceTypeId () const override
+  {
+    return GetTypeId ();
+  }
+
+  uint32_t GetSerializedSize () const override
+  {
+    return 4;
+  }
+
+  void Serialize (TagBuffer buffer) const override
+  {
+    buffer.WriteU32 (m_label);
+  }
+
+  void Deserialize (TagBuffer buffer) override
+  {
+    m_label = buffer.ReadU32 ();
+  }
+
+  void Print (std::ostream &os) const override
+  {
+    os << "ports=" << (m_label >> 16) << ":" << (m_label & 0xffff);
+  }
+
+  // as portas na ordem do cabeçalho UDP/TCP
+  uint32_t GetLabel () const
+  {
+    return m_label;
+  }
+
+private:
+  uint32_t m_label;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (FlowLabelTag);
+
+class FlowHashEcmpRouting : public Ipv4GlobalRouting
+{
+public:
+  static TypeId GetTypeId ()
+  {
+    static TypeId tid =
+      TypeId ("ns3::FlowHashEcmpRouting").SetParent<Ipv4GlobalRouting> ().AddConstructor<FlowHashEcmpRouting> ();
+    return tid;
+  }
+
+  FlowHashEcmpRouting ()
+    : m_salt (0),
+      m_decisions (0),
+      m_version (0),
+      m_routeCount (0)
+  {
+  }
+
+  // as tabelas de algum nó mudaram: os conjuntos de todos são refeitos na
+  // próxima busca
+  static void InvalidateAll ()
+  {
+    ++GetTableVersion ();
+  }
+
+  void NotifyInterfaceUp (uint32_t interface) override
+  {
+    InvalidateAll ();
+    Ipv4GlobalRouting::NotifyInterfaceUp (interface);
+  }
+
+  void NotifyInterfaceDown (uint32_t interface) override
+  {
+    InvalidateAll ();
+    Ipv4GlobalRouting::NotifyInterfaceDown (interface);
+  }
+
+  void NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address) override
+  {
+    InvalidateAll ();
+    Ipv4GlobalRouting::NotifyAddAddress (interface, address);
+  }
+
+  void NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address) override
+  {
+    InvalidateAll ();
+    Ipv4GlobalRouting::NotifyRemoveAddress (interface, address);
+  }
+
+  void SetIpv4 (Ptr<Ipv4> ipv4) override
+  {
+    m_ipv4 = ipv4;
+    Ipv4GlobalRouting::SetIpv4 (ipv4);
+  }
+
+  Ptr<Ipv4Route> RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif,
+                              Socket::SocketErrno &sockerr) override
+  {
+    if (oif == nullptr && !header.GetDestination ().IsMulticast ())
+    {
+      FlowLabelTag tag;
+      Ptr<Ipv4Route> route = Lookup (header, nullptr, p && p->PeekPacketTag (tag) ? tag.GetLabel () : 0);
+      if (route)
+      {
+        sockerr = Socket::ERROR_NOTERROR;
+        return route;
+      }
+    }
+    return Ipv4GlobalRouting::RouteOutput (p, header, oif, sockerr);
+  }
+
+  bool RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev,
+                   UnicastForwardCallback ucb, MulticastForwardCallback mcb, LocalDeliverCallback lcb,
+                   ErrorCallback ecb) override
+  {
+    uint32_t iif = m_ipv4->GetInterfaceForDevice (idev);
+    Ipv4Address destination = header.GetDestination ();
+    if (!destination.IsMulticast () && !destination.IsBroadcast () && !m_ipv4->IsDestinationAddress (destination, iif)
+        && m_ipv4->IsForwarding (iif))
+    {
+      Ptr<Ipv4Route> route = Lookup (header, p, 0);
+      if (route)
+      {
+        ucb (route, p, header);
+        return true;
+      }
+    }
+    // entrega local, multicast e destinos com uma rota só: como no Ipv4GlobalRouting
+    return Ipv4GlobalRouting::RouteInput (p, header, idev, ucb, mcb, lcb, ecb);
+  }
+
+  // escolhas entre rotas de mesmo custo, por interface de saída
+  const std::map<uint32_t, uint64_t> &GetInterfaceCounts () const
+  {
+    return m_interfaceCounts;
+  }
+
+  uint64_t GetDecisions () const
+  {
+    return m_decisions;
+  }
+
+  // pacotes por saída em cada nó que dividiu tráfego e o equilíbrio (índice de
+  // Jain: 1 = dividido por igual, 1/n = tudo numa saída)
+  static void Report (std::ostream &os, NodeContainer nodes)
+  {
+    char line[128];
+    for (uint32_t i = 0; i < nodes.GetN (); ++i)
+    {
+      Ptr<FlowHashEcmpRouting> routing = Find (nodes.Get (i));
+      if (routing == nullptr || routing->m_interfaceCounts.size () < 2)
+      {
+        continue;
+      }
+      double sum = 0;
+      double squares = 0;
+      os << "ECMP node " << nodes.Get (i)->GetId () << ":";
+      for (const auto &count : routing->m_interfaceCounts)
+      {
+        os << " if" << count.first << "=" << count.second;
+        sum += count.second;
+        squares += double (count.second) * count.second;
+      }
+      std::snprintf (line, sizeof (line), " (balance %.3f)\n",
+                     squares > 0 ? sum * sum / (routing->m_interfaceCounts.size () * squares) : 0.0);
+      os << line;
+    }
+  }
+
+  // a FlowHashEcmpRouting do nó, direta ou dentro da Ipv4ListRouting
+  static Ptr<FlowHashEcmpRouting> Find (Ptr<Node> node)
+  {
+    Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+    Ptr<Ipv4RoutingProtocol> protocol = ipv4 ? ipv4->GetRoutingProtocol () : nullptr;
+    if (Ptr<Ipv4ListRouting> list = DynamicCast<Ipv4ListRouting> (protocol))
+    {
+      for (uint32_t i = 0; i < list->GetNRoutingProtocols (); ++i)
+      {
+        int16_t priority;
+        if (Ptr<FlowHashEcmpRouting> routing = DynamicCast<FlowHashEcmpRouting> (list->GetRoutingProtocol (i, priority)))
+        {
+          return routing;
+        }
+      }
+      return nullptr;
+    }
+    return DynamicCast<FlowHashEcmpRouting> (protocol);
+  }
+
+private:
+  struct NextHop
+  {
+    uint32_t interface;
+    Ptr<Ipv4Route> route;
+  };
+
+  // versão das tabelas do roteamento global, comum a todos os nós
+  static uint64_t &GetTableVersion ()
+  {
+    static uint64_t version = 1;
+    return version;
+  }
+
+  // agrupa as rotas da tabela por prefixo, com as Ipv4Route de cada uma
+  void BuildGroups ()
+  {
+    m_version = GetTableVersion ();
+    m_routeCount = GetNRoutes ();
+    m_groups.clear ();
+    m_trie.Clear ();
+    std::map<std::pair<uint32_t, uint8_t>, std::vector<NextHop> > prefixes;
+    for (uint32_t i = 0; i < m_routeCount; ++i)
+    {
+      Ipv4RoutingTableEntry *entry = GetRoute (i);
+      uint8_t length = PrefixTrie<uint32_t>::GetPrefixLength (entry->GetDestNetworkMask ().Get ());
+      uint32_t network = entry->GetDestNetwork ().Get () & entry->GetDestNetworkMask ().Get ();
+      uint32_t interface = entry->GetInterface ();
+      Ptr<Ipv4Route> route = Create<Ipv4Route> ();
+      route->SetDestination (entry->GetDest ());
+      route->SetSource (m_ipv4->GetAddress (interface, 0).GetLocal ());
+      route->SetGateway (entry->GetGateway ());
+      route->SetOutputDevice (m_ipv4->GetNetDevice (interface));
+      prefixes[std::make_pair (network, length)].push_back (NextHop {interface, route});
+    }
+    for (std::pair<const std::pair<uint32_t, uint8_t>, std::vector<NextHop> > &prefix : prefixes)
+    {
+      m_trie.Insert (prefix.first.first, prefix.first.second, m_groups.size ());
+      m_groups.push_back (std::vector<NextHop> ());
+      m_groups.back ().swap (prefix.second);
+    }
+  }
+
+  // rota pelo hash do fluxo entre as de maior prefixo; nula se houver uma só
+  // (o Ipv4GlobalRouting resolve) ou nenhuma. 'packet' começa no cabeçalho de
+  // transporte (RouteInput); sem ele, 'ports' vem do FlowLabelTag
+  Ptr<Ipv4Route> Lookup (const Ipv4Header &header, Ptr<const Packet> packet, uint32_t ports)
+  {
+    if (m_version != GetTableVersion () || m_routeCount != GetNRoutes ())
+    {
+      BuildGroups ();
+    }
+    uint32_t destination = header.GetDestination ().Get ();
+    const uint32_t *group = m_trie.Lookup (destination);
+    if (group == nullptr || m_groups[*group].size () < 2)
+    {
+      return nullptr;
+    }
+    const std::vector<NextHop> &candidates = m_groups[*group];
+
+    // origem, destino, salt, portas (os 4 primeiros bytes de UDP e TCP) e protocolo
+    uint8_t key[17] = {0};
+    uint32_t source = header.GetSource ().Get ();
+    for (uint32_t b = 0; b < 4; ++b)
+    {
+      key[b] = source >> (24 - 8 * b);
+      key[4 + b] = destination >> (24 - 8 * b);
+      key[8 + b] = m_salt >> (24 - 8 * b);
+      key[12 + b] = ports >> (24 - 8 * b);
+    }
+    if (packet && (header.GetProtocol () == UdpL4Protocol::PROT_NUMBER || header.GetProtocol () == 6)
+        && packet->GetSize () >= 4)
+    {
+      packet->CopyData (key + 12, 4);
+    }
+    key[16] = header.GetProtocol ();
+    uint32_t hash = Hash32 (reinterpret_cast<const char *> (key), sizeof (key));
+    const NextHop &hop = candidates[hash % candidates.size ()];
+    ++m_interfaceCounts[hop.interface];
+    ++m_decisions;
+    return hop.route;
+  }
+
+  void DoInitialize () override
+  {
+    m_salt = m_ipv4 ? m_ipv4->GetObject<Node> ()->GetId () : 0;
+    Ipv4GlobalRouting::DoInitialize ();
+  }
+
+  void DoDispose () override
+  {
+    m_groups.clear ();
+    m_trie.Clear ();
+    m_ipv4 = nullptr;
+    Ipv4GlobalRouting::DoDispose ();
+  }
+
+  Ptr<Ipv4> m_ipv4;
+  uint32_t m_salt;
+  std::map<uint32_t, uint64_t> m_interfaceCounts;
+  uint64_t m_decisions;
+  uint64_t m_version;    // GetTableVersion dos conjuntos montados
+  uint32_t m_routeCount; // GetNRoutes na montagem
+  std::vector<std::vector<NextHop> > m_groups;
+  PrefixTrie<uint32_t> m_trie; // prefixo -> índice em m_groups
+};
+
+NS_OBJECT_ENSURE_REGISTERED (FlowHashEcmpRouting);
+
+// como o Ipv4GlobalRoutingHelper, mas com a FlowHashEcmpRouting
+class FlowHashEcmpHelper : public Ipv4RoutingHelper
+{
+public:
+  FlowHashEcmpHelper *Copy () const override
+  {
+    return new FlowHashEcmpHelper (*this);
+  }
+
+  Ptr<Ipv4RoutingProtocol> Create (Ptr<Node> node) const override
+  {
+    Ptr<GlobalRouter> globalRouter = CreateObject<GlobalRouter> ();
+    node->AggregateObject (globalRouter);
+    Ptr<FlowHashEcmpRouting> routing = CreateObject<FlowHashEcmpRouting> ();
+    globalRouter->SetRoutingProtocol (routing);
+    return routing;
+  }
+};
+
+} // namespace ecmp
+
+using ecmp::FlowHashEcmpHelper;
+using ecmp::FlowHashEcmpRouting;
+using ecmp::FlowLabelTag;
+
+} // namespace ns3
+
+#endif /* ECMP_ROUTING_H */
@@ -0,0 +1,210 @@
+// Liga o EventLogWriter (event-log.h) aos traces da pilha IP e do
+// roteamento de cada nó: Tx, Rx, Drop, UnicastForward e LocalDeliver do
+// Ipv4L3Protocol, Drop do ArpL3Protocol, RouteChange da BatchedRip e
+// LsaInstall e SpfRun da OspfRouting. São os pontos que o LOG_LEVEL_ALL
+// dos cenários descrevia em texto, agora em registros de 40 bytes.
+//
+//   EventLogHelper eventLog;
+//   eventLog.Open ("tp2-rip.evl");
+//   eventLog.EnableAll ();
+//   ...
+//   Simulator::Run ();
+//   eventLog.Close ();
+//
+// O arquivo é lido com tools/log_dump.cc.
+
+#ifndef EVENT_LOG_HELPER_H
+#define EVENT_LOG_HELPER_H
+
+#include "batched-rip.h"
+#include "event-log.h"
+#include "ospf-routing.h"
+#include "route-cache.h"
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+namespace eventlog {
+
+NS_LOG_COMPONENT_DEFINE ("EventLogHelper");
+
+class EventLogHelper
+{
+public:
+  void Open (const std::string &path)
+  {
+    std::string error;
+    if (!m_writer.Open (path, &error))
+    {
+      NS_FATAL_ERROR (error);
+    }
+  }
+
+  // todos os nós criados até aqui
+  void EnableAll ()
+  {
+    for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); ++node)
+    {
+      Enable (*node);
+    }
+  }
+
+  void Enable (Ptr<Node> node)
+  {
+    Ptr<Ipv4L3Protocol> ipv4 = node->GetObject<Ipv4L3Protocol> ();
+    if (ipv4 == nullptr)
+    {
+      return;
+    }
+    m_sinks.emplace_back (new NodeSink (&m_writer, node->GetId ()));
+    NodeSink *sink = m_sinks.back ().get ();
+    ipv4->TraceConnectWithoutContext ("Tx", MakeCallback (&NodeSink::Transmit, sink));
+    ipv4->TraceConnectWithoutContext ("Rx", MakeCallback (&NodeSink::Receive, sink));
+    ipv4->TraceConnectWithoutContext ("Drop", MakeCallback (&NodeSink::Drop, sink));
+    ipv4->TraceConnectWithoutContext ("UnicastForward", MakeCallback (&NodeSink::Forward, sink));
+    ipv4->TraceConnectWithoutContext ("LocalDeliver", MakeCallback (&NodeSink::Deliver, sink));
+    if (Ptr<ArpL3Protocol> arp = node->GetObject<ArpL3Protocol> ())
+    {
+      arp->TraceConnectWithoutContext ("Drop", MakeCallback (&NodeSink::ArpDrop, sink));
+    }
+    EnableRouting (ipv4->GetRoutingProtocol (), sink);
+  }
+
+  void Close ()
+  {
+    m_writer.Close ();
+    NS_LOG_INFO ("Wrote " << m_writer.GetRecords () << " events in " << m_writer.GetBytesWritten () << " bytes, "
+                          << m_writer.GetStalls () << " stalls, " << m_writer.GetDropped () << " dropped");
+  }
+
+  uint64_t GetRecords () const
+  {
+    return m_writer.GetRecords ();
+  }
+
+private:
+  class NodeSink
+  {
+  public:
+    NodeSink (EventLogWriter *writer, uint32_t node)
+      : m_writer (writer),
+        m_node (node)
+    {
+    }
+
+    // no Tx e no Rx o pacote ainda tem o cabeçalho IP
+    void Transmit (Ptr<const Packet> packet, Ptr<Ipv4> /* ipv4 */, uint32_t interface)
+    {
+      WritePacket (EVENT_IP_TX, packet, interface);
+    }
+
+    void Receive (Ptr<const Packet> packet, Ptr<Ipv4> /* ipv4 */, uint32_t interface)
+    {
+      WritePacket (EVENT_IP_RX, packet, interface);
+    }
+
+    void Drop (const Ipv4Header &header, Ptr<const Packet> packet, Ipv4L3Protocol::DropReason reason,
+               Ptr<Ipv4> /* ipv4 */, uint32_t interface)
+    {
+      Write (EVENT_IP_DROP, packet->GetUid (), uint64_t (interface) << 32 | reason, Addresses (header));
+    }
+
+    void Forward (const Ipv4Header &header, Ptr<const Packet> packet, uint32_t interface)
+    {
+      Write (EVENT_IP_FORWARD, packet->GetUid (), uint64_t (interface) << 32 | packet->GetSize (),
+             Addresses (header));
+    }
+
+    void Deliver (const Ipv4Header &header, Ptr<const Packet> packet, uint32_t interface)
+    {
+      Write (EVENT_IP_DELIVER, packet->GetUid (), uint64_t (interface) << 32 | packet->GetSize (),
+             Addresses (header));
+    }
+
+    void ArpDrop (Ptr<const Packet> packet)
+    {
+      Write (EVENT_ARP_DROP, packet->GetUid (), packet->GetSize (), 0);
+    }
+
+    void RouteChange (Ipv4Address network, Ipv4Mask mask, Ipv4Address gateway, uint32_t interface, uint32_t metric)
+    {
+      Write (EVENT_RIP_ROUTE, uint64_t (network.Get ()) << 32 | mask.Get (),
+             uint64_t (gateway.Get ()) << 32 | interface, metric);
+    }
+
+    void LsaInstall (uint32_t advertisingRouter, uint32_t sequence, uint32_t links)
+    {
+      Write (EVENT_OSPF_LSA, advertisingRouter, sequence, links);
+    }
+
+    void SpfRun (uint32_t routes)
+    {
+      Write (EVENT_OSPF_SPF, routes, 0, 0);
+    }
+
+  private:
+    static uint64_t Addresses (const Ipv4Header &header)
+    {
+      return uint64_t (header.GetSource ().Get ()) << 32 | header.GetDestination ().Get ();
+    }
+
+    void WritePacket (uint16_t type, Ptr<const Packet> packet, uint32_t interface)
+    {
+      Ipv4Header header;
+      packet->PeekHeader (header);
+      Write (type, packet->GetUid (), uint64_t (interface) << 32 | packet->GetSize (), Addresses (header));
+    }
+
+    void Write (uint16_t type, uint64_t a, uint64_t b, uint64_t c)
+    {
+      m_writer->Write (EventRecord {uint64_t (Simulator::Now ().GetNanoSeconds ()), m_node, type, 0, a, b, c});
+    }
+
+    EventLogWriter *m_writer;
+    uint32_t m_node;
+  };
+
+  // a BatchedRip ou a OspfRouting do nó, direta ou dentro da Ipv4ListRouting
+  // (e do RouteCache)
+  void EnableRouting (Ptr<Ipv4RoutingProtocol> protocol, NodeSink *sink)
+  {
+    if (Ptr<Ipv4ListRouting> list = DynamicCast<Ipv4ListRouting> (protocol))
+    {
+      for (uint32_t i = 0; i < list->GetNRoutingProtocols (); ++i)
+      {
+        int16_t priority;
+        EnableRouting (list->GetRoutingProtocol (i, priority), sink);
+      }
+    }
+    else if (Ptr<RouteCache> cache = DynamicCast<RouteCache> (protocol))
+    {
+      EnableRouting (cache->GetRouting (), sink);
+    }
+    else if (Ptr<BatchedRip> rip = DynamicCast<BatchedRip> (protocol))
+    {
+      rip->TraceConnectWithoutContext ("RouteChange", MakeCallback (&NodeSink::RouteChange, sink));
+    }
+    else if (Ptr<OspfRouting> ospf = DynamicCast<OspfRouting> (protocol))
+    {
+      ospf->TraceConnectWithoutContext ("LsaInstall", MakeCallback (&NodeSink::LsaInstall, sink));
+      ospf->TraceConnectWithoutContext ("SpfRun", MakeCallback (&NodeSink::SpfRun, sink));
+    }
+  }
+
+  EventLogWriter m_writer;
+  std::vector<std::unique_ptr<NodeSink> > m_sinks;
+};
+
+} // namespace eventlog
+
+using eventlog::EventLogHelper;
+
+} // namespace ns3
+
+#endif /* EVENT_LOG_HELPER_H */
@@ -0,0 +1,601 @@
+// Log de eventos binário, no lugar do texto do LOG_LEVEL_ALL: cada evento é
+// um registro de tamanho fixo (instante, nó, tipo, thread e três argumentos
+// de 64 bits) copiado para um anel da thread que o gerou, sem formatar nada.
+// Uma thread de escrita esvazia os anéis, comprime os registros em blocos e
+// grava o arquivo; o texto só é montado depois, por tools/log_dump.cc.
+//
+//   EventLogWriter log;
+//   log.Open ("tp2-rip.evl", &error);
+//   log.Write (EventRecord {timeNs, node, EVENT_IP_TX, 0, uid, interface, addresses});
+//   ...
+//   log.Close ();
+//
+// Cada thread tem o seu anel (produtor único, consumidor único, sem trava);
+// com o anel cheio, a thread espera a de escrita (GetStalls conta as
+// esperas) em vez de perder registros. Antes do Open e depois do Close não há
+// thread de escrita para esvaziar os anéis: aí o Write descarta o registro
+// (GetDropped conta os descartes). O Close espera os Write em andamento
+// terminarem antes de esvaziar os anéis pela última vez; um deles só é
+// descartado se achar o anel cheio depois que a thread de escrita parou. A
+// ordem é a de cada thread; registros de
+// threads diferentes ficam intercalados na ordem em que os anéis foram
+// esvaziados.
+//
+// Arquivo: a assinatura EVENT_LOG_MAGIC seguida de blocos, como no trace
+// binário (binary-trace.h):
+//
+//   <tamanho original: u32> <tamanho comprimido: u32> <registros: u32> <bloco>
+//
+// com o bloco comprimido pelo BlockCompress (block-codec.h) e os registros,
+// de EVENT_RECORD_SIZE bytes, em little-endian.
+//
+// Não depende do ns-3; o EventLogHelper (event-log-helper.h) liga o escritor
+// aos traces da pilha IP e dos protocolos de roteamento.
+
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include "address-plan.h"
+#include "block-codec.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+const char EVENT_LOG_MAGIC[8] = {'N', 'S', '3', 'E', 'V', 'L', '1', '\n'};
+
+// argumentos de cada tipo (endereços IPv4 em 32 bits, dois por argumento
+// quando vêm juntos: alto << 32 | baixo)
+enum EventType
+{
+  EVENT_IP_TX = 1,   // uid, interface << 32 | tamanho, origem << 32 | destino
+  EVENT_IP_RX,       // idem
+  EVENT_IP_DROP,     // uid, interface << 32 | motivo, origem << 32 | destino
+  EVENT_IP_FORWARD,  // uid, interface << 32 | tamanho, origem << 32 | destino
+  EVENT_IP_DELIVER,  // idem
+  EVENT_ARP_DROP,    // uid, tamanho
+  EVENT_RIP_ROUTE,   // rede << 32 | máscara, gateway << 32 | interface, métrica
+  EVENT_OSPF_LSA,    // roteador anunciante, sequência, enlaces
+  EVENT_OSPF_SPF,    // rotas
+  EVENT_TYPES
+};
+
+struct EventRecord
+{
+  uint64_t timeNs;
+  uint32_t node;
+  uint16_t type;
+  uint16_t thread; // preenchido pelo EventLogWriter
+  uint64_t a;
+  uint64_t b;
+  uint64_t c;
+};
+
+const uint32_t EVENT_RECORD_SIZE = 40;
+
+inline const char *
+GetEventName (uint16_t type)
+{
+  static const char *names[] = {"?",          "ip-tx",    "ip-rx",     "ip-drop",  "ip-forward",
+                                "ip-deliver", "arp-drop", "rip-route", "ospf-lsa", "ospf-spf"};
+  return type < EVENT_TYPES ? names[type] : "?";
+}
+
+namespace eventlog {
+
+// motivos do Ipv4L3Protocol::DropReason
+inline const char *
+GetDropReason (uint32_t reason)
+{
+  static const char *names[] = {"?",           "ttl-expired",  "no-route",        "bad-checksum",
+                                "interface-down", "route-error", "fragment-timeout"};
+  return reason < sizeof (names) / sizeof (names[0]) ? names[reason] : "?";
+}
+
+inline void
+PutLe (std::vector<uint8_t> &out, uint64_t value, uint32_t bytes)
+{
+  for (uint32_t i = 0; i < bytes; ++i)
+  {
+    out.push_back (uint8_t (value >> (8 * i)));
+  }
+}
+
+inline uint64_t
+GetLe (const uint8_t *in, uint32_t bytes)
+{
+  uint64_t value = 0;
+  for (uint32_t i = 0; i < bytes; ++i)
+  {
+    value |= uint64_t (in[i]) << (8 * i);
+  }
+  return value;
+}
+
+// fila circular de uma thread: só ela escreve em m_head, só a thread de
+// escrita escreve em m_tail
+class Ring
+{
+public:
+  Ring (uint32_t capacity, uint16_t thread)
+    : m_records (capacity),
+      m_mask (capacity - 1),
+      m_thread (thread),
+      m_head (0),
+      m_tail (0),
+      m_stalls (0)
+  {
+  }
+
+  // false se o anel estava cheio (o registro não entrou)
+  bool Push (const EventRecord &record)
+  {
+    uint64_t head = m_head.load (std::memory_order_relaxed);
+    if (head - m_tail.load (std::memory_order_acquire) > m_mask)
+    {
+      ++m_stalls;
+      return false;
+    }
+    m_records[head & m_mask] = record;
+    m_records[head & m_mask].thread = m_thread;
+    m_head.store (head + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool IsHalfFull () const
+  {
+    return m_head.load (std::memory_order_relaxed) - m_tail.load (std::memory_order_relaxed) > m_mask / 2;
+  }
+
+  // serializa os registros pendentes no fim de 'out'; devolve quantos
+  uint32_t Drain (std::vector<uint8_t> &out)
+  {
+    uint64_t tail = m_tail.load (std::memory_order_relaxed);
+    uint64_t head = m_head.load (std::memory_order_acquire);
+    for (uint64_t i = tail; i < head; ++i)
+    {
+      const EventRecord &record = m_records[i & m_mask];
+      PutLe (out, record.timeNs, 8);
+      PutLe (out, record.node, 4);
+      PutLe (out, record.type, 2);
+      PutLe (out, record.thread, 2);
+      PutLe (out, record.a, 8);
+      PutLe (out, record.b, 8);
+      PutLe (out, record.c, 8);
+    }
+    m_tail.store (head, std::memory_order_release);
+    return head - tail;
+  }
+
+  uint64_t GetStalls () const
+  {
+    return m_stalls;
+  }
+
+private:
+  std::vector<EventRecord> m_records;
+  uint64_t m_mask;
+  uint16_t m_thread;
+  std::atomic<uint64_t> m_head;
+  std::atomic<uint64_t> m_tail;
+  uint64_t m_stalls; // só a thread produtora escreve
+};
+
+} // namespace eventlog
+
+class EventLogWriter
+{
+public:
+  EventLogWriter ()
+    : m_id (NextId ()),
+      m_ringCapacity (1 << 14),
+      m_blockSize (256 * 1024),
+      m_running (false),
+      m_writers (0),
+      m_dropped (0),
+      m_blockRecords (0),
+      m_records (0),
+      m_bytes (0)
+  {
+  }
+
+  ~EventLogWriter ()
+  {
+    Close ();
+    m_rings.clear ();
+    ++Generation (); // as threads tiram os anéis deste escritor da cache
+  }
+
+  // registros por anel (arredondado para potência de 2); antes do Open
+  void SetRingCapacity (uint32_t records)
+  {
+    m_ringCapacity = 2;
+    while (m_ringCapacity < records)
+    {
+      m_ringCapacity <<= 1;
+    }
+  }
+
+  // tamanho do bloco antes da compressão
+  void SetBlockSize (uint32_t bytes)
+  {
+    m_blockSize = bytes;
+  }
+
+  bool Open (const std::string &path, std::string *error)
+  {
+    m_out.open (path, std::ios::binary | std::ios::trunc);
+    if (!m_out)
+    {
+      *error = "nao foi possivel gravar " + path;
+      return false;
+    }
+    m_out.write (EVENT_LOG_MAGIC, sizeof (EVENT_LOG_MAGIC));
+    m_bytes = sizeof (EVENT_LOG_MAGIC);
+    m_raw.reserve (m_blockSize + EVENT_RECORD_SIZE * m_ringCapacity);
+    m_running = true;
+    m_thread = std::thread (&EventLogWriter::Run, this);
+    return true;
+  }
+
+  // de qualquer thread, entre o Open e o Close; fora disso o registro é
+  // descartado
+  void Write (const EventRecord &record)
+  {
+    // conta antes de olhar m_running: ou o Close vê este Write e espera por
+    // ele, ou o Write vê o Close e descarta (as duas operações são seq_cst)
+    ++m_writers;
+    if (!m_running)
+    {
+      ++m_dropped;
+      --m_writers;
+      return;
+    }
+    eventlog::Ring *ring = GetRing ();
+    while (!ring->Push (record))
+    {
+      if (!m_running)
+      {
+        ++m_dropped; // anel cheio e o Close já parou a thread de escrita
+        --m_writers;
+        return;
+      }
+      m_wake.notify_one ();
+      std::this_thread::yield ();
+    }
+    if (ring->IsHalfFull ())
+    {
+      m_wake.notify_one ();
+    }
+    --m_writers;
+  }
+
+  // para a thread de escrita e grava o que ficou nos anéis
+  void Close ()
+  {
+    if (!m_running)
+    {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock (m_mutex);
+      m_running = false;
+    }
+    m_wake.notify_one ();
+    m_thread.join ();
+    while (m_writers > 0)
+    {
+      std::this_thread::yield ();
+    }
+    Drain ();
+    Flush ();
+    m_out.close ();
+  }
+
+  uint64_t GetRecords () const
+  {
+    return m_records;
+  }
+
+  // vezes em que uma thread achou o seu anel cheio
+  uint64_t GetStalls () const
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    uint64_t stalls = 0;
+    for (const std::shared_ptr<eventlog::Ring> &ring : m_rings)
+    {
+      stalls += ring->GetStalls ();
+    }
+    return stalls;
+  }
+
+  // registros descartados por Write fora do intervalo Open-Close (ou com o
+  // anel cheio durante o Close)
+  uint64_t GetDropped () const
+  {
+    return m_dropped;
+  }
+
+  uint64_t GetBytesWritten () const
+  {
+    return m_bytes;
+  }
+
+private:
+  static uint64_t NextId ()
+  {
+    static std::atomic<uint64_t> next (1);
+    return next++;
+  }
+
+  // escritores destruídos até agora
+  static std::atomic<uint64_t> &Generation ()
+  {
+    static std::atomic<uint64_t> generation (0);
+    return generation;
+  }
+
+  // anel da thread corrente, criado na primeira escrita dela; o último
+  // usado fica à mão, os outros escritores da thread numa lista, de onde
+  // saem os já destruídos quando a geração muda
+  eventlog::Ring *GetRing ()
+  {
+    struct Cache
+    {
+      uint64_t writer;
+      eventlog::Ring *ring;
+      std::weak_ptr<eventlog::Ring> owner;
+    };
+    static thread_local Cache last = {0, nullptr, std::weak_ptr<eventlog::Ring> ()};
+    static thread_local std::vector<Cache> others;
+    static thread_local uint64_t generation = 0;
+    if (last.writer == m_id)
+    {
+      return last.ring;
+    }
+    for (Cache &cache : others)
+    {
+      if (cache.writer == m_id)
+      {
+        std::swap (cache, last);
+        return last.ring;
+      }
+    }
+    if (generation != Generation ())
+    {
+      generation = Generation ();
+      others.erase (std::remove_if (others.begin (), others.end (),
+                                    [] (const Cache &cache) { return cache.owner.expired (); }),
+                    others.end ());
+    }
+    if (!last.owner.expired ())
+    {
+      others.push_back (last);
+    }
+    std::lock_guard<std::mutex> lock (m_mutex);
+    m_rings.emplace_back (new eventlog::Ring (m_ringCapacity, m_rings.size ()));
+    last = Cache {m_id, m_rings.back ().get (), m_rings.back ()};
+    return last.ring;
+  }
+
+  // thread de escrita: acorda com um anel pela metade ou a cada 10 ms
+  void Run ()
+  {
+    std::unique_lock<std::mutex> lock (m_mutex);
+    while (m_running)
+    {
+      m_wake.wait_for (lock, std::chrono::milliseconds (10));
+      lock.unlock ();
+      Drain ();
+      lock.lock ();
+    }
+  }
+
+  void Drain ()
+  {
+    std::vector<eventlog::Ring *> rings;
+    {
+      std::lock_guard<std::mutex> lock (m_mutex);
+      for (const std::shared_ptr<eventlog::Ring> &ring : m_rings)
+      {
+        rings.push_back (ring.get ());
+      }
+    }
+    for (eventlog::Ring *ring : rings)
+    {
+      uint32_t records = ring->Drain (m_raw);
+      m_blockRecords += records;
+      m_records += records;
+      if (m_raw.size () >= m_blockSize)
+      {
+        Flush ();
+      }
+    }
+  }
+
+  // comprime e grava o bloco corrente (só a thread de escrita, ou o Close)
+  void Flush ()
+  {
+    if (m_blockRecords == 0)
+    {
+      return;
+    }
+    m_compressed.clear ();
+    BlockCompress (m_raw.data (), m_raw.size (), m_compressed);
+    PutU32 (m_out, m_raw.size ());
+    PutU32 (m_out, m_compressed.size ());
+    PutU32 (m_out, m_blockRecords);
+    m_out.write (reinterpret_cast<const char *> (m_compressed.data ()), m_compressed.size ());
+    m_bytes += 12 + m_compressed.size ();
+    m_raw.clear ();
+    m_blockRecords = 0;
+  }
+
+  const uint64_t m_id;
+  uint32_t m_ringCapacity;
+  uint32_t m_blockSize;
+  std::ofstream m_out;
+  std::thread m_thread;
+  mutable std::mutex m_mutex; // m_rings; m_running muda com ele (m_wake)
+  std::condition_variable m_wake;
+  std::atomic<bool> m_running;
+  std::atomic<uint32_t> m_writers; // Write em andamento
+  std::atomic<uint64_t> m_dropped;
+  std::vector<std::shared_ptr<eventlog::Ring> > m_rings; // as caches das threads guardam weak_ptr
+  std::vector<uint8_t> m_raw;
+  std::vector<uint8_t> m_compressed;
+  uint32_t m_blockRecords;
+  uint64_t m_records;
+  uint64_t m_bytes;
+};
+
+// leitura sequencial, um bloco descomprimido por vez
+class EventLogReader
+{
+public:
+  EventLogReader ()
+    : m_pos (0),
+      m_blockRecords (0)
+  {
+  }
+
+  bool Open (const std::string &path, std::string *error)
+  {
+    m_in.open (path, std::ios::binary);
+    char magic[sizeof (EVENT_LOG_MAGIC)];
+    if (!m_in || !m_in.read (magic, sizeof (magic))
+        || std::string (magic, sizeof (magic)) != std::string (EVENT_LOG_MAGIC, sizeof (magic)))
+    {
+      *error = path + " nao e um log de eventos";
+      return false;
+    }
+    return true;
+  }
+
+  // false no fim do arquivo ou em erro (error fica vazio no fim normal)
+  bool Next (EventRecord &record, std::string *error)
+  {
+    error->clear ();
+    while (m_blockRecords == 0)
+    {
+      if (!ReadBlock (error))
+      {
+        return false;
+      }
+    }
+    if (m_pos + EVENT_RECORD_SIZE > m_raw.size ())
+    {
+      *error = "registro truncado";
+      return false;
+    }
+    const uint8_t *in = m_raw.data () + m_pos;
+    record.timeNs = eventlog::GetLe (in, 8);
+    record.node = eventlog::GetLe (in + 8, 4);
+    record.type = eventlog::GetLe (in + 12, 2);
+    record.thread = eventlog::GetLe (in + 14, 2);
+    record.a = eventlog::GetLe (in + 16, 8);
+    record.b = eventlog::GetLe (in + 24, 8);
+    record.c = eventlog::GetLe (in + 32, 8);
+    m_pos += EVENT_RECORD_SIZE;
+    --m_blockRecords;
+    return true;
+  }
+
+private:
+  bool ReadBlock (std::string *error)
+  {
+    uint32_t rawSize;
+    uint32_t compressedSize;
+    if (!GetU32 (m_in, rawSize))
+    {
+      return false; // fim do arquivo
+    }
+    if (!GetU32 (m_in, compressedSize) || !GetU32 (m_in, m_blockRecords))
+    {
+      *error = "cabecalho de bloco truncado";
+      return false;
+    }
+    m_compressed.resize (compressedSize);
+    if (!m_in.read (reinterpret_cast<char *> (m_compressed.data ()), compressedSize))
+    {
+      *error = "bloco truncado";
+      return false;
+    }
+    m_raw.clear ();
+    if (!BlockDecompress (m_compressed.data (), compressedSize, rawSize, m_raw, error))
+    {
+      return false;
+    }
+    m_pos = 0;
+    return true;
+  }
+
+  std::ifstream m_in;
+  std::vector<uint8_t> m_compressed;
+  std::vector<uint8_t> m_raw;
+  std::size_t m_pos;
+  uint32_t m_blockRecords;
+};
+
+// argumentos do registro em texto, sem o instante, o nó e o tipo
+inline std::string
+FormatEventArgs (const EventRecord &record)
+{
+  char text[160];
+  uint32_t high = record.b >> 32;
+  uint32_t low = uint32_t (record.b);
+  std::string source = AddressPlan::FormatAddress (record.c >> 32);
+  std::string destination = AddressPlan::FormatAddress (uint32_t (record.c));
+  switch (record.type)
+  {
+  case EVENT_IP_TX:
+  case EVENT_IP_RX:
+  case EVENT_IP_FORWARD:
+  case EVENT_IP_DELIVER:
+    std::snprintf (text, sizeof (text), "if=%u uid=%llu size=%u %s > %s", high, (unsigned long long) record.a, low,
+                   source.c_str (), destination.c_str ());
+    break;
+  case EVENT_IP_DROP:
+    std::snprintf (text, sizeof (text), "if=%u uid=%llu reason=%s %s > %s", high, (unsigned long long) record.a,
+                   eventlog::GetDropReason (low), source.c_str (), destination.c_str ());
+    break;
+  case EVENT_ARP_DROP:
+    std::snprintf (text, sizeof (text), "uid=%llu size=%llu", (unsigned long long) record.a,
+                   (unsigned long long) record.b);
+    break;
+  case EVENT_RIP_ROUTE:
+    std::snprintf (text, sizeof (text), "%s/%s via %s if=%u metric=%llu",
+                   AddressPlan::FormatAddress (record.a >> 32).c_str (),
+                   AddressPlan::FormatAddress (uint32_t (record.a)).c_str (),
+                   AddressPlan::FormatAddress (high).c_str (), low, (unsigned long long) record.c);
+    break;
+  case EVENT_OSPF_LSA:
+    std::snprintf (text, sizeof (text), "router %s seq=0x%08llx links=%llu",
+                   AddressPlan::FormatAddress (record.a).c_str (), (unsigned long long) record.b,
+                   (unsigned long long) record.c);
+    break;
+  case EVENT_OSPF_SPF:
+    std::snprintf (text, sizeof (text), "routes=%llu", (unsigned long long) record.a);
+    break;
+  default:
+    std::snprintf (text, sizeof (text), "a=%llu b=%llu c=%llu", (unsigned long long) record.a,
+                   (unsigned long long) record.b, (unsigned long long) record.c);
+  }
+  return text;
+}
+
+} // namespace ns3
+
+#endif /* EVENT_LOG_H */
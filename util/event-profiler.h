@@ -0,0 +1,421 @@
+// Perfil dos eventos do simulador: quantos eventos de cada tipo de tratador
+// rodaram, em que nó e quanto tempo de relógio cada tipo consumiu.
+//
+// O ProfilingScheduler envolve o escalonador de verdade (MapScheduler por
+// padrão) e é instalado com Simulator::SetScheduler. O simulador tira o
+// próximo evento do escalonador logo antes de executá-lo, então o tempo entre
+// duas chamadas a RemoveNext é o custo do evento anterior (mais o do próprio
+// escalonador). O tipo do tratador é o tipo C++ do EventImpl, que o MakeEvent
+// gera por método agendado: "Rip", "CsmaNetDevice", "ArpCache",
+// "UdpEchoClient"... O nó é o contexto do evento.
+//
+// O custo por evento é uma leitura do relógio e duas buscas em tabela hash,
+// pouco o bastante para deixar ligado nas varreduras.
+//
+//   EventProfiler profiler;
+//   profiler.Enable ();
+//   Simulator::Run ();
+//   profiler.Stop ();
+//   profiler.Report (std::cout);
+//   profiler.WriteCsv ("tp2-rip.profile.csv");
+
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+#include "ns3/core-module.h"
+#include "ns3/scheduler.h"
+
+#include <cxxabi.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+namespace profiling {
+
+NS_LOG_COMPONENT_DEFINE ("EventProfiler");
+
+// nome curto do tratador a partir do nome C++ do tipo do evento
+inline std::string
+EventLabel (const char *mangled)
+{
+  int status = 0;
+  char *demangled = abi::__cxa_demangle (mangled, nullptr, nullptr, &status);
+  std::string name (status == 0 && demangled ? demangled : mangled);
+  std::free (demangled);
+  std::string label;
+  std::string::size_type member = name.find ("::*)");
+  std::string::size_type function = name.find ("(*)(");
+  if (member != std::string::npos)
+  {
+    // método: "... void (ns3::Rip::*)() ..." -> "Rip"
+    std::string::size_type open = name.rfind ('(', member);
+    label = name.substr (open + 1, member - open - 1);
+  }
+  else if (function != std::string::npos)
+  {
+    // função: "... void (*)(ns3::Ptr<ns3::Ipv4>, unsigned int) ..." -> "(Ptr<Ipv4>, unsigned int)"
+    std::string::size_type close = function + 3;
+    for (int depth = 0; close < name.size (); ++close)
+    {
+      depth += name[close] == '(' ? 1 : name[close] == ')' ? -1 : 0;
+      if (depth == 0)
+      {
+        break;
+      }
+    }
+    label = name.substr (function + 3, close - function - 2);
+  }
+  else
+  {
+    label = name;
+  }
+  for (std::string::size_type ns; (ns = label.find ("ns3::")) != std::string::npos;)
+  {
+    label.erase (ns, 5);
+  }
+  return label.size () > 80 ? label.substr (0, 77) + "..." : label;
+}
+
+struct EventCost
+{
+  uint64_t events;
+  uint64_t wallNs;
+};
+
+// contabilidade dos eventos, separada do escalonador
+class EventProfile
+{
+public:
+  static const uint32_t NO_NODE = 0xffffffff;
+
+  EventProfile ()
+    : m_current (NO_LABEL),
+      m_currentNode (NO_NODE),
+      m_startNs (0)
+  {
+  }
+
+  // o evento de tipo 'type' no contexto 'node' começa em 'nowNs'; encerra o anterior
+  void Begin (const std::type_info &type, uint32_t node, bool cancelled, uint64_t nowNs)
+  {
+    End (nowNs);
+    m_current = cancelled ? LabelIndex ("(cancelled)") : TypeIndex (type);
+    m_currentNode = node;
+    m_startNs = nowNs;
+  }
+
+  void End (uint64_t nowNs)
+  {
+    if (m_current == NO_LABEL)
+    {
+      return;
+    }
+    EventCost &cost = m_costs[uint64_t (m_current) << 32 | m_currentNode];
+    ++cost.events;
+    cost.wallNs += nowNs - m_startNs;
+    m_current = NO_LABEL;
+  }
+
+  const std::vector<std::string> &GetLabels () const
+  {
+    return m_labels;
+  }
+
+  // custo por (rótulo, nó), na ordem de maior tempo
+  struct Row
+  {
+    uint32_t label;
+    uint32_t node;
+    EventCost cost;
+  };
+
+  std::vector<Row> GetRows () const
+  {
+    std::vector<Row> rows;
+    for (const auto &entry : m_costs)
+    {
+      rows.push_back (Row {uint32_t (entry.first >> 32), uint32_t (entry.first), entry.second});
+    }
+    std::sort (rows.begin (), rows.end (), [] (const Row &a, const Row &b) { return a.cost.wallNs > b.cost.wallNs; });
+    return rows;
+  }
+
+  // somas por rótulo (node = NO_NODE), na ordem de maior tempo
+  std::vector<Row> GetLabelTotals () const
+  {
+    std::vector<Row> totals (m_labels.size ());
+    for (uint32_t i = 0; i < totals.size (); ++i)
+    {
+      totals[i] = Row {i, NO_NODE, EventCost {0, 0}};
+    }
+    for (const auto &entry : m_costs)
+    {
+      totals[entry.first >> 32].cost.events += entry.second.events;
+      totals[entry.first >> 32].cost.wallNs += entry.second.wallNs;
+    }
+    std::sort (totals.begin (), totals.end (),
+               [] (const Row &a, const Row &b) { return a.cost.wallNs > b.cost.wallNs; });
+    return totals;
+  }
+
+private:
+  static const uint32_t NO_LABEL = 0xffffffff;
+
+  uint32_t TypeIndex (const std::type_info &type)
+  {
+    auto it = m_types.find (&type);
+    if (it == m_types.end ())
+    {
+      it = m_types.emplace (&type, LabelIndex (EventLabel (type.name ()))).first;
+    }
+    return it->second;
+  }
+
+  uint32_t LabelIndex (const std::string &label)
+  {
+    auto it = std::find (m_labels.begin (), m_labels.end (), label);
+    if (it != m_labels.end ())
+    {
+      return it - m_labels.begin ();
+    }
+    m_labels.push_back (label);
+    return m_labels.size () - 1;
+  }
+
+  std::unordered_map<const std::type_info *, uint32_t> m_types;
+  std::vector<std::string> m_labels;
+  std::unordered_map<uint64_t, EventCost> m_costs;
+  uint32_t m_current;
+  uint32_t m_currentNode;
+  uint64_t m_startNs;
+};
+
+inline uint64_t
+WallNs ()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds> (
+           std::chrono::steady_clock::now ().time_since_epoch ())
+    .count ();
+}
+
+// perfil em uso; o simulador cria o escalonador pela ObjectFactory, sem
+// como receber o perfil
+inline EventProfile *&
+ActiveProfile ()
+{
+  static EventProfile *profile = nullptr;
+  return profile;
+}
+
+class ProfilingScheduler : public Scheduler
+{
+public:
+  static TypeId GetTypeId ()
+  {
+    static TypeId tid = TypeId ("ns3::ProfilingScheduler")
+                          .SetParent<Scheduler> ()
+                          .AddConstructor<ProfilingScheduler> ()
+                          .AddAttribute ("Inner", "Scheduler that keeps the events", StringValue ("ns3::MapScheduler"),
+                                         MakeStringAccessor (&ProfilingScheduler::m_innerType), MakeStringChecker ());
+    return tid;
+  }
+
+  ProfilingScheduler ()
+    : m_profile (ActiveProfile ())
+  {
+  }
+
+  void Insert (const Event &ev) override
+  {
+    GetInner ()->Insert (ev);
+  }
+
+  bool IsEmpty (void) const override
+  {
+    return m_inner == nullptr || m_inner->IsEmpty ();
+  }
+
+  Event PeekNext (void) const override
+  {
+    return m_inner->PeekNext ();
+  }
+
+  Event RemoveNext (void) override
+  {
+    Event ev = m_inner->RemoveNext ();
+    if (m_profile)
+    {
+      m_profile->Begin (typeid (*ev.impl), ev.key.m_context, ev.impl->IsCancelled (), WallNs ());
+    }
+    return ev;
+  }
+
+  void Remove (const Event &ev) override
+  {
+    m_inner->Remove (ev);
+  }
+
+private:
+  Ptr<Scheduler> GetInner ()
+  {
+    if (m_inner == nullptr)
+    {
+      ObjectFactory factory;
+      factory.SetTypeId (m_innerType);
+      m_inner = factory.Create<Scheduler> ();
+    }
+    return m_inner;
+  }
+
+  std::string m_innerType;
+  Ptr<Scheduler> m_inner;
+  EventProfile *m_profile;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (ProfilingScheduler);
+
+class EventProfiler
+{
+public:
+  EventProfiler ()
+    : m_enabled (false),
+      m_startNs (0),
+      m_wallNs (0)
+  {
+  }
+
+  ~EventProfiler ()
+  {
+    if (ActiveProfile () == &m_profile)
+    {
+      ActiveProfile () = nullptr;
+    }
+  }
+
+  // troca o escalonador do simulador; os eventos já agendados passam para o novo
+  void Enable (const std::string &inner = "ns3::MapScheduler")
+  {
+    ActiveProfile () = &m_profile;
+    ObjectFactory factory;
+    factory.SetTypeId ("ns3::ProfilingScheduler");
+    factory.Set ("Inner", StringValue (inner));
+    Simulator::SetScheduler (factory);
+    m_enabled = true;
+    m_startNs = WallNs ();
+  }
+
+  // logo depois do Simulator::Run, para fechar o último evento
+  void Stop ()
+  {
+    if (m_enabled)
+    {
+      uint64_t now = WallNs ();
+      m_profile.End (now);
+      m_wallNs = now - m_startNs;
+    }
+  }
+
+  bool IsEnabled () const
+  {
+    return m_enabled;
+  }
+
+  const EventProfile &GetProfile () const
+  {
+    return m_profile;
+  }
+
+  // totais, eventos por segundo simulado e de relógio e os tipos de tratador
+  // mais caros, com os nós que mais pesaram em cada um
+  void Report (std::ostream &os, uint32_t nodesPerLabel = 3) const
+  {
+    std::vector<EventProfile::Row> totals = m_profile.GetLabelTotals ();
+    std::vector<EventProfile::Row> rows = m_profile.GetRows ();
+    uint64_t events = 0;
+    for (const EventProfile::Row &row : totals)
+    {
+      events += row.cost.events;
+    }
+    double wall = m_wallNs / 1e9;
+    double simulated = Simulator::Now ().GetSeconds ();
+    char line[160];
+    std::snprintf (line, sizeof (line), "Events: %llu in %.3f s wall, %.0f per simulated second, %.0f per wall second\n",
+                   (unsigned long long) events, wall, simulated > 0 ? events / simulated : 0.0,
+                   wall > 0 ? events / wall : 0.0);
+    os << line;
+    for (const EventProfile::Row &total : totals)
+    {
+      std::snprintf (line, sizeof (line), "  %-40s %10llu events %10.3f ms %5.1f%% %8.0f ns/event\n",
+                     m_profile.GetLabels ()[total.label].c_str (), (unsigned long long) total.cost.events,
+                     total.cost.wallNs / 1e6, m_wallNs ? 100.0 * total.cost.wallNs / m_wallNs : 0.0,
+                     total.cost.events ? double (total.cost.wallNs) / total.cost.events : 0.0);
+      os << line;
+      uint32_t shown = 0;
+      for (const EventProfile::Row &row : rows)
+      {
+        if (row.label != total.label || shown++ == nodesPerLabel)
+        {
+          continue;
+        }
+        if (row.node == EventProfile::NO_NODE)
+        {
+          std::snprintf (line, sizeof (line), "      no node  %10llu events %10.3f ms\n",
+                         (unsigned long long) row.cost.events, row.cost.wallNs / 1e6);
+        }
+        else
+        {
+          std::snprintf (line, sizeof (line), "      node %-4u %10llu events %10.3f ms\n", row.node,
+                         (unsigned long long) row.cost.events, row.cost.wallNs / 1e6);
+        }
+        os << line;
+      }
+    }
+  }
+
+  // handler,node,events,wallMs; node vazio para eventos sem contexto
+  void WriteCsv (std::ostream &os) const
+  {
+    os << "handler,node,events,wallMs\n";
+    for (const EventProfile::Row &row : m_profile.GetRows ())
+    {
+      os << '"' << m_profile.GetLabels ()[row.label] << "\",";
+      if (row.node != EventProfile::NO_NODE)
+      {
+        os << row.node;
+      }
+      os << "," << row.cost.events << "," << row.cost.wallNs / 1e6 << "\n";
+    }
+  }
+
+  void WriteCsv (const std::string &path) const
+  {
+    std::ofstream out (path);
+    NS_ABORT_MSG_IF (!out, "Cannot write " << path);
+    WriteCsv (out);
+  }
+
+private:
+  EventProfile m_profile;
+  bool m_enabled;
+  uint64_t m_startNs;
+  uint64_t m_wallNs;
+};
+
+} // namespace profiling
+
+using profiling::EventProfiler;
+using profiling::ProfilingScheduler;
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
@@ -0,0 +1,352 @@
+// Roteiro de falhas por nome, independente do ns-3: quedas e voltas de
+// enlaces e nós em instantes fixos, processos de oscilação com MTBF/MTTR
+// aleatórios e grupos de enlaces que falham juntos (SRLG, shared risk link
+// group). O FailureScheduler (failure-scheduler.h) aplica o roteiro.
+//
+// Formato (uma declaração por linha, '#' inicia comentário; tempos em
+// segundos ou com unidade, como no TopologySpec: 30, 30s, 500ms):
+//
+//   down 30 link net2            # as duas pontas do enlace
+//   down 30 link net2 RouterB    # só a interface de RouterB no enlace
+//   up 40 link net2
+//   down 50 node RouterC         # todas as interfaces do nó
+//   up 60 node RouterC
+//   srlg duto1 net2 net5         # enlaces que compartilham o mesmo risco
+//   down 70 srlg duto1
+//   up 90 srlg duto1
+//   flap link net3 mtbf=20 mttr=2 [start=10] [stop=100]
+//   flap srlg duto1 mtbf=60 mttr=5
+//   flap node RouterD mtbf=120 mttr=10
+//
+// Uma oscilação alterna períodos de funcionamento e de reparo com duração
+// exponencial de médias mtbf e mttr, de start (0) até stop (o fim da
+// simulação). Uma interface derrubada por mais de uma causa só volta quando
+// todas voltam; a causa de um down/up fixo é o alvo ("link net2", "node
+// RouterC", "srlg duto1"), e a de uma oscilação é a própria declaração. As durações vêm do sorteador passado ao Expand; no
+// FailureScheduler é um ExponentialRandomVariable do ns-3, que segue o
+// RngSeed/RngRun da execução.
+
+#ifndef FAILURE_PLAN_H
+#define FAILURE_PLAN_H
+
+#include "topology-spec.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <istream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+// mudança de estado de uma interface já resolvida para o TopologySpec
+struct FailureEvent
+{
+  int64_t timeNs;
+  bool up;
+  uint32_t node;
+  uint32_t link;
+  bool flap;         // gerada por uma oscilação
+  std::string label; // "net2-down", "RouterC-up", "duto1-down"...
+  uint32_t cause;    // mesma causa na queda e na volta correspondente
+};
+
+class FailurePlan
+{
+public:
+  bool ReadString (const std::string &text, std::string *error)
+  {
+    std::istringstream is (text);
+    return Read (is, error);
+  }
+
+  bool ReadFile (const std::string &path, std::string *error)
+  {
+    std::ifstream is (path);
+    if (!is)
+    {
+      *error = "nao foi possivel abrir " + path;
+      return false;
+    }
+    if (!Read (is, error))
+    {
+      *error = path + ": " + *error;
+      return false;
+    }
+    return true;
+  }
+
+  // sorteia uma duração (s) exponencial de média 'mean' (s)
+  typedef std::function<double (double mean)> Exponential;
+
+  // resolve os nomes em 'spec', sorteia as oscilações até stopNs e devolve as
+  // mudanças de interface em ordem de tempo
+  bool Expand (const TopologySpec &spec, int64_t stopNs, const Exponential &exponential,
+               std::vector<FailureEvent> &events, std::string *error) const
+  {
+    events.clear ();
+    std::map<std::pair<Kind, std::string>, uint32_t> targetCauses;
+    uint32_t causes = 0;
+    for (const Statement &statement : m_statements)
+    {
+      std::vector<std::pair<uint32_t, uint32_t> > ends; // (nó, enlace)
+      if (!Resolve (spec, statement, ends, error))
+      {
+        *error = "linha " + std::to_string (statement.line) + ": " + *error;
+        return false;
+      }
+      std::string label = statement.target;
+      uint32_t cause = causes;
+      if (!statement.flap)
+      {
+        cause = targetCauses.emplace (std::make_pair (statement.kind, statement.target), causes).first->second;
+      }
+      if (cause == causes)
+      {
+        ++causes;
+      }
+      if (statement.flap)
+      {
+        double mtbf = statement.mtbfNs / 1e9;
+        double mttr = statement.mttrNs / 1e9;
+        int64_t stop = statement.stopNs >= 0 ? std::min (statement.stopNs, stopNs) : stopNs;
+        int64_t t = statement.timeNs;
+        while (true)
+        {
+          t += int64_t (exponential (mtbf) * 1e9);
+          if (t >= stop)
+          {
+            break;
+          }
+          Add (events, ends, t, false, true, label + "-down", cause);
+          t += std::max<int64_t> (1, int64_t (exponential (mttr) * 1e9));
+          Add (events, ends, std::min (t, stop), true, true, label + "-up", cause);
+        }
+      }
+      else if (statement.timeNs <= stopNs)
+      {
+        Add (events, ends, statement.timeNs, statement.up, false, label + (statement.up ? "-up" : "-down"), cause);
+      }
+    }
+    std::stable_sort (events.begin (), events.end (),
+                      [] (const FailureEvent &a, const FailureEvent &b) { return a.timeNs < b.timeNs; });
+    return true;
+  }
+
+  // o mesmo, com um gerador próprio, fora do ns-3
+  bool Expand (const TopologySpec &spec, int64_t stopNs, uint64_t seed, std::vector<FailureEvent> &events,
+               std::string *error) const
+  {
+    std::mt19937_64 rng (seed);
+    return Expand (
+      spec, stopNs, [&rng] (double mean) { return std::exponential_distribution<double> (1 / mean) (rng); }, events,
+      error);
+  }
+
+  bool Empty () const
+  {
+    return m_statements.empty ();
+  }
+
+private:
+  enum Kind
+  {
+    LINK,
+    NODE,
+    SRLG
+  };
+
+  struct Statement
+  {
+    uint32_t line;
+    Kind kind;
+    std::string target;
+    std::string side; // nó da ponta, em "link <nome> <nó>"
+    bool flap;
+    bool up;
+    int64_t timeNs; // instante, ou start da oscilação
+    int64_t stopNs; // < 0: fim da simulação
+    int64_t mtbfNs;
+    int64_t mttrNs;
+  };
+
+  bool Read (std::istream &is, std::string *error)
+  {
+    std::string line;
+    uint32_t lineNo = 0;
+    while (std::getline (is, line))
+    {
+      ++lineNo;
+      std::istringstream fields (line.substr (0, line.find ('#')));
+      std::vector<std::string> words;
+      for (std::string word; fields >> word;)
+      {
+        words.push_back (word);
+      }
+      if (words.empty ())
+      {
+        continue;
+      }
+      if (!ReadStatement (words, lineNo, error))
+      {
+        *error = "linha " + std::to_string (lineNo) + ": " + *error;
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool ReadStatement (const std::vector<std::string> &words, uint32_t line, std::string *error)
+  {
+    if (words[0] == "srlg")
+    {
+      if (words.size () < 3)
+      {
+        *error = "esperado 'srlg <grupo> <enlace> ...'";
+        return false;
+      }
+      m_groups[words[1]].assign (words.begin () + 2, words.end ());
+      return true;
+    }
+    Statement statement {line, LINK, "", "", words[0] == "flap", words[0] == "up", 0, -1, 0, 0};
+    std::vector<std::string>::size_type next;
+    if (statement.flap)
+    {
+      next = 1;
+    }
+    else if ((words[0] == "down" || words[0] == "up") && words.size () >= 2)
+    {
+      if (!ParseDelay (words[1], &statement.timeNs))
+      {
+        *error = "instante invalido '" + words[1] + "'";
+        return false;
+      }
+      next = 2;
+    }
+    else
+    {
+      *error = "declaracao desconhecida '" + words[0] + "' (use down, up, flap ou srlg)";
+      return false;
+    }
+    if (words.size () < next + 2)
+    {
+      *error = "esperado 'link <nome>', 'node <nome>' ou 'srlg <grupo>'";
+      return false;
+    }
+    const std::string &kind = words[next];
+    statement.kind = kind == "link" ? LINK : kind == "node" ? NODE : SRLG;
+    if (kind != "link" && kind != "node" && kind != "srlg")
+    {
+      *error = "alvo desconhecido '" + kind + "' (use link, node ou srlg)";
+      return false;
+    }
+    statement.target = words[next + 1];
+    for (std::vector<std::string>::size_type i = next + 2; i < words.size (); ++i)
+    {
+      std::string::size_type equals = words[i].find ('=');
+      std::string key = words[i].substr (0, equals);
+      std::string value = equals == std::string::npos ? "" : words[i].substr (equals + 1);
+      int64_t *field = key == "mtbf" ? &statement.mtbfNs
+                       : key == "mttr" ? &statement.mttrNs
+                       : key == "start" ? &statement.timeNs
+                       : key == "stop" ? &statement.stopNs
+                                       : nullptr;
+      if (equals == std::string::npos && statement.kind == LINK && !statement.flap && statement.side.empty ())
+      {
+        statement.side = words[i];
+      }
+      else if (field == nullptr || !statement.flap || !ParseDelay (value, field))
+      {
+        *error = "parametro invalido '" + words[i] + "'";
+        return false;
+      }
+    }
+    if (statement.flap && (statement.mtbfNs <= 0 || statement.mttrNs <= 0))
+    {
+      *error = "flap precisa de mtbf=<tempo> e mttr=<tempo> positivos";
+      return false;
+    }
+    m_statements.push_back (statement);
+    return true;
+  }
+
+  bool Resolve (const TopologySpec &spec, const Statement &statement,
+                std::vector<std::pair<uint32_t, uint32_t> > &ends, std::string *error) const
+  {
+    if (statement.kind == NODE)
+    {
+      int64_t node = spec.FindNode (statement.target);
+      if (node < 0)
+      {
+        *error = "no desconhecido '" + statement.target + "'";
+        return false;
+      }
+      for (uint32_t l = 0; l < spec.links.size (); ++l)
+      {
+        if (spec.links[l].a == node || spec.links[l].b == node)
+        {
+          ends.emplace_back (node, l);
+        }
+      }
+      return true;
+    }
+    std::vector<std::string> links (1, statement.target);
+    if (statement.kind == SRLG)
+    {
+      std::map<std::string, std::vector<std::string> >::const_iterator group = m_groups.find (statement.target);
+      if (group == m_groups.end ())
+      {
+        *error = "grupo desconhecido '" + statement.target + "'";
+        return false;
+      }
+      links = group->second;
+    }
+    for (const std::string &name : links)
+    {
+      int64_t link = spec.FindLink (name);
+      if (link < 0)
+      {
+        *error = "enlace desconhecido '" + name + "'";
+        return false;
+      }
+      const TopologyLinkSpec &l = spec.links[link];
+      if (statement.side.empty ())
+      {
+        ends.emplace_back (l.a, link);
+        ends.emplace_back (l.b, link);
+      }
+      else
+      {
+        int64_t side = spec.FindNode (statement.side);
+        if (side < 0 || (side != l.a && side != l.b))
+        {
+          *error = "'" + statement.side + "' nao e ponta do enlace " + name;
+          return false;
+        }
+        ends.emplace_back (side, link);
+      }
+    }
+    return true;
+  }
+
+  static void Add (std::vector<FailureEvent> &events, const std::vector<std::pair<uint32_t, uint32_t> > &ends,
+                   int64_t timeNs, bool up, bool flap, const std::string &label, uint32_t cause)
+  {
+    for (const std::pair<uint32_t, uint32_t> &end : ends)
+    {
+      events.push_back (FailureEvent {timeNs, up, end.first, end.second, flap, label, cause});
+    }
+  }
+
+  std::vector<Statement> m_statements;
+  std::map<std::string, std::vector<std::string> > m_groups;
+};
+
+} // namespace ns3
+
+#endif /* FAILURE_PLAN_H */
@@ -0,0 +1,204 @@
+// Aplica um roteiro de falhas (failure-plan.h) a uma topologia montada pelo
+// TopologyLoader, no lugar dos Simulator::Schedule (..., &Ipv4::SetDown, ...)
+// com índices de interface escritos à mão.
+//
+//   FailureScheduler failures (topology);
+//   failures.Load ("falhas.txt");
+//   failures.Install (Seconds (simulationTime));
+//
+// Todas as mudanças ficam num vetor ordenado, e um único evento do simulador
+// as percorre: cada disparo aplica as mudanças do instante atual e se
+// reagenda para o próximo instante. Milhares de oscilações custam um evento
+// por instante distinto, não uma entrada na fila por mudança.
+//
+// Por padrão as interfaces caem e voltam por Ipv4::SetDown/SetUp; cenários com
+// o IncrementalGlobalRouting passam SetInterfaceCallback.
+//
+// As oscilações são sorteadas por um ExponentialRandomVariable, então mudam
+// com o RngRun/RngSeed da execução (cada replicação do tools/sweep tem as
+// suas); AssignStreams fixa o fluxo, como nos modelos do ns-3.
+
+#ifndef FAILURE_SCHEDULER_H
+#define FAILURE_SCHEDULER_H
+
+#include "failure-plan.h"
+#include "topology-loader.h"
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+namespace failure {
+
+NS_LOG_COMPONENT_DEFINE ("FailureScheduler");
+
+class FailureScheduler
+{
+public:
+  typedef std::function<void (Ptr<Node>, uint32_t, bool)> InterfaceCallback;
+
+  explicit FailureScheduler (const TopologyLoader &topology)
+    : m_topology (topology),
+      m_random (CreateObject<ExponentialRandomVariable> ()),
+      m_next (0),
+      m_transitions (0)
+  {
+  }
+
+  void Load (const std::string &path)
+  {
+    std::string error;
+    if (!m_plan.ReadFile (path, &error))
+    {
+      NS_FATAL_ERROR (error);
+    }
+  }
+
+  void LoadString (const std::string &text)
+  {
+    std::string error;
+    if (!m_plan.ReadString (text, &error))
+    {
+      NS_FATAL_ERROR (error);
+    }
+  }
+
+  // fluxo do gerador das oscilações; devolve quantos fluxos usou
+  int64_t AssignStreams (int64_t stream)
+  {
+    m_random->SetStream (stream);
+    return 1;
+  }
+
+  // (nó, interface, up); o padrão chama Ipv4::SetDown/SetUp
+  void SetInterfaceCallback (InterfaceCallback callback)
+  {
+    m_callback = callback;
+  }
+
+  // depois do topology.Build (); sorteia as oscilações até stop
+  void Install (Time stop)
+  {
+    std::string error;
+    FailurePlan::Exponential exponential = [this] (double mean) { return m_random->GetValue (mean, 0); };
+    if (!m_plan.Expand (m_topology.GetSpec (), stop.GetNanoSeconds (), exponential, m_events, &error))
+    {
+      NS_FATAL_ERROR (error);
+    }
+    const TopologySpec &spec = m_topology.GetSpec ();
+    m_interfaces.resize (m_events.size ());
+    for (uint32_t i = 0; i < m_events.size (); ++i)
+    {
+      const FailureEvent &event = m_events[i];
+      m_interfaces[i] = m_topology.GetInterface (event.link, spec.links[event.link].a == event.node ? 0 : 1);
+    }
+    NS_LOG_INFO ("Scheduled " << m_events.size () << " interface changes");
+    if (!m_events.empty ())
+    {
+      Simulator::Schedule (NanoSeconds (m_events[0].timeNs), &FailureScheduler::Dispatch, this);
+    }
+  }
+
+  // mudanças expandidas, em ordem de tempo (para o ConvergenceMonitor, por exemplo)
+  const std::vector<FailureEvent> &GetEvents () const
+  {
+    return m_events;
+  }
+
+  // quedas e voltas fixas do roteiro (sem as oscilações), uma por declaração
+  std::vector<std::pair<Time, std::string> > GetScheduledFailures () const
+  {
+    std::vector<std::pair<Time, std::string> > failures;
+    for (uint32_t i = 0; i < m_events.size (); ++i)
+    {
+      const FailureEvent &event = m_events[i];
+      if (!event.flap && (i == 0 || event.timeNs != m_events[i - 1].timeNs || event.label != m_events[i - 1].label))
+      {
+        failures.emplace_back (NanoSeconds (event.timeNs), event.label);
+      }
+    }
+    return failures;
+  }
+
+  // interfaces que de fato mudaram de estado até agora
+  uint64_t GetTransitions () const
+  {
+    return m_transitions;
+  }
+
+private:
+  void Dispatch ()
+  {
+    int64_t now = Simulator::Now ().GetNanoSeconds ();
+    for (; m_next < m_events.size () && m_events[m_next].timeNs <= now; ++m_next)
+    {
+      const FailureEvent &event = m_events[m_next];
+      std::set<uint32_t> &causes = m_down[std::make_pair (event.node, m_interfaces[m_next])];
+      bool wasDown = !causes.empty ();
+      if (!event.up)
+      {
+        causes.insert (event.cause);
+      }
+      else if (causes.erase (event.cause) == 0)
+      {
+        // volta sem queda da mesma causa: não libera as quedas das outras
+        NS_LOG_WARN (event.label << ": node " << event.node << " interface " << m_interfaces[m_next]
+                                 << " was not taken down by this cause; ignored");
+        continue;
+      }
+      if (wasDown != !causes.empty ())
+      {
+        Apply (m_topology.GetNode (event.node), m_interfaces[m_next], causes.empty ());
+      }
+    }
+    if (m_next < m_events.size ())
+    {
+      Simulator::Schedule (NanoSeconds (m_events[m_next].timeNs - now), &FailureScheduler::Dispatch, this);
+    }
+  }
+
+  void Apply (Ptr<Node> node, uint32_t interface, bool up)
+  {
+    NS_LOG_INFO (Simulator::Now ().GetSeconds () << " s: node " << node->GetId () << " interface " << interface
+                                                  << (up ? " up" : " down"));
+    ++m_transitions;
+    if (m_callback)
+    {
+      m_callback (node, interface, up);
+    }
+    else if (up)
+    {
+      node->GetObject<Ipv4> ()->SetUp (interface);
+    }
+    else
+    {
+      node->GetObject<Ipv4> ()->SetDown (interface);
+    }
+  }
+
+  const TopologyLoader &m_topology;
+  FailurePlan m_plan;
+  Ptr<ExponentialRandomVariable> m_random;
+  InterfaceCallback m_callback;
+  std::vector<FailureEvent> m_events;
+  std::vector<uint32_t> m_interfaces; // interface Ipv4 de cada mudança
+  std::map<std::pair<uint32_t, uint32_t>, std::set<uint32_t> > m_down; // (nó, interface) -> causas da queda
+  uint32_t m_next;
+  uint64_t m_transitions;
+};
+
+} // namespace failure
+
+using failure::FailureScheduler;
+
+} // namespace ns3
+
+#endif /* FAILURE_SCHEDULER_H */
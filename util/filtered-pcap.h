@@ -0,0 +1,435 @@
+// Captura pcap filtrada, no lugar do EnablePcapAll promíscuo em todos os
+// dispositivos.
+//
+// O filtro olha só os primeiros bytes de cada pacote (cabeçalhos de enlace,
+// IPv4 e UDP/TCP, copiados com Packet::CopyData) antes de qualquer coisa ser
+// gravada, então os pacotes descartados, como os 1024 bytes de carga do
+// UdpEchoClient, não chegam a ser copiados. Os aceitos são gravados com no
+// máximo 'snaplen' bytes, num anel de arquivos por dispositivo com tamanho
+// limitado.
+//
+// Filtro: termos separados por vírgula, aceitos se qualquer um casar:
+//
+//   all              tudo
+//   rip              UDP porta 520
+//   ospf             IP protocolo 89
+//   arp, icmp
+//   udp[:porta]      UDP (na origem ou no destino)
+//   tcp[:porta]      TCP (na origem ou no destino)
+//   ip:<protocolo>   IPv4 com o número de protocolo dado
+//
+// Arquivos: <prefixo>-<nó>-<dispositivo>.pcap, ou
+// <prefixo>-<nó>-<dispositivo>-<k>.pcap com k = 0, 1, ... quando o anel tem
+// mais de um arquivo (o mais antigo é sobrescrito).
+
+#ifndef FILTERED_PCAP_H
+#define FILTERED_PCAP_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/csma-module.h"
+#include "ns3/point-to-point-module.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+namespace pcap {
+
+NS_LOG_COMPONENT_DEFINE ("FilteredPcap");
+
+// tipos de enlace do pcap, os mesmos que o PcapHelper usa nesses dispositivos
+const uint32_t DLT_EN10MB = 1;
+const uint32_t DLT_PPP = 9;
+
+// bytes copiados do início do pacote para o filtro
+const uint32_t FILTER_BYTES = 64;
+
+class PacketFilter
+{
+public:
+  PacketFilter ()
+    : m_all (true)
+  {
+  }
+
+  bool Parse (const std::string &spec, std::string *error)
+  {
+    m_terms.clear ();
+    m_all = false;
+    std::string::size_type start = 0;
+    while (start <= spec.size ())
+    {
+      std::string::size_type comma = spec.find (',', start);
+      std::string term = spec.substr (start, comma == std::string::npos ? std::string::npos : comma - start);
+      start = comma == std::string::npos ? spec.size () + 1 : comma + 1;
+      if (term.empty ())
+      {
+        continue;
+      }
+      std::string name = term.substr (0, term.find (':'));
+      std::string arg = term.size () > name.size () ? term.substr (name.size () + 1) : "";
+      long value = arg.empty () ? -1 : std::strtol (arg.c_str (), nullptr, 10);
+      if (name == "all")
+      {
+        m_all = true;
+      }
+      else if (name == "rip")
+      {
+        m_terms.push_back (Term {IPV4, 17, 520});
+      }
+      else if (name == "ospf")
+      {
+        m_terms.push_back (Term {IPV4, 89, -1});
+      }
+      else if (name == "icmp")
+      {
+        m_terms.push_back (Term {IPV4, 1, -1});
+      }
+      else if (name == "arp")
+      {
+        m_terms.push_back (Term {ARP, -1, -1});
+      }
+      else if (name == "udp" || name == "tcp")
+      {
+        m_terms.push_back (Term {IPV4, name == "udp" ? 17 : 6, value});
+      }
+      else if (name == "ip" && value >= 0)
+      {
+        m_terms.push_back (Term {IPV4, value, -1});
+      }
+      else
+      {
+        *error = "termo de filtro invalido '" + term + "'";
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool AcceptsAll () const
+  {
+    return m_all;
+  }
+
+  // bytes: início do pacote como o sniffer do dispositivo o entrega
+  bool Match (const uint8_t *bytes, uint32_t size, uint32_t linkType) const
+  {
+    if (m_all)
+    {
+      return true;
+    }
+    uint32_t offset;
+    uint32_t etherType;
+    if (linkType == DLT_PPP)
+    {
+      if (size < 2)
+      {
+        return false;
+      }
+      uint32_t protocol = (bytes[0] << 8) | bytes[1];
+      etherType = protocol == 0x0021 ? 0x0800 : protocol;
+      offset = 2;
+    }
+    else
+    {
+      if (size < 14)
+      {
+        return false;
+      }
+      etherType = (bytes[12] << 8) | bytes[13];
+      offset = 14;
+      if (etherType < 0x0600 && size >= 22) // LLC/SNAP
+      {
+        etherType = (bytes[20] << 8) | bytes[21];
+        offset = 22;
+      }
+    }
+
+    long protocol = -1;
+    long sourcePort = -1;
+    long destinationPort = -1;
+    if (etherType == 0x0800 && size >= offset + 20)
+    {
+      protocol = bytes[offset + 9];
+      uint32_t transport = offset + (bytes[offset] & 0x0f) * 4;
+      if ((protocol == 6 || protocol == 17) && size >= transport + 4)
+      {
+        sourcePort = (bytes[transport] << 8) | bytes[transport + 1];
+        destinationPort = (bytes[transport + 2] << 8) | bytes[transport + 3];
+      }
+    }
+    for (const Term &term : m_terms)
+    {
+      if (term.kind == ARP)
+      {
+        if (etherType == 0x0806)
+        {
+          return true;
+        }
+      }
+      else if (protocol >= 0 && term.protocol == protocol
+               && (term.port < 0 || term.port == sourcePort || term.port == destinationPort))
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+private:
+  enum Kind
+  {
+    IPV4,
+    ARP
+  };
+
+  struct Term
+  {
+    Kind kind;
+    long protocol;
+    long port;
+  };
+
+  bool m_all;
+  std::vector<Term> m_terms;
+};
+
+// arquivos pcap de um dispositivo, em anel de 'files' arquivos de até
+// 'maxBytes' cada (maxBytes = 0: um arquivo sem limite)
+class PcapRingWriter
+{
+public:
+  PcapRingWriter (const std::string &base, uint32_t linkType, uint32_t snaplen, uint64_t maxBytes, uint32_t files)
+    : m_base (base),
+      m_linkType (linkType),
+      m_snaplen (snaplen),
+      m_maxBytes (maxBytes),
+      m_files (files ? files : 1),
+      m_current (0),
+      m_bytes (0),
+      m_written (0)
+  {
+    OpenFile ();
+  }
+
+  void Write (uint64_t timeNs, const uint8_t *data, uint32_t captured, uint32_t original)
+  {
+    if (m_maxBytes && m_bytes + 16 + captured > m_maxBytes && m_bytes > 24)
+    {
+      m_current = (m_current + 1) % m_files;
+      OpenFile ();
+    }
+    uint32_t header[4] = {uint32_t (timeNs / 1000000000), uint32_t (timeNs % 1000000000 / 1000), captured,
+                          original};
+    m_out.write (reinterpret_cast<const char *> (header), sizeof (header));
+    m_out.write (reinterpret_cast<const char *> (data), captured);
+    m_bytes += sizeof (header) + captured;
+    ++m_written;
+  }
+
+  uint32_t GetSnaplen () const
+  {
+    return m_snaplen;
+  }
+
+  uint32_t GetLinkType () const
+  {
+    return m_linkType;
+  }
+
+  uint64_t GetWritten () const
+  {
+    return m_written;
+  }
+
+private:
+  void OpenFile ()
+  {
+    std::string path = m_files > 1 ? m_base + "-" + std::to_string (m_current) + ".pcap" : m_base + ".pcap";
+    m_out.close ();
+    m_out.open (path, std::ios::binary | std::ios::trunc);
+    NS_ABORT_MSG_IF (!m_out, "Cannot write " << path);
+    // cabeçalho global do pcap (microssegundos, ordem de bytes da máquina)
+    uint32_t header[6] = {0xa1b2c3d4, 0x00040002, 0, 0, m_snaplen, m_linkType};
+    m_out.write (reinterpret_cast<const char *> (header), sizeof (header));
+    m_bytes = sizeof (header);
+  }
+
+  std::string m_base;
+  uint32_t m_linkType;
+  uint32_t m_snaplen;
+  uint64_t m_maxBytes;
+  uint32_t m_files;
+  uint32_t m_current;
+  uint64_t m_bytes;
+  uint64_t m_written;
+  std::ofstream m_out;
+};
+
+class FilteredPcapHelper
+{
+public:
+  FilteredPcapHelper ()
+    : m_snaplen (65535),
+      m_maxBytes (0),
+      m_files (1),
+      m_promiscuous (true)
+  {
+  }
+
+  void SetFilter (const std::string &spec)
+  {
+    std::string error;
+    if (!m_filter.Parse (spec, &error))
+    {
+      NS_FATAL_ERROR (error);
+    }
+  }
+
+  void SetSnaplen (uint32_t snaplen)
+  {
+    m_snaplen = snaplen;
+  }
+
+  // anel de 'files' arquivos de até 'maxBytes' por dispositivo
+  void SetRing (uint64_t maxBytes, uint32_t files)
+  {
+    m_maxBytes = maxBytes;
+    m_files = files;
+  }
+
+  void SetPromiscuous (bool promiscuous)
+  {
+    m_promiscuous = promiscuous;
+  }
+
+  void Enable (const std::string &prefix, Ptr<NetDevice> device)
+  {
+    uint32_t linkType;
+    if (DynamicCast<CsmaNetDevice> (device))
+    {
+      linkType = DLT_EN10MB;
+    }
+    else if (DynamicCast<PointToPointNetDevice> (device))
+    {
+      linkType = DLT_PPP;
+    }
+    else
+    {
+      return;
+    }
+    std::string base = prefix + "-" + std::to_string (device->GetNode ()->GetId ()) + "-"
+                       + std::to_string (device->GetIfIndex ());
+    m_sinks.emplace_back (new DeviceSink (this, new PcapRingWriter (base, linkType, m_snaplen, m_maxBytes, m_files)));
+    device->TraceConnectWithoutContext (m_promiscuous ? "PromiscSniffer" : "Sniffer",
+                                        MakeCallback (&DeviceSink::Sniff, m_sinks.back ().get ()));
+  }
+
+  void Enable (const std::string &prefix, NetDeviceContainer devices)
+  {
+    for (NetDeviceContainer::Iterator device = devices.Begin (); device != devices.End (); ++device)
+    {
+      Enable (prefix, *device);
+    }
+  }
+
+  // todos os dispositivos dos nós dados
+  void Enable (const std::string &prefix, NodeContainer nodes)
+  {
+    for (NodeContainer::Iterator node = nodes.Begin (); node != nodes.End (); ++node)
+    {
+      for (uint32_t i = 0; i < (*node)->GetNDevices (); ++i)
+      {
+        Enable (prefix, (*node)->GetDevice (i));
+      }
+    }
+  }
+
+  void EnableAll (const std::string &prefix)
+  {
+    Enable (prefix, NodeContainer::GetGlobal ());
+  }
+
+  // pacotes vistos e gravados por todos os dispositivos
+  uint64_t GetSeen () const
+  {
+    uint64_t seen = 0;
+    for (const std::unique_ptr<DeviceSink> &sink : m_sinks)
+    {
+      seen += sink->seen;
+    }
+    return seen;
+  }
+
+  uint64_t GetWritten () const
+  {
+    uint64_t written = 0;
+    for (const std::unique_ptr<DeviceSink> &sink : m_sinks)
+    {
+      written += sink->writer->GetWritten ();
+    }
+    return written;
+  }
+
+private:
+  struct DeviceSink
+  {
+    DeviceSink (FilteredPcapHelper *helper, PcapRingWriter *writer)
+      : helper (helper),
+        writer (writer),
+        seen (0)
+    {
+    }
+
+    void Sniff (Ptr<const Packet> packet)
+    {
+      ++seen;
+      uint32_t size = packet->GetSize ();
+      uint8_t head[FILTER_BYTES];
+      uint32_t headBytes = 0;
+      if (!helper->m_filter.AcceptsAll ())
+      {
+        headBytes = packet->CopyData (head, std::min (size, FILTER_BYTES));
+        if (!helper->m_filter.Match (head, headBytes, writer->GetLinkType ()))
+        {
+          return;
+        }
+      }
+      uint32_t captured = std::min (size, writer->GetSnaplen ());
+      if (captured <= headBytes)
+      {
+        writer->Write (Simulator::Now ().GetNanoSeconds (), head, captured, size);
+        return;
+      }
+      buffer.resize (captured);
+      packet->CopyData (buffer.data (), captured);
+      writer->Write (Simulator::Now ().GetNanoSeconds (), buffer.data (), captured, size);
+    }
+
+    FilteredPcapHelper *helper;
+    std::unique_ptr<PcapRingWriter> writer;
+    std::vector<uint8_t> buffer;
+    uint64_t seen;
+  };
+
+  PacketFilter m_filter;
+  uint32_t m_snaplen;
+  uint64_t m_maxBytes;
+  uint32_t m_files;
+  bool m_promiscuous;
+  std::vector<std::unique_ptr<DeviceSink> > m_sinks;
+};
+
+} // namespace pcap
+
+using pcap::FilteredPcapHelper;
+
+} // namespace ns3
+
+#endif /* FILTERED_PCAP_H */
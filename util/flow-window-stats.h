@@ -0,0 +1,301 @@
+// Estatísticas por fluxo em janelas de tempo, no estilo do FlowMonitor,
+// para ver os picos de perda e atraso em volta das quedas de enlace.
+//
+// Um fluxo é a quíntupla (origem, destino, protocolo, portas) dos pacotes
+// unicast gerados pelos nós; o controle do RIP (multicast e porta 520) fica
+// de fora. Na origem (SendOutgoing do Ipv4L3Protocol) o pacote recebe um
+// FlowWindowTag com o fluxo e o instante de envio; no destino (LocalDeliver)
+// o tag dá o atraso, e os descartes do IP (Drop) são atribuídos ao fluxo.
+//
+// Tudo é contado na janela do instante de envio, então a perda de uma janela
+// é o que foi enviado nela e não chegou (inclusive o que ainda estava em
+// trânsito no fim). Cada fluxo tem um vetor fixo de janelas até 'stop',
+// alocado no primeiro pacote; nada depende do número de pacotes.
+//
+//   FlowWindowStats flows;
+//   flows.Install (Seconds (1.0), Seconds (simulationTime));
+//   ...
+//   Simulator::Run ();
+//   flows.Write ("tp2-rip.flows");
+
+#ifndef FLOW_WINDOW_STATS_H
+#define FLOW_WINDOW_STATS_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace ns3 {
+namespace flowstats {
+
+NS_LOG_COMPONENT_DEFINE ("FlowWindowStats");
+
+const uint16_t RIP_PORT = 520;
+
+class FlowWindowTag : public Tag
+{
+public:
+  FlowWindowTag ()
+    : m_flow (0),
+      m_txTimeNs (0)
+  {
+  }
+
+  FlowWindowTag (uint32_t flow, int64_t txTimeNs)
+    : m_flow (flow),
+      m_txTimeNs (txTimeNs)
+  {
+  }
+
+  static TypeId GetTypeId ()
+  {
+    static TypeId tid = TypeId ("ns3::FlowWindowTag").SetParent<Tag> ().AddConstructor<FlowWindowTag> ();
+    return tid;
+  }
+
+  TypeId GetInstanceTypeId () const override
+  {
+    return GetTypeId ();
+  }
+
+  uint32_t GetSerializedSize () const override
+  {
+    return 12;
+  }
+
+  void Serialize (TagBuffer buffer) const override
+  {
+    buffer.WriteU32 (m_flow);
+    buffer.WriteU64 (m_txTimeNs);
+  }
+
+  void Deserialize (TagBuffer buffer) override
+  {
+    m_flow = buffer.ReadU32 ();
+    m_txTimeNs = buffer.ReadU64 ();
+  }
+
+  void Print (std::ostream &os) const override
+  {
+    os << "flow=" << m_flow << " tx=" << m_txTimeNs;
+  }
+
+  uint32_t GetFlow () const
+  {
+    return m_flow;
+  }
+
+  int64_t GetTxTimeNs () const
+  {
+    return m_txTimeNs;
+  }
+
+private:
+  uint32_t m_flow;
+  int64_t m_txTimeNs;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (FlowWindowTag);
+
+struct FlowWindow
+{
+  uint32_t tx;
+  uint32_t rx;
+  uint32_t dropped;
+  uint32_t jitterSamples;
+  uint64_t delaySumNs;
+  uint64_t delayMaxNs;
+  uint64_t jitterSumNs;
+};
+
+struct Flow
+{
+  uint32_t source;
+  uint32_t destination;
+  uint8_t protocol;
+  uint16_t sourcePort;
+  uint16_t destinationPort;
+  int64_t lastDelayNs; // -1 antes da primeira chegada
+  std::vector<FlowWindow> windows;
+};
+
+class FlowWindowStats
+{
+public:
+  FlowWindowStats ()
+    : m_windowNs (0),
+      m_windows (0)
+  {
+  }
+
+  // janelas de 'window' de 0 até 'stop'; chamar depois de instalar a pilha IP
+  void Install (Time window, Time stop)
+  {
+    NS_ABORT_MSG_IF (!window.IsStrictlyPositive (), "Flow statistics window must be positive");
+    m_windowNs = window.GetNanoSeconds ();
+    m_windows = (stop.GetNanoSeconds () + m_windowNs - 1) / m_windowNs;
+    Config::ConnectWithoutContext ("/NodeList/*/$ns3::Ipv4L3Protocol/SendOutgoing",
+                                   MakeCallback (&FlowWindowStats::SendOutgoing, this));
+    Config::ConnectWithoutContext ("/NodeList/*/$ns3::Ipv4L3Protocol/LocalDeliver",
+                                   MakeCallback (&FlowWindowStats::LocalDeliver, this));
+    Config::ConnectWithoutContext ("/NodeList/*/$ns3::Ipv4L3Protocol/Drop",
+                                   MakeCallback (&FlowWindowStats::Drop, this));
+  }
+
+  uint32_t GetNFlows () const
+  {
+    return m_flows.size ();
+  }
+
+  const Flow &GetFlow (uint32_t id) const
+  {
+    return m_flows[id];
+  }
+
+  // uma linha por fluxo e uma por janela com tráfego:
+  //   flow <id> <origem>:<porta> <destino>:<porta> <protocolo>
+  //   <id> <início s> <env> <receb> <perd> <desc> <atraso médio ms> <atraso máx ms> <jitter ms>
+  void Write (std::ostream &os) const
+  {
+    char line[160];
+    for (uint32_t id = 0; id < m_flows.size (); ++id)
+    {
+      const Flow &flow = m_flows[id];
+      os << "flow " << id << " " << Ipv4Address (flow.source) << ":" << flow.sourcePort << " "
+         << Ipv4Address (flow.destination) << ":" << flow.destinationPort << " " << unsigned (flow.protocol) << "\n";
+    }
+    os << "#flow start tx rx lost drop delayMs maxDelayMs jitterMs\n";
+    for (uint32_t id = 0; id < m_flows.size (); ++id)
+    {
+      const std::vector<FlowWindow> &windows = m_flows[id].windows;
+      for (uint32_t w = 0; w < windows.size (); ++w)
+      {
+        const FlowWindow &window = windows[w];
+        if (window.tx == 0)
+        {
+          continue;
+        }
+        std::snprintf (line, sizeof (line), "%u %g %u %u %u %u %.3f %.3f %.3f\n", id, w * m_windowNs / 1e9,
+                       window.tx, window.rx, window.tx - std::min (window.tx, window.rx), window.dropped,
+                       window.rx ? window.delaySumNs / 1e6 / window.rx : 0.0, window.delayMaxNs / 1e6,
+                       window.jitterSamples ? window.jitterSumNs / 1e6 / window.jitterSamples : 0.0);
+        os << line;
+      }
+    }
+  }
+
+  void Write (const std::string &path) const
+  {
+    std::ofstream out (path);
+    NS_ABORT_MSG_IF (!out, "Cannot write " << path);
+    Write (out);
+  }
+
+private:
+  typedef std::tuple<uint32_t, uint32_t, uint8_t, uint16_t, uint16_t> FlowKey;
+
+  FlowWindow *GetWindow (uint32_t flow, int64_t txTimeNs)
+  {
+    uint64_t index = txTimeNs / m_windowNs;
+    return flow < m_flows.size () && index < m_windows ? &m_flows[flow].windows[index] : nullptr;
+  }
+
+  void SendOutgoing (const Ipv4Header &header, Ptr<const Packet> packet, uint32_t)
+  {
+    Ipv4Address destination = header.GetDestination ();
+    if (destination.IsMulticast () || destination.IsBroadcast ())
+    {
+      return;
+    }
+    uint16_t ports[2] = {0, 0};
+    uint8_t protocol = header.GetProtocol ();
+    if (protocol == UdpL4Protocol::PROT_NUMBER || protocol == TcpL4Protocol::PROT_NUMBER)
+    {
+      uint8_t bytes[4];
+      if (packet->CopyData (bytes, 4) == 4)
+      {
+        ports[0] = bytes[0] << 8 | bytes[1];
+        ports[1] = bytes[2] << 8 | bytes[3];
+      }
+      if (protocol == UdpL4Protocol::PROT_NUMBER && (ports[0] == RIP_PORT || ports[1] == RIP_PORT))
+      {
+        return;
+      }
+    }
+    FlowKey key (header.GetSource ().Get (), destination.Get (), protocol, ports[0], ports[1]);
+    std::map<FlowKey, uint32_t>::iterator it = m_ids.find (key);
+    if (it == m_ids.end ())
+    {
+      it = m_ids.insert (std::make_pair (key, uint32_t (m_flows.size ()))).first;
+      m_flows.push_back (Flow {header.GetSource ().Get (), destination.Get (), protocol, ports[0], ports[1], -1,
+                               std::vector<FlowWindow> (m_windows, FlowWindow ())});
+    }
+    int64_t now = Simulator::Now ().GetNanoSeconds ();
+    packet->AddByteTag (FlowWindowTag (it->second, now));
+    if (FlowWindow *window = GetWindow (it->second, now))
+    {
+      ++window->tx;
+    }
+  }
+
+  void LocalDeliver (const Ipv4Header &, Ptr<const Packet> packet, uint32_t)
+  {
+    FlowWindowTag tag;
+    if (!packet->FindFirstMatchingByteTag (tag))
+    {
+      return;
+    }
+    FlowWindow *window = GetWindow (tag.GetFlow (), tag.GetTxTimeNs ());
+    if (window == nullptr)
+    {
+      return;
+    }
+    Flow &flow = m_flows[tag.GetFlow ()];
+    int64_t delay = Simulator::Now ().GetNanoSeconds () - tag.GetTxTimeNs ();
+    ++window->rx;
+    window->delaySumNs += delay;
+    window->delayMaxNs = std::max<uint64_t> (window->delayMaxNs, delay);
+    if (flow.lastDelayNs >= 0)
+    {
+      ++window->jitterSamples;
+      window->jitterSumNs += std::abs (delay - flow.lastDelayNs);
+    }
+    flow.lastDelayNs = delay;
+  }
+
+  void Drop (const Ipv4Header &, Ptr<const Packet> packet, Ipv4L3Protocol::DropReason, Ptr<Ipv4>, uint32_t)
+  {
+    FlowWindowTag tag;
+    if (packet->FindFirstMatchingByteTag (tag))
+    {
+      if (FlowWindow *window = GetWindow (tag.GetFlow (), tag.GetTxTimeNs ()))
+      {
+        ++window->dropped;
+      }
+    }
+  }
+
+  int64_t m_windowNs;
+  uint64_t m_windows;
+  std::map<FlowKey, uint32_t> m_ids;
+  std::vector<Flow> m_flows;
+};
+
+} // namespace flowstats
+
+using flowstats::FlowWindowStats;
+using flowstats::FlowWindowTag;
+
+} // namespace ns3
+
+#endif /* FLOW_WINDOW_STATS_H */
@@ -0,0 +1,268 @@
+// Divide os nós de um TopologySpec entre os processos (ranks) da simulação
+// distribuída, com pouco tráfego entre processos e carga parecida em cada um.
+//
+// Peso de um nó: 1 + grau (o trabalho do RIP cresce com os vizinhos). Peso de
+// um enlace: o tráfego esperado, 1 entre roteadores e HOST_LINK_WEIGHT entre
+// host e roteador, para o host ficar no processo do seu roteador.
+//
+// Partição inicial: os nós em ordem de busca em largura a partir de um nó
+// periférico, fatiados em partes de peso total / partes. Refinamento: passadas
+// que movem nós da fronteira para a parte vizinha quando isso diminui o peso
+// dos enlaces cortados sem passar do limite de desbalanceamento.
+//
+// Não depende do ns-3.
+
+#ifndef GRAPH_PARTITION_H
+#define GRAPH_PARTITION_H
+
+#include "topology-spec.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <queue>
+#include <vector>
+
+namespace ns3 {
+
+struct PartitionStats
+{
+  uint32_t cutLinks;
+  uint64_t cutWeight;
+  int64_t minCutDelayNs; // -1: nenhum enlace cortado ou só atrasos padrão
+  std::vector<uint64_t> partWeights;
+  double imbalance; // maior parte / média
+};
+
+namespace partition {
+
+const uint32_t HOST_LINK_WEIGHT = 16;
+const uint32_t MAX_PASSES = 16;
+
+struct Neighbour
+{
+  uint32_t node;
+  uint32_t weight;
+};
+
+inline std::vector<std::vector<Neighbour> >
+BuildAdjacency (const TopologySpec &spec)
+{
+  std::vector<std::vector<Neighbour> > adjacency (spec.nodes.size ());
+  for (const TopologyLinkSpec &link : spec.links)
+  {
+    if (link.a == link.b)
+    {
+      continue;
+    }
+    uint32_t weight = spec.nodes[link.a].host || spec.nodes[link.b].host ? HOST_LINK_WEIGHT : 1;
+    adjacency[link.a].push_back (Neighbour {link.b, weight});
+    adjacency[link.b].push_back (Neighbour {link.a, weight});
+  }
+  return adjacency;
+}
+
+// ordem de busca em largura, cobrindo todos os componentes
+inline std::vector<uint32_t>
+BfsOrder (const std::vector<std::vector<Neighbour> > &adjacency, uint32_t start)
+{
+  std::vector<uint32_t> order;
+  std::vector<bool> seen (adjacency.size (), false);
+  for (uint32_t root = 0; root <= adjacency.size (); ++root)
+  {
+    uint32_t first = root == 0 ? start : root - 1;
+    if (seen[first])
+    {
+      continue;
+    }
+    std::queue<uint32_t> queue;
+    queue.push (first);
+    seen[first] = true;
+    while (!queue.empty ())
+    {
+      uint32_t node = queue.front ();
+      queue.pop ();
+      order.push_back (node);
+      for (const Neighbour &neighbour : adjacency[node])
+      {
+        if (!seen[neighbour.node])
+        {
+          seen[neighbour.node] = true;
+          queue.push (neighbour.node);
+        }
+      }
+    }
+  }
+  return order;
+}
+
+// fatia 'order' em partes de peso parecido e refina; devolve o peso cortado
+inline uint64_t
+PartitionFromOrder (const std::vector<std::vector<Neighbour> > &adjacency, const std::vector<uint64_t> &nodeWeight,
+                    const std::vector<uint32_t> &order, uint32_t parts, double maxImbalance,
+                    std::vector<uint32_t> &part, std::vector<uint64_t> &partWeight)
+{
+  uint32_t n = adjacency.size ();
+  uint64_t total = 0;
+  for (uint64_t weight : nodeWeight)
+  {
+    total += weight;
+  }
+  part.assign (n, 0);
+  partWeight.assign (parts, 0);
+  uint64_t accumulated = 0;
+  for (uint32_t node : order)
+  {
+    uint32_t p = std::min<uint64_t> (parts - 1, accumulated * parts / total);
+    part[node] = p;
+    partWeight[p] += nodeWeight[node];
+    accumulated += nodeWeight[node];
+  }
+
+  uint64_t maxWeight = uint64_t (maxImbalance * total / parts) + 1;
+  std::vector<int64_t> connection (parts, 0);
+  for (uint32_t pass = 0; pass < MAX_PASSES; ++pass)
+  {
+    uint32_t moves = 0;
+    for (uint32_t node = 0; node < n; ++node)
+    {
+      uint32_t own = part[node];
+      std::fill (connection.begin (), connection.end (), 0);
+      bool boundary = false;
+      for (const Neighbour &neighbour : adjacency[node])
+      {
+        connection[part[neighbour.node]] += neighbour.weight;
+        boundary = boundary || part[neighbour.node] != own;
+      }
+      if (!boundary || partWeight[own] == nodeWeight[node])
+      {
+        continue;
+      }
+      uint32_t best = own;
+      int64_t bestGain = 0;
+      for (uint32_t p = 0; p < parts; ++p)
+      {
+        if (p == own || connection[p] == 0 || partWeight[p] + nodeWeight[node] > maxWeight)
+        {
+          continue;
+        }
+        int64_t gain = connection[p] - connection[own];
+        // ganho zero só se o movimento melhorar o balanceamento
+        if (gain > bestGain
+            || (gain == bestGain && gain == 0 && partWeight[p] + nodeWeight[node] < partWeight[own]
+                && (best == own || partWeight[p] < partWeight[best])))
+        {
+          best = p;
+          bestGain = gain;
+        }
+      }
+      if (best != own)
+      {
+        partWeight[own] -= nodeWeight[node];
+        partWeight[best] += nodeWeight[node];
+        part[node] = best;
+        moves += bestGain > 0;
+      }
+    }
+    if (moves == 0)
+    {
+      break;
+    }
+  }
+
+  uint64_t cut = 0;
+  for (uint32_t node = 0; node < n; ++node)
+  {
+    for (const Neighbour &neighbour : adjacency[node])
+    {
+      cut += part[node] != part[neighbour.node] ? neighbour.weight : 0;
+    }
+  }
+  return cut / 2;
+}
+
+} // namespace partition
+
+// parte (0 .. parts-1) de cada nó; maxImbalance limita a maior parte a
+// maxImbalance vezes a média. Parte da ordem de busca em largura e da ordem
+// dos identificadores (boa em grades e anéis gerados) e fica com a de menor
+// corte.
+inline std::vector<uint32_t>
+PartitionGraph (const TopologySpec &spec, uint32_t parts, PartitionStats *stats = nullptr,
+                double maxImbalance = 1.05)
+{
+  uint32_t n = spec.nodes.size ();
+  parts = std::max (1u, std::min (parts, n));
+  std::vector<std::vector<partition::Neighbour> > adjacency = partition::BuildAdjacency (spec);
+  std::vector<uint64_t> nodeWeight (n);
+  for (uint32_t i = 0; i < n; ++i)
+  {
+    nodeWeight[i] = 1 + adjacency[i].size ();
+  }
+
+  std::vector<uint32_t> part (n, 0);
+  std::vector<uint64_t> partWeight (parts, 0);
+  if (parts > 1)
+  {
+    // nó periférico: o último da busca em largura a partir do nó 0
+    std::vector<uint32_t> bfs = partition::BfsOrder (adjacency, 0);
+    bfs = partition::BfsOrder (adjacency, bfs.back ());
+    std::vector<uint32_t> ids (n);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+      ids[i] = i;
+    }
+    std::vector<uint32_t> candidate;
+    std::vector<uint64_t> candidateWeight;
+    uint64_t bestCut = std::numeric_limits<uint64_t>::max ();
+    for (const std::vector<uint32_t> *order : {&bfs, &ids})
+    {
+      uint64_t cut = partition::PartitionFromOrder (adjacency, nodeWeight, *order, parts, maxImbalance, candidate,
+                                                    candidateWeight);
+      if (cut < bestCut)
+      {
+        bestCut = cut;
+        part.swap (candidate);
+        partWeight.swap (candidateWeight);
+      }
+    }
+  }
+  else
+  {
+    for (uint64_t weight : nodeWeight)
+    {
+      partWeight[0] += weight;
+    }
+  }
+
+  if (stats)
+  {
+    uint64_t total = 0;
+    for (uint64_t weight : partWeight)
+    {
+      total += weight;
+    }
+    stats->cutLinks = 0;
+    stats->cutWeight = 0;
+    stats->minCutDelayNs = -1;
+    for (const TopologyLinkSpec &link : spec.links)
+    {
+      if (part[link.a] != part[link.b])
+      {
+        ++stats->cutLinks;
+        stats->cutWeight += spec.nodes[link.a].host || spec.nodes[link.b].host ? partition::HOST_LINK_WEIGHT : 1;
+        if (link.delayNs >= 0 && (stats->minCutDelayNs < 0 || link.delayNs < stats->minCutDelayNs))
+        {
+          stats->minCutDelayNs = link.delayNs;
+        }
+      }
+    }
+    stats->partWeights = partWeight;
+    stats->imbalance = double (*std::max_element (partWeight.begin (), partWeight.end ())) * parts / total;
+  }
+  return part;
+}
+
+} // namespace ns3
+
+#endif /* GRAPH_PARTITION_H */
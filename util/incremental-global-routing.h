@@ -0,0 +1,245 @@
+// Roteamento global com SPF incremental: instala nas Ipv4GlobalRouting dos
+// nós as rotas calculadas pelo DynamicSpf (dynamic-spf.h) e, a cada queda ou
+// volta de interface, reescreve só as tabelas das origens cujo primeiro
+// salto mudou, no lugar do recálculo completo do RespondToInterfaceEvents.
+//
+// Uso (com ns3::Ipv4GlobalRouting::RespondToInterfaceEvents desligado e a
+// topologia montada pelo TopologyLoader com ROUTING_NONE):
+//
+//   IncrementalGlobalRouting spf (topology);
+//   spf.Install ();
+//   Simulator::Schedule (Seconds (30), &IncrementalGlobalRouting::SetDown, &spf, node, ifIndex);
+//
+// Cada enlace recebe uma rota para a sua sub-rede (do AddressPlan do loader)
+// pela ponta mais próxima; as redes diretamente conectadas ficam com as rotas
+// do Ipv4StaticRouting.
+
+#ifndef INCREMENTAL_GLOBAL_ROUTING_H
+#define INCREMENTAL_GLOBAL_ROUTING_H
+
+#include "dynamic-spf.h"
+#include "ecmp-routing.h"
+#include "resource-usage.h"
+#include "topology-loader.h"
+
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/global-router-interface.h"
+
+#include <map>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+namespace spf {
+
+NS_LOG_COMPONENT_DEFINE ("IncrementalGlobalRouting");
+
+class IncrementalGlobalRouting
+{
+public:
+  explicit IncrementalGlobalRouting (const TopologyLoader &topology);
+
+  // SPF completo e rotas iniciais (no lugar do PopulateRoutingTables)
+  void Install ();
+  // derrubam/religam a interface e atualizam as tabelas afetadas
+  void SetDown (Ptr<Node> node, uint32_t interface);
+  void SetUp (Ptr<Node> node, uint32_t interface);
+
+  void PrintStats (std::ostream &os) const;
+
+private:
+  void Update (Ptr<Node> node, uint32_t interface, bool up);
+  void InstallRoutes (uint32_t source);
+  // ponta do enlace pela qual a origem alcança a rede dele
+  uint32_t GetTarget (uint32_t source, uint32_t link) const;
+  // aborta antes de alocar as matrizes do DynamicSpf se a topologia for grande demais
+  static const TopologySpec &CheckSize (const TopologySpec &spec);
+
+  const TopologyLoader &m_topology;
+  DynamicSpf m_spf;
+  std::vector<Ptr<Ipv4GlobalRouting> > m_routing;
+  std::map<uint32_t, uint32_t> m_nodeIndex;                         // Node::GetId -> índice
+  std::map<std::pair<uint32_t, uint32_t>, uint32_t> m_interfaceLink; // (índice, interface) -> enlace
+  std::vector<uint8_t> m_sideUp;                                    // 2 por enlace
+
+  uint32_t m_events;
+  uint64_t m_tablesRewritten;
+  double m_installMs;
+  double m_updateMs;
+};
+
+inline
+IncrementalGlobalRouting::IncrementalGlobalRouting (const TopologyLoader &topology)
+  : m_topology (topology),
+    m_spf (CheckSize (topology.GetSpec ())),
+    m_sideUp (2 * topology.GetSpec ().links.size (), 1),
+    m_events (0),
+    m_tablesRewritten (0),
+    m_installMs (0),
+    m_updateMs (0)
+{
+  const TopologySpec &spec = topology.GetSpec ();
+  for (uint32_t i = 0; i < spec.nodes.size (); ++i)
+  {
+    Ptr<Node> node = topology.GetNode (i);
+    m_nodeIndex[node->GetId ()] = i;
+    Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+    NS_ABORT_MSG_IF (router == nullptr, "Node " << spec.nodes[i].name << " has no global routing");
+    m_routing.push_back (router->GetRoutingProtocol ());
+  }
+  for (uint32_t i = 0; i < spec.links.size (); ++i)
+  {
+    m_interfaceLink[std::make_pair (spec.links[i].a, topology.GetInterface (i, 0))] = i;
+    m_interfaceLink[std::make_pair (spec.links[i].b, topology.GetInterface (i, 1))] = i;
+  }
+}
+
+inline const TopologySpec &
+IncrementalGlobalRouting::CheckSize (const TopologySpec &spec)
+{
+  std::string error;
+  if (!DynamicSpf::CheckSize (spec, &error))
+  {
+    NS_FATAL_ERROR (error);
+  }
+  return spec;
+}
+
+inline void
+IncrementalGlobalRouting::Install ()
+{
+  WallClock clock;
+  m_spf.ComputeAll ();
+  for (uint32_t source = 0; source < m_spf.GetNNodes (); ++source)
+  {
+    InstallRoutes (source);
+  }
+  m_installMs = clock.GetMilliSeconds ();
+  NS_LOG_INFO ("Installed routes on " << m_spf.GetNNodes () << " nodes in " << m_installMs << " ms");
+}
+
+inline void
+IncrementalGlobalRouting::InstallRoutes (uint32_t source)
+{
+  Ptr<Ipv4GlobalRouting> routing = m_routing[source];
+  while (routing->GetNRoutes () > 0)
+  {
+    routing->RemoveRoute (0);
+  }
+  const AddressPlan &addresses = m_topology.GetAddressPlan ();
+  for (uint32_t link = 0; link < m_spf.GetNLinks (); ++link)
+  {
+    if (m_spf.GetLinkEnd (link, 0) == source || m_spf.GetLinkEnd (link, 1) == source)
+    {
+      continue; // rede conectada
+    }
+    uint32_t target = GetTarget (source, link);
+    if (target == DynamicSpf::INFINITE_DISTANCE)
+    {
+      continue;
+    }
+    int32_t hop = m_spf.GetFirstHop (source, target);
+    uint32_t side = m_spf.GetLinkEnd (hop, 0) == source ? 0 : 1;
+    routing->AddNetworkRouteTo (Ipv4Address (addresses.GetLink (link).network), Ipv4Mask (addresses.GetMask (link)),
+                                m_topology.GetAddress (hop, 1 - side), m_topology.GetInterface (hop, side));
+  }
+  FlowHashEcmpRouting::InvalidateAll ();
+}
+
+// a rede do enlace é alcançada pela ponta mais próxima com a interface no ar
+inline uint32_t
+IncrementalGlobalRouting::GetTarget (uint32_t source, uint32_t link) const
+{
+  uint32_t target = DynamicSpf::INFINITE_DISTANCE;
+  uint32_t best = DynamicSpf::INFINITE_DISTANCE;
+  for (uint32_t side = 0; side < 2; ++side)
+  {
+    uint32_t end = m_spf.GetLinkEnd (link, side);
+    uint32_t distance = m_spf.GetDistance (source, end);
+    if (m_sideUp[2 * link + side] && distance < best)
+    {
+      best = distance;
+      target = end;
+    }
+  }
+  return target;
+}
+
+inline void
+IncrementalGlobalRouting::SetDown (Ptr<Node> node, uint32_t interface)
+{
+  node->GetObject<Ipv4> ()->SetDown (interface);
+  Update (node, interface, false);
+}
+
+inline void
+IncrementalGlobalRouting::SetUp (Ptr<Node> node, uint32_t interface)
+{
+  node->GetObject<Ipv4> ()->SetUp (interface);
+  Update (node, interface, true);
+}
+
+inline void
+IncrementalGlobalRouting::Update (Ptr<Node> node, uint32_t interface, bool up)
+{
+  std::map<uint32_t, uint32_t>::const_iterator index = m_nodeIndex.find (node->GetId ());
+  NS_ABORT_MSG_IF (index == m_nodeIndex.end (), "Node " << node->GetId () << " is not in the topology");
+  std::map<std::pair<uint32_t, uint32_t>, uint32_t>::const_iterator it =
+    m_interfaceLink.find (std::make_pair (index->second, interface));
+  NS_ABORT_MSG_IF (it == m_interfaceLink.end (), "Interface " << interface << " of node " << node->GetId ()
+                                                               << " is not on a topology link");
+  uint32_t link = it->second;
+  uint32_t side = m_spf.GetLinkEnd (link, 0) == index->second ? 0 : 1;
+
+  WallClock clock;
+  std::vector<uint32_t> targets (m_spf.GetNNodes ());
+  for (uint32_t source = 0; source < m_spf.GetNNodes (); ++source)
+  {
+    targets[source] = GetTarget (source, link);
+  }
+  m_sideUp[2 * link + side] = up;
+  // o enlace só carrega tráfego com as duas pontas no ar
+  m_spf.SetLinkUp (link, m_sideUp[2 * link] && m_sideUp[2 * link + 1]);
+
+  // além das origens com primeiro salto novo, as que passam a alcançar a
+  // rede do próprio enlace pela outra ponta
+  std::vector<bool> rewrite (m_spf.GetNNodes (), false);
+  for (uint32_t source : m_spf.GetChangedSources ())
+  {
+    rewrite[source] = true;
+  }
+  std::vector<uint32_t> changed;
+  for (uint32_t source = 0; source < m_spf.GetNNodes (); ++source)
+  {
+    if (rewrite[source] || GetTarget (source, link) != targets[source])
+    {
+      changed.push_back (source);
+      InstallRoutes (source);
+    }
+  }
+  double ms = clock.GetMilliSeconds ();
+  ++m_events;
+  m_tablesRewritten += changed.size ();
+  m_updateMs += ms;
+  NS_LOG_INFO ("Link " << m_topology.GetSpec ().links[link].name << (up ? " up" : " down") << ": "
+                       << m_spf.GetLastSources () << " trees updated, " << changed.size ()
+                       << " tables rewritten in " << ms << " ms");
+}
+
+inline void
+IncrementalGlobalRouting::PrintStats (std::ostream &os) const
+{
+  os << "Incremental SPF: initial install " << m_installMs << " ms, " << m_events << " interface events, "
+     << m_updateMs << " ms updating, " << m_tablesRewritten << " tables rewritten" << std::endl;
+}
+
+} // namespace spf
+
+using spf::IncrementalGlobalRouting;
+
+} // namespace ns3
+
+#endif /* INCREMENTAL_GLOBAL_ROUTING_H */
@@ -0,0 +1,1520 @@
+// OSPF de área única para comparar com o Rip sob as mesmas falhas: no lugar
+// do oráculo Ipv4GlobalRoutingHelper::PopulateRoutingTables, cada roteador
+// troca hellos, inunda Router-LSAs com número de sequência e confirmação e
+// roda o SPF sobre o próprio LSDB.
+//
+//  - pacotes IP de protocolo 89 para 224.0.0.5 (AllSPFRouters), um socket
+//    raw por interface, com os formatos do RFC 2328 para Hello, LS Update e
+//    LS Ack (sem checksum nem autenticação);
+//  - hello a cada HelloInterval; o vizinho cai quando passa RouterDeadInterval
+//    sem hello, ou na hora se a interface cair deste lado;
+//  - sem eleição de DR nem troca de Database Description: a adjacência sobe
+//    no 2-way e cada ponta manda o LSDB inteiro ao vizinho num LS Update, com
+//    confirmação e retransmissão a cada RxmtInterval como na inundação. Os
+//    enlaces do TopologyLoader têm duas pontas, então cada enlace CSMA se
+//    comporta como ponto a ponto;
+//  - Router-LSA com um enlace ponto a ponto por vizinho adjacente e uma rede
+//    stub por interface (as interfaces excluídas, viradas para hosts, só
+//    anunciam a stub); a métrica é a Ipv4::GetMetric da interface;
+//  - LSA e SPF com espera exponencial (como o "timers throttle" dos
+//    roteadores): o primeiro evento depois de um período calmo espera o
+//    atraso inicial, os seguintes esperam o hold, que dobra a cada nova
+//    execução até o máximo e volta ao início depois de 2 * máximo sem eventos;
+//  - ECMP entre caminhos de mesmo custo, escolhido por hash de origem e
+//    destino; a tabela fica ordenada por prefixo e a busca vai por uma
+//    PrefixTrie (prefix-trie.h) refeita, com a geração da tabela
+//    (route-generation.h), a cada SPF.
+//
+// O custo do plano de controle fica em GetStats (pacotes e bytes enviados
+// por tipo, retransmissões, execuções do SPF e o tempo de parede gasto
+// nelas); Report soma tudo para um conjunto de nós.
+//
+//   OspfHelper ospf;
+//   ospf.ExcludeInterface (router, 2);
+//   ospf.Set ("SpfHoldTime", TimeValue (MilliSeconds (500)));
+//   InternetStackHelper internet;
+//   internet.SetRoutingHelper (ospf);
+//   ...
+//   OspfRouting::Report (std::cout, routers);
+
+#ifndef OSPF_ROUTING_H
+#define OSPF_ROUTING_H
+
+#include "prefix-trie.h"
+#include "resource-usage.h"
+#include "route-generation.h"
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <ostream>
+#include <queue>
+#include <set>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+namespace ospf {
+
+NS_LOG_COMPONENT_DEFINE ("OspfRouting");
+
+// enlace de uma Router-LSA (RFC 2328, A.4.2)
+struct OspfLsaLink
+{
+  enum Type
+  {
+    POINT_TO_POINT = 1, // id: router id do vizinho, data: endereço da interface
+    STUB = 3            // id: rede, data: máscara
+  };
+
+  uint32_t id;
+  uint32_t data;
+  uint8_t type;
+  uint16_t metric;
+};
+
+struct OspfLsa
+{
+  static const uint8_t ROUTER_LSA = 1;
+  static const uint32_t HEADER_SIZE = 20;
+
+  uint16_t age; // segundos
+  uint32_t advertisingRouter;
+  uint32_t sequence; // comparado como int32_t, a partir de 0x80000001
+  std::vector<OspfLsaLink> links;
+
+  uint32_t GetSerializedSize () const
+  {
+    return HEADER_SIZE + 4 + 12 * links.size ();
+  }
+
+  // só o cabeçalho, usado nos LS Acks
+  void SerializeHeader (Buffer::Iterator &i) const
+  {
+    i.WriteHtonU16 (age);
+    i.WriteU8 (0); // options
+    i.WriteU8 (ROUTER_LSA);
+    i.WriteHtonU32 (advertisingRouter); // link state id
+    i.WriteHtonU32 (advertisingRouter);
+    i.WriteHtonU32 (sequence);
+    i.WriteHtonU16 (0); // checksum
+    i.WriteHtonU16 (GetSerializedSize ());
+  }
+
+  // devolve o tamanho anunciado no cabeçalho
+  uint16_t DeserializeHeader (Buffer::Iterator &i)
+  {
+    age = i.ReadNtohU16 ();
+    i.Next (2);
+    i.ReadNtohU32 ();
+    advertisingRouter = i.ReadNtohU32 ();
+    sequence = i.ReadNtohU32 ();
+    i.Next (2);
+    return i.ReadNtohU16 ();
+  }
+
+  void Serialize (Buffer::Iterator &i) const
+  {
+    SerializeHeader (i);
+    i.WriteHtonU16 (0); // flags
+    i.WriteHtonU16 (links.size ());
+    for (const OspfLsaLink &link : links)
+    {
+      i.WriteHtonU32 (link.id);
+      i.WriteHtonU32 (link.data);
+      i.WriteU8 (link.type);
+      i.WriteU8 (0); // métricas de TOS
+      i.WriteHtonU16 (link.metric);
+    }
+  }
+
+  void Deserialize (Buffer::Iterator &i)
+  {
+    DeserializeHeader (i);
+    i.Next (2);
+    links.resize (i.ReadNtohU16 ());
+    for (OspfLsaLink &link : links)
+    {
+      link.id = i.ReadNtohU32 ();
+      link.data = i.ReadNtohU32 ();
+      link.type = i.ReadU8 ();
+      i.Next (1);
+      link.metric = i.ReadNtohU16 ();
+    }
+  }
+};
+
+// cabeçalho comum (24 bytes) e corpo de um pacote OSPF
+class OspfHeader : public Header
+{
+public:
+  enum Type
+  {
+    HELLO = 1,
+    LS_UPDATE = 4,
+    LS_ACK = 5
+  };
+
+  static const uint32_t COMMON_SIZE = 24;
+  static const uint32_t HELLO_SIZE = 20;
+
+  OspfHeader ()
+    : m_type (HELLO),
+      m_routerId (0),
+      m_mask (0),
+      m_helloInterval (0),
+      m_deadInterval (0)
+  {
+  }
+
+  static TypeId GetTypeId ()
+  {
+    static TypeId tid = TypeId ("ns3::OspfHeader").SetParent<Header> ().AddConstructor<OspfHeader> ();
+    return tid;
+  }
+
+  TypeId GetInstanceTypeId () const override
+  {
+    return GetTypeId ();
+  }
+
+  uint32_t GetSerializedSize () const override
+  {
+    uint32_t size = COMMON_SIZE;
+    switch (m_type)
+    {
+    case HELLO:
+      return size + HELLO_SIZE + 4 * m_neighbors.size ();
+    case LS_UPDATE:
+      size += 4;
+      for (const OspfLsa &lsa : m_lsas)
+      {
+        size += lsa.GetSerializedSize ();
+      }
+      return size;
+    default:
+      return size + OspfLsa::HEADER_SIZE * m_lsas.size ();
+    }
+  }
+
+  void Serialize (Buffer::Iterator start) const override
+  {
+    Buffer::Iterator i = start;
+    i.WriteU8 (2); // versão
+    i.WriteU8 (m_type);
+    i.WriteHtonU16 (GetSerializedSize ());
+    i.WriteHtonU32 (m_routerId);
+    i.WriteHtonU32 (0); // área 0
+    i.WriteHtonU16 (0); // checksum
+    i.WriteHtonU16 (0); // sem autenticação
+    i.WriteHtonU64 (0);
+    if (m_type == HELLO)
+    {
+      i.WriteHtonU32 (m_mask);
+      i.WriteHtonU16 (m_helloInterval);
+      i.WriteU8 (0); // options
+      i.WriteU8 (0); // prioridade: nunca DR
+      i.WriteHtonU32 (m_deadInterval);
+      i.WriteHtonU32 (0); // DR
+      i.WriteHtonU32 (0); // BDR
+      for (uint32_t neighbor : m_neighbors)
+      {
+        i.WriteHtonU32 (neighbor);
+      }
+    }
+    else if (m_type == LS_UPDATE)
+    {
+      i.WriteHtonU32 (m_lsas.size ());
+      for (const OspfLsa &lsa : m_lsas)
+      {
+        lsa.Serialize (i);
+      }
+    }
+    else
+    {
+      for (const OspfLsa &lsa : m_lsas)
+      {
+        lsa.SerializeHeader (i);
+      }
+    }
+  }
+
+  uint32_t Deserialize (Buffer::Iterator start) override
+  {
+    Buffer::Iterator i = start;
+    i.Next (1);
+    m_type = i.ReadU8 ();
+    uint16_t length = i.ReadNtohU16 ();
+    m_routerId = i.ReadNtohU32 ();
+    i.Next (4 + 2 + 2 + 8);
+    m_neighbors.clear ();
+    m_lsas.clear ();
+    if (m_type == HELLO)
+    {
+      m_mask = i.ReadNtohU32 ();
+      m_helloInterval = i.ReadNtohU16 ();
+      i.Next (2);
+      m_deadInterval = i.ReadNtohU32 ();
+      i.Next (8);
+      for (uint32_t n = COMMON_SIZE + HELLO_SIZE; n + 4 <= length; n += 4)
+      {
+        m_neighbors.push_back (i.ReadNtohU32 ());
+      }
+    }
+    else if (m_type == LS_UPDATE)
+    {
+      m_lsas.resize (i.ReadNtohU32 ());
+      for (OspfLsa &lsa : m_lsas)
+      {
+        lsa.Deserialize (i);
+      }
+    }
+    else
+    {
+      m_lsas.resize ((length - COMMON_SIZE) / OspfLsa::HEADER_SIZE);
+      for (OspfLsa &lsa : m_lsas)
+      {
+        lsa.DeserializeHeader (i);
+      }
+    }
+    return i.GetDistanceFrom (start);
+  }
+
+  void Print (std::ostream &os) const override
+  {
+    os << "type " << uint32_t (m_type) << " router " << Ipv4Address (m_routerId);
+    if (m_type == HELLO)
+    {
+      os << " neighbors " << m_neighbors.size ();
+    }
+    else
+    {
+      os << " lsas " << m_lsas.size ();
+    }
+  }
+
+  uint8_t m_type;
+  uint32_t m_routerId;
+  // hello
+  uint32_t m_mask;
+  uint16_t m_helloInterval;
+  uint32_t m_deadInterval;
+  std::vector<uint32_t> m_neighbors;
+  // LS Update (LSAs inteiras) e LS Ack (só os cabeçalhos)
+  std::vector<OspfLsa> m_lsas;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (OspfHeader);
+
+// espera exponencial entre execuções de uma ação (origem de LSA, SPF)
+class OspfThrottle
+{
+public:
+  OspfThrottle ()
+    : m_ran (false)
+  {
+  }
+
+  void Configure (Time initial, Time hold, Time maximum)
+  {
+    m_initial = initial;
+    m_hold = hold;
+    m_maximum = maximum;
+    m_wait = hold;
+  }
+
+  // espera até a próxima execução, pedida agora
+  Time GetDelay ()
+  {
+    Time now = Simulator::Now ();
+    if (!m_ran || now - m_last >= m_maximum + m_maximum)
+    {
+      m_wait = m_hold;
+      return m_initial;
+    }
+    Time delay = std::max (m_initial, m_last + m_wait - now);
+    m_wait = std::min (m_wait + m_wait, m_maximum);
+    return std::max (delay, Seconds (0));
+  }
+
+  void NotifyRun ()
+  {
+    m_ran = true;
+    m_last = Simulator::Now ();
+  }
+
+private:
+  Time m_initial;
+  Time m_hold;
+  Time m_maximum;
+  Time m_wait;
+  Time m_last;
+  bool m_ran;
+};
+
+class OspfRouting : public Ipv4RoutingProtocol, public RouteGeneration
+{
+public:
+  static const uint8_t PROT_NUMBER = 89;
+
+  struct Stats
+  {
+    uint64_t hellosSent;
+    uint64_t updatesSent;
+    uint64_t acksSent;
+    uint64_t lsasSent;        // LSAs dentro dos LS Updates
+    uint64_t retransmissions; // LSAs reenviadas sem confirmação
+    uint64_t bytesSent;       // com o cabeçalho IP
+    uint64_t packetsReceived;
+    uint64_t bytesReceived;
+    uint64_t lsasOriginated;
+    uint64_t spfRuns;
+    double spfMs; // tempo de parede nos SPFs
+  };
+
+  // roteador anunciante, sequência e enlaces da LSA instalada
+  typedef void (*LsaInstallTracedCallback) (uint32_t advertisingRouter, uint32_t sequence, uint32_t links);
+  // rotas calculadas
+  typedef void (*SpfRunTracedCallback) (uint32_t routes);
+
+  static TypeId GetTypeId ()
+  {
+    static TypeId tid =
+      TypeId ("ns3::OspfRouting")
+        .SetParent<Ipv4RoutingProtocol> ()
+        .AddConstructor<OspfRouting> ()
+        .AddAttribute ("HelloInterval", "Interval between hellos on each interface", TimeValue (Seconds (10)),
+                       MakeTimeAccessor (&OspfRouting::m_helloInterval), MakeTimeChecker ())
+        .AddAttribute ("RouterDeadInterval", "Time without hellos after which a neighbor is down",
+                       TimeValue (Seconds (40)), MakeTimeAccessor (&OspfRouting::m_deadInterval),
+                       MakeTimeChecker ())
+        .AddAttribute ("RxmtInterval", "Interval between retransmissions of unacknowledged LSAs",
+                       TimeValue (Seconds (5)), MakeTimeAccessor (&OspfRouting::m_rxmtInterval), MakeTimeChecker ())
+        .AddAttribute ("LsRefreshTime", "Interval between refreshes of the router's own LSA",
+                       TimeValue (Seconds (1800)), MakeTimeAccessor (&OspfRouting::m_refreshTime), MakeTimeChecker ())
+        .AddAttribute ("MaxAge", "Age at which an LSA is removed from the database", TimeValue (Seconds (3600)),
+                       MakeTimeAccessor (&OspfRouting::m_maxAge), MakeTimeChecker ())
+        .AddAttribute ("LsaDelay", "Delay of the first LSA origination after a quiet period",
+                       TimeValue (Seconds (0)), MakeTimeAccessor (&OspfRouting::m_lsaDelay), MakeTimeChecker ())
+        .AddAttribute ("LsaHoldTime", "Initial hold time between LSA originations", TimeValue (Seconds (1)),
+                       MakeTimeAccessor (&OspfRouting::m_lsaHold), MakeTimeChecker ())
+        .AddAttribute ("LsaMaxHoldTime", "Maximum hold time between LSA originations", TimeValue (Seconds (5)),
+                       MakeTimeAccessor (&OspfRouting::m_lsaMaxHold), MakeTimeChecker ())
+        .AddAttribute ("SpfDelay", "Delay of the first SPF after a quiet period", TimeValue (MilliSeconds (50)),
+                       MakeTimeAccessor (&OspfRouting::m_spfDelay), MakeTimeChecker ())
+        .AddAttribute ("SpfHoldTime", "Initial hold time between SPF runs", TimeValue (MilliSeconds (200)),
+                       MakeTimeAccessor (&OspfRouting::m_spfHold), MakeTimeChecker ())
+        .AddAttribute ("SpfMaxHoldTime", "Maximum hold time between SPF runs", TimeValue (Seconds (5)),
+                       MakeTimeAccessor (&OspfRouting::m_spfMaxHold), MakeTimeChecker ())
+        .AddTraceSource ("LsaInstall", "An LSA enters the database",
+                         MakeTraceSourceAccessor (&OspfRouting::m_lsaInstallTrace),
+                         "ns3::OspfRouting::LsaInstallTracedCallback")
+        .AddTraceSource ("SpfRun", "The routing table is recomputed",
+                         MakeTraceSourceAccessor (&OspfRouting::m_spfTrace),
+                         "ns3::OspfRouting::SpfRunTracedCallback");
+    return tid;
+  }
+
+  OspfRouting ()
+    : m_routerId (0),
+      m_sequence (0x80000000u),
+      m_initialized (false),
+      m_stats ()
+  {
+    m_rng = CreateObject<UniformRandomVariable> ();
+  }
+
+  void SetInterfaceExclusions (const std::set<uint32_t> &exclusions)
+  {
+    m_exclusions = exclusions;
+  }
+
+  int64_t AssignStreams (int64_t stream)
+  {
+    m_rng->SetStream (stream);
+    return 1;
+  }
+
+  uint32_t GetRouterId () const
+  {
+    return m_routerId;
+  }
+
+  const Stats &GetStats () const
+  {
+    return m_stats;
+  }
+
+  uint32_t GetNLsas () const
+  {
+    return m_lsdb.size ();
+  }
+
+  // vizinho adjacente, salvo e restaurado pelo WarmStart (warm-start.h)
+  struct Adjacency
+  {
+    uint32_t interface;
+    uint32_t routerId;
+    Ipv4Address address;
+  };
+
+  // LSDB com a idade atual
+  std::vector<OspfLsa> ExportLsdb () const
+  {
+    std::vector<OspfLsa> lsas;
+    for (const std::pair<const uint32_t, LsdbEntry> &entry : m_lsdb)
+    {
+      lsas.push_back (GetCurrent (entry.second));
+    }
+    return lsas;
+  }
+
+  std::vector<Adjacency> ExportAdjacencies () const
+  {
+    std::vector<Adjacency> adjacencies;
+    for (const std::pair<const uint32_t, Interface> &interface : m_interfaces)
+    {
+      for (const std::pair<const uint32_t, Neighbor> &neighbor : interface.second.neighbors)
+      {
+        if (neighbor.second.adjacent)
+        {
+          adjacencies.push_back (Adjacency {interface.first, neighbor.first, neighbor.second.address});
+        }
+      }
+    }
+    return adjacencies;
+  }
+
+  // depois do DoInitialize e antes da primeira Router-LSA (LsaDelay): a
+  // própria LSA salva só adianta a sequência, e a próxima passa por cima dela
+  void ImportLsa (const OspfLsa &lsa)
+  {
+    NS_ABORT_MSG_IF (!m_initialized, "OspfRouting::ImportLsa before initialization");
+    if (lsa.advertisingRouter == m_routerId)
+    {
+      m_sequence = std::max<int32_t> (m_sequence, lsa.sequence);
+    }
+    Install (lsa);
+  }
+
+  // adjacência sem esperar os hellos; cai no DeadInterval se o vizinho
+  // não confirmar
+  void ImportAdjacency (const Adjacency &adjacency)
+  {
+    NS_ABORT_MSG_IF (!m_initialized, "OspfRouting::ImportAdjacency before initialization");
+    std::map<uint32_t, Interface>::iterator interface = m_interfaces.find (adjacency.interface);
+    if (interface == m_interfaces.end ())
+    {
+      return;
+    }
+    Neighbor &neighbor = interface->second.neighbors[adjacency.routerId];
+    neighbor.routerId = adjacency.routerId;
+    neighbor.address = adjacency.address;
+    neighbor.adjacent = true;
+    neighbor.deadEvent.Cancel ();
+    neighbor.deadEvent = Simulator::Schedule (m_deadInterval, &OspfRouting::NeighborDead, this, adjacency.interface,
+                                              adjacency.routerId);
+    RequestLsa ();
+  }
+
+  Ptr<Ipv4Route> RouteOutput (Ptr<Packet> /* p */, const Ipv4Header &header, Ptr<NetDevice> oif,
+                              Socket::SocketErrno &sockerr) override
+  {
+    Ptr<Ipv4Route> route = Lookup (header.GetSource (), header.GetDestination (), oif);
+    sockerr = route ? Socket::ERROR_NOTERROR : Socket::ERROR_NOROUTETOHOST;
+    return route;
+  }
+
+  bool RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev,
+                   UnicastForwardCallback ucb, MulticastForwardCallback /* mcb */, LocalDeliverCallback lcb,
+                   ErrorCallback ecb) override
+  {
+    NS_ASSERT (m_ipv4->GetInterfaceForDevice (idev) >= 0);
+    uint32_t iif = m_ipv4->GetInterfaceForDevice (idev);
+    Ipv4Address destination = header.GetDestination ();
+    // inclui 224.0.0.5: os hellos e LSAs chegam aos sockets raw por aqui
+    if (m_ipv4->IsDestinationAddress (destination, iif))
+    {
+      if (lcb.IsNull ())
+      {
+        return false;
+      }
+      lcb (p, header, iif);
+      return true;
+    }
+    if (destination.IsMulticast () || destination.IsBroadcast ())
+    {
+      return false;
+    }
+    if (!m_ipv4->IsForwarding (iif))
+    {
+      ecb (p, header, Socket::ERROR_NOROUTETOHOST);
+      return true;
+    }
+    Ptr<Ipv4Route> route = Lookup (header.GetSource (), destination, nullptr);
+    if (route == nullptr)
+    {
+      return false;
+    }
+    ucb (route, p, header);
+    return true;
+  }
+
+  void NotifyInterfaceUp (uint32_t interface) override
+  {
+    if (!m_initialized)
+    {
+      return;
+    }
+    OpenInterface (interface);
+    RequestLsa ();
+    RequestSpf ();
+  }
+
+  void NotifyInterfaceDown (uint32_t interface) override
+  {
+    if (!m_initialized)
+    {
+      return;
+    }
+    CloseInterface (interface);
+    // sem esperar o SPF: nada mais sai por uma interface fora do ar
+    m_routes.erase (std::remove_if (m_routes.begin (), m_routes.end (),
+                                    [interface] (const Route &route) { return route.interface == interface; }),
+                    m_routes.end ());
+    IndexRoutes ();
+    RequestLsa ();
+    RequestSpf ();
+  }
+
+  void NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress /* address */) override
+  {
+    if (m_initialized && m_ipv4->IsUp (interface))
+    {
+      OpenInterface (interface);
+      RequestLsa ();
+      RequestSpf ();
+    }
+  }
+
+  void NotifyRemoveAddress (uint32_t /* interface */, Ipv4InterfaceAddress /* address */) override
+  {
+    if (m_initialized)
+    {
+      RequestLsa ();
+      RequestSpf ();
+    }
+  }
+
+  void SetIpv4 (Ptr<Ipv4> ipv4) override
+  {
+    NS_ASSERT (m_ipv4 == nullptr && ipv4 != nullptr);
+    m_ipv4 = ipv4;
+  }
+
+  // no formato do Rip (Destination Gateway Genmask Flags Metric Ref Use Iface),
+  // lido pelo RouteRecorder e pelo ConvergenceMonitor
+  void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const override
+  {
+    std::ostream *os = stream->GetStream ();
+    *os << "Node: " << m_ipv4->GetObject<Node> ()->GetId () << ", Time: " << Simulator::Now ().As (unit)
+        << ", OSPF router " << Ipv4Address (m_routerId) << ", " << m_lsdb.size () << " LSAs\n";
+    *os << "Destination     Gateway         Genmask         Flags Metric Ref    Use Iface\n";
+    char line[128];
+    for (const Route &route : m_routes)
+    {
+      std::ostringstream destination;
+      std::ostringstream gateway;
+      std::ostringstream mask;
+      destination << Ipv4Address (route.network);
+      gateway << Ipv4Address (route.gateway);
+      mask << Ipv4Mask (route.mask);
+      std::snprintf (line, sizeof (line), "%-16s%-16s%-16s%-6s%-7u-      -   %u\n", destination.str ().c_str (),
+                     gateway.str ().c_str (), mask.str ().c_str (), route.gateway ? "UG" : "U", route.metric,
+                     route.interface);
+      *os << line;
+    }
+    *os << "\n";
+  }
+
+  // soma dos Stats dos nós com OSPF
+  static Stats GetTotalStats (NodeContainer nodes)
+  {
+    Stats total = Stats ();
+    for (uint32_t i = 0; i < nodes.GetN (); ++i)
+    {
+      Ptr<OspfRouting> routing = nodes.Get (i)->GetObject<OspfRouting> ();
+      if (routing == nullptr)
+      {
+        continue;
+      }
+      const Stats &stats = routing->GetStats ();
+      total.hellosSent += stats.hellosSent;
+      total.updatesSent += stats.updatesSent;
+      total.acksSent += stats.acksSent;
+      total.lsasSent += stats.lsasSent;
+      total.retransmissions += stats.retransmissions;
+      total.bytesSent += stats.bytesSent;
+      total.packetsReceived += stats.packetsReceived;
+      total.bytesReceived += stats.bytesReceived;
+      total.lsasOriginated += stats.lsasOriginated;
+      total.spfRuns += stats.spfRuns;
+      total.spfMs += stats.spfMs;
+    }
+    return total;
+  }
+
+  static void Report (std::ostream &os, NodeContainer nodes)
+  {
+    uint32_t routers = 0;
+    double maxSpfMs = 0;
+    for (uint32_t i = 0; i < nodes.GetN (); ++i)
+    {
+      if (Ptr<OspfRouting> routing = nodes.Get (i)->GetObject<OspfRouting> ())
+      {
+        ++routers;
+        maxSpfMs = std::max (maxSpfMs, routing->GetStats ().spfMs);
+      }
+    }
+    if (routers == 0)
+    {
+      return;
+    }
+    Stats total = GetTotalStats (nodes);
+    os << "OSPF " << routers << " routers: " << total.hellosSent << " hellos, " << total.updatesSent
+       << " LS updates (" << total.lsasSent << " LSAs, " << total.retransmissions << " retransmitted), "
+       << total.acksSent << " LS acks, " << total.bytesSent << " bytes sent; " << total.lsasOriginated
+       << " LSAs originated, " << total.spfRuns << " SPF runs in " << total.spfMs << " ms (max " << maxSpfMs
+       << " ms on one router)" << std::endl;
+  }
+
+private:
+  struct Route
+  {
+    uint32_t network;
+    uint32_t mask;
+    uint32_t gateway; // 0 nas redes conectadas
+    uint32_t interface;
+    uint32_t metric;
+  };
+
+  // rotas de um prefixo em m_routes (as de mesmo custo ficam juntas)
+  struct RouteRange
+  {
+    uint32_t first;
+    uint32_t count;
+  };
+
+  struct Neighbor
+  {
+    uint32_t routerId;
+    Ipv4Address address;
+    bool adjacent; // 2-way: entra na Router-LSA e na inundação
+    EventId deadEvent;
+    std::map<uint32_t, uint32_t> retransmit; // roteador anunciante -> sequência sem confirmação
+  };
+
+  struct Interface
+  {
+    Ptr<Socket> socket;
+    std::map<uint32_t, Neighbor> neighbors;
+  };
+
+  struct LsdbEntry
+  {
+    OspfLsa lsa;
+    Time installed;
+  };
+
+  // próximo salto a partir da raiz: (interface, gateway)
+  typedef std::set<std::pair<uint32_t, uint32_t> > NextHops;
+
+  static Ipv4Address AllSpfRouters ()
+  {
+    return Ipv4Address ("224.0.0.5");
+  }
+
+  // > 0 se 'a' é mais nova que 'b' (RFC 2328, 13.1, sem o checksum)
+  int Compare (const OspfLsa &a, const OspfLsa &b) const
+  {
+    if (a.sequence != b.sequence)
+    {
+      return int32_t (a.sequence) > int32_t (b.sequence) ? 1 : -1;
+    }
+    uint16_t maxAge = m_maxAge.GetSeconds ();
+    if ((a.age >= maxAge) != (b.age >= maxAge))
+    {
+      return a.age >= maxAge ? 1 : -1;
+    }
+    return 0;
+  }
+
+  // cópia do LSDB com a idade atual
+  OspfLsa GetCurrent (const LsdbEntry &entry) const
+  {
+    OspfLsa lsa = entry.lsa;
+    uint32_t age = lsa.age + uint32_t ((Simulator::Now () - entry.installed).GetSeconds ());
+    lsa.age = std::min<uint32_t> (age, m_maxAge.GetSeconds ());
+    return lsa;
+  }
+
+  bool IsActive (uint32_t interface) const
+  {
+    return interface != 0 && m_ipv4->IsUp (interface) && m_ipv4->GetNAddresses (interface) > 0
+           && m_exclusions.find (interface) == m_exclusions.end ();
+  }
+
+  void DoInitialize () override
+  {
+    m_lsaThrottle.Configure (m_lsaDelay, m_lsaHold, m_lsaMaxHold);
+    m_spfThrottle.Configure (m_spfDelay, m_spfHold, m_spfMaxHold);
+    // router id: o maior endereço das interfaces
+    for (uint32_t i = 1; i < m_ipv4->GetNInterfaces (); ++i)
+    {
+      for (uint32_t j = 0; j < m_ipv4->GetNAddresses (i); ++j)
+      {
+        m_routerId = std::max (m_routerId, m_ipv4->GetAddress (i, j).GetLocal ().Get ());
+      }
+    }
+    m_initialized = true;
+    for (uint32_t i = 1; i < m_ipv4->GetNInterfaces (); ++i)
+    {
+      OpenInterface (i);
+    }
+    // hellos sem sincronia entre roteadores
+    m_helloEvent = Simulator::Schedule (Seconds (m_rng->GetValue (0, 0.1 * m_helloInterval.GetSeconds ())),
+                                        &OspfRouting::SendHellos, this);
+    m_rxmtEvent = Simulator::Schedule (m_rxmtInterval, &OspfRouting::Retransmit, this);
+    RequestLsa ();
+    RequestSpf ();
+    Ipv4RoutingProtocol::DoInitialize ();
+  }
+
+  void DoDispose () override
+  {
+    for (std::pair<const uint32_t, Interface> &interface : m_interfaces)
+    {
+      for (std::pair<const uint32_t, Neighbor> &neighbor : interface.second.neighbors)
+      {
+        neighbor.second.deadEvent.Cancel ();
+      }
+      interface.second.socket->Close ();
+    }
+    m_interfaces.clear ();
+    m_helloEvent.Cancel ();
+    m_rxmtEvent.Cancel ();
+    m_lsaEvent.Cancel ();
+    m_spfEvent.Cancel ();
+    m_refreshEvent.Cancel ();
+    for (std::pair<const uint32_t, EventId> &expire : m_expireEvents)
+    {
+      expire.second.Cancel ();
+    }
+    m_expireEvents.clear ();
+    m_ipv4 = nullptr;
+    Ipv4RoutingProtocol::DoDispose ();
+  }
+
+  void OpenInterface (uint32_t interface)
+  {
+    if (!IsActive (interface) || m_interfaces.find (interface) != m_interfaces.end ())
+    {
+      return;
+    }
+    Ptr<Socket> socket = Socket::CreateSocket (m_ipv4->GetObject<Node> (), Ipv4RawSocketFactory::GetTypeId ());
+    socket->SetAttribute ("Protocol", UintegerValue (PROT_NUMBER));
+    socket->BindToNetDevice (m_ipv4->GetNetDevice (interface));
+    socket->SetRecvCallback (MakeCallback (&OspfRouting::Receive, this));
+    m_interfaces[interface].socket = socket;
+    SendHello (interface);
+  }
+
+  void CloseInterface (uint32_t interface)
+  {
+    std::map<uint32_t, Interface>::iterator it = m_interfaces.find (interface);
+    if (it == m_interfaces.end ())
+    {
+      return;
+    }
+    for (std::pair<const uint32_t, Neighbor> &neighbor : it->second.neighbors)
+    {
+      neighbor.second.deadEvent.Cancel ();
+    }
+    it->second.socket->Close ();
+    m_interfaces.erase (it);
+  }
+
+  void Send (uint32_t interface, OspfHeader &header)
+  {
+    header.m_routerId = m_routerId;
+    Ptr<Packet> packet = Create<Packet> ();
+    packet->AddHeader (header);
+    m_stats.bytesSent += packet->GetSize () + 20;
+    m_interfaces[interface].socket->SendTo (packet, 0, InetSocketAddress (AllSpfRouters (), 0));
+  }
+
+  void SendHello (uint32_t interface)
+  {
+    OspfHeader header;
+    header.m_type = OspfHeader::HELLO;
+    header.m_mask = m_ipv4->GetAddress (interface, 0).GetMask ().Get ();
+    header.m_helloInterval = m_helloInterval.GetSeconds ();
+    header.m_deadInterval = m_deadInterval.GetSeconds ();
+    for (const std::pair<const uint32_t, Neighbor> &neighbor : m_interfaces[interface].neighbors)
+    {
+      header.m_neighbors.push_back (neighbor.first);
+    }
+    ++m_stats.hellosSent;
+    Send (interface, header);
+  }
+
+  void SendHellos ()
+  {
+    for (const std::pair<const uint32_t, Interface> &interface : m_interfaces)
+    {
+      SendHello (interface.first);
+    }
+    m_helloEvent = Simulator::Schedule (m_helloInterval, &OspfRouting::SendHellos, this);
+  }
+
+  void SendUpdate (uint32_t interface, std::vector<OspfLsa> lsas)
+  {
+    OspfHeader header;
+    header.m_type = OspfHeader::LS_UPDATE;
+    for (OspfLsa &lsa : lsas)
+    {
+      lsa.age = std::min<uint32_t> (lsa.age + 1, m_maxAge.GetSeconds ()); // InfTransDelay
+    }
+    header.m_lsas.swap (lsas);
+    ++m_stats.updatesSent;
+    m_stats.lsasSent += header.m_lsas.size ();
+    Send (interface, header);
+  }
+
+  void SendAck (uint32_t interface, std::vector<OspfLsa> &lsas)
+  {
+    OspfHeader header;
+    header.m_type = OspfHeader::LS_ACK;
+    header.m_lsas.swap (lsas);
+    ++m_stats.acksSent;
+    Send (interface, header);
+  }
+
+  void Receive (Ptr<Socket> socket)
+  {
+    Address from;
+    Ptr<Packet> packet = socket->RecvFrom (from);
+    m_stats.bytesReceived += packet->GetSize ();
+    ++m_stats.packetsReceived;
+    Ipv4Header ipHeader;
+    packet->RemoveHeader (ipHeader);
+    OspfHeader header;
+    packet->RemoveHeader (header);
+    uint32_t interface = 0;
+    for (const std::pair<const uint32_t, Interface> &candidate : m_interfaces)
+    {
+      if (candidate.second.socket == socket)
+      {
+        interface = candidate.first;
+      }
+    }
+    if (interface == 0 || header.m_routerId == m_routerId)
+    {
+      return;
+    }
+    if (header.m_type == OspfHeader::HELLO)
+    {
+      ReceiveHello (interface, ipHeader.GetSource (), header);
+      return;
+    }
+    std::map<uint32_t, Neighbor> &neighbors = m_interfaces[interface].neighbors;
+    std::map<uint32_t, Neighbor>::iterator neighbor = neighbors.find (header.m_routerId);
+    if (neighbor == neighbors.end () || !neighbor->second.adjacent)
+    {
+      return;
+    }
+    if (header.m_type == OspfHeader::LS_UPDATE)
+    {
+      ReceiveUpdate (interface, neighbor->second, header);
+    }
+    else if (header.m_type == OspfHeader::LS_ACK)
+    {
+      for (const OspfLsa &lsa : header.m_lsas)
+      {
+        std::map<uint32_t, uint32_t>::iterator pending = neighbor->second.retransmit.find (lsa.advertisingRouter);
+        if (pending != neighbor->second.retransmit.end () && pending->second == lsa.sequence)
+        {
+          neighbor->second.retransmit.erase (pending);
+        }
+      }
+    }
+  }
+
+  void ReceiveHello (uint32_t interface, Ipv4Address source, const OspfHeader &header)
+  {
+    if (header.m_helloInterval != uint16_t (m_helloInterval.GetSeconds ())
+        || header.m_deadInterval != uint32_t (m_deadInterval.GetSeconds ()))
+    {
+      NS_LOG_WARN ("Hello from " << Ipv4Address (header.m_routerId) << " with different timers, ignored");
+      return;
+    }
+    std::map<uint32_t, Neighbor> &neighbors = m_interfaces[interface].neighbors;
+    bool heard = neighbors.find (header.m_routerId) != neighbors.end ();
+    Neighbor &neighbor = neighbors[header.m_routerId];
+    neighbor.routerId = header.m_routerId;
+    neighbor.address = source;
+    neighbor.deadEvent.Cancel ();
+    neighbor.deadEvent =
+      Simulator::Schedule (m_deadInterval, &OspfRouting::NeighborDead, this, interface, header.m_routerId);
+    bool twoWay = std::find (header.m_neighbors.begin (), header.m_neighbors.end (), m_routerId)
+                  != header.m_neighbors.end ();
+    if (twoWay && !neighbor.adjacent)
+    {
+      NS_LOG_INFO ("Adjacency with " << Ipv4Address (neighbor.routerId) << " on interface " << interface << " up");
+      neighbor.adjacent = true;
+      // no lugar da troca de Database Description: o LSDB inteiro, confirmado
+      std::vector<OspfLsa> lsas;
+      for (const std::pair<const uint32_t, LsdbEntry> &entry : m_lsdb)
+      {
+        lsas.push_back (GetCurrent (entry.second));
+        neighbor.retransmit[entry.first] = entry.second.lsa.sequence;
+      }
+      if (!lsas.empty ())
+      {
+        SendUpdate (interface, lsas);
+      }
+      RequestLsa ();
+    }
+    else if (!twoWay && neighbor.adjacent)
+    {
+      neighbor.adjacent = false;
+      neighbor.retransmit.clear ();
+      RequestLsa ();
+    }
+    if (!heard)
+    {
+      // para o vizinho se ver no hello sem esperar o HelloInterval
+      SendHello (interface);
+    }
+  }
+
+  void NeighborDead (uint32_t interface, uint32_t routerId)
+  {
+    NS_LOG_INFO ("Neighbor " << Ipv4Address (routerId) << " on interface " << interface << " dead");
+    std::map<uint32_t, Neighbor> &neighbors = m_interfaces.at (interface).neighbors;
+    bool adjacent = neighbors.at (routerId).adjacent;
+    neighbors.erase (routerId);
+    if (adjacent)
+    {
+      RequestLsa ();
+    }
+  }
+
+  // inundação (RFC 2328, 13), sem MinLSArrival
+  void ReceiveUpdate (uint32_t interface, Neighbor &neighbor, const OspfHeader &header)
+  {
+    std::vector<OspfLsa> acks;
+    uint16_t maxAge = m_maxAge.GetSeconds ();
+    for (const OspfLsa &lsa : header.m_lsas)
+    {
+      std::map<uint32_t, LsdbEntry>::iterator it = m_lsdb.find (lsa.advertisingRouter);
+      if (it == m_lsdb.end () && lsa.age >= maxAge)
+      {
+        acks.push_back (lsa);
+        continue;
+      }
+      int order = it == m_lsdb.end () ? 1 : Compare (lsa, GetCurrent (it->second));
+      if (order > 0)
+      {
+        acks.push_back (lsa);
+        if (lsa.advertisingRouter == m_routerId)
+        {
+          // instância antiga da própria LSA: a próxima passa por cima dela
+          m_sequence = std::max<int32_t> (m_sequence, lsa.sequence);
+          RequestLsa ();
+          continue;
+        }
+        Install (lsa);
+        Flood (lsa, interface);
+      }
+      else if (order == 0)
+      {
+        std::map<uint32_t, uint32_t>::iterator pending = neighbor.retransmit.find (lsa.advertisingRouter);
+        if (pending != neighbor.retransmit.end () && pending->second == lsa.sequence)
+        {
+          neighbor.retransmit.erase (pending); // confirmação implícita
+        }
+        else
+        {
+          acks.push_back (lsa);
+        }
+      }
+      else
+      {
+        // o vizinho tem uma cópia velha: devolve a nossa
+        neighbor.retransmit[lsa.advertisingRouter] = it->second.lsa.sequence;
+        SendUpdate (interface, std::vector<OspfLsa> (1, GetCurrent (it->second)));
+      }
+    }
+    if (!acks.empty ())
+    {
+      SendAck (interface, acks);
+    }
+  }
+
+  void Install (const OspfLsa &lsa)
+  {
+    m_lsdb[lsa.advertisingRouter] = LsdbEntry {lsa, Simulator::Now ()};
+    m_lsaInstallTrace (lsa.advertisingRouter, lsa.sequence, lsa.links.size ());
+    EventId &expire = m_expireEvents[lsa.advertisingRouter];
+    expire.Cancel ();
+    uint16_t maxAge = m_maxAge.GetSeconds ();
+    if (lsa.advertisingRouter != m_routerId && lsa.age < maxAge)
+    {
+      expire = Simulator::Schedule (Seconds (maxAge - lsa.age), &OspfRouting::Expire, this, lsa.advertisingRouter);
+    }
+    RequestSpf ();
+  }
+
+  // LSA que envelheceu sem ser renovada (o roteador sumiu)
+  void Expire (uint32_t advertisingRouter)
+  {
+    m_lsdb.erase (advertisingRouter);
+    m_expireEvents.erase (advertisingRouter);
+    RequestSpf ();
+  }
+
+  // manda a LSA aos vizinhos adjacentes das outras interfaces e a guarda
+  // para retransmissão até a confirmação
+  void Flood (const OspfLsa &lsa, uint32_t from)
+  {
+    for (std::pair<const uint32_t, Interface> &interface : m_interfaces)
+    {
+      if (interface.first == from)
+      {
+        continue;
+      }
+      bool send = false;
+      for (std::pair<const uint32_t, Neighbor> &neighbor : interface.second.neighbors)
+      {
+        if (neighbor.second.adjacent)
+        {
+          neighbor.second.retransmit[lsa.advertisingRouter] = lsa.sequence;
+          send = true;
+        }
+      }
+      if (send)
+      {
+        SendUpdate (interface.first, std::vector<OspfLsa> (1, lsa));
+      }
+    }
+  }
+
+  void Retransmit ()
+  {
+    for (std::pair<const uint32_t, Interface> &interface : m_interfaces)
+    {
+      std::map<uint32_t, OspfLsa> pending;
+      for (std::pair<const uint32_t, Neighbor> &neighbor : interface.second.neighbors)
+      {
+        std::map<uint32_t, uint32_t> &retransmit = neighbor.second.retransmit;
+        for (std::map<uint32_t, uint32_t>::iterator it = retransmit.begin (); it != retransmit.end ();)
+        {
+          std::map<uint32_t, LsdbEntry>::const_iterator entry = m_lsdb.find (it->first);
+          if (entry == m_lsdb.end ())
+          {
+            it = retransmit.erase (it);
+            continue;
+          }
+          it->second = entry->second.lsa.sequence;
+          pending[it->first] = GetCurrent (entry->second);
+          ++it;
+        }
+      }
+      if (!pending.empty ())
+      {
+        std::vector<OspfLsa> lsas;
+        for (const std::pair<const uint32_t, OspfLsa> &lsa : pending)
+        {
+          lsas.push_back (lsa.second);
+        }
+        m_stats.retransmissions += lsas.size ();
+        SendUpdate (interface.first, lsas);
+      }
+    }
+    m_rxmtEvent = Simulator::Schedule (m_rxmtInterval, &OspfRouting::Retransmit, this);
+  }
+
+  void RequestLsa ()
+  {
+    if (m_initialized && !m_lsaEvent.IsRunning ())
+    {
+      m_lsaEvent = Simulator::Schedule (m_lsaThrottle.GetDelay (), &OspfRouting::OriginateLsa, this);
+    }
+  }
+
+  void OriginateLsa ()
+  {
+    m_lsaThrottle.NotifyRun ();
+    OspfLsa lsa;
+    lsa.age = 0;
+    lsa.advertisingRouter = m_routerId;
+    lsa.sequence = ++m_sequence;
+    for (uint32_t i = 1; i < m_ipv4->GetNInterfaces (); ++i)
+    {
+      if (!m_ipv4->IsUp (i) || m_ipv4->GetNAddresses (i) == 0)
+      {
+        continue;
+      }
+      Ipv4InterfaceAddress address = m_ipv4->GetAddress (i, 0);
+      uint16_t metric = m_ipv4->GetMetric (i);
+      std::map<uint32_t, Interface>::const_iterator interface = m_interfaces.find (i);
+      if (interface != m_interfaces.end ())
+      {
+        for (const std::pair<const uint32_t, Neighbor> &neighbor : interface->second.neighbors)
+        {
+          if (neighbor.second.adjacent)
+          {
+            lsa.links.push_back (
+              OspfLsaLink {neighbor.first, address.GetLocal ().Get (), OspfLsaLink::POINT_TO_POINT, metric});
+          }
+        }
+      }
+      lsa.links.push_back (OspfLsaLink {address.GetLocal ().CombineMask (address.GetMask ()).Get (),
+                                        address.GetMask ().Get (), OspfLsaLink::STUB, metric});
+    }
+    ++m_stats.lsasOriginated;
+    Install (lsa);
+    Flood (lsa, 0);
+    m_refreshEvent.Cancel ();
+    m_refreshEvent = Simulator::Schedule (m_refreshTime, &OspfRouting::RequestLsa, this);
+  }
+
+  void RequestSpf ()
+  {
+    if (m_initialized && !m_spfEvent.IsRunning ())
+    {
+      m_spfEvent = Simulator::Schedule (m_spfThrottle.GetDelay (), &OspfRouting::RunSpf, this);
+    }
+  }
+
+  // LSA válida do roteador, ou nula
+  const OspfLsa *FindLsa (uint32_t router) const
+  {
+    std::map<uint32_t, LsdbEntry>::const_iterator it = m_lsdb.find (router);
+    if (it == m_lsdb.end () || GetCurrent (it->second).age >= m_maxAge.GetSeconds ())
+    {
+      return nullptr;
+    }
+    return &it->second.lsa;
+  }
+
+  static bool HasLinkTo (const OspfLsa &lsa, uint32_t router)
+  {
+    for (const OspfLsaLink &link : lsa.links)
+    {
+      if (link.type == OspfLsaLink::POINT_TO_POINT && link.id == router)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void RunSpf ()
+  {
+    WallClock clock;
+    m_spfThrottle.NotifyRun ();
+    std::map<uint32_t, uint32_t> distance;
+    std::map<uint32_t, NextHops> nextHops;
+    std::set<uint32_t> settled;
+    typedef std::pair<uint32_t, uint32_t> HeapEntry; // (distância, roteador)
+    std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry> > heap;
+    distance[m_routerId] = 0;
+    heap.push (HeapEntry (0, m_routerId));
+    while (!heap.empty ())
+    {
+      HeapEntry top = heap.top ();
+      heap.pop ();
+      uint32_t u = top.second;
+      if (!settled.insert (u).second)
+      {
+        continue;
+      }
+      const OspfLsa *lsa = FindLsa (u);
+      if (lsa == nullptr)
+      {
+        continue;
+      }
+      for (const OspfLsaLink &link : lsa->links)
+      {
+        const OspfLsa *other = link.type == OspfLsaLink::POINT_TO_POINT ? FindLsa (link.id) : nullptr;
+        if (other == nullptr || !HasLinkTo (*other, u) || settled.count (link.id))
+        {
+          continue;
+        }
+        NextHops hops;
+        if (u == m_routerId)
+        {
+          int32_t interface = m_ipv4->GetInterfaceForAddress (Ipv4Address (link.data));
+          std::map<uint32_t, Interface>::const_iterator it = m_interfaces.find (interface);
+          if (interface < 0 || it == m_interfaces.end () || it->second.neighbors.count (link.id) == 0)
+          {
+            continue;
+          }
+          hops.insert (std::make_pair (uint32_t (interface), it->second.neighbors.at (link.id).address.Get ()));
+        }
+        else
+        {
+          hops = nextHops[u];
+        }
+        uint32_t d = top.first + link.metric;
+        std::map<uint32_t, uint32_t>::iterator known = distance.find (link.id);
+        if (known == distance.end () || d < known->second)
+        {
+          distance[link.id] = d;
+          nextHops[link.id] = hops;
+          heap.push (HeapEntry (d, link.id));
+        }
+        else if (d == known->second)
+        {
+          nextHops[link.id].insert (hops.begin (), hops.end ());
+        }
+      }
+    }
+
+    // redes stub pelo roteador mais próximo que as anuncia
+    std::vector<Route> routes;
+    std::set<std::pair<uint32_t, uint32_t> > connected;
+    for (uint32_t i = 1; i < m_ipv4->GetNInterfaces (); ++i)
+    {
+      for (uint32_t j = 0; m_ipv4->IsUp (i) && j < m_ipv4->GetNAddresses (i); ++j)
+      {
+        Ipv4InterfaceAddress address = m_ipv4->GetAddress (i, j);
+        uint32_t network = address.GetLocal ().CombineMask (address.GetMask ()).Get ();
+        routes.push_back (Route {network, address.GetMask ().Get (), 0, i, 0});
+        connected.insert (std::make_pair (network, address.GetMask ().Get ()));
+      }
+    }
+    std::map<std::pair<uint32_t, uint32_t>, std::pair<uint32_t, NextHops> > best;
+    for (uint32_t router : settled)
+    {
+      const OspfLsa *lsa = FindLsa (router);
+      if (router == m_routerId || lsa == nullptr || nextHops[router].empty ())
+      {
+        continue;
+      }
+      for (const OspfLsaLink &link : lsa->links)
+      {
+        std::pair<uint32_t, uint32_t> prefix (link.id, link.data);
+        if (link.type != OspfLsaLink::STUB || connected.count (prefix))
+        {
+          continue;
+        }
+        uint32_t cost = distance[router] + link.metric;
+        std::map<std::pair<uint32_t, uint32_t>, std::pair<uint32_t, NextHops> >::iterator it = best.find (prefix);
+        if (it == best.end () || cost < it->second.first)
+        {
+          best[prefix] = std::make_pair (cost, nextHops[router]);
+        }
+        else if (cost == it->second.first)
+        {
+          it->second.second.insert (nextHops[router].begin (), nextHops[router].end ());
+        }
+      }
+    }
+    for (const auto &prefix : best)
+    {
+      for (const std::pair<uint32_t, uint32_t> &hop : prefix.second.second)
+      {
+        routes.push_back (Route {prefix.first.first, prefix.first.second, hop.second, hop.first, prefix.second.first});
+      }
+    }
+    m_routes.swap (routes);
+    IndexRoutes ();
+    ++m_stats.spfRuns;
+    m_stats.spfMs += clock.GetMilliSeconds ();
+    m_spfTrace (m_routes.size ());
+    NS_LOG_INFO ("SPF: " << settled.size () << " routers, " << m_routes.size () << " routes");
+  }
+
+  // ordena m_routes por prefixo (mantendo a ordem das de mesmo prefixo) e
+  // refaz a trie, um valor por prefixo
+  void IndexRoutes ()
+  {
+    NextRouteGeneration ();
+    std::stable_sort (m_routes.begin (), m_routes.end (), [] (const Route &a, const Route &b) {
+      return a.network != b.network ? a.network < b.network : a.mask < b.mask;
+    });
+    m_trie.Clear ();
+    for (uint32_t first = 0; first < m_routes.size ();)
+    {
+      uint32_t last = first + 1;
+      while (last < m_routes.size () && m_routes[last].network == m_routes[first].network
+             && m_routes[last].mask == m_routes[first].mask)
+      {
+        ++last;
+      }
+      m_trie.Insert (m_routes[first].network, PrefixTrie<RouteRange>::GetPrefixLength (m_routes[first].mask),
+                     RouteRange {first, last - first});
+      first = last;
+    }
+  }
+
+  // maior prefixo; entre rotas de mesmo custo, hash de origem e destino
+  Ptr<Ipv4Route> Lookup (Ipv4Address source, Ipv4Address destination, Ptr<NetDevice> oif) const
+  {
+    if (destination.IsLocalMulticast ())
+    {
+      NS_ASSERT_MSG (oif, "Local multicast sent without an output interface");
+      Ptr<Ipv4Route> route = Create<Ipv4Route> ();
+      route->SetSource (m_ipv4->GetAddress (m_ipv4->GetInterfaceForDevice (oif), 0).GetLocal ());
+      route->SetDestination (destination);
+      route->SetGateway (Ipv4Address::GetZero ());
+      route->SetOutputDevice (oif);
+      return route;
+    }
+    // com oif, o maior prefixo com alguma rota por ela
+    const RouteRange *range = m_trie.Lookup (destination.Get (), [this, oif] (const RouteRange &candidate) {
+      for (uint32_t i = candidate.first; oif && i < candidate.first + candidate.count; ++i)
+      {
+        if (m_ipv4->GetNetDevice (m_routes[i].interface) == oif)
+        {
+          return true;
+        }
+      }
+      return !oif;
+    });
+    if (range == nullptr)
+    {
+      return nullptr;
+    }
+    std::vector<const Route *> candidates;
+    for (uint32_t i = range->first; i < range->first + range->count; ++i)
+    {
+      if (!oif || m_ipv4->GetNetDevice (m_routes[i].interface) == oif)
+      {
+        candidates.push_back (&m_routes[i]);
+      }
+    }
+    uint32_t key[2] = {source.Get (), destination.Get ()};
+    const Route &chosen =
+      *candidates[candidates.size () == 1 ? 0 : Hash32 (reinterpret_cast<const char *> (key), sizeof (key))
+                                                     % candidates.size ()];
+    Ptr<Ipv4Route> route = Create<Ipv4Route> ();
+    route->SetDestination (destination);
+    route->SetSource (m_ipv4->GetAddress (chosen.interface, 0).GetLocal ());
+    route->SetGateway (Ipv4Address (chosen.gateway));
+    route->SetOutputDevice (m_ipv4->GetNetDevice (chosen.interface));
+    return route;
+  }
+
+  Ptr<Ipv4> m_ipv4;
+  Ptr<UniformRandomVariable> m_rng;
+  std::set<uint32_t> m_exclusions;
+  uint32_t m_routerId;
+  uint32_t m_sequence;
+  bool m_initialized;
+
+  Time m_helloInterval;
+  Time m_deadInterval;
+  Time m_rxmtInterval;
+  Time m_refreshTime;
+  Time m_maxAge;
+  Time m_lsaDelay;
+  Time m_lsaHold;
+  Time m_lsaMaxHold;
+  Time m_spfDelay;
+  Time m_spfHold;
+  Time m_spfMaxHold;
+
+  std::map<uint32_t, Interface> m_interfaces; // só as que trocam hellos
+  std::map<uint32_t, LsdbEntry> m_lsdb;       // Router-LSAs por roteador anunciante
+  std::map<uint32_t, EventId> m_expireEvents;
+  std::vector<Route> m_routes;
+  PrefixTrie<RouteRange> m_trie; // prefixos de m_routes, para o Lookup
+  OspfThrottle m_lsaThrottle;
+  OspfThrottle m_spfThrottle;
+  EventId m_helloEvent;
+  EventId m_rxmtEvent;
+  EventId m_lsaEvent;
+  EventId m_spfEvent;
+  EventId m_refreshEvent;
+  Stats m_stats;
+  TracedCallback<uint32_t, uint32_t, uint32_t> m_lsaInstallTrace;
+  TracedCallback<uint32_t> m_spfTrace;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (OspfRouting);
+
+// como o RipHelper: interfaces excluídas (passivas) e atributos
+class OspfHelper : public Ipv4RoutingHelper
+{
+public:
+  OspfHelper ()
+  {
+    m_factory.SetTypeId (OspfRouting::GetTypeId ());
+  }
+
+  OspfHelper *Copy () const override
+  {
+    return new OspfHelper (*this);
+  }
+
+  Ptr<Ipv4RoutingProtocol> Create (Ptr<Node> node) const override
+  {
+    Ptr<OspfRouting> ospf = m_factory.Create<OspfRouting> ();
+    std::map<Ptr<Node>, std::set<uint32_t> >::const_iterator it = m_exclusions.find (node);
+    if (it != m_exclusions.end ())
+    {
+      ospf->SetInterfaceExclusions (it->second);
+    }
+    node->AggregateObject (ospf);
+    return ospf;
+  }
+
+  void Set (std::string name, const AttributeValue &value)
+  {
+    m_factory.Set (name, value);
+  }
+
+  // a interface não troca hellos; a rede dela continua anunciada
+  void ExcludeInterface (Ptr<Node> node, uint32_t interface)
+  {
+    m_exclusions[node].insert (interface);
+  }
+
+  int64_t AssignStreams (NodeContainer nodes, int64_t stream)
+  {
+    int64_t current = stream;
+    for (NodeContainer::Iterator it = nodes.Begin (); it != nodes.End (); ++it)
+    {
+      Ptr<OspfRouting> ospf = (*it)->GetObject<OspfRouting> ();
+      if (ospf != nullptr)
+      {
+        current += ospf->AssignStreams (current);
+      }
+    }
+    return current - stream;
+  }
+
+private:
+  ObjectFactory m_factory;
+  std::map<Ptr<Node>, std::set<uint32_t> > m_exclusions;
+};
+
+} // namespace ospf
+
+using ospf::OspfHeader;
+using ospf::OspfHelper;
+using ospf::OspfRouting;
+
+} // namespace ns3
+
+#endif /* OSPF_ROUTING_H */
@@ -0,0 +1,294 @@
+// Trie binária comprimida (Patricia) de prefixos IPv4 para a busca do maior
+// prefixo: as tabelas da BatchedRip e da OspfRouting eram percorridas
+// inteiras a cada RouteOutput/RouteInput, e com milhares de prefixos essa
+// busca virava o custo de cada pacote.
+//
+// Cada nó guarda um prefixo (rede e comprimento) e só existe se tiver valor
+// ou dois filhos, então a altura é no máximo 33 e a busca visita só os
+// prefixos no caminho do endereço, qualquer que seja o tamanho da tabela.
+// Inserção e remoção são incrementais (um update RIP mexe em poucos nós); os
+// nós ficam num vetor com lista de livres, sem uma alocação por prefixo.
+//
+//   PrefixTrie<const Route *> trie;
+//   trie.Insert (network, PrefixTrie<const Route *>::GetPrefixLength (mask), &route);
+//   const Route *const *best = trie.Lookup (destination);
+//   best = trie.Lookup (destination, [] (const Route *route) { return route->metric < 16; });
+//
+// A busca com predicado devolve o maior prefixo cujo valor é aceito, para as
+// rotas que existem na tabela mas não podem ser usadas (métrica 16, rota
+// suprimida, outra interface de saída).
+//
+// Não depende do ns-3; bench/lpm_bench.cc mede a busca contra a varredura
+// linear.
+
+#ifndef PREFIX_TRIE_H
+#define PREFIX_TRIE_H
+
+#include <cstdint>
+#include <vector>
+
+namespace ns3 {
+
+template <typename T>
+class PrefixTrie
+{
+public:
+  PrefixTrie ()
+    : m_root (NONE),
+      m_size (0)
+  {
+  }
+
+  // bits 1 à esquerda da máscara (as máscaras de rota são contíguas)
+  static uint8_t GetPrefixLength (uint32_t mask)
+  {
+    uint8_t length = 0;
+    while (length < 32 && (mask & (0x80000000u >> length)))
+    {
+      ++length;
+    }
+    return length;
+  }
+
+  // acrescenta ou troca o valor do prefixo; 'network' sem bits fora da máscara
+  void Insert (uint32_t network, uint8_t length, const T &value)
+  {
+    network &= Mask (length);
+    uint32_t parent = NONE;
+    uint32_t side = 0;
+    uint32_t current = m_root;
+    while (current != NONE)
+    {
+      uint32_t key = m_nodes[current].key;
+      uint8_t nodeLength = m_nodes[current].length;
+      uint8_t common = CommonLength (key, nodeLength, network, length);
+      if (common == nodeLength && nodeLength == length)
+      {
+        if (!m_nodes[current].full)
+        {
+          ++m_size;
+        }
+        m_nodes[current].full = true;
+        m_nodes[current].value = value;
+        return;
+      }
+      if (common == nodeLength)
+      {
+        parent = current;
+        side = Bit (network, nodeLength);
+        current = m_nodes[current].child[side];
+        continue;
+      }
+      uint32_t leaf = NewNode (network, length, true, value);
+      if (common == length)
+      {
+        // o prefixo novo é ancestral do nó corrente
+        m_nodes[leaf].child[Bit (key, length)] = current;
+        SetLink (parent, side, leaf);
+      }
+      else
+      {
+        uint32_t branch = NewNode (network & Mask (common), common, false, T ());
+        m_nodes[branch].child[Bit (network, common)] = leaf;
+        m_nodes[branch].child[Bit (key, common)] = current;
+        SetLink (parent, side, branch);
+      }
+      ++m_size;
+      return;
+    }
+    SetLink (parent, side, NewNode (network, length, true, value));
+    ++m_size;
+  }
+
+  // false se o prefixo não estava na trie
+  bool Remove (uint32_t network, uint8_t length)
+  {
+    network &= Mask (length);
+    uint32_t grandparent = NONE;
+    uint32_t parentSide = 0;
+    uint32_t parent = NONE;
+    uint32_t side = 0;
+    uint32_t current = m_root;
+    while (current != NONE && m_nodes[current].length < length)
+    {
+      if (((m_nodes[current].key ^ network) & Mask (m_nodes[current].length)) != 0)
+      {
+        return false;
+      }
+      grandparent = parent;
+      parentSide = side;
+      parent = current;
+      side = Bit (network, m_nodes[current].length);
+      current = m_nodes[current].child[side];
+    }
+    if (current == NONE || m_nodes[current].length != length || m_nodes[current].key != network
+        || !m_nodes[current].full)
+    {
+      return false;
+    }
+    Node &node = m_nodes[current];
+    node.full = false;
+    node.value = T ();
+    --m_size;
+    if (node.child[0] != NONE && node.child[1] != NONE)
+    {
+      return true; // continua como bifurcação
+    }
+    SetLink (parent, side, node.child[0] != NONE ? node.child[0] : node.child[1]);
+    FreeNode (current);
+    // o pai sem valor que ficou com um filho só deixa de ser necessário
+    if (parent != NONE && !m_nodes[parent].full)
+    {
+      uint32_t other = m_nodes[parent].child[1 - side];
+      if (m_nodes[parent].child[side] == NONE)
+      {
+        SetLink (grandparent, parentSide, other);
+        FreeNode (parent);
+      }
+    }
+    return true;
+  }
+
+  T *Find (uint32_t network, uint8_t length)
+  {
+    network &= Mask (length);
+    uint32_t current = m_root;
+    while (current != NONE && m_nodes[current].length < length)
+    {
+      current = m_nodes[current].child[Bit (network, m_nodes[current].length)];
+    }
+    if (current == NONE || m_nodes[current].length != length || m_nodes[current].key != network
+        || !m_nodes[current].full)
+    {
+      return nullptr;
+    }
+    return &m_nodes[current].value;
+  }
+
+  // valor do maior prefixo que contém o endereço, nullptr se nenhum
+  const T *Lookup (uint32_t address) const
+  {
+    return Lookup (address, [] (const T &) { return true; });
+  }
+
+  // maior prefixo que contém o endereço e cujo valor 'accept' aceita
+  template <typename Accept>
+  const T *Lookup (uint32_t address, Accept accept) const
+  {
+    uint32_t path[33];
+    uint32_t depth = 0;
+    uint32_t current = m_root;
+    while (current != NONE)
+    {
+      const Node &node = m_nodes[current];
+      if (((node.key ^ address) & Mask (node.length)) != 0)
+      {
+        break;
+      }
+      if (node.full)
+      {
+        path[depth++] = current;
+      }
+      if (node.length == 32)
+      {
+        break;
+      }
+      current = node.child[Bit (address, node.length)];
+    }
+    while (depth > 0)
+    {
+      const T &value = m_nodes[path[--depth]].value;
+      if (accept (value))
+      {
+        return &value;
+      }
+    }
+    return nullptr;
+  }
+
+  void Clear ()
+  {
+    m_nodes.clear ();
+    m_free.clear ();
+    m_root = NONE;
+    m_size = 0;
+  }
+
+  // prefixos com valor
+  uint32_t GetSize () const
+  {
+    return m_size;
+  }
+
+private:
+  static const uint32_t NONE = 0xffffffffu;
+
+  struct Node
+  {
+    uint32_t key;
+    uint8_t length;
+    bool full; // tem valor (senão é só bifurcação)
+    uint32_t child[2];
+    T value;
+  };
+
+  static uint32_t Mask (uint8_t length)
+  {
+    return length == 0 ? 0 : 0xffffffffu << (32 - length);
+  }
+
+  // bit 'position' (0 é o mais significativo)
+  static uint32_t Bit (uint32_t key, uint8_t position)
+  {
+    return (key >> (31 - position)) & 1;
+  }
+
+  static uint8_t CommonLength (uint32_t a, uint8_t lengthA, uint32_t b, uint8_t lengthB)
+  {
+    uint32_t diff = a ^ b;
+    uint8_t common = diff == 0 ? 32 : __builtin_clz (diff);
+    common = common < lengthA ? common : lengthA;
+    return common < lengthB ? common : lengthB;
+  }
+
+  uint32_t NewNode (uint32_t key, uint8_t length, bool full, const T &value)
+  {
+    Node node = {key, length, full, {NONE, NONE}, value};
+    if (!m_free.empty ())
+    {
+      uint32_t index = m_free.back ();
+      m_free.pop_back ();
+      m_nodes[index] = node;
+      return index;
+    }
+    m_nodes.push_back (node);
+    return m_nodes.size () - 1;
+  }
+
+  void FreeNode (uint32_t index)
+  {
+    m_nodes[index].value = T ();
+    m_free.push_back (index);
+  }
+
+  void SetLink (uint32_t parent, uint32_t side, uint32_t child)
+  {
+    if (parent == NONE)
+    {
+      m_root = child;
+    }
+    else
+    {
+      m_nodes[parent].child[side] = child;
+    }
+  }
+
+  std::vector<Node> m_nodes;
+  std::vector<uint32_t> m_free;
+  uint32_t m_root;
+  uint32_t m_size;
+};
+
+} // namespace ns3
+
+#endif /* PREFIX_TRIE_H */
@@ -0,0 +1,80 @@
+// Medidas de tempo de parede e memória do próprio processo, usadas nos
+// relatórios de carga e nos benchmarks.
+
+#ifndef RESOURCE_USAGE_H
+#define RESOURCE_USAGE_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+class WallClock
+{
+public:
+  WallClock ()
+    : m_start (std::chrono::steady_clock::now ())
+  {
+  }
+
+  void Restart ()
+  {
+    m_start = std::chrono::steady_clock::now ();
+  }
+
+  double GetSeconds () const
+  {
+    return std::chrono::duration<double> (std::chrono::steady_clock::now () - m_start).count ();
+  }
+
+  double GetMilliSeconds () const
+  {
+    return GetSeconds () * 1e3;
+  }
+
+private:
+  std::chrono::steady_clock::time_point m_start;
+};
+
+// pico de memória residente do processo, em KiB
+inline uint64_t
+GetPeakRssKiB ()
+{
+  struct rusage usage;
+  if (getrusage (RUSAGE_SELF, &usage) != 0)
+  {
+    return 0;
+  }
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1024; // bytes no macOS
+#else
+  return usage.ru_maxrss;
+#endif
+}
+
+// memória residente atual, em KiB (0 se /proc não estiver disponível)
+inline uint64_t
+GetCurrentRssKiB ()
+{
+  FILE *statm = std::fopen ("/proc/self/statm", "r");
+  if (statm == nullptr)
+  {
+    return 0;
+  }
+  unsigned long size = 0;
+  unsigned long resident = 0;
+  int read = std::fscanf (statm, "%lu %lu", &size, &resident);
+  std::fclose (statm);
+  if (read != 2)
+  {
+    return 0;
+  }
+  return resident * (sysconf (_SC_PAGESIZE) / 1024);
+}
+
+} // namespace ns3
+
+#endif /* RESOURCE_USAGE_H */
@@ -0,0 +1,478 @@
+// Cache de rotas por nó na frente da Ipv4ListRouting: cada pacote repassado
+// passava pela lista de protocolos e depois pela tabela do protocolo; com o
+// cache, um destino já visto sai de uma tabela de acesso direto.
+//
+// A chave é (origem, destino), porque o ECMP da OspfRouting escolhe a saída
+// por hash dos dois. Há uma tabela para o RouteOutput e outra para o
+// RouteInput, de Size entradas cada, indexadas pelo hash da chave (um destino
+// novo toma o lugar do que caía na mesma posição). Só os casos comuns passam
+// pelo cache: RouteOutput sem interface de saída pedida e RouteInput de
+// unicast repassado; entrega local, multicast e broadcast vão direto à
+// lista.
+//
+// Invalidação por gerações: cada entrada guarda a soma dos contadores de
+// geração (route-generation.h) dos protocolos da lista e do próprio cache (que
+// avança a cada evento de interface) do momento em que foi preenchida, e só
+// vale enquanto a soma não mudar. Por isso os protocolos da lista precisam
+// ter o contador (BatchedRip, OspfRouting), ser a Ipv4StaticRouting, cujas
+// rotas são fixas depois da montagem (quem mudar rotas estáticas durante a
+// simulação chama Invalidate), ou ser o ns3::Rip.
+//
+// O ns3::Rip não tem contador nem trace de mudança de rota, mas a tabela dele
+// só muda em três casos, todos visíveis de fora: eventos de interface (que
+// passam pelo cache), a chegada de uma mensagem RIP (UDP na porta 520, vista
+// no trace LocalDeliver da Ipv4L3Protocol) e a expiração de uma rota, que
+// acontece TimeoutDelay depois da mensagem que a atualizou por último. O cache
+// avança a própria geração a cada mensagem RIP recebida e de novo TimeoutDelay
+// depois dela. Com o roteamento global, cujas tabelas são reescritas de fora
+// dos nós, a instalação aborta.
+//
+//   Ipv4ListRoutingHelper list;
+//   list.Add (ospf, 0);
+//   RouteCacheHelper cache (list);
+//   InternetStackHelper internet;
+//   internet.SetRoutingHelper (cache);
+//   ...
+//   RouteCache::Report (std::cout, routers);
+
+#ifndef ROUTE_CACHE_H
+#define ROUTE_CACHE_H
+
+#include "route-generation.h"
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/ipv4-list-routing.h"
+
+#include <algorithm>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+namespace ns3 {
+namespace routecache {
+
+NS_LOG_COMPONENT_DEFINE ("RouteCache");
+
+class RouteCache : public Ipv4RoutingProtocol
+{
+public:
+  struct Stats
+  {
+    uint64_t outputLookups; // que passaram pelo cache
+    uint64_t outputHits;
+    uint64_t inputLookups;
+    uint64_t inputHits;
+    uint64_t generations; // mudanças de geração vistas (invalidações)
+  };
+
+  static TypeId GetTypeId ()
+  {
+    static TypeId tid =
+      TypeId ("ns3::RouteCache")
+        .SetParent<Ipv4RoutingProtocol> ()
+        .AddConstructor<RouteCache> ()
+        .AddAttribute ("Size", "Entries of each table (output and input), rounded up to a power of 2",
+                       UintegerValue (1024), MakeUintegerAccessor (&RouteCache::m_size),
+                       MakeUintegerChecker<uint32_t> (1));
+    return tid;
+  }
+
+  RouteCache ()
+    : m_size (1024),
+      m_shift (0),
+      m_generation (0),
+      m_lastGeneration (0),
+      m_followRip (false),
+      m_pending (),
+      m_stats ()
+  {
+  }
+
+  // o roteamento de verdade (em geral a Ipv4ListRouting); antes do SetIpv4
+  void SetRouting (Ptr<Ipv4RoutingProtocol> routing)
+  {
+    m_routing = routing;
+    m_sources.clear ();
+    AddSources (routing);
+    uint32_t entries = 1;
+    m_shift = 64;
+    while (entries < m_size)
+    {
+      entries <<= 1;
+      --m_shift;
+    }
+    m_output.assign (entries, Entry ());
+    m_input.assign (entries, Entry ());
+  }
+
+  Ptr<Ipv4RoutingProtocol> GetRouting () const
+  {
+    return m_routing;
+  }
+
+  // descarta todas as entradas
+  void Invalidate ()
+  {
+    ++m_generation;
+  }
+
+  const Stats &GetStats () const
+  {
+    return m_stats;
+  }
+
+  Ptr<Ipv4Route> RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif,
+                              Socket::SocketErrno &sockerr) override
+  {
+    Ipv4Address destination = header.GetDestination ();
+    if (oif || destination.IsMulticast () || destination.IsBroadcast ())
+    {
+      return m_routing->RouteOutput (p, header, oif, sockerr);
+    }
+    ++m_stats.outputLookups;
+    uint64_t key = GetKey (header);
+    uint64_t generation = GetGeneration ();
+    Entry &entry = m_output[GetIndex (key)];
+    if (entry.route && entry.key == key && entry.generation == generation)
+    {
+      ++m_stats.outputHits;
+      sockerr = Socket::ERROR_NOTERROR;
+      return entry.route;
+    }
+    Ptr<Ipv4Route> route = m_routing->RouteOutput (p, header, oif, sockerr);
+    if (route)
+    {
+      entry = Entry {key, generation, route};
+    }
+    return route;
+  }
+
+  bool RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev,
+                   UnicastForwardCallback ucb, MulticastForwardCallback mcb, LocalDeliverCallback lcb,
+                   ErrorCallback ecb) override
+  {
+    uint32_t iif = m_ipv4->GetInterfaceForDevice (idev);
+    Ipv4Address destination = header.GetDestination ();
+    // as mesmas verificações que a Ipv4ListRouting faz antes dos protocolos
+    if (destination.IsMulticast () || destination.IsBroadcast () || m_ipv4->IsDestinationAddress (destination, iif)
+        || !m_ipv4->IsForwarding (iif))
+    {
+      return m_routing->RouteInput (p, header, idev, ucb, mcb, lcb, ecb);
+    }
+    ++m_stats.inputLookups;
+    uint64_t key = GetKey (header);
+    uint64_t generation = GetGeneration ();
+    Entry &entry = m_input[GetIndex (key)];
+    if (entry.route && entry.key == key && entry.generation == generation)
+    {
+      ++m_stats.inputHits;
+      ucb (entry.route, p, header);
+      return true;
+    }
+    // a rota escolhida chega pelo callback de repasse; guardada e repassada
+    // ao callback original (o anterior é restaurado no fim, caso o repasse
+    // volte a este nó)
+    Pending saved = m_pending;
+    m_pending = Pending {&entry, key, generation, ucb};
+    bool routed = m_routing->RouteInput (p, header, idev, MakeCallback (&RouteCache::Forward, this), mcb, lcb, ecb);
+    m_pending = saved;
+    return routed;
+  }
+
+  void NotifyInterfaceUp (uint32_t interface) override
+  {
+    Invalidate ();
+    m_routing->NotifyInterfaceUp (interface);
+  }
+
+  void NotifyInterfaceDown (uint32_t interface) override
+  {
+    Invalidate ();
+    m_routing->NotifyInterfaceDown (interface);
+  }
+
+  void NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address) override
+  {
+    Invalidate ();
+    m_routing->NotifyAddAddress (interface, address);
+  }
+
+  void NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address) override
+  {
+    Invalidate ();
+    m_routing->NotifyRemoveAddress (interface, address);
+  }
+
+  void SetIpv4 (Ptr<Ipv4> ipv4) override
+  {
+    NS_ASSERT_MSG (m_routing, "RouteCache::SetIpv4 before SetRouting");
+    m_ipv4 = ipv4;
+    m_routing->SetIpv4 (ipv4);
+    if (m_followRip)
+    {
+      ipv4->TraceConnectWithoutContext ("LocalDeliver", MakeCallback (&RouteCache::LocalDeliver, this));
+    }
+  }
+
+  void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const override
+  {
+    m_routing->PrintRoutingTable (stream, unit);
+  }
+
+  // o cache do nó, ou nulo
+  static Ptr<RouteCache> Find (Ptr<Node> node)
+  {
+    return node->GetObject<RouteCache> ();
+  }
+
+  // soma dos Stats dos nós com cache
+  static Stats GetTotalStats (NodeContainer nodes)
+  {
+    Stats total = Stats ();
+    for (uint32_t i = 0; i < nodes.GetN (); ++i)
+    {
+      Ptr<RouteCache> cache = Find (nodes.Get (i));
+      if (cache == nullptr)
+      {
+        continue;
+      }
+      const Stats &stats = cache->GetStats ();
+      total.outputLookups += stats.outputLookups;
+      total.outputHits += stats.outputHits;
+      total.inputLookups += stats.inputLookups;
+      total.inputHits += stats.inputHits;
+      total.generations += stats.generations;
+    }
+    return total;
+  }
+
+  // acertos sobre buscas, RouteOutput e RouteInput juntos
+  static double GetHitRate (const Stats &stats)
+  {
+    uint64_t lookups = stats.outputLookups + stats.inputLookups;
+    return lookups ? double (stats.outputHits + stats.inputHits) / lookups : 0;
+  }
+
+  static void Report (std::ostream &os, NodeContainer nodes)
+  {
+    uint32_t caches = 0;
+    double lowest = -1; // só entre os nós com alguma busca
+    for (uint32_t i = 0; i < nodes.GetN (); ++i)
+    {
+      if (Ptr<RouteCache> cache = Find (nodes.Get (i)))
+      {
+        ++caches;
+        const Stats &stats = cache->GetStats ();
+        if (stats.outputLookups + stats.inputLookups > 0)
+        {
+          double rate = GetHitRate (stats);
+          lowest = lowest < 0 ? rate : std::min (lowest, rate);
+        }
+      }
+    }
+    if (caches == 0)
+    {
+      return;
+    }
+    Stats total = GetTotalStats (nodes);
+    os << "Route cache on " << caches << " nodes: " << 100 * GetHitRate (total) << "% hits ("
+       << total.inputHits << "/" << total.inputLookups << " forwarded, " << total.outputHits << "/"
+       << total.outputLookups << " sent), lowest node ";
+    if (lowest < 0)
+    {
+      os << "n/a";
+    }
+    else
+    {
+      os << 100 * lowest << "%";
+    }
+    os << ", " << total.generations << " invalidations" << std::endl;
+  }
+
+protected:
+  void DoDispose () override
+  {
+    m_output.clear ();
+    m_input.clear ();
+    m_sources.clear ();
+    m_pending = Pending ();
+    m_routing = nullptr;
+    m_ipv4 = nullptr;
+    Ipv4RoutingProtocol::DoDispose ();
+  }
+
+private:
+  static const uint16_t RIP_PORT = 520; // o RIP_PORT do rip.cc
+
+  struct Entry
+  {
+    uint64_t key;
+    uint64_t generation;
+    Ptr<Ipv4Route> route; // nulo: vazia
+  };
+
+  // RouteInput em andamento, esperando a rota no Forward
+  struct Pending
+  {
+    Entry *entry;
+    uint64_t key;
+    uint64_t generation;
+    UnicastForwardCallback ucb;
+  };
+
+  // protocolos cujas mudanças invalidam o cache
+  void AddSources (Ptr<Ipv4RoutingProtocol> protocol)
+  {
+    if (Ptr<Ipv4ListRouting> list = DynamicCast<Ipv4ListRouting> (protocol))
+    {
+      for (uint32_t i = 0; i < list->GetNRoutingProtocols (); ++i)
+      {
+        int16_t priority;
+        AddSources (list->GetRoutingProtocol (i, priority));
+      }
+    }
+    else if (const RouteGeneration *source = dynamic_cast<const RouteGeneration *> (PeekPointer (protocol)))
+    {
+      m_sources.push_back (source);
+    }
+    else if (Ptr<Rip> rip = DynamicCast<Rip> (protocol))
+    {
+      TimeValue timeout;
+      rip->GetAttribute ("TimeoutDelay", timeout);
+      m_ripTimeout = timeout.Get ();
+      m_followRip = true;
+    }
+    else if (!DynamicCast<Ipv4StaticRouting> (protocol))
+    {
+      NS_FATAL_ERROR ("RouteCache cannot follow the changes of " << protocol->GetInstanceTypeId ().GetName ()
+                                                                 << "; use Rip, BatchedRip or OspfRouting");
+    }
+  }
+
+  // mensagem RIP entregue ao nó: o ns3::Rip pode mudar a tabela ao tratá-la,
+  // logo depois deste trace, e uma rota que ela atualizou expira TimeoutDelay
+  // depois
+  void LocalDeliver (const Ipv4Header &header, Ptr<const Packet> packet, uint32_t /* interface */)
+  {
+    UdpHeader udp;
+    if (header.GetProtocol () != UdpL4Protocol::PROT_NUMBER || packet->PeekHeader (udp) == 0
+        || udp.GetDestinationPort () != RIP_PORT)
+    {
+      return;
+    }
+    Invalidate ();
+    Simulator::ScheduleNow (&RouteCache::ScheduleRipTimeout, this);
+  }
+
+  // agendado depois de o Rip tratar a mensagem, para que a invalidação do
+  // cache rode depois da expiração da rota no mesmo instante
+  void ScheduleRipTimeout ()
+  {
+    Time at = Simulator::Now () + m_ripTimeout;
+    if (at != m_lastRipTimeout)
+    {
+      m_lastRipTimeout = at;
+      Simulator::Schedule (m_ripTimeout, &RouteCache::Invalidate, this);
+    }
+  }
+
+  uint64_t GetGeneration ()
+  {
+    uint64_t generation = m_generation;
+    for (const RouteGeneration *source : m_sources)
+    {
+      generation += source->GetRouteGeneration ();
+    }
+    if (generation != m_lastGeneration)
+    {
+      ++m_stats.generations;
+      m_lastGeneration = generation;
+    }
+    return generation;
+  }
+
+  static uint64_t GetKey (const Ipv4Header &header)
+  {
+    return uint64_t (header.GetSource ().Get ()) << 32 | header.GetDestination ().Get ();
+  }
+
+  uint32_t GetIndex (uint64_t key) const
+  {
+    return m_shift == 64 ? 0 : (key * 0x9e3779b97f4a7c15ull) >> m_shift;
+  }
+
+  void Forward (Ptr<Ipv4Route> route, Ptr<const Packet> p, const Ipv4Header &header)
+  {
+    *m_pending.entry = Entry {m_pending.key, m_pending.generation, route};
+    m_pending.ucb (route, p, header);
+  }
+
+  Ptr<Ipv4RoutingProtocol> m_routing;
+  Ptr<Ipv4> m_ipv4;
+  std::vector<const RouteGeneration *> m_sources;
+  uint32_t m_size;
+  uint32_t m_shift; // 64 - log2 (entradas)
+  std::vector<Entry> m_output;
+  std::vector<Entry> m_input;
+  uint64_t m_generation; // eventos de interface, mensagens RIP e Invalidate
+  uint64_t m_lastGeneration;
+  bool m_followRip;       // há um ns3::Rip na lista
+  Time m_ripTimeout;      // TimeoutDelay do Rip
+  Time m_lastRipTimeout;  // última expiração agendada
+  Pending m_pending;
+  Stats m_stats;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (RouteCache);
+
+// põe um RouteCache na frente do roteamento criado por outro helper
+class RouteCacheHelper : public Ipv4RoutingHelper
+{
+public:
+  explicit RouteCacheHelper (const Ipv4RoutingHelper &routing)
+    : m_routing (routing.Copy ())
+  {
+    m_factory.SetTypeId (RouteCache::GetTypeId ());
+  }
+
+  RouteCacheHelper (const RouteCacheHelper &other)
+    : m_factory (other.m_factory),
+      m_routing (other.m_routing->Copy ())
+  {
+  }
+
+  RouteCacheHelper &operator= (const RouteCacheHelper &) = delete;
+
+  RouteCacheHelper *Copy () const override
+  {
+    return new RouteCacheHelper (*this);
+  }
+
+  Ptr<Ipv4RoutingProtocol> Create (Ptr<Node> node) const override
+  {
+    Ptr<RouteCache> cache = m_factory.Create<RouteCache> ();
+    cache->SetRouting (m_routing->Create (node));
+    node->AggregateObject (cache);
+    return cache;
+  }
+
+  void Set (std::string name, const AttributeValue &value)
+  {
+    m_factory.Set (name, value);
+  }
+
+private:
+  ObjectFactory m_factory;
+  std::unique_ptr<Ipv4RoutingHelper> m_routing;
+};
+
+} // namespace routecache
+
+using routecache::RouteCache;
+using routecache::RouteCacheHelper;
+
+} // namespace ns3
+
+#endif /* ROUTE_CACHE_H */
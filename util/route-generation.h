@@ -0,0 +1,46 @@
+// Contador de geração da tabela de um protocolo de roteamento: o protocolo
+// chama NextRouteGeneration a cada mudança que pode alterar o resultado de
+// uma busca (rota nova, removida, com outro próximo salto ou métrica,
+// suprimida), e o RouteCache (route-cache.h) compara a soma dos contadores
+// com a guardada em cada entrada para saber se ela ainda vale, sem ser
+// avisado de cada mudança.
+//
+//   class MeuRoteamento : public Ipv4RoutingProtocol, public RouteGeneration
+
+#ifndef ROUTE_GENERATION_H
+#define ROUTE_GENERATION_H
+
+#include <cstdint>
+
+namespace ns3 {
+
+class RouteGeneration
+{
+public:
+  virtual ~RouteGeneration ()
+  {
+  }
+
+  uint64_t GetRouteGeneration () const
+  {
+    return m_routeGeneration;
+  }
+
+protected:
+  RouteGeneration ()
+    : m_routeGeneration (0)
+  {
+  }
+
+  void NextRouteGeneration ()
+  {
+    ++m_routeGeneration;
+  }
+
+private:
+  uint64_t m_routeGeneration;
+};
+
+} // namespace ns3
+
+#endif /* ROUTE_GENERATION_H */
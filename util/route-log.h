@@ -0,0 +1,639 @@
+// Registro binário das mudanças nas tabelas de roteamento.
+//
+// Cada registro traz, para um nó num instante, as rotas removidas e as
+// acrescentadas desde a amostra anterior desse nó (a primeira amostra traz a
+// tabela inteira). Uma rota é a tupla (protocolo, destino, prefixo, gateway,
+// interface, métrica); mudar qualquer campo é remover a antiga e acrescentar
+// a nova. O protocolo é 'r' (Rip ou BatchedRip), 'o' (OspfRouting), 'g'
+// (Ipv4GlobalRouting) ou 's' (estática).
+//
+// Arquivo: a assinatura ROUTE_LOG_MAGIC seguida de blocos
+//
+//   <tamanho original: u32> <tamanho comprimido: u32> <registros: u32> <tipo: u32> <bloco>
+//
+// como no trace binário (binary-trace.h). Dentro do bloco, por registro:
+//
+//   <nó> <instante - instante do registro anterior, ns> <removidas> <acrescentadas>
+//   e cada rota: <protocolo: byte> <destino> <prefixo: byte> <gateway> <interface> <métrica>
+//
+// com os inteiros em varint. O RouteTableReplay aplica os registros em ordem
+// e devolve a tabela de qualquer nó no instante do último registro aplicado.
+//
+// Quadros-chave: quando os registros gravados desde o último quadro-chave
+// passam do tamanho dele, o escritor grava as tabelas inteiras de todos os
+// nós (blocos do tipo BLOCK_KEYFRAME, um registro só com acrescentadas por
+// nó). A leitura em sequência pula esses blocos; RouteLogReader::Seek começa
+// do último quadro-chave antes do instante pedido, então a consulta de um
+// instante lê no máximo um quadro-chave e cerca do mesmo tamanho em
+// registros, e não o arquivo desde o início. O arquivo termina com um bloco
+// BLOCK_INDEX (instante e posição de cada quadro-chave, em varint) e a
+// posição desse bloco (u64); sem ele (gravação interrompida) a consulta lê
+// desde o início.
+//
+// Não depende do ns-3; o RouteRecorder (route-recorder.h) amostra as tabelas
+// e o tools/rt_query.cc consulta o arquivo.
+
+#ifndef ROUTE_LOG_H
+#define ROUTE_LOG_H
+
+#include "address-plan.h"
+#include "block-codec.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+const char ROUTE_LOG_MAGIC[8] = {'N', 'S', '3', 'R', 'T', 'L', '2', '\n'};
+
+struct RouteEntry
+{
+  char protocol;
+  uint32_t destination;
+  uint8_t prefixLength;
+  uint32_t gateway;
+  uint32_t interface;
+  uint32_t metric;
+
+  bool operator< (const RouteEntry &other) const
+  {
+    return std::tie (destination, prefixLength, protocol, gateway, interface, metric)
+           < std::tie (other.destination, other.prefixLength, other.protocol, other.gateway, other.interface,
+                       other.metric);
+  }
+
+  bool operator== (const RouteEntry &other) const
+  {
+    return !(*this < other) && !(other < *this);
+  }
+};
+
+struct RouteDelta
+{
+  uint32_t node;
+  uint64_t timeNs;
+  std::vector<RouteEntry> removed;
+  std::vector<RouteEntry> added;
+};
+
+namespace routelog {
+
+enum BlockType
+{
+  BLOCK_DELTAS = 0,
+  BLOCK_KEYFRAME = 1,
+  BLOCK_INDEX = 2
+};
+
+inline void
+PutU64 (std::ostream &os, uint64_t value)
+{
+  PutU32 (os, uint32_t (value));
+  PutU32 (os, uint32_t (value >> 32));
+}
+
+inline bool
+GetU64 (std::istream &is, uint64_t &value)
+{
+  uint32_t low;
+  uint32_t high;
+  if (!GetU32 (is, low) || !GetU32 (is, high))
+  {
+    return false;
+  }
+  value = uint64_t (high) << 32 | low;
+  return true;
+}
+
+inline bool
+ParseAddress (const std::string &text, uint32_t &address)
+{
+  unsigned a;
+  unsigned b;
+  unsigned c;
+  unsigned d;
+  char tail;
+  if (std::sscanf (text.c_str (), "%u.%u.%u.%u%c", &a, &b, &c, &d, &tail) != 4 || a > 255 || b > 255 || c > 255
+      || d > 255)
+  {
+    return false;
+  }
+  address = (a << 24) | (b << 16) | (c << 8) | d;
+  return true;
+}
+
+inline uint8_t
+PrefixLength (uint32_t mask)
+{
+  uint8_t length = 0;
+  while (length < 32 && (mask & (0x80000000u >> length)))
+  {
+    ++length;
+  }
+  return length;
+}
+
+inline void
+PutRoute (std::vector<uint8_t> &out, const RouteEntry &route)
+{
+  out.push_back (uint8_t (route.protocol));
+  PutVarint (out, route.destination);
+  out.push_back (route.prefixLength);
+  PutVarint (out, route.gateway);
+  PutVarint (out, route.interface);
+  PutVarint (out, route.metric);
+}
+
+inline bool
+GetRoute (const uint8_t *&in, const uint8_t *end, RouteEntry &route)
+{
+  uint64_t destination;
+  uint64_t gateway;
+  uint64_t interface;
+  uint64_t metric;
+  if (in >= end)
+  {
+    return false;
+  }
+  route.protocol = char (*in++);
+  if (!GetVarint (in, end, destination) || in >= end)
+  {
+    return false;
+  }
+  route.prefixLength = *in++;
+  if (!GetVarint (in, end, gateway) || !GetVarint (in, end, interface) || !GetVarint (in, end, metric))
+  {
+    return false;
+  }
+  route.destination = destination;
+  route.gateway = gateway;
+  route.interface = interface;
+  route.metric = metric;
+  return true;
+}
+
+} // namespace routelog
+
+// linhas "Destination Gateway Genmask Flags Metric Ref Use Iface" do
+// PrintRoutingTable do ns-3; as outras linhas são ignoradas
+inline void
+ParseRoutingTable (const std::string &text, char protocol, std::vector<RouteEntry> &routes)
+{
+  std::istringstream lines (text);
+  std::string line;
+  while (std::getline (lines, line))
+  {
+    std::istringstream fields (line);
+    std::string destination;
+    std::string gateway;
+    std::string mask;
+    std::string flags;
+    std::string metric;
+    std::string ref;
+    std::string use;
+    uint32_t interface;
+    RouteEntry route {protocol, 0, 0, 0, 0, 0};
+    uint32_t maskBits;
+    if (!(fields >> destination >> gateway >> mask >> flags >> metric >> ref >> use >> interface)
+        || !routelog::ParseAddress (destination, route.destination)
+        || !routelog::ParseAddress (gateway, route.gateway) || !routelog::ParseAddress (mask, maskBits))
+    {
+      continue;
+    }
+    route.prefixLength = routelog::PrefixLength (maskBits);
+    route.interface = interface;
+    route.metric = metric == "-" ? 0 : std::strtoul (metric.c_str (), nullptr, 10);
+    routes.push_back (route);
+  }
+}
+
+// before e after ordenadas; removed/added recebem as diferenças
+inline void
+DiffRoutes (const std::vector<RouteEntry> &before, const std::vector<RouteEntry> &after,
+            std::vector<RouteEntry> &removed, std::vector<RouteEntry> &added)
+{
+  std::set_difference (before.begin (), before.end (), after.begin (), after.end (), std::back_inserter (removed));
+  std::set_difference (after.begin (), after.end (), before.begin (), before.end (), std::back_inserter (added));
+}
+
+// tabelas reconstruídas a partir dos registros
+class RouteTableReplay
+{
+public:
+  void Apply (const RouteDelta &delta)
+  {
+    std::set<RouteEntry> &table = m_tables[delta.node];
+    for (const RouteEntry &route : delta.removed)
+    {
+      table.erase (route);
+    }
+    table.insert (delta.added.begin (), delta.added.end ());
+  }
+
+  const std::map<uint32_t, std::set<RouteEntry> > &GetTables () const
+  {
+    return m_tables;
+  }
+
+private:
+  std::map<uint32_t, std::set<RouteEntry> > m_tables;
+};
+
+class RouteLogWriter
+{
+public:
+  RouteLogWriter ()
+    : m_blockSize (64 * 1024),
+      m_blockRecords (0),
+      m_lastTime (0),
+      m_records (0),
+      m_bytes (0),
+      m_keyframeBytes (0),
+      m_sinceKeyframe (0)
+  {
+  }
+
+  ~RouteLogWriter ()
+  {
+    Close ();
+  }
+
+  bool Open (const std::string &path, std::string *error)
+  {
+    m_out.open (path, std::ios::binary | std::ios::trunc);
+    if (!m_out)
+    {
+      *error = "nao foi possivel gravar " + path;
+      return false;
+    }
+    m_out.write (ROUTE_LOG_MAGIC, sizeof (ROUTE_LOG_MAGIC));
+    m_bytes = sizeof (ROUTE_LOG_MAGIC);
+    return true;
+  }
+
+  // registros em ordem de instante
+  void Write (const RouteDelta &delta)
+  {
+    std::size_t before = m_raw.size ();
+    PutRecord (m_raw, delta.node, delta.timeNs - m_lastTime, delta.removed, delta.added);
+    m_sinceKeyframe += m_raw.size () - before;
+    m_state.Apply (delta);
+    m_lastTime = delta.timeNs;
+    ++m_blockRecords;
+    ++m_records;
+    if (m_raw.size () >= m_blockSize)
+    {
+      Flush ();
+      // o quadro-chave custa o mesmo que os registros desde o anterior
+      if (m_sinceKeyframe >= std::max<uint64_t> (m_keyframeBytes, 4 * m_blockSize))
+      {
+        WriteKeyframe (delta.timeNs);
+      }
+    }
+  }
+
+  void Flush ()
+  {
+    if (m_blockRecords == 0 || !m_out.is_open ())
+    {
+      return;
+    }
+    WriteBlock (routelog::BLOCK_DELTAS, m_raw, m_blockRecords);
+    m_raw.clear ();
+    m_blockRecords = 0;
+    m_lastTime = 0;
+  }
+
+  void Close ()
+  {
+    if (!m_out.is_open ())
+    {
+      return;
+    }
+    Flush ();
+    std::vector<uint8_t> index;
+    PutVarint (index, m_keyframes.size ());
+    for (const std::pair<uint64_t, uint64_t> &keyframe : m_keyframes)
+    {
+      PutVarint (index, keyframe.first);
+      PutVarint (index, keyframe.second);
+    }
+    uint64_t offset = m_bytes;
+    WriteBlock (routelog::BLOCK_INDEX, index, m_keyframes.size ());
+    routelog::PutU64 (m_out, offset);
+    m_bytes += 8;
+    m_out.close ();
+  }
+
+  uint64_t GetRecords () const
+  {
+    return m_records;
+  }
+
+  uint64_t GetBytesWritten () const
+  {
+    return m_bytes;
+  }
+
+  uint32_t GetKeyframes () const
+  {
+    return m_keyframes.size ();
+  }
+
+private:
+  static void PutRecord (std::vector<uint8_t> &out, uint32_t node, uint64_t timeDelta,
+                         const std::vector<RouteEntry> &removed, const std::vector<RouteEntry> &added)
+  {
+    PutVarint (out, node);
+    PutVarint (out, timeDelta);
+    PutVarint (out, removed.size ());
+    PutVarint (out, added.size ());
+    for (const RouteEntry &route : removed)
+    {
+      routelog::PutRoute (out, route);
+    }
+    for (const RouteEntry &route : added)
+    {
+      routelog::PutRoute (out, route);
+    }
+  }
+
+  void WriteBlock (uint32_t type, const std::vector<uint8_t> &raw, uint32_t records)
+  {
+    m_compressed.clear ();
+    BlockCompress (raw.data (), raw.size (), m_compressed);
+    PutU32 (m_out, raw.size ());
+    PutU32 (m_out, m_compressed.size ());
+    PutU32 (m_out, records);
+    PutU32 (m_out, type);
+    m_out.write (reinterpret_cast<const char *> (m_compressed.data ()), m_compressed.size ());
+    m_bytes += 16 + m_compressed.size ();
+  }
+
+  // tabelas inteiras de todos os nós no instante 'timeNs', em blocos de até
+  // m_blockSize
+  void WriteKeyframe (uint64_t timeNs)
+  {
+    m_keyframes.push_back (std::make_pair (timeNs, m_bytes));
+    std::vector<uint8_t> raw;
+    std::vector<RouteEntry> none;
+    std::vector<RouteEntry> routes;
+    uint32_t records = 0;
+    m_keyframeBytes = 0;
+    for (const std::pair<const uint32_t, std::set<RouteEntry> > &table : m_state.GetTables ())
+    {
+      if (table.second.empty ())
+      {
+        continue;
+      }
+      routes.assign (table.second.begin (), table.second.end ());
+      PutRecord (raw, table.first, records == 0 ? timeNs : 0, none, routes);
+      ++records;
+      if (raw.size () >= m_blockSize)
+      {
+        m_keyframeBytes += raw.size ();
+        WriteBlock (routelog::BLOCK_KEYFRAME, raw, records);
+        raw.clear ();
+        records = 0;
+      }
+    }
+    if (records > 0)
+    {
+      m_keyframeBytes += raw.size ();
+      WriteBlock (routelog::BLOCK_KEYFRAME, raw, records);
+    }
+    m_sinceKeyframe = 0;
+  }
+
+  std::ofstream m_out;
+  uint32_t m_blockSize;
+  std::vector<uint8_t> m_raw;
+  std::vector<uint8_t> m_compressed;
+  uint32_t m_blockRecords;
+  uint64_t m_lastTime;
+  uint64_t m_records;
+  uint64_t m_bytes;
+  RouteTableReplay m_state;                               // tabelas até o último registro
+  std::vector<std::pair<uint64_t, uint64_t> > m_keyframes; // (instante, posição)
+  uint64_t m_keyframeBytes;
+  uint64_t m_sinceKeyframe;
+};
+
+class RouteLogReader
+{
+public:
+  RouteLogReader ()
+    : m_pos (0),
+      m_blockRecords (0),
+      m_lastTime (0),
+      m_takeKeyframe (false)
+  {
+  }
+
+  bool Open (const std::string &path, std::string *error)
+  {
+    m_in.open (path, std::ios::binary);
+    char magic[sizeof (ROUTE_LOG_MAGIC)];
+    if (!m_in || !m_in.read (magic, sizeof (magic))
+        || std::string (magic, sizeof (magic)) != std::string (ROUTE_LOG_MAGIC, sizeof (magic)))
+    {
+      *error = path + " nao e um registro de rotas";
+      return false;
+    }
+    ReadIndex ();
+    m_in.clear ();
+    m_in.seekg (sizeof (ROUTE_LOG_MAGIC));
+    return true;
+  }
+
+  // o próximo Next devolve, a partir do último quadro-chave até 'timeNs'
+  // (ou do início, se não houver), registros que reconstroem as tabelas
+  // num RouteTableReplay vazio
+  void Seek (uint64_t timeNs)
+  {
+    uint64_t offset = sizeof (ROUTE_LOG_MAGIC);
+    m_takeKeyframe = false;
+    for (const std::pair<uint64_t, uint64_t> &keyframe : m_keyframes)
+    {
+      if (keyframe.first > timeNs)
+      {
+        break;
+      }
+      offset = keyframe.second;
+      m_takeKeyframe = true;
+    }
+    m_in.clear ();
+    m_in.seekg (offset);
+    m_blockRecords = 0;
+  }
+
+  uint32_t GetKeyframes () const
+  {
+    return m_keyframes.size ();
+  }
+
+  // false no fim do arquivo ou em erro (error fica vazio no fim normal)
+  bool Next (RouteDelta &delta, std::string *error)
+  {
+    error->clear ();
+    while (m_blockRecords == 0)
+    {
+      if (!ReadBlock (error))
+      {
+        return false;
+      }
+    }
+    const uint8_t *in = m_raw.data () + m_pos;
+    const uint8_t *end = m_raw.data () + m_raw.size ();
+    uint64_t node;
+    uint64_t timeDelta;
+    uint64_t removed;
+    uint64_t added;
+    if (!GetVarint (in, end, node) || !GetVarint (in, end, timeDelta) || !GetVarint (in, end, removed)
+        || !GetVarint (in, end, added) || removed + added > uint64_t (end - in))
+    {
+      *error = "registro truncado";
+      return false;
+    }
+    delta.node = node;
+    m_lastTime += timeDelta;
+    delta.timeNs = m_lastTime;
+    delta.removed.resize (removed);
+    delta.added.resize (added);
+    for (RouteEntry &route : delta.removed)
+    {
+      if (!routelog::GetRoute (in, end, route))
+      {
+        *error = "registro truncado";
+        return false;
+      }
+    }
+    for (RouteEntry &route : delta.added)
+    {
+      if (!routelog::GetRoute (in, end, route))
+      {
+        *error = "registro truncado";
+        return false;
+      }
+    }
+    m_pos = in - m_raw.data ();
+    --m_blockRecords;
+    return true;
+  }
+
+private:
+  // quadros-chave do bloco BLOCK_INDEX do fim; sem ele, nenhum
+  void ReadIndex ()
+  {
+    uint64_t offset;
+    uint32_t rawSize;
+    uint32_t compressedSize;
+    uint32_t records;
+    uint32_t type;
+    std::string error;
+    m_in.seekg (-8, std::ios::end);
+    if (!routelog::GetU64 (m_in, offset) || !m_in.seekg (offset) || !GetU32 (m_in, rawSize)
+        || !GetU32 (m_in, compressedSize) || !GetU32 (m_in, records) || !GetU32 (m_in, type)
+        || type != routelog::BLOCK_INDEX || !ReadPayload (rawSize, compressedSize, &error))
+    {
+      return;
+    }
+    const uint8_t *in = m_raw.data ();
+    const uint8_t *end = in + m_raw.size ();
+    uint64_t count;
+    std::vector<std::pair<uint64_t, uint64_t> > keyframes;
+    if (!GetVarint (in, end, count) || count != records)
+    {
+      return;
+    }
+    for (uint64_t i = 0; i < count; ++i)
+    {
+      uint64_t time;
+      uint64_t position;
+      if (!GetVarint (in, end, time) || !GetVarint (in, end, position) || position >= offset)
+      {
+        return;
+      }
+      keyframes.push_back (std::make_pair (time, position));
+    }
+    m_keyframes.swap (keyframes);
+  }
+
+  bool ReadPayload (uint32_t rawSize, uint32_t compressedSize, std::string *error)
+  {
+    m_compressed.resize (compressedSize);
+    if (!m_in.read (reinterpret_cast<char *> (m_compressed.data ()), compressedSize))
+    {
+      *error = "bloco truncado";
+      return false;
+    }
+    m_raw.clear ();
+    return BlockDecompress (m_compressed.data (), compressedSize, rawSize, m_raw, error);
+  }
+
+  // o próximo bloco de registros; os quadros-chave só logo depois do Seek
+  bool ReadBlock (std::string *error)
+  {
+    while (true)
+    {
+      uint32_t rawSize;
+      uint32_t compressedSize;
+      uint32_t type;
+      if (!GetU32 (m_in, rawSize))
+      {
+        return false; // fim do arquivo
+      }
+      if (!GetU32 (m_in, compressedSize) || !GetU32 (m_in, m_blockRecords) || !GetU32 (m_in, type))
+      {
+        *error = "cabecalho de bloco truncado";
+        return false;
+      }
+      if (type == routelog::BLOCK_INDEX)
+      {
+        m_blockRecords = 0;
+        return false;
+      }
+      if (type == routelog::BLOCK_KEYFRAME && !m_takeKeyframe)
+      {
+        m_blockRecords = 0;
+        m_in.seekg (compressedSize, std::ios::cur);
+        continue;
+      }
+      if (type == routelog::BLOCK_DELTAS)
+      {
+        m_takeKeyframe = false;
+      }
+      if (!ReadPayload (rawSize, compressedSize, error))
+      {
+        return false;
+      }
+      m_pos = 0;
+      m_lastTime = 0;
+      return true;
+    }
+  }
+
+  std::ifstream m_in;
+  std::vector<uint8_t> m_compressed;
+  std::vector<uint8_t> m_raw;
+  std::size_t m_pos;
+  uint32_t m_blockRecords;
+  uint64_t m_lastTime;
+  bool m_takeKeyframe; // Seek parou num quadro-chave
+  std::vector<std::pair<uint64_t, uint64_t> > m_keyframes; // (instante, posição)
+};
+
+} // namespace ns3
+
+#endif /* ROUTE_LOG_H */
@@ -0,0 +1,254 @@
+// Amostra periodicamente as tabelas de roteamento dos nós e grava só o que
+// mudou desde a amostra anterior, no formato do route-log.h, no lugar das
+// tabelas inteiras impressas pelo PrintRoutingTableAt.
+//
+//   RouteRecorder routes;
+//   routes.Open ("tp2-rip.rtl");
+//   routes.Install (topology.GetNodes (), Seconds (simulationTime));
+//   ...
+//   Simulator::Run ();
+//   routes.Close ();
+//
+// As rotas do Ipv4GlobalRouting e do Ipv4StaticRouting são lidas pela API
+// (GetNRoutes/GetRoute); o Rip não expõe a tabela, então a dele é lida do
+// PrintRoutingTable, que só traz as rotas válidas (a BatchedRip e a
+// OspfRouting imprimem no mesmo formato). O arquivo é consultado com
+// tools/rt_query.cc.
+//
+// Só é lida de novo a tabela dos nós que podem ter mudado: a BatchedRip e a
+// OspfRouting avançam o contador de geração (route-generation.h) a cada
+// mudança, e o nó em que a soma dos contadores não mudou desde a amostra
+// anterior fica de fora; nós só com rotas estáticas são lidos uma vez, em 0.
+// Nós com o Rip ou o roteamento global, que não avisam as mudanças, são lidos
+// a cada amostra.
+
+#ifndef ROUTE_RECORDER_H
+#define ROUTE_RECORDER_H
+
+#include "batched-rip.h"
+#include "ospf-routing.h"
+#include "route-cache.h"
+#include "route-generation.h"
+#include "route-log.h"
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+namespace routing {
+
+NS_LOG_COMPONENT_DEFINE ("RouteRecorder");
+
+class RouteRecorder
+{
+public:
+  RouteRecorder ()
+    : m_interval (MilliSeconds (100)),
+      m_snapshots (0)
+  {
+  }
+
+  void SetInterval (Time interval)
+  {
+    m_interval = interval;
+  }
+
+  void Open (const std::string &path)
+  {
+    std::string error;
+    if (!m_writer.Open (path, &error))
+    {
+      NS_FATAL_ERROR (error);
+    }
+  }
+
+  // começa a amostrar em 0 e segue até stop
+  void Install (NodeContainer nodes, Time stop)
+  {
+    m_nodes = nodes;
+    m_stop = stop;
+    m_tables.assign (nodes.GetN (), std::vector<RouteEntry> ());
+    m_watches.assign (nodes.GetN (), Watch ());
+    for (uint32_t i = 0; i < nodes.GetN (); ++i)
+    {
+      Ptr<Ipv4> ipv4 = nodes.Get (i)->GetObject<Ipv4> ();
+      if (ipv4 != nullptr && ipv4->GetRoutingProtocol () != nullptr)
+      {
+        AddSources (ipv4->GetRoutingProtocol (), m_watches[i]);
+      }
+    }
+    Simulator::ScheduleNow (&RouteRecorder::Poll, this);
+  }
+
+  void Close ()
+  {
+    m_writer.Close ();
+    NS_LOG_INFO ("Wrote " << m_writer.GetRecords () << " routing table changes in " << m_writer.GetBytesWritten ()
+                          << " bytes, " << m_writer.GetKeyframes () << " keyframes, from " << m_snapshots
+                          << " table reads");
+  }
+
+  uint64_t GetRecords () const
+  {
+    return m_writer.GetRecords ();
+  }
+
+  // tabelas lidas (a soma, sobre as amostras, dos nós lidos)
+  uint64_t GetSnapshots () const
+  {
+    return m_snapshots;
+  }
+
+  // tabela atual do nó, ordenada
+  static std::vector<RouteEntry> Snapshot (Ptr<Node> node)
+  {
+    std::vector<RouteEntry> routes;
+    Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+    if (ipv4 != nullptr && ipv4->GetRoutingProtocol () != nullptr)
+    {
+      Collect (ipv4->GetRoutingProtocol (), routes);
+    }
+    std::sort (routes.begin (), routes.end ());
+    return routes;
+  }
+
+private:
+  // contadores de geração do nó; polled quando algum protocolo não tem
+  struct Watch
+  {
+    std::vector<const RouteGeneration *> sources;
+    uint64_t generation;
+    bool polled;
+  };
+
+  static void AddSources (Ptr<Ipv4RoutingProtocol> protocol, Watch &watch)
+  {
+    if (Ptr<Ipv4ListRouting> list = DynamicCast<Ipv4ListRouting> (protocol))
+    {
+      for (uint32_t i = 0; i < list->GetNRoutingProtocols (); ++i)
+      {
+        int16_t priority;
+        AddSources (list->GetRoutingProtocol (i, priority), watch);
+      }
+    }
+    else if (Ptr<RouteCache> cache = DynamicCast<RouteCache> (protocol))
+    {
+      AddSources (cache->GetRouting (), watch);
+    }
+    else if (const RouteGeneration *source = dynamic_cast<const RouteGeneration *> (PeekPointer (protocol)))
+    {
+      watch.sources.push_back (source);
+    }
+    else if (!DynamicCast<Ipv4StaticRouting> (protocol))
+    {
+      watch.polled = true;
+    }
+  }
+
+  static uint64_t GetGeneration (const Watch &watch)
+  {
+    uint64_t generation = 0;
+    for (const RouteGeneration *source : watch.sources)
+    {
+      generation += source->GetRouteGeneration ();
+    }
+    return generation;
+  }
+
+  static void Collect (Ptr<Ipv4RoutingProtocol> protocol, std::vector<RouteEntry> &routes)
+  {
+    if (Ptr<Ipv4ListRouting> list = DynamicCast<Ipv4ListRouting> (protocol))
+    {
+      for (uint32_t i = 0; i < list->GetNRoutingProtocols (); ++i)
+      {
+        int16_t priority;
+        Collect (list->GetRoutingProtocol (i, priority), routes);
+      }
+    }
+    else if (Ptr<RouteCache> cache = DynamicCast<RouteCache> (protocol))
+    {
+      Collect (cache->GetRouting (), routes);
+    }
+    else if (Ptr<Ipv4GlobalRouting> global = DynamicCast<Ipv4GlobalRouting> (protocol))
+    {
+      for (uint32_t i = 0; i < global->GetNRoutes (); ++i)
+      {
+        Add ('g', *global->GetRoute (i), 0, routes);
+      }
+    }
+    else if (Ptr<Ipv4StaticRouting> staticRouting = DynamicCast<Ipv4StaticRouting> (protocol))
+    {
+      for (uint32_t i = 0; i < staticRouting->GetNRoutes (); ++i)
+      {
+        Add ('s', staticRouting->GetRoute (i), staticRouting->GetMetric (i), routes);
+      }
+    }
+    else
+    {
+      std::ostringstream table;
+      protocol->PrintRoutingTable (Create<OutputStreamWrapper> (&table));
+      char name = DynamicCast<Rip> (protocol) || DynamicCast<BatchedRip> (protocol) ? 'r'
+                  : DynamicCast<OspfRouting> (protocol)                             ? 'o'
+                                                                                    : '?';
+      ParseRoutingTable (table.str (), name, routes);
+    }
+  }
+
+  static void Add (char protocol, const Ipv4RoutingTableEntry &entry, uint32_t metric,
+                   std::vector<RouteEntry> &routes)
+  {
+    routes.push_back (RouteEntry {protocol, entry.GetDestNetwork ().Get (),
+                                  routelog::PrefixLength (entry.GetDestNetworkMask ().Get ()),
+                                  entry.GetGateway ().Get (), entry.GetInterface (), metric});
+  }
+
+  void Poll ()
+  {
+    uint64_t now = Simulator::Now ().GetNanoSeconds ();
+    for (uint32_t i = 0; i < m_nodes.GetN (); ++i)
+    {
+      Watch &watch = m_watches[i];
+      uint64_t generation = GetGeneration (watch);
+      if (now > 0 && !watch.polled && generation == watch.generation)
+      {
+        continue;
+      }
+      watch.generation = generation;
+      ++m_snapshots;
+      std::vector<RouteEntry> routes = Snapshot (m_nodes.Get (i));
+      RouteDelta delta {m_nodes.Get (i)->GetId (), now, {}, {}};
+      DiffRoutes (m_tables[i], routes, delta.removed, delta.added);
+      if (!delta.removed.empty () || !delta.added.empty ())
+      {
+        m_writer.Write (delta);
+        m_tables[i].swap (routes);
+      }
+    }
+    if (Simulator::Now () + m_interval <= m_stop)
+    {
+      Simulator::Schedule (m_interval, &RouteRecorder::Poll, this);
+    }
+  }
+
+  Time m_interval;
+  Time m_stop;
+  NodeContainer m_nodes;
+  std::vector<std::vector<RouteEntry> > m_tables;
+  std::vector<Watch> m_watches;
+  uint64_t m_snapshots;
+  RouteLogWriter m_writer;
+};
+
+} // namespace routing
+
+using routing::RouteRecorder;
+
+} // namespace ns3
+
+#endif /* ROUTE_RECORDER_H */
@@ -0,0 +1,188 @@
+// Resultados de uma execução em CSV: cada cenário grava uma linha com os
+// parâmetros usados e as métricas medidas (--results=<arquivo>), e o
+// tools/sweep.cc junta as linhas de todas as execuções numa tabela só.
+//
+// Não depende do ns-3.
+
+#ifndef RUN_RESULTS_H
+#define RUN_RESULTS_H
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+// aspas só quando o campo tem vírgula, aspas ou quebra de linha
+inline std::string
+CsvEscape (const std::string &field)
+{
+  if (field.find_first_of (",\"\n\r") == std::string::npos)
+  {
+    return field;
+  }
+  std::string out ("\"");
+  for (char ch : field)
+  {
+    if (ch == '"')
+    {
+      out += '"';
+    }
+    out += ch;
+  }
+  out += '"';
+  return out;
+}
+
+inline std::vector<std::string>
+SplitCsvLine (const std::string &line)
+{
+  std::vector<std::string> fields (1);
+  bool quoted = false;
+  for (std::string::size_type i = 0; i < line.size (); ++i)
+  {
+    char ch = line[i];
+    if (quoted)
+    {
+      if (ch == '"' && i + 1 < line.size () && line[i + 1] == '"')
+      {
+        fields.back () += '"';
+        ++i;
+      }
+      else if (ch == '"')
+      {
+        quoted = false;
+      }
+      else
+      {
+        fields.back () += ch;
+      }
+    }
+    else if (ch == '"')
+    {
+      quoted = true;
+    }
+    else if (ch == ',')
+    {
+      fields.emplace_back ();
+    }
+    else if (ch != '\r')
+    {
+      fields.back () += ch;
+    }
+  }
+  return fields;
+}
+
+// lê um CSV com cabeçalho; linhas vazias são ignoradas
+inline bool
+ReadCsv (const std::string &path, std::vector<std::string> &header,
+         std::vector<std::vector<std::string> > &rows, std::string *error)
+{
+  std::ifstream in (path);
+  if (!in)
+  {
+    *error = "nao foi possivel abrir " + path;
+    return false;
+  }
+  header.clear ();
+  rows.clear ();
+  std::string line;
+  while (std::getline (in, line))
+  {
+    if (line.empty () || line == "\r")
+    {
+      continue;
+    }
+    if (header.empty ())
+    {
+      header = SplitCsvLine (line);
+    }
+    else
+    {
+      rows.push_back (SplitCsvLine (line));
+      rows.back ().resize (header.size ());
+    }
+  }
+  if (header.empty ())
+  {
+    *error = path + " vazio";
+    return false;
+  }
+  return true;
+}
+
+inline void
+WriteCsvRow (std::ostream &out, const std::vector<std::string> &fields)
+{
+  for (std::vector<std::string>::size_type i = 0; i < fields.size (); ++i)
+  {
+    out << (i ? "," : "") << CsvEscape (fields[i]);
+  }
+  out << '\n';
+}
+
+// uma linha de resultados; as colunas ficam na ordem em que foram definidas
+class RunResults
+{
+public:
+  template <typename T>
+  void Set (const std::string &column, const T &value)
+  {
+    std::ostringstream text;
+    text << value;
+    for (std::vector<std::string>::size_type i = 0; i < m_columns.size (); ++i)
+    {
+      if (m_columns[i] == column)
+      {
+        m_values[i] = text.str ();
+        return;
+      }
+    }
+    m_columns.push_back (column);
+    m_values.push_back (text.str ());
+  }
+
+  const std::vector<std::string> &GetColumns () const
+  {
+    return m_columns;
+  }
+
+  const std::vector<std::string> &GetValues () const
+  {
+    return m_values;
+  }
+
+  // acrescenta a linha ao arquivo, escrevendo o cabeçalho se ele ainda não
+  // existir ou estiver vazio
+  bool Write (const std::string &path, std::string *error) const
+  {
+    bool fresh = true;
+    {
+      std::ifstream probe (path);
+      fresh = !probe || probe.peek () == std::ifstream::traits_type::eof ();
+    }
+    std::ofstream out (path, std::ios::app);
+    if (!out)
+    {
+      *error = "nao foi possivel gravar " + path;
+      return false;
+    }
+    if (fresh)
+    {
+      WriteCsvRow (out, m_columns);
+    }
+    WriteCsvRow (out, m_values);
+    return true;
+  }
+
+private:
+  std::vector<std::string> m_columns;
+  std::vector<std::string> m_values;
+};
+
+} // namespace ns3
+
+#endif /* RUN_RESULTS_H */
@@ -0,0 +1,290 @@
+// Geradores de topologias sintéticas para os testes de escala. Produzem um
+// TopologySpec, que pode ser gravado em lista de arestas (tools/topogen.cc)
+// ou passado direto para o TopologyLoader.
+
+#ifndef TOPOLOGY_GENERATOR_H
+#define TOPOLOGY_GENERATOR_H
+
+#include "topology-spec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+namespace topology {
+
+inline std::string
+RouterName (uint32_t i)
+{
+  return "R" + std::to_string (i);
+}
+
+inline void
+AddRouters (TopologySpec &spec, uint32_t n)
+{
+  for (uint32_t i = 0; i < n; ++i)
+  {
+    spec.AddNode (RouterName (i), false);
+  }
+}
+
+} // namespace topology
+
+// anel R0 - R1 - ... - R(n-1) - R0
+inline void
+GenerateRing (TopologySpec &spec, uint32_t n)
+{
+  topology::AddRouters (spec, n);
+  for (uint32_t i = 0; i < n && n > 1; ++i)
+  {
+    if (n == 2 && i == 1)
+    {
+      break;
+    }
+    spec.AddLink (i, (i + 1) % n);
+  }
+}
+
+// grade rows x cols, roteador (r, c) = R(r * cols + c)
+inline void
+GenerateGrid (TopologySpec &spec, uint32_t rows, uint32_t cols)
+{
+  topology::AddRouters (spec, rows * cols);
+  for (uint32_t r = 0; r < rows; ++r)
+  {
+    for (uint32_t c = 0; c < cols; ++c)
+    {
+      uint32_t id = r * cols + c;
+      if (c + 1 < cols)
+      {
+        spec.AddLink (id, id + 1);
+      }
+      if (r + 1 < rows)
+      {
+        spec.AddLink (id, id + cols);
+      }
+    }
+  }
+}
+
+// malha aleatória conexa: árvore geradora aleatória mais arestas extras até
+// atingir o grau médio pedido
+inline void
+GenerateRandomMesh (TopologySpec &spec, uint32_t n, double meanDegree, uint32_t seed)
+{
+  std::mt19937 rng (seed);
+  topology::AddRouters (spec, n);
+  std::set<std::pair<uint32_t, uint32_t> > edges;
+  for (uint32_t i = 1; i < n; ++i)
+  {
+    uint32_t parent = std::uniform_int_distribution<uint32_t> (0, i - 1) (rng);
+    edges.emplace (parent, i);
+    spec.AddLink (parent, i);
+  }
+  uint64_t target = (uint64_t) std::llround (meanDegree * n / 2.0);
+  uint64_t maxEdges = (uint64_t) n * (n - 1) / 2;
+  target = std::min (target, maxEdges);
+  std::uniform_int_distribution<uint32_t> pick (0, n - 1);
+  while (edges.size () < target)
+  {
+    uint32_t a = pick (rng);
+    uint32_t b = pick (rng);
+    if (a == b)
+    {
+      continue;
+    }
+    if (edges.emplace (std::min (a, b), std::max (a, b)).second)
+    {
+      spec.AddLink (a, b);
+    }
+  }
+}
+
+// grafo aleatório d-regular conexo (modelo de configuração): as pontas de
+// aresta são casadas ao acaso, sem laços nem arestas repetidas; se o
+// casamento empacar ou o grafo sair desconexo, recomeça com outra semente
+inline bool
+GenerateRandomRegular (TopologySpec &spec, uint32_t n, uint32_t degree, uint32_t seed)
+{
+  if (degree == 0 || degree >= n || (uint64_t (n) * degree) % 2 != 0)
+  {
+    return false;
+  }
+  std::mt19937 rng (seed);
+  std::set<std::pair<uint32_t, uint32_t> > edges;
+  for (uint32_t attempt = 0; attempt < 100; ++attempt)
+  {
+    edges.clear ();
+    std::vector<uint32_t> stubs;
+    for (uint32_t i = 0; i < n; ++i)
+    {
+      stubs.insert (stubs.end (), degree, i);
+    }
+    uint32_t failures = 0;
+    while (!stubs.empty () && failures < 100)
+    {
+      std::uniform_int_distribution<std::size_t> pick (0, stubs.size () - 1);
+      std::size_t i = pick (rng);
+      std::size_t j = pick (rng);
+      uint32_t a = std::min (stubs[i], stubs[j]);
+      uint32_t b = std::max (stubs[i], stubs[j]);
+      if (i == j || a == b || edges.count (std::make_pair (a, b)))
+      {
+        ++failures;
+        continue;
+      }
+      failures = 0;
+      edges.emplace (a, b);
+      std::swap (stubs[std::max (i, j)], stubs.back ());
+      stubs.pop_back ();
+      std::swap (stubs[std::min (i, j)], stubs.back ());
+      stubs.pop_back ();
+    }
+    if (!stubs.empty ())
+    {
+      continue;
+    }
+    // conexo?
+    std::vector<uint32_t> component (n);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+      component[i] = i;
+    }
+    auto find = [&component] (uint32_t x) {
+      while (component[x] != x)
+      {
+        x = component[x] = component[component[x]];
+      }
+      return x;
+    };
+    uint32_t components = n;
+    for (const std::pair<uint32_t, uint32_t> &edge : edges)
+    {
+      uint32_t ra = find (edge.first);
+      uint32_t rb = find (edge.second);
+      if (ra != rb)
+      {
+        component[ra] = rb;
+        --components;
+      }
+    }
+    if (components == 1)
+    {
+      topology::AddRouters (spec, n);
+      for (const std::pair<uint32_t, uint32_t> &edge : edges)
+      {
+        spec.AddLink (edge.first, edge.second);
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+// fat-tree de k portas (k par): (k/2)^2 roteadores de núcleo e k pods com
+// k/2 de agregação e k/2 de borda, 5k^2/4 roteadores ao todo. Numeração:
+// núcleo, depois os pods (agregação e borda de cada pod)
+inline void
+GenerateFatTree (TopologySpec &spec, uint32_t k)
+{
+  uint32_t half = k / 2;
+  uint32_t cores = half * half;
+  topology::AddRouters (spec, cores + k * k);
+  for (uint32_t pod = 0; pod < k; ++pod)
+  {
+    uint32_t aggregation = cores + pod * k;
+    uint32_t edge = aggregation + half;
+    for (uint32_t a = 0; a < half; ++a)
+    {
+      for (uint32_t e = 0; e < half; ++e)
+      {
+        spec.AddLink (aggregation + a, edge + e);
+      }
+      for (uint32_t c = 0; c < half; ++c)
+      {
+        spec.AddLink (aggregation + a, a * half + c);
+      }
+    }
+  }
+}
+
+// pendura um host em cada um dos 'count' primeiros roteadores (H0 em R0, ...)
+inline void
+AttachHosts (TopologySpec &spec, uint32_t count)
+{
+  uint32_t routers = spec.nodes.size ();
+  for (uint32_t i = 0; i < count && i < routers; ++i)
+  {
+    uint32_t host = spec.AddNode ("H" + std::to_string (i), true);
+    spec.AddLink (host, i);
+  }
+}
+
+// pendura 'count' hosts nos roteadores em rodízio (H0 em R0, H1 em R1, ...,
+// e de novo em R0 depois do último), para muitos hosts atrás de poucos roteadores
+inline void
+SpreadHosts (TopologySpec &spec, uint32_t count)
+{
+  uint32_t routers = spec.nodes.size ();
+  for (uint32_t i = 0; routers > 0 && i < count; ++i)
+  {
+    uint32_t host = spec.AddNode ("H" + std::to_string (i), true);
+    spec.AddLink (host, i % routers);
+  }
+}
+
+// "ring:N", "grid:RxC", "mesh:N[:grau[:semente]]", "regular:N:grau[:semente]",
+// "fattree:K"; devolve false se a descrição não for reconhecida
+inline bool
+GenerateTopology (TopologySpec &spec, const std::string &description, std::string *error)
+{
+  std::string kind = description.substr (0, description.find (':'));
+  std::string args = description.size () > kind.size () ? description.substr (kind.size () + 1) : "";
+  unsigned long a = 0;
+  unsigned long b = 0;
+  double degree = 4.0;
+  unsigned long seed = 1;
+  if (kind == "ring" && std::sscanf (args.c_str (), "%lu", &a) == 1 && a >= 2)
+  {
+    GenerateRing (spec, a);
+  }
+  else if (kind == "grid" && std::sscanf (args.c_str (), "%lux%lu", &a, &b) == 2 && a * b >= 2)
+  {
+    GenerateGrid (spec, a, b);
+  }
+  else if (kind == "mesh" && std::sscanf (args.c_str (), "%lu:%lf:%lu", &a, &degree, &seed) >= 1 && a >= 2)
+  {
+    GenerateRandomMesh (spec, a, degree, seed);
+  }
+  else if (kind == "regular" && std::sscanf (args.c_str (), "%lu:%lu:%lu", &a, &b, &seed) >= 2)
+  {
+    if (!GenerateRandomRegular (spec, a, b, seed))
+    {
+      *error = "sem grafo " + std::to_string (b) + "-regular conexo com " + std::to_string (a)
+               + " roteadores (o grau deve ser menor que N e N * grau par)";
+      return false;
+    }
+  }
+  else if (kind == "fattree" && std::sscanf (args.c_str (), "%lu", &a) == 1 && a >= 2 && a % 2 == 0)
+  {
+    GenerateFatTree (spec, a);
+  }
+  else
+  {
+    *error = "topologia gerada invalida '" + description
+             + "' (use ring:N, grid:RxC, mesh:N[:grau[:semente]], regular:N:grau[:semente] ou fattree:K)";
+    return false;
+  }
+  return true;
+}
+
+} // namespace ns3
+
+#endif /* TOPOLOGY_GENERATOR_H */
@@ -0,0 +1,824 @@
+// Monta nós, enlaces, endereços e roteamento a partir de um TopologySpec
+// (lista de arestas ou GraphML, ver topology-spec.h), em passadas sobre a
+// topologia inteira no lugar dos blocos CreateObject<Node>/NodeContainer/
+// SetBase escritos à mão em cada cenário.
+//
+// Endereçamento: as sub-redes saem do AddressPlan (address-plan.h), /30 em
+// todos os enlaces, de 10.0.0.0/8 (SetAddressPlan muda); o primeiro nó do
+// enlace fica com o primeiro endereço e o segundo com o seguinte. Os endereços são atribuídos direto na Ipv4, sem passar pelo
+// Ipv4AddressGenerator, cuja verificação de colisão é linear no número de
+// endereços já alocados. Como o Ipv4AddressHelper::Assign, cada dispositivo
+// ganha a fila raiz padrão (TrafficControlHelper::Default), para as filas
+// serem as mesmas dos cenários montados à mão. WriteLinkIndex grava o índice
+// enlace -> sub-rede e dispositivos, lido por tools/trace_dump e tools/rt_query.
+//
+// Hosts: o perfil HOST_FULL instala neles a mesma pilha dos roteadores
+// (InternetStackHelper). O HOST_LIGHT, para topologias com dezenas de milhares
+// de hosts, agrega só o necessário para UDP e ICMP: Ipv4L3Protocol,
+// Icmpv4L4Protocol, UdpL4Protocol e TrafficControlLayer. Fica sem TCP, sem
+// PacketSocketFactory e sem ArpL3Protocol quando todos os enlaces do host são
+// ponto a ponto. Com RIP ou OSPF, o roteamento do host é só um Ipv4StaticRouting
+// com a rota padrão, sem Ipv4ListRouting e sem Ipv4GlobalRouting/GlobalRouter. Com
+// roteamento global, o host mantém o GlobalRouter, porque as LSAs dos enlaces
+// dele saem de lá.
+
+#ifndef TOPOLOGY_LOADER_H
+#define TOPOLOGY_LOADER_H
+
+#include "address-plan.h"
+#include "batched-rip.h"
+#include "ecmp-routing.h"
+#include "ospf-routing.h"
+#include "resource-usage.h"
+#include "route-cache.h"
+#include "topology-spec.h"
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/csma-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/traffic-control-module.h"
+#include "ns3/ipv4-global-routing-helper.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+namespace topology {
+
+NS_LOG_COMPONENT_DEFINE ("TopologyLoader");
+
+class TopologyLoader
+{
+public:
+  enum LinkType
+  {
+    CSMA,
+    POINT_TO_POINT
+  };
+
+  enum HostProfile
+  {
+    HOST_FULL,  // InternetStackHelper completo
+    HOST_LIGHT  // IPv4, ICMP e UDP; rota padrão estática com RIP e OSPF
+  };
+
+  enum RoutingType
+  {
+    ROUTING_RIP,         // RIP entre roteadores, rota padrão estática nos hosts
+    ROUTING_BATCHED_RIP, // BatchedRip (batched-rip.h) entre roteadores, idem
+    ROUTING_OSPF,        // OspfRouting (ospf-routing.h) entre roteadores, idem
+    ROUTING_GLOBAL,      // Ipv4GlobalRoutingHelper::PopulateRoutingTables
+    ROUTING_NONE
+  };
+
+  TopologyLoader ();
+
+  void SetLinkType (LinkType type);
+  void SetRouting (RoutingType routing);
+  // usados nos enlaces sem rate=/delay= no arquivo
+  void SetDefaultDataRate (DataRate rate);
+  void SetDefaultDelay (Time delay);
+  // registra cada nó no Names (desligar economiza memória em topologias grandes)
+  void SetRegisterNames (bool enable);
+  // processo (system id) de cada nó na simulação distribuída, por exemplo o
+  // PartitionGraph (graph-partition.h); enlaces entre processos diferentes
+  // viram ponto a ponto, cujo atraso é o lookahead do simulador
+  void SetPartition (const std::vector<uint32_t> &systemIds);
+  // roteamento global com ECMP por fluxo (FlowHashEcmpRouting, ecmp-routing.h)
+  // em roteadores e hosts, no lugar do Ipv4GlobalRouting
+  void SetFlowHashEcmp (bool enable);
+  // RouteCache (route-cache.h) na frente do roteamento dos roteadores; só com
+  // RIP, BatchedRip ou OSPF (não com o roteamento global)
+  void SetRouteCache (bool enable);
+  void SetHostProfile (HostProfile profile);
+
+  void Load (const std::string &path);
+  void LoadString (const std::string &edgeList);
+  void SetSpec (const TopologySpec &spec);
+  // troca métricas da topologia carregada, antes do Build: "net7=2,net8=2"
+  void SetLinkMetrics (const std::string &metrics);
+  // pool ("10.0.0.0/8") e prefixos dos enlaces entre roteadores (30 ou 31) e
+  // com host (16 a 30)
+  void SetAddressPlan (const std::string &pool, uint32_t routerPrefix, uint32_t hostPrefix);
+  void Build ();
+
+  const TopologySpec &GetSpec () const;
+  Ptr<Node> GetNode (const std::string &name) const;
+  NodeContainer GetNodes () const;
+  // nós de uma lista de nomes separados por vírgula
+  NodeContainer GetNodes (const std::string &names) const;
+  NodeContainer GetRouters () const;
+  NodeContainer GetHosts () const;
+  // índice da interface Ipv4 do nó no enlace (0 é o loopback)
+  uint32_t GetInterface (const std::string &node, const std::string &link) const;
+  Ipv4Address GetAddress (const std::string &node, const std::string &link) const;
+  Ptr<NetDevice> GetDevice (const std::string &node, const std::string &link) const;
+  // os mesmos, pelos índices do TopologySpec (side 0 = link.a, 1 = link.b)
+  Ptr<Node> GetNode (uint32_t id) const;
+  uint32_t GetInterface (uint32_t link, uint32_t side) const;
+  Ipv4Address GetAddress (uint32_t link, uint32_t side) const;
+  uint32_t GetSystemId (uint32_t node) const;
+  const AddressPlan &GetAddressPlan () const;
+  // depois do Build
+  void WriteLinkIndex (const std::string &path) const;
+
+  void PrintReport (std::ostream &os) const;
+
+private:
+  struct LinkState
+  {
+    Ptr<NetDevice> devices[2];
+    uint32_t interfaces[2];
+  };
+
+  struct Phase
+  {
+    const char *name;
+    double ms;
+    uint64_t rssKiB;
+  };
+
+  void CreateNodes ();
+  void CreateDevices ();
+  void InstallStack ();
+  // exclusões e métricas do RIP (RipHelper ou BatchedRipHelper)
+  template <typename RipHelperType>
+  void ConfigureRip (RipHelperType &ripRouting) const;
+  void InstallLightHost (Ptr<Node> node, bool arp, const Ipv4RoutingHelper &routing);
+  void AssignAddresses ();
+  void InstallQueueDisc (Ptr<Node> node, Ptr<NetDevice> device);
+  void PopulateRouting ();
+  void EndPhase (const char *name, WallClock &clock);
+  uint32_t GetLinkEnd (const std::string &node, const std::string &link) const;
+
+  TopologySpec m_spec;
+  LinkType m_linkType;
+  RoutingType m_routing;
+  DataRate m_defaultRate;
+  Time m_defaultDelay;
+  bool m_registerNames;
+  bool m_flowHashEcmp;
+  bool m_routeCache;
+  HostProfile m_hostProfile;
+  std::vector<uint32_t> m_systemIds;
+  AddressPlan m_addresses;
+  bool m_built;
+
+  std::vector<Ptr<Node> > m_nodes;
+  std::vector<LinkState> m_links;
+  // interface que cada nó vai receber em cada enlace, calculada antes da pilha
+  // ser instalada porque o RipHelper precisa dela em ExcludeInterface
+  std::vector<uint32_t> m_nextInterface;
+  std::vector<Phase> m_phases;
+  uint64_t m_startRssKiB;
+};
+
+inline
+TopologyLoader::TopologyLoader ()
+  : m_linkType (CSMA),
+    m_routing (ROUTING_RIP),
+    m_defaultRate (DataRate (5000000)),
+    m_defaultDelay (MilliSeconds (2)),
+    m_registerNames (true),
+    m_flowHashEcmp (false),
+    m_routeCache (false),
+    m_hostProfile (HOST_FULL),
+    m_built (false),
+    m_startRssKiB (GetCurrentRssKiB ())
+{
+}
+
+inline void
+TopologyLoader::SetLinkType (LinkType type)
+{
+  m_linkType = type;
+}
+
+inline void
+TopologyLoader::SetPartition (const std::vector<uint32_t> &systemIds)
+{
+  m_systemIds = systemIds;
+}
+
+inline void
+TopologyLoader::SetFlowHashEcmp (bool enable)
+{
+  m_flowHashEcmp = enable;
+}
+
+inline void
+TopologyLoader::SetRouteCache (bool enable)
+{
+  m_routeCache = enable;
+}
+
+inline void
+TopologyLoader::SetAddressPlan (const std::string &pool, uint32_t routerPrefix, uint32_t hostPrefix)
+{
+  std::string error;
+  if (!m_addresses.SetPool (pool, &error) || !m_addresses.SetPrefixes (routerPrefix, hostPrefix, &error))
+  {
+    NS_FATAL_ERROR ("Invalid address plan: " << error);
+  }
+}
+
+inline const AddressPlan &
+TopologyLoader::GetAddressPlan () const
+{
+  return m_addresses;
+}
+
+inline void
+TopologyLoader::WriteLinkIndex (const std::string &path) const
+{
+  NS_ASSERT_MSG (m_built, "TopologyLoader::WriteLinkIndex called before Build");
+  std::string error;
+  if (!m_addresses.WriteFile (path, &error))
+  {
+    NS_FATAL_ERROR (error);
+  }
+}
+
+inline void
+TopologyLoader::SetHostProfile (HostProfile profile)
+{
+  m_hostProfile = profile;
+}
+
+inline uint32_t
+TopologyLoader::GetSystemId (uint32_t node) const
+{
+  return m_systemIds.empty () ? 0 : m_systemIds[node];
+}
+
+inline void
+TopologyLoader::SetRouting (RoutingType routing)
+{
+  m_routing = routing;
+}
+
+inline void
+TopologyLoader::SetDefaultDataRate (DataRate rate)
+{
+  m_defaultRate = rate;
+}
+
+inline void
+TopologyLoader::SetDefaultDelay (Time delay)
+{
+  m_defaultDelay = delay;
+}
+
+inline void
+TopologyLoader::SetRegisterNames (bool enable)
+{
+  m_registerNames = enable;
+}
+
+inline void
+TopologyLoader::Load (const std::string &path)
+{
+  WallClock clock;
+  std::string error;
+  m_spec.Clear ();
+  if (!m_spec.ReadFile (path, &error))
+  {
+    NS_FATAL_ERROR ("Invalid topology: " << error);
+  }
+  EndPhase ("parse", clock);
+}
+
+inline void
+TopologyLoader::LoadString (const std::string &edgeList)
+{
+  WallClock clock;
+  std::istringstream is (edgeList);
+  std::string error;
+  m_spec.Clear ();
+  if (!m_spec.ReadEdgeList (is, &error))
+  {
+    NS_FATAL_ERROR ("Invalid topology: " << error);
+  }
+  EndPhase ("parse", clock);
+}
+
+inline void
+TopologyLoader::SetSpec (const TopologySpec &spec)
+{
+  m_spec = spec;
+}
+
+inline void
+TopologyLoader::SetLinkMetrics (const std::string &metrics)
+{
+  NS_ASSERT_MSG (!m_built, "TopologyLoader::SetLinkMetrics called after Build");
+  std::istringstream list (metrics);
+  std::string item;
+  while (std::getline (list, item, ','))
+  {
+    if (item.empty ())
+    {
+      continue;
+    }
+    std::string::size_type equals = item.find ('=');
+    int64_t link = m_spec.FindLink (item.substr (0, equals));
+    NS_ABORT_MSG_IF (equals == std::string::npos, "Expected <link>=<metric> in link metrics, got " << item);
+    NS_ABORT_MSG_IF (link < 0, "Unknown link " << item.substr (0, equals));
+    char *end;
+    unsigned long metric = std::strtoul (item.c_str () + equals + 1, &end, 10);
+    NS_ABORT_MSG_IF (*end != '\0' || end == item.c_str () + equals + 1 || metric == 0,
+                     "Invalid metric in " << item);
+    m_spec.links[link].metric = metric;
+  }
+}
+
+inline const TopologySpec &
+TopologyLoader::GetSpec () const
+{
+  return m_spec;
+}
+
+inline void
+TopologyLoader::Build ()
+{
+  NS_ASSERT_MSG (!m_built, "TopologyLoader::Build called twice");
+  NS_ABORT_MSG_IF (m_spec.nodes.empty (), "Empty topology");
+  m_built = true;
+  WallClock clock;
+  CreateNodes ();
+  EndPhase ("nodes", clock);
+  CreateDevices ();
+  EndPhase ("devices", clock);
+  InstallStack ();
+  EndPhase ("stack", clock);
+  AssignAddresses ();
+  EndPhase ("addresses", clock);
+  PopulateRouting ();
+  EndPhase ("routing", clock);
+}
+
+inline void
+TopologyLoader::EndPhase (const char *name, WallClock &clock)
+{
+  m_phases.push_back (Phase {name, clock.GetMilliSeconds (), GetCurrentRssKiB ()});
+  clock.Restart ();
+}
+
+inline void
+TopologyLoader::CreateNodes ()
+{
+  NS_LOG_INFO ("Create " << m_spec.nodes.size () << " nodes.");
+  NS_ABORT_MSG_IF (!m_systemIds.empty () && m_systemIds.size () != m_spec.nodes.size (),
+                   "Partition has " << m_systemIds.size () << " entries for " << m_spec.nodes.size () << " nodes");
+  m_nodes.resize (m_spec.nodes.size ());
+  for (uint32_t i = 0; i < m_nodes.size (); ++i)
+  {
+    m_nodes[i] = CreateObject<Node> (GetSystemId (i));
+  }
+  if (m_registerNames)
+  {
+    for (uint32_t i = 0; i < m_nodes.size (); ++i)
+    {
+      Names::Add (m_spec.nodes[i].name, m_nodes[i]);
+    }
+  }
+
+  m_nextInterface.assign (m_nodes.size (), 1);
+  m_links.resize (m_spec.links.size ());
+  for (uint32_t i = 0; i < m_spec.links.size (); ++i)
+  {
+    const TopologyLinkSpec &link = m_spec.links[i];
+    m_links[i].interfaces[0] = m_nextInterface[link.a]++;
+    m_links[i].interfaces[1] = m_nextInterface[link.b]++;
+  }
+}
+
+inline void
+TopologyLoader::CreateDevices ()
+{
+  NS_LOG_INFO ("Create " << m_spec.links.size () << " channels.");
+  CsmaHelper csma;
+  PointToPointHelper p2p;
+  for (uint32_t i = 0; i < m_spec.links.size (); ++i)
+  {
+    const TopologyLinkSpec &link = m_spec.links[i];
+    DataRate rate = link.rateBps ? DataRate (link.rateBps) : m_defaultRate;
+    Time delay = link.delayNs >= 0 ? NanoSeconds (link.delayNs) : m_defaultDelay;
+    NetDeviceContainer devices;
+    // um canal CSMA não atravessa processos
+    if (m_linkType == CSMA && GetSystemId (link.a) == GetSystemId (link.b))
+    {
+      csma.SetChannelAttribute ("DataRate", DataRateValue (rate));
+      csma.SetChannelAttribute ("Delay", TimeValue (delay));
+      devices = csma.Install (NodeContainer (m_nodes[link.a], m_nodes[link.b]));
+    }
+    else
+    {
+      p2p.SetDeviceAttribute ("DataRate", DataRateValue (rate));
+      p2p.SetChannelAttribute ("Delay", TimeValue (delay));
+      devices = p2p.Install (m_nodes[link.a], m_nodes[link.b]);
+    }
+    m_links[i].devices[0] = devices.Get (0);
+    m_links[i].devices[1] = devices.Get (1);
+  }
+}
+
+inline void
+TopologyLoader::InstallStack ()
+{
+  NS_LOG_INFO ("Create IPv4 and routing.");
+  NS_ABORT_MSG_IF (m_routeCache && m_routing != ROUTING_RIP && m_routing != ROUTING_BATCHED_RIP
+                     && m_routing != ROUTING_OSPF,
+                   "The route cache needs RIP, BatchedRip or OSPF routing");
+  NodeContainer routers = GetRouters ();
+  NodeContainer hosts = GetHosts ();
+  // roteamento dos nós fora do RIP: estático e global (ou o ECMP por fluxo),
+  // como o padrão do InternetStackHelper
+  Ipv4StaticRoutingHelper staticRH;
+  Ipv4GlobalRoutingHelper globalRH;
+  FlowHashEcmpHelper ecmpRH;
+  Ipv4ListRoutingHelper listGlobalRH;
+  listGlobalRH.Add (staticRH, 0);
+  if (m_flowHashEcmp)
+  {
+    listGlobalRH.Add (ecmpRH, -10);
+  }
+  else
+  {
+    listGlobalRH.Add (globalRH, -10);
+  }
+
+  if (m_routing == ROUTING_RIP || m_routing == ROUTING_BATCHED_RIP)
+  {
+    RipHelper ripRouting;
+    BatchedRipHelper batchedRipRouting;
+    Ipv4ListRoutingHelper listRH;
+    if (m_routing == ROUTING_RIP)
+    {
+      ConfigureRip (ripRouting);
+      listRH.Add (ripRouting, 0);
+    }
+    else
+    {
+      ConfigureRip (batchedRipRouting);
+      listRH.Add (batchedRipRouting, 0);
+    }
+
+    RouteCacheHelper cacheRH (listRH);
+    InternetStackHelper internet;
+    internet.SetIpv6StackInstall (false);
+    internet.SetRoutingHelper (m_routeCache ? static_cast<const Ipv4RoutingHelper &> (cacheRH) : listRH);
+    internet.Install (routers);
+  }
+  else if (m_routing == ROUTING_OSPF)
+  {
+    // como no RIP: sem hellos nas interfaces dos hosts, que só são anunciadas
+    OspfHelper ospfRouting;
+    for (uint32_t i = 0; i < m_spec.links.size (); ++i)
+    {
+      const TopologyLinkSpec &link = m_spec.links[i];
+      bool hostA = m_spec.nodes[link.a].host;
+      bool hostB = m_spec.nodes[link.b].host;
+      if (hostB && !hostA)
+      {
+        ospfRouting.ExcludeInterface (m_nodes[link.a], m_links[i].interfaces[0]);
+      }
+      if (hostA && !hostB)
+      {
+        ospfRouting.ExcludeInterface (m_nodes[link.b], m_links[i].interfaces[1]);
+      }
+    }
+    Ipv4ListRoutingHelper listRH;
+    listRH.Add (ospfRouting, 0);
+
+    RouteCacheHelper cacheRH (listRH);
+    InternetStackHelper internet;
+    internet.SetIpv6StackInstall (false);
+    internet.SetRoutingHelper (m_routeCache ? static_cast<const Ipv4RoutingHelper &> (cacheRH) : listRH);
+    internet.Install (routers);
+  }
+  else
+  {
+    InternetStackHelper internet;
+    internet.SetIpv6StackInstall (false);
+    internet.SetRoutingHelper (listGlobalRH);
+    internet.Install (routers);
+  }
+
+  if (m_hostProfile == HOST_LIGHT)
+  {
+    // ARP só nos hosts com algum enlace CSMA
+    std::vector<bool> arp (m_nodes.size (), false);
+    for (uint32_t i = 0; i < m_spec.links.size (); ++i)
+    {
+      arp[m_spec.links[i].a] = arp[m_spec.links[i].a] || m_links[i].devices[0]->NeedsArp ();
+      arp[m_spec.links[i].b] = arp[m_spec.links[i].b] || m_links[i].devices[1]->NeedsArp ();
+    }
+    bool staticHosts = m_routing == ROUTING_RIP || m_routing == ROUTING_BATCHED_RIP || m_routing == ROUTING_OSPF;
+    const Ipv4RoutingHelper &hostRH = staticHosts ? static_cast<const Ipv4RoutingHelper &> (staticRH) : listGlobalRH;
+    for (uint32_t i = 0; i < m_nodes.size (); ++i)
+    {
+      if (m_spec.nodes[i].host)
+      {
+        InstallLightHost (m_nodes[i], arp[i], hostRH);
+      }
+    }
+    return;
+  }
+
+  // com ECMP os hosts também: com dois enlaces, o próprio host de origem divide os fluxos
+  InternetStackHelper internetNodes;
+  internetNodes.SetIpv6StackInstall (false);
+  internetNodes.SetRoutingHelper (listGlobalRH);
+  internetNodes.Install (hosts);
+}
+
+template <typename RipHelperType>
+void
+TopologyLoader::ConfigureRip (RipHelperType &ripRouting) const
+{
+  for (uint32_t i = 0; i < m_spec.links.size (); ++i)
+  {
+    const TopologyLinkSpec &link = m_spec.links[i];
+    bool hostA = m_spec.nodes[link.a].host;
+    bool hostB = m_spec.nodes[link.b].host;
+    // o RIP acontece somente entre os roteadores
+    if (hostB && !hostA)
+    {
+      ripRouting.ExcludeInterface (m_nodes[link.a], m_links[i].interfaces[0]);
+    }
+    if (hostA && !hostB)
+    {
+      ripRouting.ExcludeInterface (m_nodes[link.b], m_links[i].interfaces[1]);
+    }
+    NS_ABORT_MSG_IF (link.metric > 15, "RIP metric above 15 on link " << link.name);
+    if (link.metric != 1 && !hostA && !hostB)
+    {
+      ripRouting.SetInterfaceMetric (m_nodes[link.a], m_links[i].interfaces[0], link.metric);
+      ripRouting.SetInterfaceMetric (m_nodes[link.b], m_links[i].interfaces[1], link.metric);
+    }
+  }
+}
+
+// o que o InternetStackHelper agrega, na mesma ordem, menos TCP, o
+// PacketSocketFactory e (sem enlaces CSMA) o ARP
+inline void
+TopologyLoader::InstallLightHost (Ptr<Node> node, bool arp, const Ipv4RoutingHelper &routing)
+{
+  Ptr<ArpL3Protocol> arpL3;
+  if (arp)
+  {
+    arpL3 = CreateObject<ArpL3Protocol> ();
+    node->AggregateObject (arpL3);
+  }
+  Ptr<Ipv4L3Protocol> ipv4 = CreateObject<Ipv4L3Protocol> ();
+  node->AggregateObject (ipv4);
+  node->AggregateObject (CreateObject<Icmpv4L4Protocol> ());
+  ipv4->SetRoutingProtocol (routing.Create (node));
+  Ptr<TrafficControlLayer> tc = CreateObject<TrafficControlLayer> ();
+  node->AggregateObject (tc);
+  node->AggregateObject (CreateObject<UdpL4Protocol> ());
+  if (arpL3)
+  {
+    arpL3->SetTrafficControl (tc);
+  }
+}
+
+inline void
+TopologyLoader::AssignAddresses ()
+{
+  NS_LOG_INFO ("Assign IPv4 Addresses.");
+  std::string error;
+  if (!m_addresses.Allocate (m_spec, &error))
+  {
+    NS_FATAL_ERROR ("Invalid address plan: " << error);
+  }
+  for (uint32_t i = 0; i < m_spec.links.size (); ++i)
+  {
+    const TopologyLinkSpec &link = m_spec.links[i];
+    Ipv4Mask mask (m_addresses.GetMask (i));
+    uint32_t ends[2] = {link.a, link.b};
+    m_addresses.SetDevices (i, m_nodes[link.a]->GetId (), m_links[i].devices[0]->GetIfIndex (),
+                            m_nodes[link.b]->GetId (), m_links[i].devices[1]->GetIfIndex ());
+    for (uint32_t side = 0; side < 2; ++side)
+    {
+      Ptr<NetDevice> device = m_links[i].devices[side];
+      Ptr<Ipv4> ipv4 = m_nodes[ends[side]]->GetObject<Ipv4> ();
+      uint32_t interface = ipv4->AddInterface (device);
+      NS_ASSERT (interface == m_links[i].interfaces[side]);
+      ipv4->AddAddress (interface, Ipv4InterfaceAddress (Ipv4Address (m_addresses.GetAddress (i, side)), mask));
+      ipv4->SetMetric (interface, link.metric);
+      InstallQueueDisc (m_nodes[ends[side]], device);
+      ipv4->SetUp (interface);
+    }
+  }
+}
+
+// o que o Ipv4AddressHelper::Assign faz em cada dispositivo: fila raiz padrão,
+// se o nó tem a camada de controle de tráfego e o dispositivo expõe as filas
+inline void
+TopologyLoader::InstallQueueDisc (Ptr<Node> node, Ptr<NetDevice> device)
+{
+  Ptr<TrafficControlLayer> tc = node->GetObject<TrafficControlLayer> ();
+  if (tc == nullptr || tc->GetRootQueueDiscOnDevice (device) != nullptr)
+  {
+    return;
+  }
+  Ptr<NetDeviceQueueInterface> queues = device->GetObject<NetDeviceQueueInterface> ();
+  if (queues != nullptr)
+  {
+    TrafficControlHelper::Default (queues->GetNTxQueues ()).Install (device);
+  }
+}
+
+inline void
+TopologyLoader::PopulateRouting ()
+{
+  if (m_routing == ROUTING_GLOBAL)
+  {
+    Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+    FlowHashEcmpRouting::InvalidateAll ();
+    return;
+  }
+  if (m_routing != ROUTING_RIP && m_routing != ROUTING_BATCHED_RIP && m_routing != ROUTING_OSPF)
+  {
+    return;
+  }
+
+  // rota padrão dos hosts: um gateway por roteador vizinho, o primeiro
+  // enlace do host com a menor métrica
+  std::vector<uint32_t> defaultRoutes (m_nodes.size (), 0);
+  for (uint32_t i = 0; i < m_spec.links.size (); ++i)
+  {
+    const TopologyLinkSpec &link = m_spec.links[i];
+    uint32_t ends[2] = {link.a, link.b};
+    for (uint32_t side = 0; side < 2; ++side)
+    {
+      uint32_t host = ends[side];
+      uint32_t gateway = ends[1 - side];
+      if (!m_spec.nodes[host].host || m_spec.nodes[gateway].host)
+      {
+        continue;
+      }
+      Ptr<Ipv4StaticRouting> staticRouting = Ipv4RoutingHelper::GetRouting<Ipv4StaticRouting> (
+        m_nodes[host]->GetObject<Ipv4> ()->GetRoutingProtocol ());
+      staticRouting->SetDefaultRoute (GetAddress (i, 1 - side),
+                                      m_links[i].interfaces[side], defaultRoutes[host]++);
+    }
+  }
+}
+
+inline uint32_t
+TopologyLoader::GetLinkEnd (const std::string &node, const std::string &link) const
+{
+  int64_t nodeId = m_spec.FindNode (node);
+  int64_t linkId = m_spec.FindLink (link);
+  NS_ABORT_MSG_IF (nodeId < 0, "Unknown node " << node);
+  NS_ABORT_MSG_IF (linkId < 0, "Unknown link " << link);
+  const TopologyLinkSpec &spec = m_spec.links[linkId];
+  NS_ABORT_MSG_IF (spec.a != nodeId && spec.b != nodeId, "Node " << node << " is not on link " << link);
+  return spec.a == nodeId ? 0 : 1;
+}
+
+inline Ptr<Node>
+TopologyLoader::GetNode (const std::string &name) const
+{
+  int64_t id = m_spec.FindNode (name);
+  NS_ABORT_MSG_IF (id < 0 || !m_built, "Unknown node " << name);
+  return m_nodes[id];
+}
+
+inline NodeContainer
+TopologyLoader::GetNodes () const
+{
+  NodeContainer nodes;
+  for (const Ptr<Node> &node : m_nodes)
+  {
+    nodes.Add (node);
+  }
+  return nodes;
+}
+
+inline NodeContainer
+TopologyLoader::GetNodes (const std::string &names) const
+{
+  NodeContainer nodes;
+  std::istringstream list (names);
+  std::string name;
+  while (std::getline (list, name, ','))
+  {
+    if (!name.empty ())
+    {
+      nodes.Add (GetNode (name));
+    }
+  }
+  return nodes;
+}
+
+inline NodeContainer
+TopologyLoader::GetRouters () const
+{
+  NodeContainer routers;
+  for (uint32_t i = 0; i < m_nodes.size (); ++i)
+  {
+    if (!m_spec.nodes[i].host)
+    {
+      routers.Add (m_nodes[i]);
+    }
+  }
+  return routers;
+}
+
+inline NodeContainer
+TopologyLoader::GetHosts () const
+{
+  NodeContainer hosts;
+  for (uint32_t i = 0; i < m_nodes.size (); ++i)
+  {
+    if (m_spec.nodes[i].host)
+    {
+      hosts.Add (m_nodes[i]);
+    }
+  }
+  return hosts;
+}
+
+inline uint32_t
+TopologyLoader::GetInterface (const std::string &node, const std::string &link) const
+{
+  uint32_t side = GetLinkEnd (node, link);
+  return m_links[m_spec.FindLink (link)].interfaces[side];
+}
+
+inline Ipv4Address
+TopologyLoader::GetAddress (const std::string &node, const std::string &link) const
+{
+  uint32_t side = GetLinkEnd (node, link);
+  return GetAddress (m_spec.FindLink (link), side);
+}
+
+inline Ptr<NetDevice>
+TopologyLoader::GetDevice (const std::string &node, const std::string &link) const
+{
+  uint32_t side = GetLinkEnd (node, link);
+  return m_links[m_spec.FindLink (link)].devices[side];
+}
+
+inline Ptr<Node>
+TopologyLoader::GetNode (uint32_t id) const
+{
+  NS_ABORT_MSG_IF (id >= m_nodes.size (), "Unknown node index " << id);
+  return m_nodes[id];
+}
+
+inline uint32_t
+TopologyLoader::GetInterface (uint32_t link, uint32_t side) const
+{
+  return m_links[link].interfaces[side];
+}
+
+inline Ipv4Address
+TopologyLoader::GetAddress (uint32_t link, uint32_t side) const
+{
+  return Ipv4Address (m_addresses.GetAddress (link, side));
+}
+
+inline void
+TopologyLoader::PrintReport (std::ostream &os) const
+{
+  double total = 0;
+  os << "Topology: " << m_spec.nodes.size () << " nodes (" << m_spec.nodes.size () - m_spec.CountHosts ()
+     << " routers, " << m_spec.CountHosts () << " hosts), " << m_spec.links.size () << " links" << std::endl;
+  if (!m_systemIds.empty ())
+  {
+    uint32_t cut = 0;
+    for (const TopologyLinkSpec &link : m_spec.links)
+    {
+      cut += GetSystemId (link.a) != GetSystemId (link.b);
+    }
+    os << "  partition: " << *std::max_element (m_systemIds.begin (), m_systemIds.end ()) + 1 << " systems, " << cut
+       << " links between systems" << std::endl;
+  }
+  for (const Phase &phase : m_phases)
+  {
+    os << "  " << phase.name << ": " << phase.ms << " ms, rss " << phase.rssKiB / 1024.0 << " MiB" << std::endl;
+    total += phase.ms;
+  }
+  os << "  total: " << total << " ms, peak rss " << GetPeakRssKiB () / 1024.0 << " MiB (+"
+     << (GetCurrentRssKiB () - std::min (GetCurrentRssKiB (), m_startRssKiB)) / 1024.0
+     << " MiB since the loader was created)" << std::endl;
+}
+
+} // namespace topology
+
+using topology::TopologyLoader;
+
+} // namespace ns3
+
+#endif /* TOPOLOGY_LOADER_H */
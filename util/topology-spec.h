@@ -0,0 +1,555 @@
+// Descrição de topologia independente do ns-3: nós, enlaces e os leitores
+// de lista de arestas e GraphML usados pelo TopologyLoader.
+//
+// Formato lista de arestas (uma declaração por linha, '#' inicia comentário):
+//
+//   node <nome> [router|host]
+//   link <a> <b> [rate=5Mbps] [delay=2ms] [metric=1] [name=net1]
+//   <a> <b> [rate=...] [delay=...] [metric=...] [name=...]
+//
+// Nós citados só em enlaces são roteadores. Enlaces sem nome recebem
+// "net<k>", com k começando em 1 na ordem do arquivo.
+
+#ifndef TOPOLOGY_SPEC_H
+#define TOPOLOGY_SPEC_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+
+struct TopologyNodeSpec
+{
+  std::string name;
+  bool host;
+};
+
+struct TopologyLinkSpec
+{
+  uint32_t a;
+  uint32_t b;
+  uint64_t rateBps; // 0 = taxa padrão do loader
+  int64_t delayNs;  // < 0 = atraso padrão do loader
+  uint32_t metric;
+  std::string name;
+};
+
+class TopologySpec
+{
+public:
+  uint32_t AddNode (const std::string &name, bool host)
+  {
+    auto it = m_index.find (name);
+    if (it != m_index.end ())
+    {
+      nodes[it->second].host = nodes[it->second].host || host;
+      return it->second;
+    }
+    uint32_t id = nodes.size ();
+    nodes.push_back (TopologyNodeSpec {name, host});
+    m_index.emplace (name, id);
+    return id;
+  }
+
+  int64_t FindNode (const std::string &name) const
+  {
+    auto it = m_index.find (name);
+    return it == m_index.end () ? -1 : (int64_t) it->second;
+  }
+
+  uint32_t AddLink (uint32_t a, uint32_t b, uint64_t rateBps = 0, int64_t delayNs = -1,
+                    uint32_t metric = 1, const std::string &name = "")
+  {
+    uint32_t id = links.size ();
+    std::string linkName = name.empty () ? "net" + std::to_string (id + 1) : name;
+    while (name.empty () && m_linkIndex.count (linkName))
+    {
+      linkName += "_";
+    }
+    links.push_back (TopologyLinkSpec {a, b, rateBps, delayNs, metric, linkName});
+    m_linkIndex.emplace (linkName, id);
+    return id;
+  }
+
+  int64_t FindLink (const std::string &name) const
+  {
+    auto it = m_linkIndex.find (name);
+    return it == m_linkIndex.end () ? -1 : (int64_t) it->second;
+  }
+
+  uint32_t CountHosts () const
+  {
+    uint32_t n = 0;
+    for (const TopologyNodeSpec &node : nodes)
+    {
+      n += node.host;
+    }
+    return n;
+  }
+
+  void Clear ()
+  {
+    nodes.clear ();
+    links.clear ();
+    m_index.clear ();
+    m_linkIndex.clear ();
+  }
+
+  bool ReadEdgeList (std::istream &is, std::string *error);
+  bool ReadGraphMl (std::istream &is, std::string *error);
+  // escolhe o leitor pela extensão (.graphml/.xml) do arquivo
+  bool ReadFile (const std::string &path, std::string *error);
+  void WriteEdgeList (std::ostream &os) const;
+
+  std::vector<TopologyNodeSpec> nodes;
+  std::vector<TopologyLinkSpec> links;
+
+private:
+  bool SetLinkAttribute (TopologyLinkSpec &link, const std::string &key,
+                         const std::string &value, std::string *error);
+
+  std::unordered_map<std::string, uint32_t> m_index;
+  std::unordered_map<std::string, uint32_t> m_linkIndex;
+};
+
+// "5Mbps", "100kbps", "1Gbps", "625KBps" ou número puro em bit/s
+inline bool
+ParseDataRate (const std::string &text, uint64_t *bps)
+{
+  char *end = nullptr;
+  double value = std::strtod (text.c_str (), &end);
+  if (end == text.c_str () || value < 0)
+  {
+    return false;
+  }
+  std::string unit (end);
+  static const struct { const char *unit; double factor; } units[] = {
+    {"", 1}, {"bps", 1}, {"b/s", 1},
+    {"kbps", 1e3}, {"Kbps", 1e3}, {"kb/s", 1e3}, {"Kb/s", 1e3},
+    {"Mbps", 1e6}, {"Mb/s", 1e6}, {"Gbps", 1e9}, {"Gb/s", 1e9},
+    {"Bps", 8}, {"KBps", 8e3}, {"kBps", 8e3}, {"MBps", 8e6}, {"GBps", 8e9},
+  };
+  for (const auto &u : units)
+  {
+    if (unit == u.unit)
+    {
+      *bps = (uint64_t) (value * u.factor + 0.5);
+      return true;
+    }
+  }
+  return false;
+}
+
+// "2ms", "10us", "1s", "500ns" ou número puro em segundos (como o ns3::Time)
+inline bool
+ParseDelay (const std::string &text, int64_t *ns)
+{
+  char *end = nullptr;
+  double value = std::strtod (text.c_str (), &end);
+  if (end == text.c_str () || value < 0)
+  {
+    return false;
+  }
+  std::string unit (end);
+  static const struct { const char *unit; double factor; } units[] = {
+    {"", 1e9}, {"s", 1e9}, {"ms", 1e6}, {"us", 1e3}, {"ns", 1},
+  };
+  for (const auto &u : units)
+  {
+    if (unit == u.unit)
+    {
+      *ns = (int64_t) (value * u.factor + 0.5);
+      return true;
+    }
+  }
+  return false;
+}
+
+inline std::string
+FormatDataRate (uint64_t bps)
+{
+  if (bps != 0 && bps % 1000000000 == 0)
+  {
+    return std::to_string (bps / 1000000000) + "Gbps";
+  }
+  if (bps != 0 && bps % 1000000 == 0)
+  {
+    return std::to_string (bps / 1000000) + "Mbps";
+  }
+  if (bps != 0 && bps % 1000 == 0)
+  {
+    return std::to_string (bps / 1000) + "kbps";
+  }
+  return std::to_string (bps) + "bps";
+}
+
+inline std::string
+FormatDelay (int64_t ns)
+{
+  if (ns != 0 && ns % 1000000000 == 0)
+  {
+    return std::to_string (ns / 1000000000) + "s";
+  }
+  if (ns != 0 && ns % 1000000 == 0)
+  {
+    return std::to_string (ns / 1000000) + "ms";
+  }
+  if (ns != 0 && ns % 1000 == 0)
+  {
+    return std::to_string (ns / 1000) + "us";
+  }
+  return std::to_string (ns) + "ns";
+}
+
+inline bool
+TopologySpec::SetLinkAttribute (TopologyLinkSpec &link, const std::string &key,
+                                const std::string &value, std::string *error)
+{
+  if (key == "rate" || key == "bandwidth" || key == "DataRate")
+  {
+    if (!ParseDataRate (value, &link.rateBps))
+    {
+      *error = "taxa invalida '" + value + "'";
+      return false;
+    }
+  }
+  else if (key == "delay" || key == "latency" || key == "Delay")
+  {
+    if (!ParseDelay (value, &link.delayNs))
+    {
+      *error = "atraso invalido '" + value + "'";
+      return false;
+    }
+  }
+  else if (key == "metric" || key == "weight" || key == "cost")
+  {
+    char *end = nullptr;
+    unsigned long metric = std::strtoul (value.c_str (), &end, 10);
+    if (end == value.c_str () || *end != '\0' || metric == 0)
+    {
+      *error = "metrica invalida '" + value + "'";
+      return false;
+    }
+    link.metric = metric;
+  }
+  else if (key == "name" || key == "id")
+  {
+    link.name = value;
+  }
+  // atributos desconhecidos (ex.: campos extras do GraphML) são ignorados
+  return true;
+}
+
+inline bool
+TopologySpec::ReadEdgeList (std::istream &is, std::string *error)
+{
+  std::string line;
+  uint32_t lineNo = 0;
+  while (std::getline (is, line))
+  {
+    ++lineNo;
+    std::string::size_type hash = line.find ('#');
+    if (hash != std::string::npos)
+    {
+      line.erase (hash);
+    }
+    std::istringstream tokens (line);
+    std::vector<std::string> words;
+    std::string word;
+    while (tokens >> word)
+    {
+      words.push_back (word);
+    }
+    if (words.empty ())
+    {
+      continue;
+    }
+
+    std::string where = "linha " + std::to_string (lineNo) + ": ";
+    if (words[0] == "node")
+    {
+      if (words.size () < 2 || words.size () > 3
+          || (words.size () == 3 && words[2] != "host" && words[2] != "router"))
+        {
+          *error = where + "esperado 'node <nome> [router|host]'";
+          return false;
+        }
+      AddNode (words[1], words.size () == 3 && words[2] == "host");
+      continue;
+    }
+
+    std::size_t first = words[0] == "link" ? 1 : 0;
+    if (words.size () < first + 2)
+    {
+      *error = where + "esperado 'link <a> <b> [chave=valor...]'";
+      return false;
+    }
+    uint32_t a = AddNode (words[first], false);
+    uint32_t b = AddNode (words[first + 1], false);
+    if (a == b)
+    {
+      *error = where + "enlace de '" + words[first] + "' para ele mesmo";
+      return false;
+    }
+    TopologyLinkSpec link {a, b, 0, -1, 1, ""};
+    for (std::size_t i = first + 2; i < words.size (); ++i)
+    {
+      std::string::size_type eq = words[i].find ('=');
+      if (eq == std::string::npos)
+      {
+        *error = where + "atributo '" + words[i] + "' sem '='";
+        return false;
+      }
+      if (!SetLinkAttribute (link, words[i].substr (0, eq), words[i].substr (eq + 1), error))
+      {
+        *error = where + *error;
+        return false;
+      }
+    }
+    if (!link.name.empty () && FindLink (link.name) >= 0)
+    {
+      *error = where + "enlace '" + link.name + "' repetido";
+      return false;
+    }
+    AddLink (a, b, link.rateBps, link.delayNs, link.metric, link.name);
+  }
+  return true;
+}
+
+namespace topology {
+
+// Leitor mínimo de XML para GraphML: percorre as tags em ordem e guarda
+// atributos e o texto que vem logo depois de cada tag.
+struct XmlTag
+{
+  std::string name;
+  bool closing;
+  bool selfClosing;
+  std::unordered_map<std::string, std::string> attributes;
+  std::string text;
+};
+
+inline bool
+NextXmlTag (std::istream &is, XmlTag *tag)
+{
+  char c;
+  while (is.get (c) && c != '<')
+  {
+  }
+  if (!is)
+  {
+    return false;
+  }
+  std::string raw;
+  while (is.get (c) && c != '>')
+  {
+    raw += c;
+    if (raw.size () == 3 && raw == "!--")
+    {
+      // comentário: descarta até "-->"
+      std::string tail;
+      while (is.get (c))
+      {
+        tail += c;
+        if (tail.size () >= 3 && tail.compare (tail.size () - 3, 3, "-->") == 0)
+        {
+          break;
+        }
+      }
+      raw.clear ();
+      return NextXmlTag (is, tag);
+    }
+  }
+  tag->attributes.clear ();
+  tag->text.clear ();
+  tag->closing = !raw.empty () && raw[0] == '/';
+  tag->selfClosing = !raw.empty () && raw.back () == '/';
+  std::size_t pos = tag->closing ? 1 : 0;
+  std::size_t end = raw.size () - (tag->selfClosing ? 1 : 0);
+  std::size_t nameEnd = raw.find_first_of (" \t\r\n/", pos);
+  tag->name = raw.substr (pos, std::min (nameEnd, end) - pos);
+  pos = std::min (nameEnd, end);
+  while (pos < end)
+  {
+    std::size_t eq = raw.find ('=', pos);
+    if (eq == std::string::npos || eq >= end)
+    {
+      break;
+    }
+    std::size_t keyStart = raw.find_first_not_of (" \t\r\n", pos);
+    std::string key = raw.substr (keyStart, raw.find_last_not_of (" \t\r\n", eq - 1) + 1 - keyStart);
+    std::size_t quote = raw.find_first_of ("\"'", eq);
+    if (quote == std::string::npos)
+    {
+      break;
+    }
+    std::size_t close = raw.find (raw[quote], quote + 1);
+    if (close == std::string::npos)
+    {
+      break;
+    }
+    tag->attributes[key] = raw.substr (quote + 1, close - quote - 1);
+    pos = close + 1;
+  }
+  while (is.peek () != '<' && is.get (c))
+  {
+    tag->text += c;
+  }
+  std::size_t a = tag->text.find_first_not_of (" \t\r\n");
+  tag->text = a == std::string::npos ? "" : tag->text.substr (a, tag->text.find_last_not_of (" \t\r\n") + 1 - a);
+  return true;
+}
+
+} // namespace topology
+
+inline bool
+TopologySpec::ReadGraphMl (std::istream &is, std::string *error)
+{
+  // <key id="d0" for="edge" attr.name="rate"/> mapeia id -> nome do atributo
+  std::unordered_map<std::string, std::string> keys;
+  std::vector<std::pair<std::string, std::string> > data;
+  std::string nodeId;
+  std::string source;
+  std::string target;
+  bool inNode = false;
+  bool inEdge = false;
+  topology::XmlTag tag;
+  while (topology::NextXmlTag (is, &tag))
+  {
+    if (tag.name == "key" && !tag.closing)
+    {
+      keys[tag.attributes["id"]] = tag.attributes["attr.name"];
+    }
+    else if (tag.name == "node" && !tag.closing)
+    {
+      nodeId = tag.attributes["id"];
+      data.clear ();
+      inNode = !tag.selfClosing;
+      if (tag.selfClosing)
+      {
+        AddNode (nodeId, false);
+      }
+    }
+    else if (tag.name == "edge" && !tag.closing)
+    {
+      source = tag.attributes["source"];
+      target = tag.attributes["target"];
+      data.clear ();
+      if (tag.attributes.count ("id"))
+      {
+        data.emplace_back ("name", tag.attributes["id"]);
+      }
+      inEdge = true;
+      if (!tag.selfClosing)
+      {
+        continue;
+      }
+    }
+    else if (tag.name == "data" && !tag.closing && (inNode || inEdge))
+    {
+      auto k = keys.find (tag.attributes["key"]);
+      data.emplace_back (k != keys.end () ? k->second : tag.attributes["key"], tag.text);
+      continue;
+    }
+
+    if (tag.name == "node" && tag.closing && inNode)
+    {
+      bool host = false;
+      for (const auto &kv : data)
+      {
+        if (kv.first == "type" || kv.first == "role")
+        {
+          host = kv.second == "host";
+        }
+      }
+      AddNode (nodeId, host);
+      inNode = false;
+    }
+    else if (tag.name == "edge" && inEdge && (tag.closing || tag.selfClosing))
+    {
+      if (source.empty () || target.empty () || source == target)
+      {
+        *error = "aresta GraphML invalida (" + source + " -> " + target + ")";
+        return false;
+      }
+      TopologyLinkSpec link {AddNode (source, false), AddNode (target, false), 0, -1, 1, ""};
+      for (const auto &kv : data)
+      {
+        if (!SetLinkAttribute (link, kv.first, kv.second, error))
+        {
+          *error = "aresta " + source + " -> " + target + ": " + *error;
+          return false;
+        }
+      }
+      if (!link.name.empty () && FindLink (link.name) >= 0)
+      {
+        *error = "aresta " + source + " -> " + target + ": enlace '" + link.name + "' repetido";
+        return false;
+      }
+      AddLink (link.a, link.b, link.rateBps, link.delayNs, link.metric, link.name);
+      inEdge = false;
+    }
+  }
+  if (nodes.empty ())
+  {
+    *error = "nenhum <node> encontrado";
+    return false;
+  }
+  return true;
+}
+
+inline bool
+TopologySpec::ReadFile (const std::string &path, std::string *error)
+{
+  std::ifstream is (path.c_str ());
+  if (!is)
+  {
+    *error = "nao foi possivel abrir " + path;
+    return false;
+  }
+  std::string::size_type dot = path.rfind ('.');
+  std::string ext = dot == std::string::npos ? "" : path.substr (dot);
+  bool ok = (ext == ".graphml" || ext == ".xml") ? ReadGraphMl (is, error) : ReadEdgeList (is, error);
+  if (!ok)
+  {
+    *error = path + ": " + *error;
+  }
+  return ok;
+}
+
+inline void
+TopologySpec::WriteEdgeList (std::ostream &os) const
+{
+  for (const TopologyNodeSpec &node : nodes)
+  {
+    os << "node " << node.name << (node.host ? " host" : " router") << "\n";
+  }
+  for (const TopologyLinkSpec &link : links)
+  {
+    os << "link " << nodes[link.a].name << " " << nodes[link.b].name;
+    if (link.rateBps)
+    {
+      os << " rate=" << FormatDataRate (link.rateBps);
+    }
+    if (link.delayNs >= 0)
+    {
+      os << " delay=" << FormatDelay (link.delayNs);
+    }
+    if (link.metric != 1)
+    {
+      os << " metric=" << link.metric;
+    }
+    os << " name=" << link.name << "\n";
+  }
+}
+
+} // namespace ns3
+
+#endif /* TOPOLOGY_SPEC_H */
@@ -0,0 +1,430 @@
+// Gerador de carga UDP no lugar do UdpEchoClient de 1 pacote por segundo,
+// para ver o encaminhamento sob carga e onde o próprio simulador satura.
+//
+// Modos do TrafficSource (atributo Mode):
+//
+//   cbr      pacotes de PacketSize bytes espaçados para dar DataRate
+//   poisson  chegadas de Poisson com a mesma taxa média
+//   onoff    DataRate durante os períodos ligados; períodos ligados e
+//            desligados com duração de Pareto (cauda pesada) de médias
+//            OnTime/OffTime e forma ParetoShape
+//   trace    repete em laço o arquivo TraceFile, uma linha por pacote:
+//            "<intervalo desde o pacote anterior, s> <bytes>" ('#' comenta)
+//
+// Os destinos recebem num PacketSink UDP. O TrafficMeter conta os pacotes
+// enviados e recebidos e as transmissões em todos os dispositivos, e relata
+// quantos pacotes o simulador processou por segundo de relógio. Cada pacote
+// leva um FlowLabelTag com as portas do fluxo, para o ECMP por fluxo
+// (ecmp-routing.h) separar os fluxos já no host de origem.
+//
+//   TrafficHelper load ("poisson");
+//   load.SetAttribute ("DataRate", DataRateValue (DataRate ("2Mbps")));
+//   load.InstallSink (dst, 5000);
+//   ApplicationContainer apps = load.Install (src, dstAddress, 5000);
+
+#ifndef TRAFFIC_SOURCE_H
+#define TRAFFIC_SOURCE_H
+
+#include "ecmp-routing.h"
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+
+#include <fstream>
+#include <map>
+#include <ostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+namespace traffic {
+
+NS_LOG_COMPONENT_DEFINE ("TrafficSource");
+
+struct TracePacket
+{
+  double gap;
+  uint32_t size;
+};
+
+// arquivos de trace já lidos, compartilhados entre as fontes
+inline const std::vector<TracePacket> &
+LoadTrace (const std::string &path)
+{
+  static std::map<std::string, std::vector<TracePacket> > cache;
+  std::map<std::string, std::vector<TracePacket> >::iterator it = cache.find (path);
+  if (it != cache.end ())
+  {
+    return it->second;
+  }
+  std::ifstream in (path);
+  NS_ABORT_MSG_IF (!in, "Cannot read traffic trace " << path);
+  std::vector<TracePacket> &packets = cache[path];
+  std::string line;
+  uint32_t number = 0;
+  while (std::getline (in, line))
+  {
+    ++number;
+    std::istringstream fields (line.substr (0, line.find ('#')));
+    TracePacket packet;
+    if (!(fields >> packet.gap))
+    {
+      continue;
+    }
+    NS_ABORT_MSG_IF (!(fields >> packet.size) || packet.gap < 0 || packet.size == 0,
+                     path << ":" << number << ": expected '<gap seconds> <bytes>'");
+    packets.push_back (packet);
+  }
+  NS_ABORT_MSG_IF (packets.empty (), "Empty traffic trace " << path);
+  return packets;
+}
+
+class TrafficSource : public Application
+{
+public:
+  enum Mode
+  {
+    CBR,
+    POISSON,
+    ON_OFF,
+    TRACE
+  };
+
+  static TypeId GetTypeId ()
+  {
+    static TypeId tid =
+      TypeId ("ns3::TrafficSource")
+        .SetParent<Application> ()
+        .AddConstructor<TrafficSource> ()
+        .AddAttribute ("Remote", "Destination address and port", AddressValue (),
+                       MakeAddressAccessor (&TrafficSource::m_remote), MakeAddressChecker ())
+        .AddAttribute ("Mode", "Packet arrival process", EnumValue (CBR), MakeEnumAccessor (&TrafficSource::m_mode),
+                       MakeEnumChecker (CBR, "cbr", POISSON, "poisson", ON_OFF, "onoff", TRACE, "trace"))
+        .AddAttribute ("DataRate", "Mean rate (while on, in onoff mode)", DataRateValue (DataRate ("1Mbps")),
+                       MakeDataRateAccessor (&TrafficSource::m_rate), MakeDataRateChecker ())
+        .AddAttribute ("PacketSize", "Payload bytes per packet", UintegerValue (1024),
+                       MakeUintegerAccessor (&TrafficSource::m_packetSize), MakeUintegerChecker<uint32_t> (1))
+        .AddAttribute ("OnTime", "Mean on period (onoff)", TimeValue (Seconds (1)),
+                       MakeTimeAccessor (&TrafficSource::m_onTime), MakeTimeChecker ())
+        .AddAttribute ("OffTime", "Mean off period (onoff)", TimeValue (Seconds (1)),
+                       MakeTimeAccessor (&TrafficSource::m_offTime), MakeTimeChecker ())
+        .AddAttribute ("ParetoShape", "Shape of the Pareto on/off periods (onoff), above 1", DoubleValue (1.5),
+                       MakeDoubleAccessor (&TrafficSource::m_shape), MakeDoubleChecker<double> (1.0001))
+        .AddAttribute ("TraceFile", "Packet gaps and sizes to replay (trace)", StringValue (""),
+                       MakeStringAccessor (&TrafficSource::m_traceFile), MakeStringChecker ())
+        .AddAttribute ("MaxPackets", "Packets to send, 0 for no limit", UintegerValue (0),
+                       MakeUintegerAccessor (&TrafficSource::m_maxPackets), MakeUintegerChecker<uint64_t> ())
+        .AddTraceSource ("Tx", "A packet is sent", MakeTraceSourceAccessor (&TrafficSource::m_txTrace),
+                         "ns3::Packet::TracedCallback");
+    return tid;
+  }
+
+  TrafficSource ()
+    : m_sent (0),
+      m_traceIndex (0),
+      m_onEnd (Seconds (0))
+  {
+    m_exponential = CreateObject<ExponentialRandomVariable> ();
+    m_pareto = CreateObject<ParetoRandomVariable> ();
+  }
+
+  int64_t AssignStreams (int64_t stream)
+  {
+    m_exponential->SetStream (stream);
+    m_pareto->SetStream (stream + 1);
+    return 2;
+  }
+
+  uint64_t GetSent () const
+  {
+    return m_sent;
+  }
+
+protected:
+  void DoDispose () override
+  {
+    m_socket = nullptr;
+    Application::DoDispose ();
+  }
+
+private:
+  void StartApplication () override
+  {
+    if (!m_socket)
+    {
+      m_socket = Socket::CreateSocket (GetNode (), UdpSocketFactory::GetTypeId ());
+      m_socket->Bind ();
+      m_socket->Connect (m_remote);
+      Address local;
+      m_socket->GetSockName (local);
+      m_flowLabel = FlowLabelTag (InetSocketAddress::ConvertFrom (local).GetPort (),
+                                  InetSocketAddress::ConvertFrom (m_remote).GetPort ());
+    }
+    if (m_mode == TRACE)
+    {
+      m_trace = &LoadTrace (m_traceFile);
+    }
+    if (m_mode == ON_OFF)
+    {
+      StartOn ();
+    }
+    else
+    {
+      m_next = Simulator::Schedule (NextGap (), &TrafficSource::Send, this);
+    }
+  }
+
+  void StopApplication () override
+  {
+    Simulator::Cancel (m_next);
+    if (m_socket)
+    {
+      m_socket->Close ();
+      m_socket = nullptr;
+    }
+  }
+
+  // duração de Pareto com a média dada: escala = média (forma - 1) / forma
+  Time ParetoPeriod (Time mean)
+  {
+    m_pareto->SetAttribute ("Scale", DoubleValue (mean.GetSeconds () * (m_shape - 1) / m_shape));
+    m_pareto->SetAttribute ("Shape", DoubleValue (m_shape));
+    return Seconds (m_pareto->GetValue ());
+  }
+
+  void StartOn ()
+  {
+    m_onEnd = Simulator::Now () + ParetoPeriod (m_onTime);
+    Send ();
+  }
+
+  Time NextGap ()
+  {
+    switch (m_mode)
+    {
+    case POISSON:
+      return Seconds (m_exponential->GetValue (m_rate.CalculateBytesTxTime (m_packetSize).GetSeconds (), 0));
+    case TRACE:
+      return Seconds ((*m_trace)[m_traceIndex % m_trace->size ()].gap);
+    default:
+      return m_rate.CalculateBytesTxTime (m_packetSize);
+    }
+  }
+
+  void Send ()
+  {
+    uint32_t size = m_mode == TRACE ? (*m_trace)[m_traceIndex++ % m_trace->size ()].size : m_packetSize;
+    Ptr<Packet> packet = Create<Packet> (size);
+    packet->AddPacketTag (m_flowLabel);
+    m_txTrace (packet);
+    m_socket->Send (packet);
+    ++m_sent;
+    if (m_maxPackets && m_sent >= m_maxPackets)
+    {
+      return;
+    }
+    Time gap = NextGap ();
+    if (m_mode == ON_OFF && Simulator::Now () + gap > m_onEnd)
+    {
+      m_next = Simulator::Schedule (m_onEnd - Simulator::Now () + ParetoPeriod (m_offTime), &TrafficSource::StartOn,
+                                    this);
+      return;
+    }
+    m_next = Simulator::Schedule (gap, &TrafficSource::Send, this);
+  }
+
+  Address m_remote;
+  Mode m_mode;
+  DataRate m_rate;
+  uint32_t m_packetSize;
+  Time m_onTime;
+  Time m_offTime;
+  double m_shape;
+  std::string m_traceFile;
+  uint64_t m_maxPackets;
+
+  Ptr<Socket> m_socket;
+  FlowLabelTag m_flowLabel;
+  Ptr<ExponentialRandomVariable> m_exponential;
+  Ptr<ParetoRandomVariable> m_pareto;
+  const std::vector<TracePacket> *m_trace;
+  EventId m_next;
+  uint64_t m_sent;
+  uint64_t m_traceIndex;
+  Time m_onEnd;
+  TracedCallback<Ptr<const Packet> > m_txTrace;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (TrafficSource);
+
+class TrafficHelper
+{
+public:
+  explicit TrafficHelper (const std::string &mode)
+  {
+    NS_ABORT_MSG_IF (mode != "cbr" && mode != "poisson" && mode != "onoff" && mode != "trace",
+                     "Unknown traffic mode " << mode << " (cbr, poisson, onoff or trace)");
+    m_factory.SetTypeId ("ns3::TrafficSource");
+    m_factory.Set ("Mode", EnumValue (mode == "cbr"       ? TrafficSource::CBR
+                                      : mode == "poisson" ? TrafficSource::POISSON
+                                      : mode == "onoff"   ? TrafficSource::ON_OFF
+                                                          : TrafficSource::TRACE));
+  }
+
+  void SetAttribute (const std::string &name, const AttributeValue &value)
+  {
+    m_factory.Set (name, value);
+  }
+
+  ApplicationContainer Install (Ptr<Node> source, Ipv4Address destination, uint16_t port) const
+  {
+    m_factory.Set ("Remote", AddressValue (InetSocketAddress (destination, port)));
+    Ptr<TrafficSource> app = m_factory.Create<TrafficSource> ();
+    source->AddApplication (app);
+    return ApplicationContainer (app);
+  }
+
+  ApplicationContainer InstallSink (NodeContainer nodes, uint16_t port) const
+  {
+    PacketSinkHelper sink ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), port));
+    return sink.Install (nodes);
+  }
+
+  // 'flows' fluxos entre a e b na porta 'port', alternando o sentido (o
+  // primeiro de a para b); os sinks são instalados à parte
+  ApplicationContainer InstallFlows (Ptr<Node> a, Ipv4Address aAddress, Ptr<Node> b, Ipv4Address bAddress,
+                                     uint32_t flows, uint16_t port) const
+  {
+    ApplicationContainer apps;
+    for (uint32_t i = 0; i < flows; ++i)
+    {
+      apps.Add (i % 2 == 0 ? Install (a, bAddress, port) : Install (b, aAddress, port));
+    }
+    return apps;
+  }
+
+  // 'count' pares (origem, destino) distintos sorteados entre 'nodes' nós
+  static std::vector<std::pair<uint32_t, uint32_t> > RandomPairs (uint32_t nodes, uint32_t count, uint32_t seed)
+  {
+    std::vector<std::pair<uint32_t, uint32_t> > pairs;
+    std::mt19937 rng (seed);
+    std::uniform_int_distribution<uint32_t> pick (0, nodes - 1);
+    while (nodes > 1 && pairs.size () < count)
+    {
+      uint32_t source = pick (rng);
+      uint32_t destination = pick (rng);
+      if (source != destination)
+      {
+        pairs.emplace_back (source, destination);
+      }
+    }
+    return pairs;
+  }
+
+private:
+  mutable ObjectFactory m_factory;
+};
+
+class TrafficMeter
+{
+public:
+  TrafficMeter ()
+    : m_sent (0),
+      m_received (0),
+      m_receivedBytes (0),
+      m_transmissions (0)
+  {
+  }
+
+  // depois de instalar as aplicações e os dispositivos
+  void Install ()
+  {
+    Config::ConnectWithoutContext ("/NodeList/*/ApplicationList/*/$ns3::TrafficSource/Tx",
+                                   MakeCallback (&TrafficMeter::SourceTx, this));
+    Config::ConnectWithoutContext ("/NodeList/*/ApplicationList/*/$ns3::PacketSink/Rx",
+                                   MakeCallback (&TrafficMeter::SinkRx, this));
+    Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/$ns3::CsmaNetDevice/PhyTxEnd",
+                                   MakeCallback (&TrafficMeter::DeviceTx, this));
+    Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/$ns3::PointToPointNetDevice/PhyTxEnd",
+                                   MakeCallback (&TrafficMeter::DeviceTx, this));
+  }
+
+  uint64_t GetSent () const
+  {
+    return m_sent;
+  }
+
+  uint64_t GetReceived () const
+  {
+    return m_received;
+  }
+
+  uint64_t GetReceivedBytes () const
+  {
+    return m_receivedBytes;
+  }
+
+  // vazão agregada nos sinks (bit/s), do primeiro ao último pacote recebido
+  double GetThroughput () const
+  {
+    double seconds = (m_lastRx - m_firstRx).GetSeconds ();
+    return seconds > 0 ? m_receivedBytes * 8.0 / seconds : 0.0;
+  }
+
+  // transmissões de pacotes (de qualquer tipo) em todos os enlaces
+  uint64_t GetTransmissions () const
+  {
+    return m_transmissions;
+  }
+
+  void Report (std::ostream &os, double wallSeconds) const
+  {
+    os << "Traffic: " << m_sent << " sent, " << m_received << " received (" << m_receivedBytes << " bytes, "
+       << GetThroughput () / 1e6 << " Mbps aggregate), " << m_transmissions << " link transmissions in " << wallSeconds << " s wall: "
+       << m_transmissions / wallSeconds << " packets/s, " << Simulator::GetEventCount () / wallSeconds
+       << " events/s" << std::endl;
+  }
+
+private:
+  void SourceTx (Ptr<const Packet>)
+  {
+    ++m_sent;
+  }
+
+  void SinkRx (Ptr<const Packet> packet, const Address &)
+  {
+    if (m_received++ == 0)
+    {
+      m_firstRx = Simulator::Now ();
+    }
+    m_lastRx = Simulator::Now ();
+    m_receivedBytes += packet->GetSize ();
+  }
+
+  void DeviceTx (Ptr<const Packet>)
+  {
+    ++m_transmissions;
+  }
+
+  uint64_t m_sent;
+  uint64_t m_received;
+  uint64_t m_receivedBytes;
+  uint64_t m_transmissions;
+  Time m_firstRx;
+  Time m_lastRx;
+};
+
+} // namespace traffic
+
+using traffic::TrafficHelper;
+using traffic::TrafficMeter;
+using traffic::TrafficSource;
+
+} // namespace ns3
+
+#endif /* TRAFFIC_SOURCE_H */
@@ -0,0 +1,524 @@
+// Partida a quente: salva o estado convergido de uma execução e o restaura no
+// começo das seguintes, para que as varreduras não gastem, em cada variante,
+// os primeiros 30 s simulados esperando o roteamento convergir antes da
+// primeira falha.
+//
+//   // uma vez: converge e salva aos 25 s
+//   WarmStart warmStart (topology);
+//   warmStart.Save (Seconds (25), "convergido.ws");
+//
+//   // em cada variante: restaura em t = 0 e antecipa as falhas
+//   WarmStart warmStart (topology);
+//   warmStart.Restore ("convergido.ws");
+//
+// O que é salvo, por nó (índice do TopologySpec):
+//  - BatchedRip (batched-rip.h): as rotas aprendidas válidas, com o tempo que
+//    faltava para cada uma expirar;
+//  - OspfRouting (ospf-routing.h): o LSDB, com a idade das LSAs, e as
+//    adjacências; a própria LSA só adianta a sequência, e a Router-LSA
+//    originada na partida passa por cima dela nos vizinhos;
+//  - ARP: por ponta de enlace, se o endereço do outro lado estava resolvido.
+//    O MAC não vai para o arquivo: sai do dispositivo do outro lado, que é o
+//    mesmo para a mesma topologia. A entrada volta ALIVE e expira como uma
+//    resolvida na hora.
+//
+// O que não dá para salvar no ns-3: o ns3::Rip guarda a tabela em membros
+// privados, sem acesso de fora (use a BatchedRip, que com os atributos
+// padrão se comporta igual); as aplicações e os temporizadores periódicos
+// dos protocolos (updates do RIP, hellos do OSPF) não têm estado
+// serializável, então recomeçam como na partida, sorteados de novo. O
+// roteamento global não precisa de nada: é calculado da topologia.
+//
+// O arquivo é texto, uma linha por item, e só vale para a mesma topologia e
+// o mesmo roteamento. O cabeçalho guarda o número de nós e de enlaces e dois
+// hashes (Hash64): o da topologia (nomes e papéis dos nós; nome, pontas e
+// métrica dos enlaces; sub-rede de cada enlace) e o do roteamento (protocolo
+// de cada nó e o valor de todos os atributos dele, como o SplitHorizon da
+// BatchedRip ou o HelloInterval da OspfRouting). O Restore recusa o arquivo
+// se algum dos dois não bater:
+//
+//   warmstart <segundos> <nós> <enlaces> <hash da topologia> <hash do roteamento>
+//   route <nó> <rede/prefixo> <gateway> <interface> <métrica> <timeoutNs>
+//   adjacency <nó> <interface> <router id> <endereço>
+//   lsa <nó> <roteador> <sequência> <idade> <n> [<tipo> <id> <data> <métrica>]...
+//   arp <enlace> <ponta>
+
+#ifndef WARM_START_H
+#define WARM_START_H
+
+#include "address-plan.h"
+#include "batched-rip.h"
+#include "ospf-routing.h"
+#include "topology-loader.h"
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+
+#include <fstream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+namespace warmstart {
+
+NS_LOG_COMPONENT_DEFINE ("WarmStart");
+
+// conteúdo do arquivo, sem o ns-3 além dos tipos dos protocolos
+struct Checkpoint
+{
+  struct Route
+  {
+    uint32_t node;
+    BatchedRip::LearnedRoute route;
+  };
+
+  struct Adjacency
+  {
+    uint32_t node;
+    OspfRouting::Adjacency adjacency;
+  };
+
+  struct Lsa
+  {
+    uint32_t node;
+    ospf::OspfLsa lsa;
+  };
+
+  struct Arp
+  {
+    uint32_t link;
+    uint32_t side; // ponta que tinha o endereço da outra resolvido
+  };
+
+  double time = 0;
+  uint32_t nodes = 0;
+  uint32_t links = 0;
+  uint64_t topologyHash = 0;
+  uint64_t routingHash = 0;
+  std::vector<Route> routes;
+  std::vector<Adjacency> adjacencies;
+  std::vector<Lsa> lsas;
+  std::vector<Arp> arps;
+
+  bool WriteFile (const std::string &path, std::string *error) const
+  {
+    std::ofstream os (path);
+    if (!os)
+    {
+      *error = "nao foi possivel criar " + path;
+      return false;
+    }
+    os << "warmstart " << time << " " << nodes << " " << links << " " << topologyHash << " " << routingHash << "\n";
+    for (const Route &entry : routes)
+    {
+      const BatchedRip::LearnedRoute &route = entry.route;
+      os << "route " << entry.node << " " << AddressPlan::FormatPrefix (route.network, MaskLength (route.mask)) << " "
+         << AddressPlan::FormatAddress (route.gateway) << " " << route.interface << " " << route.metric << " "
+         << route.timeout.GetNanoSeconds () << "\n";
+    }
+    for (const Adjacency &entry : adjacencies)
+    {
+      os << "adjacency " << entry.node << " " << entry.adjacency.interface << " "
+         << AddressPlan::FormatAddress (entry.adjacency.routerId) << " "
+         << AddressPlan::FormatAddress (entry.adjacency.address.Get ()) << "\n";
+    }
+    for (const Lsa &entry : lsas)
+    {
+      const ospf::OspfLsa &lsa = entry.lsa;
+      os << "lsa " << entry.node << " " << AddressPlan::FormatAddress (lsa.advertisingRouter) << " " << lsa.sequence
+         << " " << lsa.age << " " << lsa.links.size ();
+      for (const ospf::OspfLsaLink &link : lsa.links)
+      {
+        os << " " << uint32_t (link.type) << " " << AddressPlan::FormatAddress (link.id) << " "
+           << AddressPlan::FormatAddress (link.data) << " " << link.metric;
+      }
+      os << "\n";
+    }
+    for (const Arp &entry : arps)
+    {
+      os << "arp " << entry.link << " " << entry.side << "\n";
+    }
+    return bool (os);
+  }
+
+  bool ReadFile (const std::string &path, std::string *error)
+  {
+    std::ifstream is (path);
+    if (!is)
+    {
+      *error = "nao foi possivel abrir " + path;
+      return false;
+    }
+    routes.clear ();
+    adjacencies.clear ();
+    lsas.clear ();
+    arps.clear ();
+    bool header = false;
+    std::string line;
+    uint32_t lineNo = 0;
+    while (std::getline (is, line))
+    {
+      ++lineNo;
+      std::istringstream fields (line.substr (0, line.find ('#')));
+      std::string kind;
+      if (!(fields >> kind))
+      {
+        continue;
+      }
+      bool ok;
+      if (kind == "warmstart")
+      {
+        ok = !header && bool (fields >> time >> nodes >> links >> topologyHash >> routingHash);
+        header = true;
+      }
+      else if (!header)
+      {
+        ok = false;
+      }
+      else if (kind == "route")
+      {
+        ok = ReadRoute (fields);
+      }
+      else if (kind == "adjacency")
+      {
+        ok = ReadAdjacency (fields);
+      }
+      else if (kind == "lsa")
+      {
+        ok = ReadLsa (fields);
+      }
+      else if (kind == "arp")
+      {
+        Arp arp;
+        ok = (fields >> arp.link >> arp.side) && arp.link < links && arp.side < 2;
+        arps.push_back (arp);
+      }
+      else
+      {
+        ok = false;
+      }
+      if (!ok)
+      {
+        *error = path + ": linha " + std::to_string (lineNo) + " invalida";
+        return false;
+      }
+    }
+    if (!header)
+    {
+      *error = path + ": sem o cabecalho warmstart";
+      return false;
+    }
+    return true;
+  }
+
+private:
+  static uint32_t MaskLength (uint32_t mask)
+  {
+    uint32_t length = 0;
+    for (; length < 32 && (mask & (0x80000000u >> length)); ++length)
+    {
+    }
+    return length;
+  }
+
+  static uint32_t LengthMask (uint32_t length)
+  {
+    return length == 0 ? 0 : 0xffffffffu << (32 - length);
+  }
+
+  static bool ReadAddress (std::istream &is, uint32_t *address)
+  {
+    std::string text;
+    uint32_t length;
+    return (is >> text) && AddressPlan::ParsePrefix (text, address, &length) && length == 32;
+  }
+
+  bool ReadRoute (std::istream &is)
+  {
+    Route entry;
+    BatchedRip::LearnedRoute &route = entry.route;
+    std::string prefix;
+    uint32_t length;
+    int64_t timeoutNs;
+    if (!(is >> entry.node >> prefix) || !AddressPlan::ParsePrefix (prefix, &route.network, &length)
+        || !ReadAddress (is, &route.gateway) || !(is >> route.interface >> route.metric >> timeoutNs)
+        || entry.node >= nodes)
+    {
+      return false;
+    }
+    route.mask = LengthMask (length);
+    route.timeout = NanoSeconds (timeoutNs);
+    routes.push_back (entry);
+    return true;
+  }
+
+  bool ReadAdjacency (std::istream &is)
+  {
+    Adjacency entry;
+    uint32_t address;
+    if (!(is >> entry.node >> entry.adjacency.interface) || !ReadAddress (is, &entry.adjacency.routerId)
+        || !ReadAddress (is, &address) || entry.node >= nodes)
+    {
+      return false;
+    }
+    entry.adjacency.address = Ipv4Address (address);
+    adjacencies.push_back (entry);
+    return true;
+  }
+
+  bool ReadLsa (std::istream &is)
+  {
+    Lsa entry;
+    ospf::OspfLsa &lsa = entry.lsa;
+    uint32_t nLinks;
+    if (!(is >> entry.node) || !ReadAddress (is, &lsa.advertisingRouter) || !(is >> lsa.sequence >> lsa.age >> nLinks)
+        || entry.node >= nodes)
+    {
+      return false;
+    }
+    for (uint32_t i = 0; i < nLinks; ++i)
+    {
+      ospf::OspfLsaLink link;
+      uint32_t type;
+      if (!(is >> type) || !ReadAddress (is, &link.id) || !ReadAddress (is, &link.data) || !(is >> link.metric))
+      {
+        return false;
+      }
+      link.type = type;
+      lsa.links.push_back (link);
+    }
+    lsas.push_back (entry);
+    return true;
+  }
+};
+
+class WarmStart
+{
+public:
+  explicit WarmStart (const TopologyLoader &topology)
+    : m_topology (topology)
+  {
+  }
+
+  // depois do topology.Build (); grava o estado no instante 'at', que deve
+  // vir depois da convergência e antes da primeira falha
+  void Save (Time at, const std::string &path)
+  {
+    CheckRouting ();
+    Simulator::Schedule (at, &WarmStart::Capture, this, path);
+  }
+
+  // depois do topology.Build () e antes do Simulator::Run (). Os nós agendam a
+  // própria inicialização em t = 0 quando são criados; o evento daqui, também
+  // em t = 0, roda depois dela, com os sockets e as interfaces dos protocolos
+  // já abertos
+  void Restore (const std::string &path)
+  {
+    std::string error;
+    if (!m_checkpoint.ReadFile (path, &error))
+    {
+      NS_FATAL_ERROR (error);
+    }
+    NS_ABORT_MSG_IF (m_checkpoint.nodes != m_topology.GetSpec ().nodes.size ()
+                       || m_checkpoint.links != m_topology.GetSpec ().links.size ()
+                       || m_checkpoint.topologyHash != HashTopology (),
+                     path << " was saved from another topology (" << m_checkpoint.nodes << " nodes, "
+                          << m_checkpoint.links << " links)");
+    CheckRouting ();
+    NS_ABORT_MSG_IF (m_checkpoint.routingHash != HashRouting (),
+                     path << " was saved with other routing protocols or attributes");
+    m_path = path;
+    Simulator::Schedule (Seconds (0), &WarmStart::Apply, this);
+  }
+
+  void Report (std::ostream &os) const
+  {
+    os << "Warm start from " << m_path << " (saved at " << m_checkpoint.time << " s): "
+       << m_checkpoint.routes.size () << " RIP routes, " << m_checkpoint.lsas.size () << " LSAs, "
+       << m_checkpoint.adjacencies.size () << " OSPF adjacencies, " << m_checkpoint.arps.size () << " ARP entries"
+       << std::endl;
+  }
+
+private:
+  // o ns3::Rip não deixa a tabela ser lida nem escrita
+  void CheckRouting () const
+  {
+    for (uint32_t i = 0; i < m_topology.GetSpec ().nodes.size (); ++i)
+    {
+      Ptr<Node> node = m_topology.GetNode (i);
+      NS_ABORT_MSG_IF (node->GetObject<Rip> () && !node->GetObject<BatchedRip> (),
+                       "ns3::Rip routing tables cannot be saved or restored; run with --batchedRip");
+    }
+  }
+
+  // nós (nome e papel), enlaces (nome, pontas e métrica) e sub-redes
+  uint64_t HashTopology () const
+  {
+    const TopologySpec &spec = m_topology.GetSpec ();
+    const AddressPlan &addresses = m_topology.GetAddressPlan ();
+    std::ostringstream text;
+    for (const TopologyNodeSpec &node : spec.nodes)
+    {
+      text << "node " << node.name << " " << node.host << "\n";
+    }
+    for (uint32_t i = 0; i < spec.links.size (); ++i)
+    {
+      const TopologyLinkSpec &link = spec.links[i];
+      const AddressPlan::Link &subnet = addresses.GetLink (i);
+      text << "link " << link.name << " " << link.a << " " << link.b << " " << link.metric << " "
+           << AddressPlan::FormatPrefix (subnet.network, subnet.prefixLength) << "\n";
+    }
+    return Hash64 (text.str ());
+  }
+
+  // protocolo de roteamento de cada nó e todos os atributos dele
+  uint64_t HashRouting () const
+  {
+    std::ostringstream text;
+    for (uint32_t i = 0; i < m_topology.GetSpec ().nodes.size (); ++i)
+    {
+      Ptr<Node> node = m_topology.GetNode (i);
+      text << "node " << i << "\n";
+      if (Ptr<BatchedRip> rip = node->GetObject<BatchedRip> ())
+      {
+        WriteAttributes (rip, text);
+      }
+      if (Ptr<OspfRouting> ospf = node->GetObject<OspfRouting> ())
+      {
+        WriteAttributes (ospf, text);
+      }
+    }
+    return Hash64 (text.str ());
+  }
+
+  static void WriteAttributes (Ptr<Object> object, std::ostream &os)
+  {
+    TypeId tid = object->GetInstanceTypeId ();
+    os << tid.GetName () << "\n";
+    for (std::size_t i = 0; i < tid.GetAttributeN (); ++i)
+    {
+      TypeId::AttributeInformation info = tid.GetAttribute (i);
+      Ptr<AttributeValue> value = info.checker->Create ();
+      object->GetAttribute (info.name, *value);
+      os << info.name << "=" << value->SerializeToString (info.checker) << "\n";
+    }
+  }
+
+  Ptr<ArpCache> GetArpCache (uint32_t link, uint32_t side) const
+  {
+    const TopologyLinkSpec &spec = m_topology.GetSpec ().links[link];
+    Ptr<Ipv4L3Protocol> ipv4 = m_topology.GetNode (side == 0 ? spec.a : spec.b)->GetObject<Ipv4L3Protocol> ();
+    return ipv4 ? ipv4->GetInterface (m_topology.GetInterface (link, side))->GetArpCache () : nullptr;
+  }
+
+  void Capture (std::string path)
+  {
+    const TopologySpec &spec = m_topology.GetSpec ();
+    Checkpoint checkpoint;
+    checkpoint.time = Simulator::Now ().GetSeconds ();
+    checkpoint.nodes = spec.nodes.size ();
+    checkpoint.links = spec.links.size ();
+    checkpoint.topologyHash = HashTopology ();
+    checkpoint.routingHash = HashRouting ();
+    for (uint32_t i = 0; i < spec.nodes.size (); ++i)
+    {
+      Ptr<Node> node = m_topology.GetNode (i);
+      if (Ptr<BatchedRip> rip = node->GetObject<BatchedRip> ())
+      {
+        for (const BatchedRip::LearnedRoute &route : rip->ExportRoutes ())
+        {
+          checkpoint.routes.push_back (Checkpoint::Route {i, route});
+        }
+      }
+      if (Ptr<OspfRouting> ospf = node->GetObject<OspfRouting> ())
+      {
+        for (const OspfRouting::Adjacency &adjacency : ospf->ExportAdjacencies ())
+        {
+          checkpoint.adjacencies.push_back (Checkpoint::Adjacency {i, adjacency});
+        }
+        for (const ospf::OspfLsa &lsa : ospf->ExportLsdb ())
+        {
+          checkpoint.lsas.push_back (Checkpoint::Lsa {i, lsa});
+        }
+      }
+    }
+    for (uint32_t link = 0; link < spec.links.size (); ++link)
+    {
+      for (uint32_t side = 0; side < 2; ++side)
+      {
+        Ptr<ArpCache> cache = GetArpCache (link, side);
+        ArpCache::Entry *entry = cache ? cache->Lookup (m_topology.GetAddress (link, 1 - side)) : nullptr;
+        if (entry != nullptr && entry->IsAlive ())
+        {
+          checkpoint.arps.push_back (Checkpoint::Arp {link, side});
+        }
+      }
+    }
+    std::string error;
+    if (!checkpoint.WriteFile (path, &error))
+    {
+      NS_FATAL_ERROR (error);
+    }
+    NS_LOG_INFO ("Saved " << checkpoint.routes.size () << " routes, " << checkpoint.lsas.size () << " LSAs and "
+                          << checkpoint.arps.size () << " ARP entries to " << path);
+  }
+
+  void Apply ()
+  {
+    for (const Checkpoint::Route &entry : m_checkpoint.routes)
+    {
+      Ptr<BatchedRip> rip = m_topology.GetNode (entry.node)->GetObject<BatchedRip> ();
+      NS_ABORT_MSG_IF (!rip, "Checkpoint has RIP routes for node " << m_topology.GetSpec ().nodes[entry.node].name
+                                                                   << ", which does not run BatchedRip");
+      rip->ImportRoute (entry.route);
+    }
+    for (const Checkpoint::Lsa &entry : m_checkpoint.lsas)
+    {
+      Ptr<OspfRouting> ospf = m_topology.GetNode (entry.node)->GetObject<OspfRouting> ();
+      NS_ABORT_MSG_IF (!ospf, "Checkpoint has LSAs for node " << m_topology.GetSpec ().nodes[entry.node].name
+                                                              << ", which does not run OSPF");
+      ospf->ImportLsa (entry.lsa);
+    }
+    for (const Checkpoint::Adjacency &entry : m_checkpoint.adjacencies)
+    {
+      Ptr<OspfRouting> ospf = m_topology.GetNode (entry.node)->GetObject<OspfRouting> ();
+      NS_ABORT_MSG_IF (!ospf, "Checkpoint has OSPF adjacencies for node "
+                                << m_topology.GetSpec ().nodes[entry.node].name << ", which does not run OSPF");
+      ospf->ImportAdjacency (entry.adjacency);
+    }
+    for (const Checkpoint::Arp &entry : m_checkpoint.arps)
+    {
+      Ptr<ArpCache> cache = GetArpCache (entry.link, entry.side);
+      if (!cache)
+      {
+        continue;
+      }
+      const TopologyLinkSpec &spec = m_topology.GetSpec ().links[entry.link];
+      uint32_t other = 1 - entry.side;
+      Ptr<Ipv4> ipv4 = m_topology.GetNode (other == 0 ? spec.a : spec.b)->GetObject<Ipv4> ();
+      Ipv4Address address = m_topology.GetAddress (entry.link, other);
+      ArpCache::Entry *arp = cache->Lookup (address);
+      if (arp == nullptr)
+      {
+        arp = cache->Add (address);
+      }
+      arp->SetMacAddress (ipv4->GetNetDevice (m_topology.GetInterface (entry.link, other))->GetAddress ());
+    }
+    NS_LOG_INFO ("Restored the state saved at " << m_checkpoint.time << " s from " << m_path);
+  }
+
+  const TopologyLoader &m_topology;
+  Checkpoint m_checkpoint;
+  std::string m_path;
+};
+
+} // namespace warmstart
+
+using warmstart::WarmStart;
+
+} // namespace ns3
+
+#endif /* WARM_START_H */